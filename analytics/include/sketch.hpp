@@ -0,0 +1,142 @@
+#pragma once
+#include "state-arena.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/*
+    Constant-memory stream summaries
+    - Every sketch is single-writer: keep one per thread and merge() them for reporting
+    - Updates take a precomputed 64 bit hash so a batch can hash all keys in one tight loop first
+    - Each sketch records the seed its callers hash keys with; two sketches only merge if shape and seed match
+    - The array-backed sketches can place their cells in a StateArena section, where they survive a restart
+*/
+
+// 128 bit key wide enough for an IPv4 5-tuple
+struct SketchKey {
+    uint64_t hi;
+    uint64_t lo;
+
+    bool operator==(const SketchKey& other) const { return hi == other.hi && lo == other.lo; }
+};
+
+// 64 bit mixer used to hash sketch keys
+uint64_t sketch_hash(const SketchKey& key, uint64_t seed);
+
+
+// Count-Min: frequency estimates that never undercount
+class CountMinSketch {
+public:
+    size_t depth;
+    size_t width;      // power of two
+    uint64_t seed;
+    uint64_t total;
+
+    CountMinSketch(size_t depth, size_t width, uint64_t seed = 0);
+    CountMinSketch(size_t depth, size_t width, uint64_t seed, StateArena& arena, std::string_view name,
+                   bool* found = nullptr);
+
+    void update(uint64_t hash, uint32_t count = 1);
+    void prefetch(uint64_t hash) const;
+    uint64_t estimate(uint64_t hash) const;
+    bool merge(const CountMinSketch& other);
+    void clear();
+
+private:
+    StateArray<uint32_t> counters;
+
+    size_t index(size_t row, uint64_t hash) const;
+};
+
+
+// Space-Saving: the k heaviest keys with guaranteed error bounds
+class SpaceSavingTopK {
+public:
+    struct Entry {
+        SketchKey key;
+        uint64_t count;
+        uint64_t error;    // count overestimates the true frequency by at most this much
+    };
+
+    size_t capacity;
+    uint64_t seed;
+
+    SpaceSavingTopK(size_t k, uint64_t seed = 0);
+
+    void update(const SketchKey& key, uint64_t hash, uint64_t count = 1);
+    bool merge(const SpaceSavingTopK& other);
+    void clear();
+
+    size_t size() const { return entries.size(); }
+
+    // Entries sorted by descending count
+    std::vector<Entry> top() const;
+
+    // Raw entries and their hashes (capacity slots each) for a checkpoint, returns how many are in use
+    size_t save(Entry* out_entries, uint64_t* out_hashes) const;
+    // Replaces the contents with saved entries, keeping at most capacity
+    void restore(const Entry* saved_entries, const uint64_t* saved_hashes, size_t n);
+
+private:
+    std::vector<Entry> entries;
+    std::vector<uint64_t> hashes;
+    std::vector<uint32_t> heap;        // min-heap of entry indices by count
+    std::vector<uint32_t> heap_pos;    // entry index -> heap slot
+    std::vector<uint32_t> slots;       // open-addressing index, 0 -> empty, else entry + 1
+    size_t slot_mask;
+
+    size_t find(const SketchKey& key, uint64_t hash) const;
+    void slot_insert(uint64_t hash, uint32_t entry);
+    void slot_erase(const SketchKey& key, uint64_t hash);
+    void sift_down(size_t pos);
+    void sift_up(size_t pos);
+    void heap_swap(size_t a, size_t b);
+};
+
+
+// HyperLogLog: distinct count in 2^precision one-byte registers
+class HyperLogLog {
+public:
+    uint8_t precision;
+    uint64_t seed;
+
+    HyperLogLog(uint8_t precision, uint64_t seed = 0);
+    HyperLogLog(uint8_t precision, uint64_t seed, StateArena& arena, std::string_view name, bool* found = nullptr);
+
+    void add(uint64_t hash);
+    double estimate() const;
+    bool merge(const HyperLogLog& other);
+    void clear();
+
+private:
+    StateArray<uint8_t> registers;
+
+    friend class DistinctPerKeySketch;
+};
+
+
+// Distinct-count per key (e.g. distinct sources per destination)
+// A Count-Min shaped grid of small HyperLogLogs: each key maps to one cell per row and the
+// smallest cell estimate is reported, which limits the inflation caused by colliding keys
+class DistinctPerKeySketch {
+public:
+    size_t depth;
+    size_t width;      // power of two
+    uint8_t precision;
+    uint64_t seed;     // of the key hashes
+
+    DistinctPerKeySketch(size_t depth, size_t width, uint8_t precision, uint64_t seed = 0);
+    DistinctPerKeySketch(size_t depth, size_t width, uint8_t precision, uint64_t seed, StateArena& arena,
+                         std::string_view name, bool* found = nullptr);
+
+    void add(uint64_t key_hash, uint64_t item_hash);
+    double estimate(uint64_t key_hash) const;
+    bool merge(const DistinctPerKeySketch& other);
+    void clear();
+
+private:
+    StateArray<uint8_t> registers;
+
+    size_t cell(size_t row, uint64_t key_hash) const;
+};
@@ -0,0 +1,89 @@
+#pragma once
+#include "sketch.hpp"
+#include "flow_key.hpp"
+#include "packet_view.hpp"
+#include "state-arena.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Dimensions tracked by TrafficSketches
+enum class SketchDimension {
+    SRC_ADDR,
+    DEST_ADDR,
+    DEST_PORT,
+    FLOW,
+    COUNT
+};
+
+struct TrafficSketchConfig {
+    size_t cm_depth = 4;
+    size_t cm_width = 1 << 16;
+    size_t top_k = 64;
+    uint8_t hll_precision = 12;
+
+    // Distinct sources per destination grid
+    size_t spread_depth = 2;
+    size_t spread_width = 4096;
+    uint8_t spread_precision = 6;
+
+    // Weight updates by frame length instead of 1 per packet
+    bool count_bytes = false;
+
+    uint64_t seed = 0x5DEECE66DULL;
+};
+
+// Per-thread analytics stage: Count-Min + Space-Saving + HyperLogLog for every dimension,
+// plus distinct sources per destination. Memory is fixed by the config, not by the traffic
+class TrafficSketches {
+public:
+    TrafficSketchConfig config;
+
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t skipped;      // packets without an IPv4 header
+    bool restored;         // every sketch came back from a StateArena snapshot
+
+    std::vector<CountMinSketch> frequency;
+    std::vector<SpaceSavingTopK> top;
+    std::vector<HyperLogLog> distinct;
+    DistinctPerKeySketch sources_per_dest;
+
+    TrafficSketches(const TrafficSketchConfig& config = TrafficSketchConfig());
+    // Sketch cells live in arena sections prefixed with name; a snapshot taken with another config starts empty
+    TrafficSketches(StateArena& arena, std::string_view name, const TrafficSketchConfig& config = TrafficSketchConfig());
+
+    // scale multiplies the packet's weight, e.g. LoadShedder::weight() for a sampled packet
+    void update(const PacketView& view, uint32_t scale = 1);
+    void update_batch(const PacketView* const* views, size_t n, uint32_t scale = 1);
+
+    // Folds another thread's sketches into this one, false if the configs differ
+    bool merge(const TrafficSketches& other);
+    void clear();
+
+    // Copies the counters and top-K lists into the arena section before a StateArena snapshot, no-op without an arena
+    void checkpoint();
+
+    uint64_t estimate(SketchDimension dim, const SketchKey& key) const;
+    double distinct_count(SketchDimension dim) const;
+    double distinct_sources(uint32_t dest_addr) const;
+
+    void print_top(size_t n) const;
+
+    static SketchKey make_key(SketchDimension dim, const FlowKey& flow);
+
+private:
+    struct SavedState;
+    SavedState* saved;
+
+    // Hashes for one packet, computed up front in the batch path
+    struct PacketHashes {
+        SketchKey keys[static_cast<size_t>(SketchDimension::COUNT)];
+        uint64_t hashes[static_cast<size_t>(SketchDimension::COUNT)];
+        uint64_t weight;
+    };
+
+    void hash_packet(const FlowKey& flow, uint64_t weight, PacketHashes& out) const;
+    void apply(const PacketHashes& packet);
+};
@@ -0,0 +1,432 @@
+#include "sketch.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+/*
+    Sketch Implementations
+    - CountMinSketch: depth rows of width counters, row i indexed by h1 + i * h2 (double hashing from one 64 bit hash)
+    - SpaceSavingTopK: k monitored keys, min-heap for the eviction candidate and a linear-probing index for lookups
+    - HyperLogLog: top precision bits pick the register, leading zeros of the rest give the rank
+    - DistinctPerKeySketch: Count-Min layout where every cell is a small HyperLogLog
+*/
+
+static size_t round_up_pow2(size_t n) {
+    return n < 2 ? 2 : std::bit_ceil(n);
+}
+
+uint64_t sketch_hash(const SketchKey& key, uint64_t seed) {
+    uint64_t h = seed ^ (key.hi * 0x9E3779B97F4A7C15ULL);
+    h ^= key.lo + 0xC2B2AE3D27D4EB4FULL + (h << 6) + (h >> 2);
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Register rank for the bits left after taking the index
+static inline uint8_t hll_rank(uint64_t hash, uint8_t precision) {
+    uint64_t rest = (hash << precision) | (1ULL << (precision - 1));
+    return static_cast<uint8_t>(std::countl_zero(rest) + 1);
+}
+
+static double hll_estimate(const uint8_t* registers, size_t m) {
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (size_t i = 0; i < m; i++) {
+        sum += std::ldexp(1.0, -registers[i]);
+        if (registers[i] == 0) {
+            zeros++;
+        }
+    }
+
+    double alpha;
+    if (m == 16) alpha = 0.673;
+    else if (m == 32) alpha = 0.697;
+    else if (m == 64) alpha = 0.709;
+    else alpha = 0.7213 / (1.0 + 1.079 / static_cast<double>(m));
+
+    double estimate = alpha * static_cast<double>(m) * static_cast<double>(m) / sum;
+
+    // Small range correction -> linear counting
+    if (estimate <= 2.5 * static_cast<double>(m) && zeros > 0) {
+        estimate = static_cast<double>(m) * std::log(static_cast<double>(m) / static_cast<double>(zeros));
+    }
+    return estimate;
+}
+
+
+// COUNT-MIN SKETCH
+CountMinSketch::CountMinSketch(size_t depth, size_t width, uint64_t seed) :
+    depth(std::max<size_t>(depth, 1)), width(round_up_pow2(width)), seed(seed), total(0),
+    counters(this->depth * this->width, 0)
+{
+}
+
+CountMinSketch::CountMinSketch(size_t depth, size_t width, uint64_t seed, StateArena& arena, std::string_view name,
+                               bool* found) :
+    depth(std::max<size_t>(depth, 1)), width(round_up_pow2(width)), seed(seed), total(0),
+    counters(arena, name, this->depth * this->width, 0, found)
+{
+}
+
+size_t CountMinSketch::index(size_t row, uint64_t hash) const {
+    uint32_t h1 = static_cast<uint32_t>(hash);
+    uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+    return row * width + ((h1 + row * h2) & (width - 1));
+}
+
+void CountMinSketch::update(uint64_t hash, uint32_t count) {
+    for (size_t row = 0; row < depth; row++) {
+        uint32_t& counter = counters[index(row, hash)];
+        // Saturate instead of wrapping so estimates stay upper bounds
+        counter = counter > UINT32_MAX - count ? UINT32_MAX : counter + count;
+    }
+    total += count;
+}
+
+void CountMinSketch::prefetch(uint64_t hash) const {
+    for (size_t row = 0; row < depth; row++) {
+        __builtin_prefetch(&counters[index(row, hash)], 1);
+    }
+}
+
+uint64_t CountMinSketch::estimate(uint64_t hash) const {
+    uint32_t result = UINT32_MAX;
+    for (size_t row = 0; row < depth; row++) {
+        result = std::min(result, counters[index(row, hash)]);
+    }
+    return result;
+}
+
+bool CountMinSketch::merge(const CountMinSketch& other) {
+    if (other.depth != depth || other.width != width || other.seed != seed) {
+        return false;
+    }
+    for (size_t i = 0; i < counters.size(); i++) {
+        uint64_t sum = static_cast<uint64_t>(counters[i]) + other.counters[i];
+        counters[i] = static_cast<uint32_t>(std::min<uint64_t>(sum, UINT32_MAX));
+    }
+    total += other.total;
+    return true;
+}
+
+void CountMinSketch::clear() {
+    std::fill(counters.begin(), counters.end(), 0);
+    total = 0;
+}
+
+
+// SPACE-SAVING TOP-K
+SpaceSavingTopK::SpaceSavingTopK(size_t k, uint64_t seed) :
+    capacity(std::max<size_t>(k, 1)), seed(seed),
+    heap_pos(capacity, 0),
+    slots(round_up_pow2(capacity * 2), 0),
+    slot_mask(slots.size() - 1)
+{
+    entries.reserve(capacity);
+    hashes.reserve(capacity);
+    heap.reserve(capacity);
+}
+
+size_t SpaceSavingTopK::find(const SketchKey& key, uint64_t hash) const {
+    for (size_t slot = hash & slot_mask; slots[slot] != 0; slot = (slot + 1) & slot_mask) {
+        uint32_t entry = slots[slot] - 1;
+        if (hashes[entry] == hash && entries[entry].key == key) {
+            return entry;
+        }
+    }
+    return SIZE_MAX;
+}
+
+void SpaceSavingTopK::slot_insert(uint64_t hash, uint32_t entry) {
+    size_t slot = hash & slot_mask;
+    while (slots[slot] != 0) {
+        slot = (slot + 1) & slot_mask;
+    }
+    slots[slot] = entry + 1;
+}
+
+// Backward-shift deletion keeps probe chains intact without tombstones
+void SpaceSavingTopK::slot_erase(const SketchKey& key, uint64_t hash) {
+    size_t slot = hash & slot_mask;
+    while (slots[slot] != 0) {
+        uint32_t entry = slots[slot] - 1;
+        if (hashes[entry] == hash && entries[entry].key == key) {
+            break;
+        }
+        slot = (slot + 1) & slot_mask;
+    }
+    if (slots[slot] == 0) {
+        return;
+    }
+
+    size_t hole = slot;
+    size_t next = (hole + 1) & slot_mask;
+    while (slots[next] != 0) {
+        size_t home = hashes[slots[next] - 1] & slot_mask;
+        // Move the entry back if the hole lies on its probe path
+        if (((next - home) & slot_mask) >= ((next - hole) & slot_mask)) {
+            slots[hole] = slots[next];
+            hole = next;
+        }
+        next = (next + 1) & slot_mask;
+    }
+    slots[hole] = 0;
+}
+
+void SpaceSavingTopK::heap_swap(size_t a, size_t b) {
+    std::swap(heap[a], heap[b]);
+    heap_pos[heap[a]] = static_cast<uint32_t>(a);
+    heap_pos[heap[b]] = static_cast<uint32_t>(b);
+}
+
+void SpaceSavingTopK::sift_down(size_t pos) {
+    while (true) {
+        size_t left = pos * 2 + 1;
+        size_t right = left + 1;
+        size_t smallest = pos;
+        if (left < heap.size() && entries[heap[left]].count < entries[heap[smallest]].count) {
+            smallest = left;
+        }
+        if (right < heap.size() && entries[heap[right]].count < entries[heap[smallest]].count) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            return;
+        }
+        heap_swap(pos, smallest);
+        pos = smallest;
+    }
+}
+
+void SpaceSavingTopK::sift_up(size_t pos) {
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (entries[heap[parent]].count <= entries[heap[pos]].count) {
+            return;
+        }
+        heap_swap(pos, parent);
+        pos = parent;
+    }
+}
+
+void SpaceSavingTopK::update(const SketchKey& key, uint64_t hash, uint64_t count) {
+    size_t entry = find(key, hash);
+    if (entry != SIZE_MAX) {
+        entries[entry].count += count;
+        sift_down(heap_pos[entry]);
+        return;
+    }
+
+    if (entries.size() < capacity) {
+        uint32_t index = static_cast<uint32_t>(entries.size());
+        entries.push_back(Entry{key, count, 0});
+        hashes.push_back(hash);
+        heap.push_back(index);
+        heap_pos[index] = static_cast<uint32_t>(heap.size() - 1);
+        slot_insert(hash, index);
+        sift_up(heap.size() - 1);
+        return;
+    }
+
+    // Replace the minimum: the newcomer inherits its count as error bound
+    uint32_t victim = heap[0];
+    slot_erase(entries[victim].key, hashes[victim]);
+    uint64_t floor = entries[victim].count;
+    entries[victim] = Entry{key, floor + count, floor};
+    hashes[victim] = hash;
+    slot_insert(hash, victim);
+    sift_down(0);
+}
+
+// Mergeable summaries: add counts of common keys, charge missing keys the other side's minimum
+bool SpaceSavingTopK::merge(const SpaceSavingTopK& other) {
+    // The stored hashes locate common keys, they have to come from the same seed
+    if (other.capacity != capacity || other.seed != seed) {
+        return false;
+    }
+
+    uint64_t own_min = entries.size() < capacity || heap.empty() ? 0 : entries[heap[0]].count;
+    uint64_t other_min = other.entries.size() < other.capacity || other.heap.empty() ? 0 : other.entries[other.heap[0]].count;
+
+    std::vector<Entry> combined;
+    std::vector<uint64_t> combined_hashes;
+    combined.reserve(entries.size() + other.entries.size());
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        Entry entry = entries[i];
+        size_t match = other.find(entry.key, hashes[i]);
+        if (match != SIZE_MAX) {
+            entry.count += other.entries[match].count;
+            entry.error += other.entries[match].error;
+        }
+        else {
+            entry.count += other_min;
+            entry.error += other_min;
+        }
+        combined.push_back(entry);
+        combined_hashes.push_back(hashes[i]);
+    }
+    for (size_t i = 0; i < other.entries.size(); i++) {
+        if (find(other.entries[i].key, other.hashes[i]) != SIZE_MAX) {
+            continue;
+        }
+        Entry entry = other.entries[i];
+        entry.count += own_min;
+        entry.error += own_min;
+        combined.push_back(entry);
+        combined_hashes.push_back(other.hashes[i]);
+    }
+
+    std::vector<uint32_t> order(combined.size());
+    for (uint32_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return combined[a].count > combined[b].count;
+    });
+    order.resize(std::min(order.size(), capacity));
+
+    std::vector<Entry> kept;
+    std::vector<uint64_t> kept_hashes;
+    for (uint32_t index : order) {
+        kept.push_back(combined[index]);
+        kept_hashes.push_back(combined_hashes[index]);
+    }
+    restore(kept.data(), kept_hashes.data(), kept.size());
+    return true;
+}
+
+size_t SpaceSavingTopK::save(Entry* out_entries, uint64_t* out_hashes) const {
+    std::copy(entries.begin(), entries.end(), out_entries);
+    std::copy(hashes.begin(), hashes.end(), out_hashes);
+    return entries.size();
+}
+
+void SpaceSavingTopK::restore(const Entry* saved_entries, const uint64_t* saved_hashes, size_t n) {
+    clear();
+    for (size_t i = 0; i < n && i < capacity; i++) {
+        uint32_t slot = static_cast<uint32_t>(entries.size());
+        entries.push_back(saved_entries[i]);
+        hashes.push_back(saved_hashes[i]);
+        heap.push_back(slot);
+        heap_pos[slot] = slot;
+        slot_insert(saved_hashes[i], slot);
+    }
+    // Saved entries come in any order: heapify bottom-up
+    for (size_t pos = heap.size() / 2; pos-- > 0;) {
+        sift_down(pos);
+    }
+}
+
+void SpaceSavingTopK::clear() {
+    entries.clear();
+    hashes.clear();
+    heap.clear();
+    std::fill(slots.begin(), slots.end(), 0);
+}
+
+std::vector<SpaceSavingTopK::Entry> SpaceSavingTopK::top() const {
+    std::vector<Entry> result(entries);
+    std::sort(result.begin(), result.end(), [](const Entry& a, const Entry& b) {
+        return a.count > b.count;
+    });
+    return result;
+}
+
+
+// HYPERLOGLOG
+HyperLogLog::HyperLogLog(uint8_t precision, uint64_t seed) :
+    precision(std::clamp<uint8_t>(precision, 4, 18)), seed(seed),
+    registers(static_cast<size_t>(1) << this->precision, 0)
+{
+}
+
+HyperLogLog::HyperLogLog(uint8_t precision, uint64_t seed, StateArena& arena, std::string_view name, bool* found) :
+    precision(std::clamp<uint8_t>(precision, 4, 18)), seed(seed),
+    registers(arena, name, static_cast<size_t>(1) << this->precision, 0, found)
+{
+}
+
+void HyperLogLog::add(uint64_t hash) {
+    size_t index = hash >> (64 - precision);
+    uint8_t rank = hll_rank(hash, precision);
+    registers[index] = std::max(registers[index], rank);
+}
+
+double HyperLogLog::estimate() const {
+    return hll_estimate(registers.data(), registers.size());
+}
+
+bool HyperLogLog::merge(const HyperLogLog& other) {
+    if (other.precision != precision || other.seed != seed) {
+        return false;
+    }
+    for (size_t i = 0; i < registers.size(); i++) {
+        registers[i] = std::max(registers[i], other.registers[i]);
+    }
+    return true;
+}
+
+void HyperLogLog::clear() {
+    std::fill(registers.begin(), registers.end(), 0);
+}
+
+
+// DISTINCT PER KEY SKETCH
+DistinctPerKeySketch::DistinctPerKeySketch(size_t depth, size_t width, uint8_t precision, uint64_t seed) :
+    depth(std::max<size_t>(depth, 1)), width(round_up_pow2(width)),
+    precision(std::clamp<uint8_t>(precision, 4, 12)), seed(seed),
+    registers(this->depth * this->width * (static_cast<size_t>(1) << this->precision), 0)
+{
+}
+
+DistinctPerKeySketch::DistinctPerKeySketch(size_t depth, size_t width, uint8_t precision, uint64_t seed,
+                                           StateArena& arena, std::string_view name, bool* found) :
+    depth(std::max<size_t>(depth, 1)), width(round_up_pow2(width)),
+    precision(std::clamp<uint8_t>(precision, 4, 12)), seed(seed),
+    registers(arena, name, this->depth * this->width * (static_cast<size_t>(1) << this->precision), 0, found)
+{
+}
+
+size_t DistinctPerKeySketch::cell(size_t row, uint64_t key_hash) const {
+    uint32_t h1 = static_cast<uint32_t>(key_hash);
+    uint32_t h2 = static_cast<uint32_t>(key_hash >> 32) | 1;
+    size_t column = (h1 + row * h2) & (width - 1);
+    return (row * width + column) << precision;
+}
+
+void DistinctPerKeySketch::add(uint64_t key_hash, uint64_t item_hash) {
+    size_t index = item_hash >> (64 - precision);
+    uint8_t rank = hll_rank(item_hash, precision);
+    for (size_t row = 0; row < depth; row++) {
+        uint8_t& reg = registers[cell(row, key_hash) + index];
+        reg = std::max(reg, rank);
+    }
+}
+
+double DistinctPerKeySketch::estimate(uint64_t key_hash) const {
+    double result = 0.0;
+    for (size_t row = 0; row < depth; row++) {
+        double row_estimate = hll_estimate(&registers[cell(row, key_hash)], static_cast<size_t>(1) << precision);
+        result = row == 0 ? row_estimate : std::min(result, row_estimate);
+    }
+    return result;
+}
+
+bool DistinctPerKeySketch::merge(const DistinctPerKeySketch& other) {
+    if (other.depth != depth || other.width != width || other.precision != precision || other.seed != seed) {
+        return false;
+    }
+    for (size_t i = 0; i < registers.size(); i++) {
+        registers[i] = std::max(registers[i], other.registers[i]);
+    }
+    return true;
+}
+
+void DistinctPerKeySketch::clear() {
+    std::fill(registers.begin(), registers.end(), 0);
+}
@@ -0,0 +1,294 @@
+#include "traffic-sketches.hpp"
+#include <iostream>
+#include <algorithm>
+#include <string>
+
+#define DIMENSIONS static_cast<size_t>(SketchDimension::COUNT)
+#define SKETCH_BATCH_BLOCK 32
+#define SKETCH_STATE_VERSION 1
+
+/*
+    TrafficSketches Class Implementation
+    - Feeds src IP, dst IP, dst port and 5-tuple keys from each PacketView into fixed-size sketches
+    - IPv4 only: the keys and the reported top lists are 32 bit addresses, IPv6 packets count as skipped
+    - The batch path runs in three passes per block: extract + hash, prefetch Count-Min cells, apply
+    - Intended to be owned by one worker thread and merged into a reporting copy
+    - In a StateArena, every sketch array gets a section "<name>.<sketch><dim>"; the scalars and top-K lists, which
+      are small, are copied into the "<name>" section by checkpoint() and reloaded by the constructor
+*/
+
+// "<name>" section: the config it was built with, the scalars, then top-K capacity entries and hashes per dimension
+struct TrafficSketches::SavedState {
+    uint32_t version;
+    uint32_t reserved;
+    TrafficSketchConfig config;
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t skipped;
+    uint64_t frequency_total[DIMENSIONS];
+    uint64_t top_size[DIMENSIONS];
+};
+
+static bool same_shape(const TrafficSketchConfig& a, const TrafficSketchConfig& b) {
+    return a.cm_depth == b.cm_depth && a.cm_width == b.cm_width && a.top_k == b.top_k &&
+           a.hll_precision == b.hll_precision && a.spread_depth == b.spread_depth &&
+           a.spread_width == b.spread_width && a.spread_precision == b.spread_precision &&
+           a.count_bytes == b.count_bytes && a.seed == b.seed;
+}
+
+// sources_per_dest is keyed by the destination address hash
+static uint64_t spread_seed(const TrafficSketchConfig& config) {
+    return config.seed + static_cast<size_t>(SketchDimension::DEST_ADDR);
+}
+
+static std::string section_name(std::string_view name, const char* sketch, size_t dim = DIMENSIONS) {
+    std::string result(name);
+    result += '.';
+    result += sketch;
+    if (dim < DIMENSIONS) {
+        result += static_cast<char>('0' + dim);
+    }
+    return result;
+}
+
+static const char* dimension_name(size_t dim) {
+    switch (static_cast<SketchDimension>(dim)) {
+        case SketchDimension::SRC_ADDR: return "Source IP";
+        case SketchDimension::DEST_ADDR: return "Destination IP";
+        case SketchDimension::DEST_PORT: return "Destination Port";
+        case SketchDimension::FLOW: return "Flow";
+        default: return "Unknown";
+    }
+}
+
+static void print_addr(uint32_t addr) {
+    std::cout << ((addr >> 24) & 0xFF) << "." << ((addr >> 16) & 0xFF) << "."
+              << ((addr >> 8) & 0xFF) << "." << (addr & 0xFF);
+}
+
+TrafficSketches::TrafficSketches(const TrafficSketchConfig& config) :
+    config(config), packets(0), bytes(0), skipped(0), restored(false),
+    sources_per_dest(config.spread_depth, config.spread_width, config.spread_precision, spread_seed(config)),
+    saved(nullptr)
+{
+    for (size_t dim = 0; dim < DIMENSIONS; dim++) {
+        frequency.emplace_back(config.cm_depth, config.cm_width, config.seed + dim);
+        top.emplace_back(config.top_k, config.seed + dim);
+        distinct.emplace_back(config.hll_precision, config.seed + dim);
+    }
+}
+
+TrafficSketches::TrafficSketches(StateArena& arena, std::string_view name, const TrafficSketchConfig& config) :
+    config(config), packets(0), bytes(0), skipped(0), restored(false),
+    sources_per_dest(config.spread_depth, config.spread_width, config.spread_precision, spread_seed(config), arena,
+                     section_name(name, "spread"), &restored),
+    saved(nullptr)
+{
+    bool found = restored;
+    for (size_t dim = 0; dim < DIMENSIONS; dim++) {
+        bool cells = false;
+        bool registers = false;
+        frequency.emplace_back(config.cm_depth, config.cm_width, config.seed + dim, arena, section_name(name, "cm", dim),
+                               &cells);
+        top.emplace_back(config.top_k, config.seed + dim);
+        distinct.emplace_back(config.hll_precision, config.seed + dim, arena, section_name(name, "hll", dim), &registers);
+        found = found && cells && registers;
+    }
+
+    bool saved_found = false;
+    size_t k = top[0].capacity;
+    size_t saved_size = sizeof(SavedState) + DIMENSIONS * k * (sizeof(SpaceSavingTopK::Entry) + sizeof(uint64_t));
+    saved = static_cast<SavedState*>(arena.section(name, saved_size, &saved_found));
+    restored = found && saved_found && saved->version == SKETCH_STATE_VERSION && same_shape(saved->config, config);
+    if (!restored) {
+        // Partial or foreign state is worse than none
+        clear();
+        return;
+    }
+
+    packets = saved->packets;
+    bytes = saved->bytes;
+    skipped = saved->skipped;
+    const SpaceSavingTopK::Entry* entries = reinterpret_cast<const SpaceSavingTopK::Entry*>(saved + 1);
+    const uint64_t* hashes = reinterpret_cast<const uint64_t*>(entries + DIMENSIONS * k);
+    for (size_t dim = 0; dim < DIMENSIONS; dim++) {
+        frequency[dim].total = saved->frequency_total[dim];
+        top[dim].restore(entries + dim * k, hashes + dim * k, saved->top_size[dim]);
+    }
+}
+
+SketchKey TrafficSketches::make_key(SketchDimension dim, const FlowKey& flow) {
+    switch (dim) {
+        case SketchDimension::SRC_ADDR:
+            return SketchKey{0, flow.src_addr};
+        case SketchDimension::DEST_ADDR:
+            return SketchKey{0, flow.dest_addr};
+        case SketchDimension::DEST_PORT:
+            return SketchKey{0, flow.dest_port};
+        case SketchDimension::FLOW:
+        default:
+            return SketchKey{
+                (static_cast<uint64_t>(flow.src_addr) << 32) | flow.dest_addr,
+                (static_cast<uint64_t>(flow.src_port) << 24) | (static_cast<uint64_t>(flow.dest_port) << 8) | flow.protocol
+            };
+    }
+}
+
+void TrafficSketches::hash_packet(const FlowKey& flow, uint64_t weight, PacketHashes& out) const {
+    for (size_t dim = 0; dim < DIMENSIONS; dim++) {
+        out.keys[dim] = make_key(static_cast<SketchDimension>(dim), flow);
+        out.hashes[dim] = sketch_hash(out.keys[dim], config.seed + dim);
+    }
+    out.weight = weight;
+}
+
+void TrafficSketches::apply(const PacketHashes& packet) {
+    for (size_t dim = 0; dim < DIMENSIONS; dim++) {
+        frequency[dim].update(packet.hashes[dim], static_cast<uint32_t>(packet.weight));
+        top[dim].update(packet.keys[dim], packet.hashes[dim], packet.weight);
+        distinct[dim].add(packet.hashes[dim]);
+    }
+    sources_per_dest.add(packet.hashes[static_cast<size_t>(SketchDimension::DEST_ADDR)],
+                         packet.hashes[static_cast<size_t>(SketchDimension::SRC_ADDR)]);
+}
+
+void TrafficSketches::update(const PacketView& view, uint32_t scale) {
+    FlowKey flow;
+    if (!make_flow_key(view, flow) || flow.ipv6) {
+        skipped++;
+        return;
+    }
+
+    PacketHashes packet;
+    hash_packet(flow, (config.count_bytes ? view.size() : 1) * static_cast<uint64_t>(scale), packet);
+    apply(packet);
+
+    packets++;
+    bytes += view.size();
+}
+
+void TrafficSketches::update_batch(const PacketView* const* views, size_t n, uint32_t scale) {
+    PacketHashes block[SKETCH_BATCH_BLOCK];
+
+    for (size_t base = 0; base < n; base += SKETCH_BATCH_BLOCK) {
+        size_t count = std::min(static_cast<size_t>(SKETCH_BATCH_BLOCK), n - base);
+        size_t valid = 0;
+
+        for (size_t i = 0; i < count; i++) {
+            const PacketView& view = *views[base + i];
+            FlowKey flow;
+            if (!make_flow_key(view, flow) || flow.ipv6) {
+                skipped++;
+                continue;
+            }
+            hash_packet(flow, (config.count_bytes ? view.size() : 1) * static_cast<uint64_t>(scale), block[valid++]);
+            packets++;
+            bytes += view.size();
+        }
+
+        for (size_t i = 0; i < valid; i++) {
+            for (size_t dim = 0; dim < DIMENSIONS; dim++) {
+                frequency[dim].prefetch(block[i].hashes[dim]);
+            }
+        }
+
+        for (size_t i = 0; i < valid; i++) {
+            apply(block[i]);
+        }
+    }
+}
+
+bool TrafficSketches::merge(const TrafficSketches& other) {
+    if (other.config.seed != config.seed) {
+        return false;
+    }
+    for (size_t dim = 0; dim < DIMENSIONS; dim++) {
+        if (!frequency[dim].merge(other.frequency[dim]) ||
+            !top[dim].merge(other.top[dim]) ||
+            !distinct[dim].merge(other.distinct[dim])) {
+            return false;
+        }
+    }
+    if (!sources_per_dest.merge(other.sources_per_dest)) {
+        return false;
+    }
+    packets += other.packets;
+    bytes += other.bytes;
+    skipped += other.skipped;
+    return true;
+}
+
+void TrafficSketches::clear() {
+    for (size_t dim = 0; dim < DIMENSIONS; dim++) {
+        frequency[dim].clear();
+        top[dim].clear();
+        distinct[dim].clear();
+    }
+    sources_per_dest.clear();
+    packets = 0;
+    bytes = 0;
+    skipped = 0;
+}
+
+void TrafficSketches::checkpoint() {
+    if (!saved) {
+        return;
+    }
+    size_t k = top[0].capacity;
+    saved->version = SKETCH_STATE_VERSION;
+    saved->config = config;
+    saved->packets = packets;
+    saved->bytes = bytes;
+    saved->skipped = skipped;
+    SpaceSavingTopK::Entry* entries = reinterpret_cast<SpaceSavingTopK::Entry*>(saved + 1);
+    uint64_t* hashes = reinterpret_cast<uint64_t*>(entries + DIMENSIONS * k);
+    for (size_t dim = 0; dim < DIMENSIONS; dim++) {
+        saved->frequency_total[dim] = frequency[dim].total;
+        saved->top_size[dim] = top[dim].save(entries + dim * k, hashes + dim * k);
+    }
+}
+
+uint64_t TrafficSketches::estimate(SketchDimension dim, const SketchKey& key) const {
+    size_t index = static_cast<size_t>(dim);
+    return frequency[index].estimate(sketch_hash(key, config.seed + index));
+}
+
+double TrafficSketches::distinct_count(SketchDimension dim) const {
+    return distinct[static_cast<size_t>(dim)].estimate();
+}
+
+double TrafficSketches::distinct_sources(uint32_t dest_addr) const {
+    return sources_per_dest.estimate(sketch_hash(SketchKey{0, dest_addr}, spread_seed(config)));
+}
+
+void TrafficSketches::print_top(size_t n) const {
+    std::cout << "=== TRAFFIC SKETCHES ===\n";
+    std::cout << "Packets: " << packets << " Bytes: " << bytes << " Skipped: " << skipped << '\n';
+
+    for (size_t dim = 0; dim < DIMENSIONS; dim++) {
+        std::cout << "--- " << dimension_name(dim) << " (~" << static_cast<uint64_t>(distinct[dim].estimate())
+                  << " distinct) ---\n";
+
+        std::vector<SpaceSavingTopK::Entry> entries = top[dim].top();
+        for (size_t i = 0; i < entries.size() && i < n; i++) {
+            const SketchKey& key = entries[i].key;
+            switch (static_cast<SketchDimension>(dim)) {
+                case SketchDimension::SRC_ADDR:
+                case SketchDimension::DEST_ADDR:
+                    print_addr(static_cast<uint32_t>(key.lo));
+                    break;
+                case SketchDimension::DEST_PORT:
+                    std::cout << key.lo;
+                    break;
+                default:
+                    print_addr(static_cast<uint32_t>(key.hi >> 32));
+                    std::cout << ":" << ((key.lo >> 24) & 0xFFFF) << " -> ";
+                    print_addr(static_cast<uint32_t>(key.hi));
+                    std::cout << ":" << ((key.lo >> 8) & 0xFFFF) << " proto " << (key.lo & 0xFF);
+                    break;
+            }
+            std::cout << "  count=" << entries[i].count << " (+/-" << entries[i].error << ")\n";
+        }
+    }
+    std::cout << "========================\n";
+}
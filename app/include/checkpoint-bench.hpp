@@ -0,0 +1,8 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Fills a TcpTracker (half full, SYN-only flows) and a TrafficSketches in one StateArena for growing table sizes,
+// then times the background snapshot (fork pause and write) and the restore (mmap, first full scan) against
+// rebuilding the same state from packets; the snapshot file at path is removed afterwards
+int run_checkpoint_bench(const std::string& path, size_t max_capacity);
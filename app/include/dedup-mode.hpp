@@ -0,0 +1,6 @@
+#pragma once
+#include "packet-dedup.hpp"
+#include <string>
+
+// Suppresses duplicate frames of the pcap at path and compares the cost with the parse + validate it saves
+int run_dedup_mode(const std::string& path, const DedupConfig& config);
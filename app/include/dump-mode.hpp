@@ -0,0 +1,10 @@
+#pragma once
+#include "packet-formatter.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Parses and validates count packets (cycling through the set) and streams them to stdout through the
+// buffered PacketFormatter in the given format
+int run_dump_mode(const std::vector<std::span<const uint8_t>>& packets, OutputFormat format, size_t count);
@@ -0,0 +1,10 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Parses and validates count packets (cycling through the set) and writes their metadata to a columnar file at path,
+// with synthetic 1 us spacing as the timestamps
+int run_export_mode(const std::string& path, const std::vector<std::span<const uint8_t>>& packets, size_t count);
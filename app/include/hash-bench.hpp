@@ -0,0 +1,6 @@
+#pragma once
+#include <cstddef>
+
+// Times every flow hash in flow_hash.hpp (scalar and batch) and checks bucket distribution and symmetry
+// on random and on sequential tuples
+int run_hash_bench(size_t rounds);
@@ -0,0 +1,9 @@
+#pragma once
+#include "load-shedder.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Serves live metrics on 127.0.0.1:port while the full pipeline consumes the ring name until count records or the
+// producer exits; without shed the shedder is configured never to leave full inspection
+int run_metrics_mode(const std::string& name, size_t count, LoadShedderConfig config, bool shed, uint16_t port);
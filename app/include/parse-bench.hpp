@@ -0,0 +1,10 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Times parse_packet over the plain IPv4, plain IPv6 and encapsulated packets and the whole mix separately
+// and prints best and mean ns/packet, so the IPv4 fast path can be compared across builds
+// The IPv4 group is timed once more with max_encap_depth = 0 and the decoder's overhead over it is reported
+int run_parse_bench(const std::vector<std::span<const uint8_t>>& packets, size_t rounds);
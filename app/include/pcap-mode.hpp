@@ -0,0 +1,14 @@
+#pragma once
+#include "async-file.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Writes count packets (cycling through the set, 1 us apart) as a nanosecond pcap through the io_uring writer
+int run_write_pcap_mode(const std::string& path, const std::vector<std::span<const uint8_t>>& packets, size_t count,
+                        const AsyncIoOptions& options);
+
+// Parses and validates every record of a pcap while the reader keeps the next buffers in flight
+int run_read_pcap_mode(const std::string& path, const AsyncIoOptions& options);
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Hardware events read by PerfCounters
+enum class PerfEvent {
+    CYCLES,
+    INSTRUCTIONS,
+    BRANCH_MISSES,
+    L1D_MISSES,
+    LLC_MISSES,
+    COUNT
+};
+
+#define PERF_EVENT_COUNT static_cast<size_t>(PerfEvent::COUNT)
+
+// One read of the counter group, already scaled for multiplexing
+struct PerfSample {
+    uint64_t values[PERF_EVENT_COUNT];
+    bool valid[PERF_EVENT_COUNT];
+    uint64_t wall_ns;
+};
+
+// perf_event_open counter group for the calling thread (user space only)
+// - events that cannot be opened are marked unavailable, the rest still work
+// - with no counters at all, start()/stop() still measure wall-clock time
+class PerfCounters {
+public:
+    bool available[PERF_EVENT_COUNT];
+
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool any_available() const;
+
+    void start();
+    void stop(PerfSample& sample);
+
+    static const char* event_name(PerfEvent event);
+
+private:
+    int fds[PERF_EVENT_COUNT];
+    uint64_t ids[PERF_EVENT_COUNT];
+    int leader;
+    uint64_t start_ns;
+};
@@ -0,0 +1,9 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Runs the parse and validate loops over the packet set under PerfCounters and prints
+// per-packet figures (cycles, instructions, IPC, branch/L1d/LLC misses, ns)
+int run_profile_mode(const std::vector<std::span<const uint8_t>>& packets, size_t rounds);
@@ -0,0 +1,14 @@
+#pragma once
+#include "packet-recorder.hpp"
+#include "flow_key.hpp"
+#include <cstdint>
+#include <string>
+
+// Parses and validates the pcap at path while recording every frame into rolling segments under directory,
+// and reports what the recorder costs the packet path
+int run_record_mode(const std::string& path, const std::string& directory, const RecorderConfig& config);
+
+// Reads [from_ns, to_ns) back from the segments under directory, only flow (either direction) when it is not null,
+// into the pcap output when it is not null
+int run_recall_mode(const std::string& directory, uint64_t from_ns, uint64_t to_ns, const FlowKey* flow,
+                    const char* output);
@@ -0,0 +1,6 @@
+#pragma once
+#include "pcap-replay.hpp"
+#include <string>
+
+// Replays the pcap at path with config into parse + validate, or onto iface when it is not null
+int run_replay_mode(const std::string& path, const ReplayConfig& config, const char* iface);
@@ -0,0 +1,9 @@
+#pragma once
+#include "load-shedder.hpp"
+#include "live-metrics.hpp"
+#include <cstddef>
+#include <string>
+
+// Attaches to the ring name and runs the full pipeline on every record under a LoadShedder until count records or
+// the producer exits; metrics, when given, is this thread's shard of the live metrics registry
+int run_shed_mode(const std::string& name, size_t count, const LoadShedderConfig& config, MetricsShard* metrics);
@@ -0,0 +1,14 @@
+#pragma once
+#include "shm-ring.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Creates the shared-memory ring name and publishes count parsed + validated packets (cycling through the set)
+int run_publish_mode(const std::string& name, const std::vector<std::span<const uint8_t>>& packets, size_t count,
+                     const ShmRingConfig& config);
+
+// Attaches to the ring name and reads metadata only until count records or the producer exits
+int run_subscribe_mode(const std::string& name, size_t count);
@@ -0,0 +1,6 @@
+#pragma once
+#include <string>
+
+// Runs the incremental HTTP / TLS parsers over every TCP direction of the pcap at path and compares what they
+// extract with the one-shot classifier
+int run_stream_l7_mode(const std::string& path);
@@ -0,0 +1,6 @@
+#pragma once
+#include <string>
+
+// Follows every TCP connection of the pcap at path through a TcpTracker and prints its counters
+// With a state_path the table lives in a StateArena: it resumes from that snapshot and is saved back at the end
+int run_track_tcp_mode(const std::string& path, const std::string& state_path);
@@ -0,0 +1,7 @@
+#pragma once
+#include "raw-capture.hpp"
+#include <cstddef>
+#include <string>
+
+// AF_XDP capture on iface into parse + validate until count frames or 2 s without traffic
+int run_xdp_mode(const std::string& iface, size_t count, const XdpConfig& config);
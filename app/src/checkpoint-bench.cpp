@@ -0,0 +1,114 @@
+#include "checkpoint-bench.hpp"
+#include "parser.hpp"
+#include "state-arena.hpp"
+#include "tcp-tracker.hpp"
+#include "traffic-sketches.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <unistd.h>
+
+#define CHECKPOINT_BENCH_MIN_CAPACITY (1 << 16)
+#define CHECKPOINT_BENCH_FRAME_SIZE 54
+#define CHECKPOINT_BENCH_SRC_OFFSET 26
+#define CHECKPOINT_BENCH_PORT_OFFSET 34
+
+/*
+    Checkpoint Benchmark
+    - One SYN template (Ethernet / IPv4 / TCP); flow i rewrites the source address and port, so every packet opens
+      a new connection and the tracker ends up half full
+    - Rebuild: time to feed those packets through parse + tracker + sketches, what a cold restart has to replay
+    - Snapshot: fork pause seen by the caller, then fork to writer exit (write + fsync + rename)
+    - Restore: mapping the file and constructing both components; first scan: count_state() over every slot,
+      which faults the table in from the page cache (the file was just written, so the cache is warm)
+*/
+
+static const uint8_t syn_template[CHECKPOINT_BENCH_FRAME_SIZE] = {
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0x08, 0x00,
+    0x45, 0x00, 0x00, 0x28, 0x12, 0x34, 0x40, 0x00, 0x40, 0x06, 0x00, 0x00,
+    0x0A, 0x00, 0x00, 0x00, 0xC0, 0xA8, 0x01, 0x03,
+    0x00, 0x00, 0x01, 0xBB, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x50, 0x02, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00
+};
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void run_size(const std::string& path, size_t capacity) {
+    TcpTrackerConfig tracker_config;
+    tracker_config.capacity = capacity;
+    size_t arena_size = capacity * sizeof(TcpFlowSlot) * 2 + (64 << 20);
+    size_t flows = capacity / 2;
+
+    double rebuild_ms;
+    double fork_ms;
+    double write_ms;
+    size_t state_bytes;
+    size_t active;
+    {
+        StateArena arena(arena_size);
+        TcpTracker tracker(arena, "tcp", tracker_config);
+        TrafficSketches sketches(arena, "sketches");
+
+        uint8_t frame[CHECKPOINT_BENCH_FRAME_SIZE];
+        std::memcpy(frame, syn_template, sizeof(frame));
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < flows; i++) {
+            uint32_t src = 0x0A000000u | static_cast<uint32_t>(i >> 8);
+            uint16_t port = static_cast<uint16_t>(1024 + (i & 0xFF));
+            frame[CHECKPOINT_BENCH_SRC_OFFSET] = static_cast<uint8_t>(src >> 24);
+            frame[CHECKPOINT_BENCH_SRC_OFFSET + 1] = static_cast<uint8_t>(src >> 16);
+            frame[CHECKPOINT_BENCH_SRC_OFFSET + 2] = static_cast<uint8_t>(src >> 8);
+            frame[CHECKPOINT_BENCH_SRC_OFFSET + 3] = static_cast<uint8_t>(src);
+            frame[CHECKPOINT_BENCH_PORT_OFFSET] = static_cast<uint8_t>(port >> 8);
+            frame[CHECKPOINT_BENCH_PORT_OFFSET + 1] = static_cast<uint8_t>(port);
+            ParsedPacket packet = parse_packet(std::span<const uint8_t>(frame, sizeof(frame)));
+            tracker.update(1000000000ULL + i * 100, packet.view);
+            sketches.update(packet.view);
+        }
+        rebuild_ms = elapsed_ms(start);
+
+        tracker.checkpoint();
+        sketches.checkpoint();
+        arena.snapshot_background(path);
+        arena.snapshot_poll(true);
+        fork_ms = arena.last_fork_ns / 1e6;
+        write_ms = arena.last_write_ns / 1e6;
+        state_bytes = arena.used();
+        active = tracker.active_flows();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    StateArena arena(path, arena_size);
+    TcpTracker tracker(arena, "tcp", tracker_config);
+    TrafficSketches sketches(arena, "sketches");
+    double restore_ms = elapsed_ms(start);
+
+    start = std::chrono::steady_clock::now();
+    size_t half_open = tracker.count_state(TcpState::SYN_SENT);
+    double scan_ms = elapsed_ms(start);
+
+    bool intact = arena.restored && tracker.restored && sketches.restored &&
+                  tracker.active_flows() == active && half_open == active && sketches.packets == flows;
+
+    std::cout << std::setw(10) << state_bytes / (1 << 20) << std::setw(10) << active
+              << std::setw(12) << rebuild_ms << std::setw(10) << fork_ms << std::setw(10) << write_ms
+              << std::setw(12) << restore_ms << std::setw(12) << scan_ms
+              << (intact ? "" : "  RESTORE MISMATCH") << '\n';
+}
+
+int run_checkpoint_bench(const std::string& path, size_t max_capacity) {
+    std::cout << "=== CHECKPOINT BENCH: " << path << " ===\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(10) << "state MB" << std::setw(10) << "flows" << std::setw(12) << "rebuild ms"
+              << std::setw(10) << "fork ms" << std::setw(10) << "write ms" << std::setw(12) << "restore ms"
+              << std::setw(12) << "scan ms" << '\n';
+    for (size_t capacity = CHECKPOINT_BENCH_MIN_CAPACITY; capacity <= max_capacity; capacity <<= 2) {
+        run_size(path, capacity);
+    }
+    std::cout << std::defaultfloat << std::setprecision(6);
+    std::cout << "=================\n";
+    unlink(path.c_str());
+    return 0;
+}
@@ -0,0 +1,22 @@
+#include "dump-mode.hpp"
+#include "parser.hpp"
+#include "validation.hpp"
+#include "output-buffer.hpp"
+
+/*
+    Dump Mode
+    - Every packet goes through parse_packet and PacketValidator, then one PacketFormatter call
+    - All records share a single OutputBuffer, so stdout sees large writes instead of one per line
+*/
+
+int run_dump_mode(const std::vector<std::span<const uint8_t>>& packets, OutputFormat format, size_t count) {
+    OutputBuffer out;
+    PacketFormatter formatter(out, format);
+    formatter.write_header();
+    for (size_t i = 0; i < count && !packets.empty(); i++) {
+        ParsedPacket packet = parse_packet(packets[i % packets.size()]);
+        PacketValidator validator(packet.view);
+        formatter.write_packet(packet.view, &validator);
+    }
+    return out.flush() ? 0 : 1;
+}
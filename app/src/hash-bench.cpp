@@ -0,0 +1,198 @@
+#include "hash-bench.hpp"
+#include "flow_hash.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#define HASH_BENCH_WORKING_SET 4096
+#define HASH_BENCH_BUCKETS 1024
+#define HASH_BENCH_QUALITY_KEYS (1 << 18)
+#define HASH_BENCH_SEED 0x5EED
+
+/*
+    Hash Benchmark
+    - Every round is one timed pass over HASH_BENCH_WORKING_SET random tuples, the best pass is reported
+    - Batch variants hash the same tuples from FlowColumns into an output array; flow_hash batch is timed on the
+      dispatched path and on the scalar loop
+    - Quality: low bits into HASH_BENCH_BUCKETS buckets (how the tables index), chi-square per degree of freedom
+      (about 1 is ideal) and the fullest bucket against the mean, for random tuples and for sequential ones
+      (one client walking its source port and address), plus reversed-tuple mismatches
+*/
+
+struct TupleSet {
+    std::vector<FlowKey> keys;
+    std::vector<uint32_t> src_addr;
+    std::vector<uint32_t> dest_addr;
+    std::vector<uint16_t> src_port;
+    std::vector<uint16_t> dest_port;
+    std::vector<uint8_t> protocol;
+
+    void add(const FlowKey& key) {
+        keys.push_back(key);
+        src_addr.push_back(key.src_addr);
+        dest_addr.push_back(key.dest_addr);
+        src_port.push_back(key.src_port);
+        dest_port.push_back(key.dest_port);
+        protocol.push_back(key.protocol);
+    }
+
+    FlowColumns columns() const {
+        return FlowColumns{src_addr.data(), dest_addr.data(), src_port.data(), dest_port.data(), protocol.data()};
+    }
+};
+
+static FlowKey random_key(std::mt19937& rng) {
+    return FlowKey{static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng()),
+                   static_cast<uint16_t>(rng()), static_cast<uint16_t>(rng()),
+                   static_cast<uint8_t>(rng() & 1 ? 6 : 17)};
+}
+
+// One client (10.0.x.y) walking its source port towards a single server 10.1.0.1:443
+static FlowKey sequential_key(size_t i) {
+    return FlowKey{0x0A000000u | static_cast<uint32_t>(i >> 16), 0x0A010001u,
+                   static_cast<uint16_t>(i), 443, 6};
+}
+
+template <typename Pass>
+static void time_pass(const char* name, size_t rounds, Pass pass) {
+    uint64_t best_ns = UINT64_MAX;
+    for (size_t round = 0; round < rounds; round++) {
+        auto start = std::chrono::steady_clock::now();
+        pass();
+        auto end = std::chrono::steady_clock::now();
+        uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        best_ns = std::min(best_ns, ns);
+    }
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << best_ns / static_cast<double>(HASH_BENCH_WORKING_SET) << " ns/tuple\n";
+    std::cout << std::defaultfloat << std::setprecision(6);
+}
+
+template <typename Hash>
+static void quality(const char* name, const std::vector<FlowKey>& random, Hash hash) {
+    std::vector<uint64_t> buckets(HASH_BENCH_BUCKETS);
+    double expected = static_cast<double>(HASH_BENCH_QUALITY_KEYS) / HASH_BENCH_BUCKETS;
+
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2);
+    for (int pass = 0; pass < 2; pass++) {
+        std::fill(buckets.begin(), buckets.end(), 0);
+        for (size_t i = 0; i < HASH_BENCH_QUALITY_KEYS; i++) {
+            const FlowKey key = pass == 0 ? random[i] : sequential_key(i);
+            buckets[hash(key) & (HASH_BENCH_BUCKETS - 1)]++;
+        }
+        double chi = 0.0;
+        for (uint64_t count : buckets) {
+            double d = static_cast<double>(count) - expected;
+            chi += d * d / expected;
+        }
+        uint64_t fullest = *std::max_element(buckets.begin(), buckets.end());
+        std::cout << std::setw(12) << chi / (HASH_BENCH_BUCKETS - 1) << std::setw(8) << fullest / expected;
+    }
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < HASH_BENCH_QUALITY_KEYS; i++) {
+        const FlowKey& key = random[i];
+        FlowKey reverse{key.dest_addr, key.src_addr, key.dest_port, key.src_port, key.protocol};
+        mismatches += hash(key) != hash(reverse);
+    }
+    std::cout << std::setw(12) << mismatches << '\n';
+    std::cout << std::defaultfloat << std::setprecision(6);
+}
+
+int run_hash_bench(size_t rounds) {
+    if (rounds == 0) {
+        std::cout << "Hash bench: nothing to run\n";
+        return 1;
+    }
+
+    std::mt19937 rng(HASH_BENCH_SEED);
+    TupleSet set;
+    for (size_t i = 0; i < HASH_BENCH_WORKING_SET; i++) {
+        set.add(random_key(rng));
+    }
+    FlowColumns columns = set.columns();
+
+    ToeplitzHasher toeplitz;
+    std::vector<uint32_t> out32(HASH_BENCH_WORKING_SET);
+    std::vector<uint64_t> out64(HASH_BENCH_WORKING_SET);
+    volatile uint64_t sink = 0;
+
+    std::cout << "=== HASH BENCH ===\n";
+    std::cout << "Tuples: " << HASH_BENCH_WORKING_SET << " Rounds: " << rounds
+              << " CRC32C instruction: " << (flow_hash_crc32c_hardware() ? "yes" : "no")
+              << " AVX2 batch: " << (flow_hash_batch_avx2() ? "yes" : "no") << '\n';
+
+    // The bit-serial form is only the reference, a tenth of the rounds is plenty
+    time_pass("toeplitz (bit-serial)", rounds / 10 + 1, [&] {
+        uint32_t acc = 0;
+        for (const FlowKey& key : set.keys) {
+            uint8_t tuple[RSS_IPV4_TUPLE_SIZE] = {
+                static_cast<uint8_t>(key.src_addr >> 24), static_cast<uint8_t>(key.src_addr >> 16),
+                static_cast<uint8_t>(key.src_addr >> 8), static_cast<uint8_t>(key.src_addr),
+                static_cast<uint8_t>(key.dest_addr >> 24), static_cast<uint8_t>(key.dest_addr >> 16),
+                static_cast<uint8_t>(key.dest_addr >> 8), static_cast<uint8_t>(key.dest_addr),
+                static_cast<uint8_t>(key.src_port >> 8), static_cast<uint8_t>(key.src_port),
+                static_cast<uint8_t>(key.dest_port >> 8), static_cast<uint8_t>(key.dest_port)
+            };
+            acc += toeplitz_hash(RSS_SYMMETRIC_KEY, RSS_KEY_SIZE, tuple, sizeof(tuple));
+        }
+        sink = sink + acc;
+    });
+    time_pass("toeplitz (table)", rounds, [&] {
+        uint32_t acc = 0;
+        for (const FlowKey& key : set.keys) {
+            acc += toeplitz.hash(key);
+        }
+        sink = sink + acc;
+    });
+    time_pass("toeplitz batch", rounds, [&] {
+        toeplitz.hash_batch(columns, HASH_BENCH_WORKING_SET, out32.data());
+        sink = sink + out32[0];
+    });
+    time_pass("flow_hash", rounds, [&] {
+        uint64_t acc = 0;
+        for (const FlowKey& key : set.keys) {
+            acc += flow_hash(key);
+        }
+        sink = sink + acc;
+    });
+    time_pass("flow_hash batch", rounds, [&] {
+        flow_hash_batch(columns, HASH_BENCH_WORKING_SET, 0, out64.data());
+        sink = sink + out64[0];
+    });
+    time_pass("flow_hash batch (scalar)", rounds, [&] {
+        flow_hash_batch_scalar(columns, HASH_BENCH_WORKING_SET, 0, out64.data());
+        sink = sink + out64[0];
+    });
+    time_pass("crc32c", rounds, [&] {
+        uint32_t acc = 0;
+        for (const FlowKey& key : set.keys) {
+            acc += flow_hash_crc32c(key);
+        }
+        sink = sink + acc;
+    });
+    time_pass("crc32c batch", rounds, [&] {
+        flow_hash_crc32c_batch(columns, HASH_BENCH_WORKING_SET, 0, out32.data());
+        sink = sink + out32[0];
+    });
+
+    std::vector<FlowKey> random;
+    random.reserve(HASH_BENCH_QUALITY_KEYS);
+    for (size_t i = 0; i < HASH_BENCH_QUALITY_KEYS; i++) {
+        random.push_back(random_key(rng));
+    }
+
+    std::cout << "--- distribution over " << HASH_BENCH_BUCKETS << " buckets, " << HASH_BENCH_QUALITY_KEYS << " keys ---\n";
+    std::cout << std::left << std::setw(24) << "" << std::right << std::setw(20) << "random chi2 / max"
+              << std::setw(20) << "seq. chi2 / max" << std::setw(12) << "asymmetric" << '\n';
+    quality("toeplitz (symmetric key)", random, [&](const FlowKey& key) { return toeplitz.hash(key); });
+    ToeplitzHasher rss_default(RSS_DEFAULT_KEY);
+    quality("toeplitz (default key)", random, [&](const FlowKey& key) { return rss_default.hash(key); });
+    quality("flow_hash", random, [](const FlowKey& key) { return flow_hash(key); });
+    quality("crc32c", random, [](const FlowKey& key) { return flow_hash_crc32c(key); });
+    std::cout << "==================\n";
+    return 0;
+}
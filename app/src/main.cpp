@@ -1,6 +1,27 @@
 #include <iostream>
 #include "parser.hpp"
 #include "validation.hpp"
+#include "app-classifier.hpp"
+#include "profile-mode.hpp"
+#include "parse-bench.hpp"
+#include "hash-bench.hpp"
+#include "checkpoint-bench.hpp"
+#include "dump-mode.hpp"
+#include "export-mode.hpp"
+#include "pcap-mode.hpp"
+#include "shm-mode.hpp"
+#include "tcp-mode.hpp"
+#include "shed-mode.hpp"
+#include "replay-mode.hpp"
+#include "xdp-mode.hpp"
+#include "dedup-mode.hpp"
+#include "stream-mode.hpp"
+#include "recorder-mode.hpp"
+#include "metrics-mode.hpp"
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include <arpa/inet.h>
 
 // Sample TCP Packet (Ethernet + IPv4 + TCP Headers)
     uint8_t sample_tcp_packet[] = {   // with no payload
@@ -50,6 +71,108 @@
         // Payload (0 bytes)
     };
 
+    // Sample HTTP packet (Ethernet + IPv4 + TCP + HTTP GET request)
+    uint8_t sample_http_packet[] = {
+        // Ethernet (14)
+        0x00,0x11,0x22,0x33,0x44,0x55,
+        0x66,0x77,0x88,0x99,0xAA,0xBB,
+        0x08,0x00, // IPv4
+
+        // IPv4 (20) -> Total Length = 87 bytes, Protocol = TCP
+        0x45, 0x00, 0x00,0x57, 0x12,0x34, 0x40,0x00, 0x40, 0x06,
+        0x00,0x00, 0xC0,0xA8,0x01,0x02, 0xC0,0xA8,0x01,0x03,
+
+        // TCP (20) -> 51000 -> 80, PSH|ACK
+        0xC7,0x38, 0x00,0x50, 0x00,0x00,0x00,0x01, 0x00,0x00,0x00,0x01,
+        0x50, 0x18, 0x04,0x00, 0x00,0x00, 0x00,0x00,
+
+        // HTTP payload (47)
+        'G','E','T',' ','/','i','n','d','e','x','.','h','t','m','l',' ','H','T','T','P','/','1','.','1','\r','\n',
+        'H','o','s','t',':',' ','e','x','a','m','p','l','e','.','c','o','m','\r','\n',
+        '\r','\n',
+    };
+
+    // Sample IPv6 packet (Ethernet + IPv6 + Hop-by-Hop + TCP + HTTP GET request)
+    uint8_t sample_ipv6_packet[] = {
+        // Ethernet (14)
+        0x00,0x11,0x22,0x33,0x44,0x55,
+        0x66,0x77,0x88,0x99,0xAA,0xBB,
+        0x86,0xDD, // IPv6
+
+        // IPv6 (40) -> Payload Length = 65 bytes, Next Header = Hop-by-Hop
+        0x60,0x00,0x00,0x00, 0x00,0x41, 0x00, 0x40,
+        0x20,0x01,0x0D,0xB8, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x02,  // 2001:db8::2
+        0x20,0x01,0x0D,0xB8, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x03,  // 2001:db8::3
+
+        // Hop-by-Hop (8) -> Next Header = TCP, PadN
+        0x06, 0x00, 0x01,0x04, 0x00,0x00,0x00,0x00,
+
+        // TCP (20) -> 51000 -> 80, PSH|ACK
+        0xC7,0x38, 0x00,0x50, 0x00,0x00,0x00,0x01, 0x00,0x00,0x00,0x01,
+        0x50, 0x18, 0x04,0x00, 0x00,0x00, 0x00,0x00,
+
+        // HTTP payload (37)
+        'G','E','T',' ','/',' ','H','T','T','P','/','1','.','1','\r','\n',
+        'H','o','s','t',':',' ','e','x','a','m','p','l','e','.','c','o','m','\r','\n',
+        '\r','\n',
+    };
+
+    // Sample encapsulated packets, each carrying an inner IPv4 packet
+    std::vector<std::vector<uint8_t>> encap_packets = {
+
+        // QinQ: S-tag VLAN 100, C-tag VLAN 200, IPv4 + TCP SYN
+        {
+            0x00,0x11,0x22,0x33,0x44,0x55, 0x66,0x77,0x88,0x99,0xAA,0xBB,
+            0x88,0xA8,                      // 802.1ad
+            0x00,0x64, 0x81,0x00,           // S-tag VLAN 100 -> 802.1Q
+            0x00,0xC8, 0x08,0x00,           // C-tag VLAN 200 -> IPv4
+            0x45,0x00,0x00,0x28, 0x12,0x34,0x40,0x00, 0x40,0x06, 0x00,0x00,
+            0xC0,0xA8,0x01,0x02, 0xC0,0xA8,0x01,0x03,
+            0x04,0xD2, 0x00,0x50, 0xAB,0xCD,0xEF,0xFF, 0x00,0x00,0x00,0x00,
+            0x50, 0x02, 0x04,0x00, 0x00,0x00, 0x00,0x00
+        },
+
+        // MPLS: labels 1000 and 2000 (bottom of stack), IPv4 + UDP
+        {
+            0x00,0x11,0x22,0x33,0x44,0x55, 0x66,0x77,0x88,0x99,0xAA,0xBB,
+            0x88,0x47,                      // MPLS unicast
+            0x00,0x3E,0x80,0x40,            // label 1000, TTL 64
+            0x00,0x7D,0x01,0x40,            // label 2000, bottom of stack, TTL 64
+            0x45,0x00,0x00,0x1C, 0x12,0x34,0x40,0x00, 0x40,0x11, 0x00,0x00,
+            0xC0,0xA8,0x01,0x02, 0xC0,0xA8,0x01,0x03,
+            0x1F,0x90, 0x23,0x28, 0x00,0x08, 0x00,0x00
+        },
+
+        // GRE with key 42: outer IPv4 10.0.0.1 -> 10.0.0.2, inner IPv4 + TCP SYN
+        {
+            0x00,0x11,0x22,0x33,0x44,0x55, 0x66,0x77,0x88,0x99,0xAA,0xBB,
+            0x08,0x00,
+            0x45,0x00,0x00,0x44, 0x00,0x01,0x40,0x00, 0x40,0x2F, 0x00,0x00,     // protocol = GRE
+            0x0A,0x00,0x00,0x01, 0x0A,0x00,0x00,0x02,
+            0x20,0x00, 0x08,0x00, 0x00,0x00,0x00,0x2A,                          // K flag, IPv4, key 42
+            0x45,0x00,0x00,0x28, 0x12,0x34,0x40,0x00, 0x40,0x06, 0x00,0x00,
+            0xC0,0xA8,0x01,0x02, 0xC0,0xA8,0x01,0x03,
+            0x04,0xD2, 0x00,0x50, 0xAB,0xCD,0xEF,0xFF, 0x00,0x00,0x00,0x00,
+            0x50, 0x02, 0x04,0x00, 0x00,0x00, 0x00,0x00
+        },
+
+        // VXLAN VNI 5000: outer IPv4 + UDP 4789, inner Ethernet + IPv4 + TCP SYN
+        {
+            0x00,0x11,0x22,0x33,0x44,0x55, 0x66,0x77,0x88,0x99,0xAA,0xBB,
+            0x08,0x00,
+            0x45,0x00,0x00,0x5A, 0x00,0x02,0x40,0x00, 0x40,0x11, 0x00,0x00,
+            0x0A,0x00,0x00,0x01, 0x0A,0x00,0x00,0x02,
+            0xC0,0x00, 0x12,0xB5, 0x00,0x46, 0x00,0x00,                         // UDP 49152 -> 4789
+            0x08,0x00,0x00,0x00, 0x00,0x13,0x88,0x00,                           // I flag, VNI 5000
+            0x02,0x00,0x00,0x00,0x00,0x02, 0x02,0x00,0x00,0x00,0x00,0x01,       // inner Ethernet
+            0x08,0x00,
+            0x45,0x00,0x00,0x28, 0x12,0x34,0x40,0x00, 0x40,0x06, 0x00,0x00,
+            0xC0,0xA8,0x01,0x02, 0xC0,0xA8,0x01,0x03,
+            0x04,0xD2, 0x00,0x50, 0xAB,0xCD,0xEF,0xFF, 0x00,0x00,0x00,0x00,
+            0x50, 0x02, 0x04,0x00, 0x00,0x00, 0x00,0x00
+        }
+    };
+
 // SAMPLE MALFORMED PACKETS, ONE FOR EACH KIND OF ERROR:
 std::vector<std::vector<uint8_t>> malformed_packets = {
 
@@ -258,6 +381,104 @@ std::vector<std::vector<uint8_t>> malformed_packets = {
         // IPv4: total_length=20, protocol=99
         0x45,0x00,0x00,0x14, 0,0,0,0, 64,99,
         0,0,0,0,0,0,0,0,0,0
+    },
+
+    // 18. MISSING_IPV6_HEADER (EtherType IPv6, no bytes after Ethernet)
+    {
+        0,0,0,0,0,0, 0,0,0,0,0,0,
+        0x86,0xDD
+    },
+
+    // 19. TOO_SMALL_FOR_IPV6 (< 40 bytes of IPv6)
+    {
+        0,0,0,0,0,0, 0,0,0,0,0,0,
+        0x86,0xDD,
+        0x60,0x00,0x00,0x00, 0x00,0x00, 59, 64
+    },
+
+    // 20. INVALID_IPV6_VERSION (version = 4)
+    {
+        0,0,0,0,0,0, 0,0,0,0,0,0,
+        0x86,0xDD,
+        // Next Header = No Next Header
+        0x40,0x00,0x00,0x00, 0x00,0x00, 59, 64,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+    },
+
+    // 21. IPV6_PAYLOAD_LENGTH_EXCEEDS_PACKET (payload_length = 64, 0 bytes follow)
+    {
+        0,0,0,0,0,0, 0,0,0,0,0,0,
+        0x86,0xDD,
+        0x60,0x00,0x00,0x00, 0x00,0x40, 59, 64,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+    },
+
+    // 22. IPV6_EXTENSION_HEADER_TRUNCATED (Routing header claims 16 bytes, 8 present)
+    {
+        0,0,0,0,0,0, 0,0,0,0,0,0,
+        0x86,0xDD,
+        0x60,0x00,0x00,0x00, 0x00,0x08, 43, 64,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        // Routing: Next Header = TCP, Hdr Ext Len = 1
+        0x06,0x01, 0,0,0,0,0,0
+    },
+
+    // 23. IPV6_TOO_MANY_EXTENSION_HEADERS (9 chained Destination Options headers)
+    {
+        0,0,0,0,0,0, 0,0,0,0,0,0,
+        0x86,0xDD,
+        0x60,0x00,0x00,0x00, 0x00,0x48, 60, 64,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        60,0,1,4,0,0,0,0,  60,0,1,4,0,0,0,0,  60,0,1,4,0,0,0,0,
+        60,0,1,4,0,0,0,0,  60,0,1,4,0,0,0,0,  60,0,1,4,0,0,0,0,
+        60,0,1,4,0,0,0,0,  60,0,1,4,0,0,0,0,  59,0,1,4,0,0,0,0
+    },
+
+    // 24. IPV6_MISPLACED_HOP_BY_HOP (Destination Options followed by Hop-by-Hop)
+    {
+        0,0,0,0,0,0, 0,0,0,0,0,0,
+        0x86,0xDD,
+        0x60,0x00,0x00,0x00, 0x00,0x10, 60, 64,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0x00,0,1,4,0,0,0,0,  59,0,1,4,0,0,0,0
+    },
+
+    // 25. ENCAPSULATION_TRUNCATED (802.1Q tag cut after 2 bytes)
+    {
+        0,0,0,0,0,0, 0,0,0,0,0,0,
+        0x81,0x00,
+        0x00,0x64
+    },
+
+    // 26. ENCAPSULATION_TOO_DEEP (9 stacked 802.1Q tags, the default depth is 8)
+    {
+        0,0,0,0,0,0, 0,0,0,0,0,0,
+        0x81,0x00,
+        0x00,0x01,0x81,0x00,  0x00,0x02,0x81,0x00,  0x00,0x03,0x81,0x00,
+        0x00,0x04,0x81,0x00,  0x00,0x05,0x81,0x00,  0x00,0x06,0x81,0x00,
+        0x00,0x07,0x81,0x00,  0x00,0x08,0x81,0x00,  0x00,0x09,0x08,0x00
+    },
+
+    // 27. ENCAPSULATION_TOO_DEEP (7 802.1Q tags, then IPv4 + GRE needs 2 of the 1 layer left)
+    {
+        0,0,0,0,0,0, 0,0,0,0,0,0,
+        0x81,0x00,
+        0x00,0x01,0x81,0x00,  0x00,0x02,0x81,0x00,  0x00,0x03,0x81,0x00,
+        0x00,0x04,0x81,0x00,  0x00,0x05,0x81,0x00,  0x00,0x06,0x81,0x00,
+        0x00,0x07,0x08,0x00,
+        // IPv4: total_length = 48, protocol = GRE
+        0x45,0x00,0x00,0x30, 0,0,0,0, 64,47,
+        0,0,0,0,0,0,0,0,0,0,
+        // GRE: no flags, protocol = IPv4
+        0x00,0x00,0x08,0x00,
+        // Inner IPv4: total_length = 24, protocol = 99
+        0x45,0x00,0x00,0x18, 0,0,0,0, 64,99,
+        0,0,0,0,0,0,0,0,0,0, 0,0,0,0
     }
 };
 
@@ -279,12 +500,390 @@ std::vector<std::string> expected_errors = {
     "TOO_SMALL_FOR_UDP",
     "INVALID_UDP_LENGTH",
     "UDP_LENGTH_EXCEEDS_PACKET",
-    "UNSUPPORTED_L4_PROTOCOL"
+    "UNSUPPORTED_L4_PROTOCOL",
+    "MISSING_IPV6_HEADER",
+    "TOO_SMALL_FOR_IPV6",
+    "INVALID_IPV6_VERSION",
+    "IPV6_PAYLOAD_LENGTH_EXCEEDS_PACKET",
+    "IPV6_EXTENSION_HEADER_TRUNCATED",
+    "IPV6_TOO_MANY_EXTENSION_HEADERS",
+    "IPV6_MISPLACED_HOP_BY_HOP",
+    "ENCAPSULATION_TRUNCATED",
+    "ENCAPSULATION_TOO_DEEP",
+    "ENCAPSULATION_TOO_DEEP"
 };
 
 
 
-int main() {
+// All sample packets (valid and malformed) as spans, used by the non-demo modes
+static std::vector<std::span<const uint8_t>> sample_packets() {
+    std::vector<std::span<const uint8_t>> packets = {
+        std::span<const uint8_t>(sample_tcp_packet),
+        std::span<const uint8_t>(sample_udp_packet),
+        std::span<const uint8_t>(sample_http_packet),
+        std::span<const uint8_t>(sample_ipv6_packet)
+    };
+    for (const std::vector<uint8_t>& packet : encap_packets) {
+        packets.push_back(std::span<const uint8_t>(packet));
+    }
+    for (const std::vector<uint8_t>& packet : malformed_packets) {
+        packets.push_back(std::span<const uint8_t>(packet));
+    }
+    return packets;
+}
+
+// --profile [rounds] -> run the parse/validate loops under hardware counters instead of the demo
+static int profile(int argc, char* argv[]) {
+    size_t rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+    return run_profile_mode(sample_packets(), rounds);
+}
+
+// --bench-parse [rounds] -> time parse_packet per EtherType, and the IPv4 decoder against max_encap_depth=0
+static int bench_parse(int argc, char* argv[]) {
+    size_t rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+    return run_parse_bench(sample_packets(), rounds);
+}
+
+// --bench-hash [rounds] -> time the flow hashes and check their distribution and symmetry
+static int bench_hash(int argc, char* argv[]) {
+    size_t rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+    return run_hash_bench(rounds);
+}
+
+// --bench-checkpoint [max_capacity] [path] -> snapshot / restore time of tracker + sketch state against its size
+static int bench_checkpoint(int argc, char* argv[]) {
+    size_t max_capacity = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : (1 << 22);
+    std::string path = argc > 3 ? argv[3] : "deeppacket-bench.state";
+    return run_checkpoint_bench(path, max_capacity);
+}
+
+// --dump <text|json|csv> [count] -> stream parsed + validated samples through the buffered formatter
+static int dump(int argc, char* argv[]) {
+    OutputFormat format;
+    if (argc < 3 || !PacketFormatter::parse_format(argv[2], format)) {
+        std::cerr << "usage: DeepPacket --dump <text|json|csv> [count]\n";
+        return 1;
+    }
+    size_t count = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000;
+    return run_dump_mode(sample_packets(), format, count);
+}
+
+// --export-columnar <path> [count] -> write parsed + validated samples as a columnar metadata file
+static int export_columnar(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: DeepPacket --export-columnar <path> [count]\n";
+        return 1;
+    }
+    size_t count = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000;
+    return run_export_mode(argv[2], sample_packets(), count);
+}
+
+
+// --write-pcap <path> [count] [--direct] -> write the samples as a nanosecond pcap through the io_uring writer
+static int write_pcap(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: DeepPacket --write-pcap <path> [count] [--direct]\n";
+        return 1;
+    }
+    size_t count = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000;
+    AsyncIoOptions options;
+    options.direct_io = argc > 4 && std::string(argv[4]) == "--direct";
+    return run_write_pcap_mode(argv[2], sample_packets(), count, options);
+}
+
+// --read-pcap <path> [--direct] -> parse and validate every record while the next buffers are read ahead
+static int read_pcap(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: DeepPacket --read-pcap <path> [--direct]\n";
+        return 1;
+    }
+    AsyncIoOptions options;
+    options.direct_io = argc > 3 && std::string(argv[3]) == "--direct";
+    return run_read_pcap_mode(argv[2], options);
+}
+
+
+// --publish <name> [count] [--block] -> publish parsed samples into a shared-memory ring
+static int publish(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: DeepPacket --publish <name> [count] [--block]\n";
+        return 1;
+    }
+    size_t count = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000;
+    ShmRingConfig config;
+    config.policy = argc > 4 && std::string(argv[4]) == "--block" ? ShmOverflowPolicy::BLOCK : ShmOverflowPolicy::DROP;
+    return run_publish_mode(argv[2], sample_packets(), count, config);
+}
+
+// --subscribe <name> [count] [--shed [budget_ns]] [--metrics <port>] -> attach to a ring and consume until count
+// records or the producer exits; --metrics runs the full pipeline and serves its counters on 127.0.0.1:<port>
+static int subscribe(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: DeepPacket --subscribe <name> [count] [--shed [budget_ns]] [--metrics <port>]\n";
+        return 1;
+    }
+    size_t count = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : SIZE_MAX;
+    bool shed = false;
+    int metrics_port = -1;
+    LoadShedderConfig config;
+    for (int i = 4; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--shed") {
+            shed = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                config.packet_budget_ns = std::strtoull(argv[++i], nullptr, 10);
+            }
+        }
+        else if (arg == "--metrics" && i + 1 < argc) {
+            metrics_port = std::atoi(argv[++i]);
+        }
+    }
+
+    if (!shed && metrics_port < 0) {
+        return run_subscribe_mode(argv[2], count);
+    }
+
+    if (metrics_port >= 0) {
+        return run_metrics_mode(argv[2], count, config, shed, static_cast<uint16_t>(metrics_port));
+    }
+    return run_shed_mode(argv[2], count, config, nullptr);
+}
+
+
+// --replay <path> [speed|flat] [loops] [--iface <name>] -> replay a trace into parse + validate, or onto an interface
+// --iface may come anywhere after the path; speed is a positive multiplier or "flat", loops at least 1
+static int replay(int argc, char* argv[]) {
+    const char* usage = "usage: DeepPacket --replay <path> [speed|flat] [loops] [--iface <name>]\n";
+    if (argc < 3) {
+        std::cerr << usage;
+        return 1;
+    }
+    ReplayConfig config;
+    const char* iface = nullptr;
+    int positional = 0;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        char* end = nullptr;
+        if (arg == "--iface") {
+            if (i + 1 >= argc) {
+                std::cerr << "--iface needs an interface name\n" << usage;
+                return 1;
+            }
+            iface = argv[++i];
+        }
+        else if (positional == 0) {
+            config.speed = arg == "flat" ? 0.0 : std::strtod(argv[i], &end);
+            if (arg != "flat" && (end == argv[i] || *end != '\0' || !(config.speed > 0.0))) {
+                std::cerr << "Invalid speed " << arg << " (a positive multiplier or flat)\n" << usage;
+                return 1;
+            }
+            positional++;
+        }
+        else if (positional == 1) {
+            unsigned long loops = std::strtoul(argv[i], &end, 10);
+            if (end == argv[i] || *end != '\0' || arg[0] == '-' || loops == 0 || loops > UINT32_MAX) {
+                std::cerr << "Invalid loops " << arg << " (at least 1)\n" << usage;
+                return 1;
+            }
+            config.loops = static_cast<uint32_t>(loops);
+            positional++;
+        }
+        else {
+            std::cerr << "Unexpected argument " << arg << '\n' << usage;
+            return 1;
+        }
+    }
+
+    return run_replay_mode(argv[2], config, iface);
+}
+
+// --xdp <iface> [count] [zc|native|skb] -> AF_XDP capture on queue 0 into parse + validate until count frames or 2 s idle
+static int xdp_capture(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: DeepPacket --xdp <iface> [count] [zc|native|skb]\n";
+        return 1;
+    }
+    size_t count = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : SIZE_MAX;
+    XdpConfig config;
+    if (argc > 4) {
+        std::string mode = argv[4];
+        config.mode = mode == "zc" ? XdpMode::ZERO_COPY : mode == "native" ? XdpMode::NATIVE :
+                      mode == "skb" ? XdpMode::SKB : XdpMode::AUTO;
+    }
+
+    return run_xdp_mode(argv[2], count, config);
+}
+
+// --dedup <path> [window_us] -> suppress duplicate frames of a pcap and compare the cost with the parse + validate it saves
+static int dedup(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: DeepPacket --dedup <path> [window_us]\n";
+        return 1;
+    }
+    DedupConfig config;
+    if (argc > 3) {
+        config.window_ns = std::strtoull(argv[3], nullptr, 10) * 1000;
+    }
+
+    return run_dedup_mode(argv[2], config);
+}
+
+// --track-tcp <path> [--state <file>] -> follow every TCP connection of a pcap through the state tracker,
+// resuming from and saving to a snapshot file when one is given
+static int track_tcp(int argc, char* argv[]) {
+    if (argc < 3 || (argc > 3 && (argc < 5 || std::string(argv[3]) != "--state"))) {
+        std::cerr << "usage: DeepPacket --track-tcp <path> [--state <file>]\n";
+        return 1;
+    }
+    return run_track_tcp_mode(argv[2], argc > 4 ? argv[4] : "");
+}
+
+// --stream-l7 <path> -> run the incremental HTTP / TLS parsers over every TCP direction of a pcap and compare what
+// they extract with the one-shot classifier, which only sees one segment at a time
+static int stream_l7(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: DeepPacket --stream-l7 <path>\n";
+        return 1;
+    }
+    return run_stream_l7_mode(argv[2]);
+}
+
+// --record <path> <dir> [budget_mb] [segment_mb] -> parse and validate a pcap while recording every frame into
+// rolling compressed segments under <dir>, and report what the recorder costs the packet path
+static int record(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "usage: DeepPacket --record <path> <dir> [budget_mb] [segment_mb]\n";
+        return 1;
+    }
+    RecorderConfig config;
+    if (argc > 4) {
+        config.disk_budget = std::strtoull(argv[4], nullptr, 10) << 20;
+    }
+    if (argc > 5) {
+        config.segment_size = std::strtoull(argv[5], nullptr, 10) << 20;
+    }
+
+    return run_record_mode(argv[2], argv[3], config);
+}
+
+// a.b.c.d:port or [v6 address]:port into the source or destination side of key, sets key.ipv6
+static bool parse_endpoint(const char* text, FlowKey& key, bool source) {
+    std::string endpoint = text;
+    size_t colon = endpoint.rfind(':');
+    if (colon == std::string::npos) {
+        return false;
+    }
+    std::string host = endpoint.substr(0, colon);
+    uint16_t port = static_cast<uint16_t>(std::strtoul(endpoint.c_str() + colon + 1, nullptr, 10));
+    uint32_t addr;
+    if (host.size() > 2 && host.front() == '[' && host.back() == ']') {
+        uint8_t* addr6 = source ? key.src_addr6 : key.dest_addr6;
+        if (inet_pton(AF_INET6, host.substr(1, host.size() - 2).c_str(), addr6) != 1) {
+            return false;
+        }
+        addr = ipv6_fold(addr6);
+        key.ipv6 = true;
+    }
+    else {
+        in_addr parsed;
+        if (inet_pton(AF_INET, host.c_str(), &parsed) != 1) {
+            return false;
+        }
+        addr = ntohl(parsed.s_addr);
+        key.ipv6 = false;
+    }
+    (source ? key.src_addr : key.dest_addr) = addr;
+    (source ? key.src_port : key.dest_port) = port;
+    return true;
+}
+
+// --recall <dir> <from_s> <to_s> [--flow <ip:port> <ip:port> <tcp|udp>] [out.pcap] -> read back a time range
+// (epoch seconds) from recorder segments, optionally one flow in both directions, into a pcap
+static int recall(int argc, char* argv[]) {
+    if (argc < 5) {
+        std::cerr << "usage: DeepPacket --recall <dir> <from_s> <to_s> [--flow <ip:port> <ip:port> <tcp|udp>] "
+                     "[out.pcap]\n";
+        return 1;
+    }
+    uint64_t from_ns = static_cast<uint64_t>(std::llround(std::strtod(argv[3], nullptr) * 1e9));
+    uint64_t to_ns = static_cast<uint64_t>(std::llround(std::strtod(argv[4], nullptr) * 1e9));
+    FlowKey flow{};
+    bool filter = false;
+    const char* output = nullptr;
+    for (int i = 5; i < argc; i++) {
+        if (std::string(argv[i]) == "--flow" && i + 3 < argc) {
+            bool parsed = parse_endpoint(argv[i + 1], flow, true);
+            bool source_ipv6 = flow.ipv6;
+            if (!parsed || !parse_endpoint(argv[i + 2], flow, false) || flow.ipv6 != source_ipv6) {
+                std::cerr << "Bad endpoints, expected a.b.c.d:port or [v6 address]:port, both of one family\n";
+                return 1;
+            }
+            flow.protocol = std::string(argv[i + 3]) == "udp" ? 17 : 6;
+            filter = true;
+            i += 3;
+        }
+        else {
+            output = argv[i];
+        }
+    }
+
+    return run_recall_mode(argv[2], from_ns, to_ns, filter ? &flow : nullptr, output);
+}
+
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--profile") {
+        return profile(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bench-parse") {
+        return bench_parse(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bench-hash") {
+        return bench_hash(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bench-checkpoint") {
+        return bench_checkpoint(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--dump") {
+        return dump(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--export-columnar") {
+        return export_columnar(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--write-pcap") {
+        return write_pcap(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--read-pcap") {
+        return read_pcap(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--publish") {
+        return publish(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--subscribe") {
+        return subscribe(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--replay") {
+        return replay(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--xdp") {
+        return xdp_capture(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--dedup") {
+        return dedup(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--track-tcp") {
+        return track_tcp(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--stream-l7") {
+        return stream_l7(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--record") {
+        return record(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--recall") {
+        return recall(argc, argv);
+    }
+
     std::cout << "\n=== TCP PACKET PARSING  ===" << std::endl;
     ParsedPacket tcp = parse_packet(std::span<const uint8_t>(sample_tcp_packet));
     tcp.view.print();
@@ -301,14 +900,40 @@ int main() {
     udp_validator.print_errors();
     std::cout << "\n============================\n" <<std::endl;
 
+    std::cout << "\n=== HTTP PACKET CLASSIFICATION ===" << std::endl;
+    ParsedPacket http = parse_packet(std::span<const uint8_t>(sample_http_packet));
+    http.view.print();
+    AppClassifier http_classifier(http.view);
+    http_classifier.print();
+    std::cout << "\n============================\n" <<std::endl;
+
+    std::cout << "\n=== IPv6 PACKET PARSING ===" << std::endl;
+    ParsedPacket ipv6 = parse_packet(std::span<const uint8_t>(sample_ipv6_packet));
+    ipv6.view.print();
+    std::cout << "\n=== Validation for IPv6 packet  ===" << std::endl;
+    PacketValidator ipv6_validator(ipv6.view);
+    ipv6_validator.print_errors();
+    AppClassifier ipv6_classifier(ipv6.view);
+    ipv6_classifier.print();
+    std::cout << "\n============================\n" <<std::endl;
+
+    std::cout << "\n=== ENCAPSULATED PACKET PARSING ===" << std::endl;
+    for(size_t i = 0; i < encap_packets.size(); i++) {
+        ParsedPacket packet = parse_packet(std::span<const uint8_t>(encap_packets[i]));
+        packet.view.print();
+        PacketValidator validator(packet.view);
+        validator.print_errors();
+    }
+    std::cout << "\n============================\n" <<std::endl;
+
     std::cout << "\n=== MALFORMED PACKET TESTS ===" << std::endl;
     for(size_t i = 0; i < malformed_packets.size(); i++) {
         std::cout << " Malformed Packet Test: " << i << " " << std::endl;
         ParsedPacket packet = parse_packet(std::span<const uint8_t>(malformed_packets[i]));
-        packet.view.print();
+        PacketValidator validator(packet.view);
+        packet.view.print(validator.errors.empty() ? nullptr : validation_error_name(validator.errors.front()));
         std::cout << "\n=== Validation for malformed packet " << i << " ===" << std::endl;
         std::cout << "\nExpected error: " << expected_errors[i] << " \n" << std::endl;
-        PacketValidator validator(packet.view);
         validator.print_errors();
     }
     std::cout << "\n============================\n" <<std::endl;
@@ -0,0 +1,28 @@
+#include "metrics-mode.hpp"
+#include "shed-mode.hpp"
+#include "live-metrics.hpp"
+#include "metrics-server.hpp"
+#include <iostream>
+
+/*
+    Live Metrics Mode
+    - One MetricsRegistry shard for the consuming thread, scraped by the MetricsServer thread over HTTP
+    - The ring is consumed by the load-shedding pipeline, which fills the shard as it goes; when shedding was not
+      asked for, the high watermark is put out of reach so every packet is still fully inspected
+*/
+
+int run_metrics_mode(const std::string& name, size_t count, LoadShedderConfig config, bool shed, uint16_t port) {
+    MetricsRegistry registry;
+    MetricsServer server(registry, port);
+    if (!server.ok) {
+        std::cerr << "Cannot listen on 127.0.0.1:" << port << '\n';
+        return 1;
+    }
+    std::cout << "Metrics on http://127.0.0.1:" << server.port() << "/metrics and /snapshot" << std::endl;
+    if (!shed) {
+        config.high_watermark = 2.0;    // backlog pressure never exceeds 1: nothing is shed
+    }
+    int status = run_shed_mode(name, count, config, registry.add_shard());
+    std::cout << "Scrapes: " << server.scrapes.load() << " Snapshots: " << server.snapshots.load() << '\n';
+    return status;
+}
@@ -0,0 +1,101 @@
+#include "parse-bench.hpp"
+#include "parser.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+
+#define PARSE_BENCH_WORKING_SET 4096
+#define IPv4_ETHERTYPE 0x0800
+#define IPv6_ETHERTYPE 0x86DD
+
+/*
+    Parse Benchmark
+    - Splits the packets into plain IPv4, plain IPv6 and encapsulated (VLAN, MPLS, tunnels) groups
+      and replicates each group into a working set of PARSE_BENCH_WORKING_SET packets
+    - Every round is one timed pass over the working set; the best pass is the figure to compare,
+      the mean shows how noisy the machine was
+    - The IPv4 group is also timed with max_encap_depth = 0, which never looks for tunnels; the difference
+      is what the encapsulation decoder costs traffic that carries none
+*/
+
+// Returns the best ns/packet, 0 without packets
+static double bench(const char* name, const std::vector<std::span<const uint8_t>>& packets, size_t rounds,
+                    size_t max_encap_depth = ENCAP_DEFAULT_DEPTH) {
+    std::cout << "=== PARSE BENCH: " << name << " ===\n";
+    if (packets.empty()) {
+        std::cout << "No packets\n";
+        std::cout << "=================\n";
+        return 0;
+    }
+
+    std::vector<std::span<const uint8_t>> working_set;
+    working_set.reserve(PARSE_BENCH_WORKING_SET);
+    for (size_t i = 0; i < PARSE_BENCH_WORKING_SET; i++) {
+        working_set.push_back(packets[i % packets.size()]);
+    }
+
+    // Results feed a volatile sink so the loop cannot be optimized away
+    volatile uint64_t sink = 0;
+    uint64_t best_ns = UINT64_MAX;
+    uint64_t total_ns = 0;
+    for (size_t round = 0; round < rounds; round++) {
+        uint64_t acc = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (std::span<const uint8_t> buffer : working_set) {
+            ParsedPacket packet = parse_packet(buffer, max_encap_depth);
+            acc += packet.view.payload_len + packet.view.has_tcp;
+        }
+        auto end = std::chrono::steady_clock::now();
+        sink = sink + acc;
+
+        uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        best_ns = std::min(best_ns, ns);
+        total_ns += ns;
+    }
+
+    double per_pass = static_cast<double>(working_set.size());
+    std::cout << "Packets: " << packets.size() << " Rounds: " << rounds << '\n';
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "best ns/packet: " << best_ns / per_pass << '\n';
+    std::cout << "mean ns/packet: " << total_ns / (per_pass * rounds) << '\n';
+    std::cout << std::defaultfloat << std::setprecision(6);
+    std::cout << "=================\n";
+    return best_ns / per_pass;
+}
+
+int run_parse_bench(const std::vector<std::span<const uint8_t>>& packets, size_t rounds) {
+    if (packets.empty() || rounds == 0) {
+        std::cout << "Parse bench: nothing to run\n";
+        return 1;
+    }
+
+    std::vector<std::span<const uint8_t>> ipv4;
+    std::vector<std::span<const uint8_t>> ipv6;
+    std::vector<std::span<const uint8_t>> encapsulated;
+    for (std::span<const uint8_t> packet : packets) {
+        ParsedPacket parsed = parse_packet(packet);
+        if (parsed.view.encap_count > 0) {
+            encapsulated.push_back(packet);
+        }
+        else if (parsed.view.ethertype == IPv4_ETHERTYPE) {
+            ipv4.push_back(packet);
+        }
+        else if (parsed.view.ethertype == IPv6_ETHERTYPE) {
+            ipv6.push_back(packet);
+        }
+    }
+
+    double baseline = bench("IPv4, max_encap_depth=0", ipv4, rounds, 0);
+    double decoder = bench("IPv4", ipv4, rounds);
+    if (baseline > 0) {
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "IPv4 decoder overhead: " << std::showpos << decoder - baseline << " ns/packet ("
+                  << (decoder - baseline) * 100 / baseline << "%)" << std::noshowpos << '\n';
+        std::cout << std::defaultfloat << std::setprecision(6);
+    }
+    bench("IPv6", ipv6, rounds);
+    bench("encapsulated", encapsulated, rounds);
+    bench("all", packets, rounds);
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "pcap-mode.hpp"
+#include "pcap-file.hpp"
+#include "parser.hpp"
+#include "validation.hpp"
+#include <iostream>
+
+/*
+    Capture File Modes
+    - Write: the packet set is written round robin through PcapWriter, then the writer's I/O path is reported
+    - Read: every record goes through parse_packet and PacketValidator straight from the reader's buffers
+*/
+
+int run_write_pcap_mode(const std::string& path, const std::vector<std::span<const uint8_t>>& packets, size_t count,
+                        const AsyncIoOptions& options) {
+    PcapWriter writer(path, options);
+    for (size_t i = 0; i < count && writer.ok && !packets.empty(); i++) {
+        writer.write(i * 1000, packets[i % packets.size()]);
+    }
+    if (!writer.close()) {
+        std::cerr << "Writing " << path << " failed\n";
+        return 1;
+    }
+    std::cout << "Wrote " << writer.records << " records, " << writer.file().bytes_written << " bytes in "
+              << writer.file().writes_submitted << " writes (io_uring: " << writer.file().uring_active
+              << ", registered: " << writer.file().buffers_registered << ", O_DIRECT: " << writer.file().direct_active << ")\n";
+    return 0;
+}
+
+int run_read_pcap_mode(const std::string& path, const AsyncIoOptions& options) {
+    PcapReader reader(path, options);
+    if (!reader.ok) {
+        std::cerr << "Cannot read pcap file " << path << '\n';
+        return 1;
+    }
+
+    PcapRecord record;
+    uint64_t bytes = 0;
+    uint64_t invalid = 0;
+    while (reader.next(record)) {
+        ParsedPacket packet = parse_packet(record.data);
+        PacketValidator validator(packet.view);
+        bytes += record.data.size();
+        invalid += validator.error_mask() != 0;
+    }
+
+    std::cout << "Records: " << reader.records << " Bytes: " << bytes << " Invalid: " << invalid
+              << (reader.truncated ? " (truncated)" : "") << '\n';
+    std::cout << "Reads: " << reader.file().reads_submitted << " (io_uring: " << reader.file().uring_active
+              << ", registered: " << reader.file().buffers_registered << ", O_DIRECT: " << reader.file().direct_active << ")\n";
+    return reader.file().failed ? 1 : 0;
+}
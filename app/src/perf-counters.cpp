@@ -0,0 +1,157 @@
+#include "perf-counters.hpp"
+#include <chrono>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/*
+    PerfCounters Class Implementation
+    - Opens one perf_event group (first event that opens becomes the leader) so all counters cover the same interval
+    - The group is read with a single read() as PERF_FORMAT_GROUP | PERF_FORMAT_ID
+    - Values are scaled by time_enabled / time_running when the kernel had to multiplex the group
+*/
+
+static int perf_event_open(perf_event_attr* attr, int group_fd) {
+    return static_cast<int>(syscall(SYS_perf_event_open, attr, 0, -1, group_fd, 0));
+}
+
+static void event_config(PerfEvent event, __u32& type, __u64& config) {
+    switch (event) {
+        case PerfEvent::CYCLES:
+            type = PERF_TYPE_HARDWARE;
+            config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfEvent::INSTRUCTIONS:
+            type = PERF_TYPE_HARDWARE;
+            config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfEvent::BRANCH_MISSES:
+            type = PERF_TYPE_HARDWARE;
+            config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PerfEvent::L1D_MISSES:
+            type = PERF_TYPE_HW_CACHE;
+            config = PERF_COUNT_HW_CACHE_L1D |
+                     (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case PerfEvent::LLC_MISSES:
+        default:
+            type = PERF_TYPE_HARDWARE;
+            config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+    }
+}
+
+static uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+PerfCounters::PerfCounters() : leader(-1), start_ns(0) {
+    for (size_t i = 0; i < PERF_EVENT_COUNT; i++) {
+        available[i] = false;
+        fds[i] = -1;
+        ids[i] = 0;
+
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        event_config(static_cast<PerfEvent>(i), attr.type, attr.config);
+        attr.disabled = leader < 0 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                           PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = perf_event_open(&attr, leader);
+        if (fd < 0) {
+            continue;
+        }
+        if (ioctl(fd, PERF_EVENT_IOC_ID, &ids[i]) != 0) {
+            close(fd);
+            continue;
+        }
+
+        fds[i] = fd;
+        available[i] = true;
+        if (leader < 0) {
+            leader = fd;
+        }
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (size_t i = 0; i < PERF_EVENT_COUNT; i++) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+        }
+    }
+}
+
+bool PerfCounters::any_available() const {
+    return leader >= 0;
+}
+
+void PerfCounters::start() {
+    if (leader >= 0) {
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    start_ns = now_ns();
+}
+
+void PerfCounters::stop(PerfSample& sample) {
+    uint64_t end_ns = now_ns();
+    if (leader >= 0) {
+        ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    sample.wall_ns = end_ns - start_ns;
+    for (size_t i = 0; i < PERF_EVENT_COUNT; i++) {
+        sample.values[i] = 0;
+        sample.valid[i] = false;
+    }
+    if (leader < 0) {
+        return;
+    }
+
+    // { nr, time_enabled, time_running, { value, id } * nr }
+    uint64_t buffer[3 + 2 * PERF_EVENT_COUNT];
+    ssize_t bytes = read(leader, buffer, sizeof(buffer));
+    if (bytes < static_cast<ssize_t>(3 * sizeof(uint64_t))) {
+        return;
+    }
+
+    uint64_t nr = buffer[0];
+    uint64_t enabled = buffer[1];
+    uint64_t running = buffer[2];
+    if (running == 0) {
+        return;
+    }
+
+    for (uint64_t n = 0; n < nr && n < PERF_EVENT_COUNT; n++) {
+        uint64_t value = buffer[3 + 2 * n];
+        uint64_t id = buffer[4 + 2 * n];
+        for (size_t i = 0; i < PERF_EVENT_COUNT; i++) {
+            if (available[i] && ids[i] == id) {
+                sample.values[i] = static_cast<uint64_t>(static_cast<double>(value) * enabled / running);
+                sample.valid[i] = true;
+                break;
+            }
+        }
+    }
+}
+
+const char* PerfCounters::event_name(PerfEvent event) {
+    switch (event) {
+        case PerfEvent::CYCLES: return "cycles";
+        case PerfEvent::INSTRUCTIONS: return "instructions";
+        case PerfEvent::BRANCH_MISSES: return "branch-misses";
+        case PerfEvent::L1D_MISSES: return "L1d-misses";
+        case PerfEvent::LLC_MISSES: return "LLC-misses";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,146 @@
+#include "profile-mode.hpp"
+#include "perf-counters.hpp"
+#include "parser.hpp"
+#include "validation.hpp"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+#define PROFILE_BATCH_SIZE 256
+
+/*
+    Profiling Mode
+    - Replicates the given packets into a working set and runs the parse and validate loops over it
+    - Each stage is measured in batches of PROFILE_BATCH_SIZE packets: counters are enabled, the batch runs, the group is read
+    - Totals are normalized per packet, so branch-bound and memory-bound stages can be told apart
+*/
+
+struct StageTotals {
+    uint64_t values[PERF_EVENT_COUNT];
+    bool valid[PERF_EVENT_COUNT];
+    uint64_t wall_ns;
+    uint64_t packets;
+    uint64_t batches;
+};
+
+static void reset_totals(StageTotals& totals) {
+    for (size_t i = 0; i < PERF_EVENT_COUNT; i++) {
+        totals.values[i] = 0;
+        totals.valid[i] = true;
+    }
+    totals.wall_ns = 0;
+    totals.packets = 0;
+    totals.batches = 0;
+}
+
+static void accumulate(StageTotals& totals, const PerfSample& sample, size_t packets) {
+    for (size_t i = 0; i < PERF_EVENT_COUNT; i++) {
+        totals.values[i] += sample.values[i];
+        // A figure is only reported if every batch produced it
+        totals.valid[i] = totals.valid[i] && sample.valid[i];
+    }
+    totals.wall_ns += sample.wall_ns;
+    totals.packets += packets;
+    totals.batches++;
+}
+
+static void report(const char* stage, const StageTotals& totals) {
+    double packets = totals.packets ? static_cast<double>(totals.packets) : 1.0;
+
+    std::cout << "=== PROFILE: " << stage << " ===\n";
+    std::cout << "Packets: " << totals.packets << " Batches: " << totals.batches << '\n';
+    std::cout << std::fixed << std::setprecision(2);
+
+    for (size_t i = 0; i < PERF_EVENT_COUNT; i++) {
+        std::cout << PerfCounters::event_name(static_cast<PerfEvent>(i)) << "/packet: ";
+        if (totals.valid[i]) {
+            std::cout << totals.values[i] / packets << '\n';
+        }
+        else {
+            std::cout << "<unavailable>\n";
+        }
+    }
+
+    size_t cycles = static_cast<size_t>(PerfEvent::CYCLES);
+    size_t instructions = static_cast<size_t>(PerfEvent::INSTRUCTIONS);
+    if (totals.valid[cycles] && totals.valid[instructions] && totals.values[cycles] > 0) {
+        std::cout << "IPC: " << static_cast<double>(totals.values[instructions]) / totals.values[cycles] << '\n';
+    }
+
+    std::cout << "ns/packet: " << totals.wall_ns / packets << '\n';
+    std::cout << std::defaultfloat << std::setprecision(6);
+    std::cout << "=================\n";
+}
+
+int run_profile_mode(const std::vector<std::span<const uint8_t>>& packets, size_t rounds) {
+    if (packets.empty()) {
+        std::cout << "Profile mode: no packets to run\n";
+        return 1;
+    }
+
+    PerfCounters counters;
+    if (!counters.any_available()) {
+        std::cout << "Hardware counters unavailable (check perf_event_paranoid / container permissions)\n";
+        std::cout << "Reporting wall-clock time only\n";
+    }
+    else {
+        for (size_t i = 0; i < PERF_EVENT_COUNT; i++) {
+            if (!counters.available[i]) {
+                std::cout << "Counter not supported: " << PerfCounters::event_name(static_cast<PerfEvent>(i)) << '\n';
+            }
+        }
+    }
+
+    // Working set: the input packets repeated to a whole number of batches
+    std::vector<std::span<const uint8_t>> working_set;
+    size_t target = std::max<size_t>(PROFILE_BATCH_SIZE, packets.size());
+    target = (target + PROFILE_BATCH_SIZE - 1) / PROFILE_BATCH_SIZE * PROFILE_BATCH_SIZE;
+    working_set.reserve(target);
+    for (size_t i = 0; i < target; i++) {
+        working_set.push_back(packets[i % packets.size()]);
+    }
+
+    std::vector<ParsedPacket> parsed;
+    parsed.reserve(working_set.size());
+    for (std::span<const uint8_t> buffer : working_set) {
+        parsed.push_back(parse_packet(buffer));
+    }
+
+    // Results feed a volatile sink so the loops cannot be optimized away
+    volatile uint64_t sink = 0;
+    PerfSample sample;
+    StageTotals parse_totals;
+    StageTotals validate_totals;
+    reset_totals(parse_totals);
+    reset_totals(validate_totals);
+
+    for (size_t round = 0; round < rounds; round++) {
+        for (size_t base = 0; base < working_set.size(); base += PROFILE_BATCH_SIZE) {
+            uint64_t acc = 0;
+            counters.start();
+            for (size_t i = base; i < base + PROFILE_BATCH_SIZE; i++) {
+                ParsedPacket packet = parse_packet(working_set[i]);
+                acc += packet.view.payload_len + packet.view.has_tcp;
+            }
+            counters.stop(sample);
+            sink = sink + acc;
+            accumulate(parse_totals, sample, PROFILE_BATCH_SIZE);
+        }
+
+        for (size_t base = 0; base < parsed.size(); base += PROFILE_BATCH_SIZE) {
+            uint64_t acc = 0;
+            counters.start();
+            for (size_t i = base; i < base + PROFILE_BATCH_SIZE; i++) {
+                PacketValidator validator(parsed[i].view);
+                acc += static_cast<uint64_t>(validator.errors.front());
+            }
+            counters.stop(sample);
+            sink = sink + acc;
+            accumulate(validate_totals, sample, PROFILE_BATCH_SIZE);
+        }
+    }
+
+    report("parse_packet", parse_totals);
+    report("PacketValidator", validate_totals);
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include "shed-mode.hpp"
+#include "app-clock.hpp"
+#include "shm-ring.hpp"
+#include "parser.hpp"
+#include "validation.hpp"
+#include "app-classifier.hpp"
+#include "traffic-sketches.hpp"
+#include <iostream>
+#include <sched.h>
+
+#define SHED_TIMING_STRIDE 16   // time the stages / sample the backlog on 1 packet in 16
+
+/*
+    Load Shedding Mode
+    - Parse, validate, sketches and payload classification on every admitted record; the LoadShedder decides from
+      the ring backlog and the measured stage costs which of them still run
+    - Sampled packets count with the shedder's weight, so invalid counts and sketch totals track offered traffic
+    - Stage timings and the backlog are sampled on 1 record in SHED_TIMING_STRIDE to keep the clock off the hot path
+*/
+
+int run_shed_mode(const std::string& name, size_t count, const LoadShedderConfig& config, MetricsShard* metrics) {
+    ShmRingConsumer consumer(name);
+    if (!consumer.ok) {
+        std::cerr << "Cannot attach to shared-memory ring " << name << '\n';
+        return 1;
+    }
+
+    LoadShedder shedder(config);
+    TrafficSketches sketches;
+    uint64_t invalid = 0;           // scaled by the sampling weight
+    uint64_t classified[4] = {};    // by AppProtocol, over inspected packets only
+    uint64_t reported_drops = 0;
+
+    ShmRecord record;
+    while (consumer.received < count) {
+        if (!consumer.next(record)) {
+            if (!consumer.producer_alive()) {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+
+        bool timed = shedder.packets % SHED_TIMING_STRIDE == 0;
+        if (timed) {
+            shedder.observe_backlog(consumer.backlog(), consumer.capacity());
+            if (metrics) {
+                metrics->set_ring(consumer.backlog(), consumer.capacity());
+            }
+        }
+        uint64_t start = timed ? now_ns() : 0;
+
+        ParsedPacket packet = parse_packet(record.frame);
+        bool admitted = shedder.admit(packet.view);
+        uint64_t parsed = timed ? now_ns() : 0;
+        if (timed) {
+            shedder.record(ShedStage::PARSE, parsed - start, 1);
+        }
+        if (metrics) {
+            metrics->count_packet(packet.view);
+            if (timed) {
+                metrics->record_latency(MetricsStage::PARSE, parsed - start);
+            }
+            if (!admitted) {
+                metrics->count_drops(MetricsDrop::SHED, 1);
+            }
+        }
+
+        if (admitted) {
+            PacketValidator validator(packet.view);
+            uint32_t error_mask = validator.error_mask();
+            invalid += error_mask != 0 ? shedder.weight() : 0;
+            uint64_t validated = timed ? now_ns() : 0;
+
+            sketches.update(packet.view, shedder.weight());
+            uint64_t counted = timed ? now_ns() : 0;
+
+            if (shedder.inspect_payload()) {
+                AppClassifier classifier(packet.view);
+                classified[static_cast<size_t>(classifier.protocol)]++;
+                if (timed) {
+                    uint64_t inspected = now_ns();
+                    shedder.record(ShedStage::PAYLOAD, inspected - counted, 1);
+                    if (metrics) {
+                        metrics->record_latency(MetricsStage::PAYLOAD, inspected - counted);
+                    }
+                }
+            }
+            if (timed) {
+                shedder.record(ShedStage::VALIDATE, validated - parsed, 1);
+                shedder.record(ShedStage::HEADERS, counted - validated, 1);
+            }
+            if (metrics) {
+                metrics->count_errors(error_mask);
+                if (timed) {
+                    metrics->record_latency(MetricsStage::VALIDATE, validated - parsed);
+                    metrics->record_latency(MetricsStage::HEADERS, counted - validated);
+                }
+            }
+        }
+        consumer.release();
+        if (metrics && consumer.dropped != reported_drops) {
+            metrics->count_drops(MetricsDrop::RING_OVERRUN, consumer.dropped - reported_drops);
+            reported_drops = consumer.dropped;
+        }
+    }
+
+    std::cout << "Received " << consumer.received << " records, dropped " << consumer.dropped
+              << ", ~" << invalid << " invalid\n";
+    std::cout << "Classified (inspected packets only): DNS " << classified[static_cast<size_t>(AppProtocol::DNS)]
+              << " HTTP " << classified[static_cast<size_t>(AppProtocol::HTTP)]
+              << " TLS " << classified[static_cast<size_t>(AppProtocol::TLS)]
+              << " unknown " << classified[static_cast<size_t>(AppProtocol::UNKNOWN)] << '\n';
+    shedder.print();
+    sketches.print_top(3);
+    return 0;
+}
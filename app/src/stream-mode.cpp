@@ -0,0 +1,142 @@
+#include "stream-mode.hpp"
+#include "app-clock.hpp"
+#include "pcap-file.hpp"
+#include "parser.hpp"
+#include "flow_key.hpp"
+#include "app-classifier.hpp"
+#include "stream-parsers.hpp"
+#include <iostream>
+#include <array>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <arpa/inet.h>
+
+/*
+    Stream L7 Mode
+    - Every TCP segment with a payload is fed, by sequence number, into the StreamSession of its direction; the
+      session reassembles across segments, so a Host header or SNI split over several of them is still found
+    - The one-shot AppClassifier runs on the same segments for comparison, and only sees one at a time
+    - A direction is finished on FIN / RST or at the end of the trace; only the feed() calls are timed
+*/
+
+struct StreamFlow {
+    StreamSession session;
+    bool one_shot_name = false;     // the one-shot classifier found the Host / SNI in some segment
+};
+
+struct StreamTotals {
+    uint64_t directions = 0;
+    uint64_t complete = 0;
+    uint64_t malformed = 0;
+    uint64_t names = 0;
+    uint64_t one_shot_names = 0;
+    uint64_t messages = 0;
+};
+
+// Source address, destination address (IPv4 as ::ffff:a.b.c.d), source port, destination port: one entry per direction
+using StreamAddress = std::array<uint8_t, 16>;
+using StreamKey = std::tuple<StreamAddress, StreamAddress, uint16_t, uint16_t>;
+
+static StreamAddress stream_address(const FlowKey& flow, bool source) {
+    StreamAddress address{};
+    if (flow.ipv6) {
+        std::memcpy(address.data(), source ? flow.src_addr6 : flow.dest_addr6, address.size());
+        return address;
+    }
+    uint32_t addr = source ? flow.src_addr : flow.dest_addr;
+    address[10] = 0xFF;
+    address[11] = 0xFF;
+    for (size_t i = 0; i < 4; i++) {
+        address[12 + i] = static_cast<uint8_t>(addr >> (24 - 8 * i));
+    }
+    return address;
+}
+
+int run_stream_l7_mode(const std::string& path) {
+    PcapReader reader(path);
+    if (!reader.ok) {
+        std::cerr << "Cannot read pcap file " << path << '\n';
+        return 1;
+    }
+
+    std::map<StreamKey, std::unique_ptr<StreamFlow>> flows;
+    StreamTotals http;
+    StreamTotals tls;
+    uint64_t segments = 0;
+    uint64_t overlaps = 0;
+    uint64_t gaps = 0;
+    uint64_t resumes = 0;
+    uint64_t unknown = 0;
+    uint64_t stream_ns = 0;
+
+    auto finish = [&](StreamFlow& flow) {
+        flow.session.close();
+        const StreamResult& result = flow.session.result;
+        segments += flow.session.segments;
+        overlaps += flow.session.overlaps;
+        gaps += flow.session.gap ? 1 : 0;
+        resumes += flow.session.resumes();
+        StreamTotals* totals = result.protocol == AppProtocol::HTTP ? &http
+                             : result.protocol == AppProtocol::TLS ? &tls : nullptr;
+        if (!totals) {
+            unknown++;
+            return;
+        }
+        totals->directions++;
+        totals->complete += result.complete ? 1 : 0;
+        totals->malformed += result.malformed ? 1 : 0;
+        totals->messages += result.messages;
+        totals->names += (totals == &http ? result.http_host.empty() : result.tls_sni.empty()) ? 0 : 1;
+        totals->one_shot_names += flow.one_shot_name ? 1 : 0;
+    };
+
+    PcapRecord record;
+    while (reader.next(record)) {
+        ParsedPacket packet = parse_packet(record.data);
+        const PacketView& view = packet.view;
+        FlowKey flow_key;
+        if (!view.has_tcp || view.payload_len < 20 || !make_flow_key(view, flow_key)) {
+            continue;
+        }
+        const TCPHeader* tcp = view.tcp_layer.tcph;
+        StreamKey key(stream_address(flow_key, true), stream_address(flow_key, false),
+                      flow_key.src_port, flow_key.dest_port);
+        AppClassifier classifier(view, APP_FIELD_HTTP_HOST | APP_FIELD_TLS_SNI);
+
+        auto it = flows.find(key);
+        if (classifier.app_len > 0) {
+            if (it == flows.end()) {
+                it = flows.emplace(key, std::make_unique<StreamFlow>()).first;
+            }
+            StreamFlow& flow = *it->second;
+            flow.one_shot_name |= !classifier.http_host.empty() || !classifier.tls_sni.empty();
+            uint64_t start = now_ns();
+            flow.session.feed(ntohl(tcp->seq_num), std::span<const uint8_t>(classifier.app_data, classifier.app_len));
+            stream_ns += now_ns() - start;
+        }
+        if (it != flows.end() && (tcp->flags & (FIN_FLAG | RST_FLAG))) {
+            finish(*it->second);
+            flows.erase(it);
+        }
+    }
+    for (auto& [key, flow] : flows) {
+        finish(*flow);
+    }
+
+    std::cout << "=== STREAM L7 ===\n";
+    std::cout << "HTTP directions: " << http.directions << " (" << http.complete << " complete, " << http.malformed
+              << " malformed) Messages: " << http.messages << '\n';
+    std::cout << "  Host: " << http.names << " streamed, " << http.one_shot_names << " one-shot\n";
+    std::cout << "TLS directions: " << tls.directions << " (" << tls.complete << " complete, " << tls.malformed
+              << " malformed)\n";
+    std::cout << "  SNI: " << tls.names << " streamed, " << tls.one_shot_names << " one-shot\n";
+    std::cout << "Other directions: " << unknown << '\n';
+    std::cout << "Segments: " << segments << " Retransmitted: " << overlaps << " Gaps: " << gaps
+              << " Resumes: " << resumes << '\n';
+    std::cout << "Streaming: " << (segments ? static_cast<double>(stream_ns) / static_cast<double>(segments) : 0.0)
+              << " ns/segment, " << sizeof(StreamSession) << " bytes/session\n";
+    StreamFramePool::local().print();
+    return 0;
+}
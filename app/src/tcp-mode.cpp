@@ -0,0 +1,58 @@
+#include "tcp-mode.hpp"
+#include "pcap-file.hpp"
+#include "parser.hpp"
+#include "state-arena.hpp"
+#include "tcp-tracker.hpp"
+#include <iostream>
+#include <chrono>
+
+/*
+    TCP Tracking Mode
+    - Every record is parsed and handed to the tracker with its capture timestamp
+    - With a state file the restore time (mmap of the snapshot) is reported before the trace, and the snapshot is
+      written by a forked child afterwards, waited for so the process does not exit under it
+*/
+
+static void track(PcapReader& reader, TcpTracker& tracker) {
+    PcapRecord record;
+    while (reader.next(record)) {
+        ParsedPacket packet = parse_packet(record.data);
+        tracker.update(record.timestamp_ns, packet.view);
+    }
+    tracker.print();
+}
+
+int run_track_tcp_mode(const std::string& path, const std::string& state_path) {
+    PcapReader reader(path);
+    if (!reader.ok) {
+        std::cerr << "Cannot read pcap file " << path << '\n';
+        return 1;
+    }
+
+    if (state_path.empty()) {
+        TcpTracker tracker;
+        track(reader, tracker);
+        return 0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    StateArena arena(state_path);
+    if (!arena.ok) {
+        std::cerr << "Cannot reserve the state arena\n";
+        return 1;
+    }
+    TcpTracker tracker(arena, "tcp");
+    auto restored = std::chrono::steady_clock::now();
+    std::cout << (tracker.restored ? "Restored " : "Started empty, ") << tracker.active_flows() << " connections in "
+              << std::chrono::duration<double, std::milli>(restored - start).count() << " ms\n";
+
+    track(reader, tracker);
+
+    tracker.checkpoint();
+    if (!arena.snapshot_background(state_path) || !arena.snapshot_poll(true) || arena.snapshot_failures) {
+        std::cerr << "Cannot write snapshot " << state_path << '\n';
+        return 1;
+    }
+    arena.print();
+    return 0;
+}
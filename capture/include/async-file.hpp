@@ -0,0 +1,104 @@
+#pragma once
+#include "io-uring.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#define ASYNC_IO_ALIGNMENT 4096
+#define ASYNC_IO_DEFAULT_BUFFER_SIZE (1 << 20)
+#define ASYNC_IO_DEFAULT_BUFFER_COUNT 3
+
+struct AsyncIoOptions {
+    size_t buffer_size = ASYNC_IO_DEFAULT_BUFFER_SIZE;    // rounded up to ASYNC_IO_ALIGNMENT
+    unsigned buffer_count = ASYNC_IO_DEFAULT_BUFFER_COUNT; // 2 = double buffering, 3 = triple, ...
+    bool direct_io = false;                                // O_DIRECT, falls back to buffered if refused
+    bool use_uring = true;                                 // false (or setup failure) -> plain pread/pwrite
+};
+
+// One aligned buffer of the read-ahead / write-behind set
+struct AsyncIoSlot {
+    uint8_t* buffer;
+    uint64_t offset;        // file offset of buffer[0]
+    size_t length;          // bytes expected (read) or to write
+    size_t done;            // bytes completed so far
+    bool in_flight;
+    int error;              // -errno of a failed request
+};
+
+// Sequential reader that keeps buffer_count reads in flight ahead of the consumer
+class AsyncFileReader {
+public:
+    bool ok;
+    bool failed;
+    bool uring_active;
+    bool buffers_registered;
+    bool direct_active;
+    uint64_t file_size;
+    uint64_t bytes_read;
+    uint64_t reads_submitted;
+
+    AsyncFileReader(const std::string& path, const AsyncIoOptions& options = AsyncIoOptions());
+    ~AsyncFileReader();
+
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    // Next chunk in file order; the previous chunk goes back to the read-ahead queue,
+    // so a chunk is only valid until the next call. False at EOF or on error (see failed)
+    bool next_chunk(std::span<const uint8_t>& chunk);
+
+private:
+    AsyncIoOptions options;
+    int fd;
+    std::unique_ptr<IoUring> ring;
+    uint8_t* memory;
+    std::vector<AsyncIoSlot> slots;
+    uint64_t next_offset;       // next chunk offset to submit
+    uint64_t consumed;          // chunks handed to the caller
+    bool holding;               // caller currently owns slot (consumed - 1)
+
+    void submit_read(unsigned index);
+    bool wait_slot(unsigned index);
+    bool read_sync(AsyncIoSlot& slot);
+};
+
+// Sequential writer that batches appends into large buffers and writes them behind the producer
+class AsyncFileWriter {
+public:
+    bool ok;
+    bool uring_active;
+    bool buffers_registered;
+    bool direct_active;
+    uint64_t bytes_written;
+    uint64_t writes_submitted;
+
+    AsyncFileWriter(const std::string& path, const AsyncIoOptions& options = AsyncIoOptions());
+    ~AsyncFileWriter();
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    // Copies into the current buffer, a full buffer is submitted without waiting for it
+    bool write(const uint8_t* data, size_t length);
+
+    // Writes the tail, waits for all outstanding writes and closes the file
+    bool close();
+
+private:
+    AsyncIoOptions options;
+    int fd;
+    std::unique_ptr<IoUring> ring;
+    uint8_t* memory;
+    std::vector<AsyncIoSlot> slots;
+    unsigned current;
+    uint64_t next_offset;
+    bool closed;
+
+    void submit_write(unsigned index);
+    bool wait_slot(unsigned index);
+    bool reap_one();
+    bool write_sync(AsyncIoSlot& slot);
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+#include <cstddef>
+#include <cstdint>
+
+// Minimal io_uring instance on the raw syscalls (no liburing dependency)
+// - one submission and one completion ring, identity-mapped SQ index array
+// - single threaded: the owner fills SQEs, submits and reaps CQEs
+class IoUring {
+public:
+    bool ok;
+    unsigned entries;
+
+    IoUring(unsigned entries);
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // Pins the buffers for IORING_OP_READ_FIXED / WRITE_FIXED (buf_index = position in iov)
+    bool register_buffers(const iovec* iov, unsigned count);
+
+    // Zeroed SQE, or nullptr when the submission ring is full
+    io_uring_sqe* get_sqe();
+
+    // Submits all SQEs handed out since the last call, optionally waiting for wait_for completions
+    // Returns the number submitted or -errno
+    int submit(unsigned wait_for = 0);
+
+    io_uring_cqe* peek_cqe();
+    io_uring_cqe* wait_cqe();      // nullptr only on a hard error
+    void cqe_seen();
+
+private:
+    int fd;
+
+    void* sq_ring;
+    size_t sq_ring_size;
+    void* cq_ring;
+    size_t cq_ring_size;
+    io_uring_sqe* sqes;
+    size_t sqes_size;
+
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned sq_mask;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned cq_mask;
+    io_uring_cqe* cqes;
+
+    unsigned sqe_head;      // first SQE not yet published to the kernel
+    unsigned sqe_tail;      // next SQE to hand out
+
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags);
+};
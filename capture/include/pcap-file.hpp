@@ -0,0 +1,74 @@
+#pragma once
+#include "async-file.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#define PCAP_MAGIC_USEC 0xA1B2C3D4
+#define PCAP_MAGIC_NSEC 0xA1B23C4D
+#define PCAP_VERSION_MAJOR 2
+#define PCAP_VERSION_MINOR 4
+#define PCAP_LINKTYPE_ETHERNET 1
+#define PCAP_DEFAULT_SNAPLEN 262144
+#define PCAP_MAX_RECORD_SIZE (16 << 20)
+
+struct PcapRecord {
+    uint64_t timestamp_ns;
+    uint32_t original_length;
+    std::span<const uint8_t> data;      // captured bytes
+};
+
+// Classic libpcap file reader on top of the read-ahead AsyncFileReader
+// - accepts both byte orders and both microsecond / nanosecond timestamp magics
+// - records are returned in place from the read buffers, only records that straddle
+//   two buffers are copied into a spill buffer
+class PcapReader {
+public:
+    bool ok;
+    bool truncated;         // last record cut short or a corrupt record length was found
+    bool nanosecond;
+    bool swapped;
+    uint32_t linktype;
+    uint32_t snaplen;
+    uint64_t records;
+
+    PcapReader(const std::string& path, const AsyncIoOptions& options = AsyncIoOptions());
+
+    // record.data is valid until the next call
+    bool next(PcapRecord& record);
+
+    const AsyncFileReader& file() const { return reader; }
+
+private:
+    AsyncFileReader reader;
+    std::span<const uint8_t> chunk;
+    size_t position;
+    std::vector<uint8_t> spill;
+
+    bool read_bytes(size_t n, const uint8_t*& out);
+    uint32_t field(const uint8_t* bytes) const;
+};
+
+// Classic libpcap file writer, records are batched into the AsyncFileWriter buffers
+class PcapWriter {
+public:
+    bool ok;
+    uint64_t records;
+
+    PcapWriter(const std::string& path, const AsyncIoOptions& options = AsyncIoOptions(),
+               bool nanosecond = true, uint32_t snaplen = PCAP_DEFAULT_SNAPLEN,
+               uint32_t linktype = PCAP_LINKTYPE_ETHERNET);
+
+    // Packets longer than snaplen are truncated, original_length 0 means packet.size()
+    bool write(uint64_t timestamp_ns, std::span<const uint8_t> packet, uint32_t original_length = 0);
+    bool close();
+
+    const AsyncFileWriter& file() const { return writer; }
+
+private:
+    AsyncFileWriter writer;
+    bool nanosecond;
+    uint32_t snaplen;
+};
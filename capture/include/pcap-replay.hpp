@@ -0,0 +1,95 @@
+#pragma once
+#include "pcap-file.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#define REPLAY_DEFAULT_SPIN_NS 50000
+#define REPLAY_LATE_NS 1000         // a frame handed out later than this past its due time counts as late
+
+// Pacing clock: invariant TSC scaled to ns when the CPU has one, steady_clock otherwise
+// - calibrated once against steady_clock in the constructor (about 10 ms)
+class ReplayClock {
+public:
+    bool tsc;
+
+    ReplayClock();
+
+    uint64_t now_ns() const;
+
+    // Sleeps through all but the last spin_ns of the wait, then busy-polls the clock
+    void wait_until(uint64_t deadline_ns, uint64_t spin_ns) const;
+
+private:
+    double ns_per_tick;
+    uint64_t base_ticks;
+    uint64_t base_ns;
+};
+
+struct ReplayConfig {
+    double speed = 1.0;                     // multiplier on the recorded timing, 0 = flat out
+    uint32_t loops = 1;
+    uint32_t addr_step = 0x00010000;        // added to both IPv4 addresses on every extra loop (one /16 per loop)
+    uint16_t port_step = 0;                 // added to both TCP/UDP ports on every extra loop
+    uint64_t spin_ns = REPLAY_DEFAULT_SPIN_NS;
+};
+
+struct ReplayFrame {
+    uint64_t timestamp_ns;                  // recorded time, shifted by one trace span per loop
+    uint32_t loop;
+    std::span<const uint8_t> data;          // valid until the next call
+};
+
+// Replays a pcap trace at its recorded timing (scaled by speed) or flat out, optionally looping it
+// - the whole trace is loaded up front so replay never waits on the disk
+// - later loops rewrite the innermost IPv4 addresses / ports of a copy of each frame (checksums patched
+//   incrementally, ports left alone in non-first fragments), so every loop shows up as a fresh set of flows;
+//   IPv6 and non-IP frames go out unchanged
+// - a VXLAN tunnel's UDP checksum is zeroed over IPv4 and patched over IPv6 when its inner headers change
+class PcapReplayer {
+public:
+    bool ok;
+    bool truncated;                 // the trace file was cut short, the records before the cut are replayed
+    ReplayConfig config;
+    ReplayClock clock;
+
+    uint64_t trace_packets;
+    uint64_t trace_bytes;
+    uint64_t trace_span_ns;         // first to last record plus one mean gap, the period of a loop
+
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t rewritten;
+    uint64_t late;                  // handed out more than REPLAY_LATE_NS after their due time
+    uint64_t max_late_ns;
+    uint64_t total_late_ns;
+
+    PcapReplayer(const std::string& path, const ReplayConfig& config = ReplayConfig());
+
+    // Waits until the next frame is due and returns it, false once every loop has been replayed
+    bool next(ReplayFrame& frame);
+
+    // From the first next() to now
+    uint64_t elapsed_ns() const;
+
+    void print() const;
+
+private:
+    struct TraceRecord {
+        uint64_t offset;
+        uint32_t length;
+        uint64_t time_ns;           // relative to the first record
+    };
+
+    std::vector<uint8_t> trace;
+    std::vector<TraceRecord> records;
+    std::vector<uint8_t> scratch;
+    size_t index;
+    uint32_t loop;
+    uint64_t start_ns;
+    uint64_t first_ns;              // timestamp of the first record
+
+    void rewrite(uint8_t* data, size_t length, uint32_t loop);
+};
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+// AF_PACKET raw socket bound to one interface (a veth end, lo, ...) that transmits whole Ethernet frames
+// - needs CAP_NET_RAW; the qdisc is bypassed when the kernel allows it
+class PacketInjector {
+public:
+    bool ok;
+    bool qdisc_bypass;
+    uint64_t sent;
+    uint64_t failed;            // e.g. frame over the interface MTU, or the device queue full
+
+    PacketInjector(const std::string& interface);
+    ~PacketInjector();
+
+    PacketInjector(const PacketInjector&) = delete;
+    PacketInjector& operator=(const PacketInjector&) = delete;
+
+    bool send(std::span<const uint8_t> frame);
+
+private:
+    int fd;
+};
+
+#define XDP_DEFAULT_FRAME_COUNT 4096
+#define XDP_DEFAULT_FRAME_SIZE 2048
+#define XDP_DEFAULT_RING_SIZE 2048
+#define XDP_MAX_BATCH 256
+
+// How the socket is attached, best first; AUTO walks down the list until one works
+enum class XdpMode : uint8_t {
+    AUTO,
+    ZERO_COPY,      // native XDP, the NIC DMAs straight into UMEM
+    NATIVE,         // native XDP in the driver, frames copied into UMEM
+    SKB,            // generic XDP after the skb is built, works on any device (veth, lo)
+    NONE
+};
+
+struct XdpConfig {
+    uint32_t queue = 0;
+    uint32_t frame_count = XDP_DEFAULT_FRAME_COUNT;     // UMEM frames, rounded up to a power of two
+    uint32_t frame_size = XDP_DEFAULT_FRAME_SIZE;       // 2048 or 4096
+    uint32_t ring_size = XDP_DEFAULT_RING_SIZE;         // RX and completion ring entries, power of two
+    XdpMode mode = XdpMode::AUTO;
+};
+
+// Producer / consumer ring mapped from the socket (fill, completion, RX)
+struct XdpRing {
+    uint32_t* producer;
+    uint32_t* consumer;
+    uint32_t* flags;
+    void* entries;          // uint64_t addresses (fill, completion) or xdp_desc (RX)
+    uint32_t mask;
+    void* map;
+    size_t map_size;
+};
+
+// AF_XDP receive socket on one interface queue, on the raw syscalls (no libbpf / libxdp)
+// - UMEM of frame_count frames, all of them handed to the kernel through the fill ring up front
+// - A six-instruction XDP program (ld_imm64 of the map takes two slots) redirects the queue into the socket through an XSKMAP,
+//   anything arriving while the socket is not in the map passes up the stack
+// - receive() hands out UMEM frames in place; they go back to the fill ring on the next receive() or release()
+// - Needs CAP_NET_ADMIN + CAP_BPF (root) and a kernel with BPF links for XDP (5.9+)
+class XdpSocket {
+public:
+    bool ok;
+    XdpMode mode;               // what AUTO settled on
+    int error;                  // errno of the step that failed
+    const char* failed_step;
+    uint64_t received;
+    uint64_t bytes;
+    uint64_t wakeups;           // fill-ring wakeup / poll syscalls
+
+    XdpSocket(const std::string& interface, const XdpConfig& config = XdpConfig());
+    ~XdpSocket();
+
+    XdpSocket(const XdpSocket&) = delete;
+    XdpSocket& operator=(const XdpSocket&) = delete;
+
+    // Up to max frames (at most XDP_MAX_BATCH), waiting up to timeout_ms when none are ready (-1 = forever)
+    // Releases the previous batch first; the spans point into UMEM
+    size_t receive(std::span<const uint8_t>* frames, size_t max, int timeout_ms);
+
+    // Returns the last batch to the fill ring
+    void release();
+
+    // Kernel side drop counters (XDP_STATISTICS)
+    bool statistics(uint64_t& rx_dropped, uint64_t& rx_ring_full, uint64_t& fill_ring_empty) const;
+
+    static const char* mode_name(XdpMode mode);
+
+private:
+    XdpConfig config;
+    int fd;
+    int map_fd;
+    int prog_fd;
+    int link_fd;
+    uint8_t* umem;
+    size_t umem_size;
+    XdpRing fill;
+    XdpRing completion;
+    XdpRing rx;
+    uint64_t pending[XDP_MAX_BATCH];    // frame addresses of the batch handed out
+    size_t pending_count;
+
+    bool fail(const char* step);
+    bool setup_rings();
+    bool load_program();
+    bool bind_socket(unsigned ifindex, uint16_t flags);
+    bool map_socket();
+    bool attach_program(unsigned ifindex, XdpMode attach);
+};
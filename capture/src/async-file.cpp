@@ -0,0 +1,401 @@
+#include "async-file.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+    AsyncFileReader / AsyncFileWriter Implementation
+    - buffer_count aligned buffers are allocated once and registered with the ring (READ_FIXED / WRITE_FIXED)
+    - The reader keeps every buffer the caller is not holding in flight, chunk k always lives in buffer k % count
+    - The writer fills one buffer while the others are being written, and only blocks when it wraps onto a busy one
+    - Short transfers are resubmitted for the remainder; without io_uring the same slots are served with pread/pwrite
+    - O_DIRECT needs aligned offsets and lengths: reads are rounded up, the final write is zero padded and truncated
+*/
+
+static size_t align_up(size_t value) {
+    return (value + ASYNC_IO_ALIGNMENT - 1) / ASYNC_IO_ALIGNMENT * ASYNC_IO_ALIGNMENT;
+}
+
+// Normalizes the options and allocates the slot buffers in one aligned block
+static uint8_t* setup_slots(AsyncIoOptions& options, std::vector<AsyncIoSlot>& slots) {
+    options.buffer_size = align_up(options.buffer_size ? options.buffer_size : ASYNC_IO_DEFAULT_BUFFER_SIZE);
+    options.buffer_count = options.buffer_count ? options.buffer_count : 1;
+
+    uint8_t* memory = static_cast<uint8_t*>(std::aligned_alloc(ASYNC_IO_ALIGNMENT, options.buffer_size * options.buffer_count));
+    if (!memory) {
+        return nullptr;
+    }
+    slots.resize(options.buffer_count);
+    for (unsigned i = 0; i < options.buffer_count; i++) {
+        slots[i] = AsyncIoSlot{memory + i * options.buffer_size, 0, 0, 0, false, 0};
+    }
+    return memory;
+}
+
+// Opens with O_DIRECT when asked, retrying buffered if the filesystem refuses it
+static int open_file(const std::string& path, int flags, bool direct, bool& direct_active) {
+    direct_active = false;
+    if (direct) {
+        int fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        if (fd >= 0) {
+            direct_active = true;
+            return fd;
+        }
+    }
+    return ::open(path.c_str(), flags, 0644);
+}
+
+static std::unique_ptr<IoUring> setup_ring(const AsyncIoOptions& options, const std::vector<AsyncIoSlot>& slots,
+                                           bool& registered) {
+    registered = false;
+    if (!options.use_uring) {
+        return nullptr;
+    }
+    std::unique_ptr<IoUring> ring = std::make_unique<IoUring>(options.buffer_count);
+    if (!ring->ok) {
+        return nullptr;
+    }
+
+    // Pinning can fail on a low RLIMIT_MEMLOCK, plain READ/WRITE still works then
+    std::vector<iovec> iov(slots.size());
+    for (size_t i = 0; i < slots.size(); i++) {
+        iov[i].iov_base = slots[i].buffer;
+        iov[i].iov_len = options.buffer_size;
+    }
+    registered = ring->register_buffers(iov.data(), static_cast<unsigned>(iov.size()));
+    return ring;
+}
+
+// Fills one SQE for the untransferred remainder of a slot
+static void queue_transfer(IoUring& ring, int fd, AsyncIoSlot& slot, unsigned index,
+                           bool write, bool registered, bool direct) {
+    io_uring_sqe* sqe = ring.get_sqe();
+    while (!sqe) {
+        ring.submit();
+        sqe = ring.get_sqe();
+    }
+
+    size_t length = slot.length - slot.done;
+    if (direct && !write) {
+        length = align_up(length);
+    }
+    if (registered) {
+        sqe->opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+        sqe->buf_index = static_cast<uint16_t>(index);
+    }
+    else {
+        sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+    }
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(slot.buffer + slot.done);
+    sqe->len = static_cast<uint32_t>(length);
+    sqe->off = slot.offset + slot.done;
+    sqe->user_data = index;
+}
+
+// Applies one completion to its slot, returns true if the slot needs a resubmit for the remainder
+static bool complete_transfer(AsyncIoSlot& slot, int result, bool write) {
+    if (result == -EINTR || result == -EAGAIN) {
+        return true;
+    }
+    if (result < 0) {
+        slot.error = result;
+        slot.in_flight = false;
+        return false;
+    }
+    if (result == 0) {
+        // Read: file ended early (truncated underneath us). Write: no progress
+        if (write) {
+            slot.error = -EIO;
+        }
+        else {
+            slot.length = slot.done;
+        }
+        slot.in_flight = false;
+        return false;
+    }
+
+    slot.done += static_cast<size_t>(result);
+    if (slot.done >= slot.length) {
+        slot.in_flight = false;
+        return false;
+    }
+    return true;
+}
+
+// ---- AsyncFileReader ----
+
+AsyncFileReader::AsyncFileReader(const std::string& path, const AsyncIoOptions& options) :
+    ok(false), failed(false), uring_active(false), buffers_registered(false), direct_active(false),
+    file_size(0), bytes_read(0), reads_submitted(0),
+    options(options), fd(-1), memory(nullptr), next_offset(0), consumed(0), holding(false)
+{
+    fd = open_file(path, O_RDONLY, options.direct_io, direct_active);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return;
+    }
+    file_size = static_cast<uint64_t>(st.st_size);
+
+    memory = setup_slots(this->options, slots);
+    if (!memory) {
+        return;
+    }
+    ring = setup_ring(this->options, slots, buffers_registered);
+    uring_active = ring != nullptr;
+
+    for (unsigned i = 0; i < slots.size() && next_offset < file_size; i++) {
+        submit_read(i);
+    }
+    if (ring) {
+        ring->submit();
+    }
+    ok = true;
+}
+
+AsyncFileReader::~AsyncFileReader() {
+    // The kernel may still be writing into the buffers
+    if (ring) {
+        for (unsigned i = 0; i < slots.size(); i++) {
+            wait_slot(i);
+        }
+    }
+    ring.reset();
+    std::free(memory);
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+void AsyncFileReader::submit_read(unsigned index) {
+    AsyncIoSlot& slot = slots[index];
+    slot.offset = next_offset;
+    slot.length = file_size - next_offset < options.buffer_size ? file_size - next_offset : options.buffer_size;
+    slot.done = 0;
+    slot.error = 0;
+    slot.in_flight = true;
+    next_offset += slot.length;
+    reads_submitted++;
+
+    if (ring) {
+        queue_transfer(*ring, fd, slot, index, false, buffers_registered, direct_active);
+    }
+}
+
+bool AsyncFileReader::read_sync(AsyncIoSlot& slot) {
+    while (slot.in_flight) {
+        size_t length = slot.length - slot.done;
+        if (direct_active) {
+            length = align_up(length);
+        }
+        ssize_t result = pread(fd, slot.buffer + slot.done, length, static_cast<off_t>(slot.offset + slot.done));
+        complete_transfer(slot, result < 0 ? -errno : static_cast<int>(result), false);
+    }
+    return slot.error == 0;
+}
+
+bool AsyncFileReader::wait_slot(unsigned index) {
+    AsyncIoSlot& slot = slots[index];
+    if (!ring) {
+        return read_sync(slot);
+    }
+
+    while (slot.in_flight) {
+        io_uring_cqe* cqe = ring->wait_cqe();
+        if (!cqe) {
+            failed = true;
+            return false;
+        }
+        unsigned completed = static_cast<unsigned>(cqe->user_data);
+        int result = cqe->res;
+        ring->cqe_seen();
+
+        if (complete_transfer(slots[completed], result, false)) {
+            queue_transfer(*ring, fd, slots[completed], completed, false, buffers_registered, direct_active);
+            ring->submit();
+        }
+    }
+    return slot.error == 0;
+}
+
+bool AsyncFileReader::next_chunk(std::span<const uint8_t>& chunk) {
+    if (!ok || failed) {
+        return false;
+    }
+
+    // Hand the previous buffer back before waiting, so it refills while this chunk is parsed
+    if (holding) {
+        holding = false;
+        if (next_offset < file_size) {
+            submit_read(static_cast<unsigned>((consumed - 1) % slots.size()));
+            if (ring) {
+                ring->submit();
+            }
+        }
+    }
+
+    if (consumed * options.buffer_size >= file_size) {
+        return false;
+    }
+
+    unsigned index = static_cast<unsigned>(consumed % slots.size());
+    if (!wait_slot(index)) {
+        failed = true;
+        return false;
+    }
+
+    AsyncIoSlot& slot = slots[index];
+    chunk = std::span<const uint8_t>(slot.buffer, slot.length);
+    bytes_read += slot.length;
+    consumed++;
+    holding = true;
+    return slot.length > 0;
+}
+
+// ---- AsyncFileWriter ----
+
+AsyncFileWriter::AsyncFileWriter(const std::string& path, const AsyncIoOptions& options) :
+    ok(false), uring_active(false), buffers_registered(false), direct_active(false),
+    bytes_written(0), writes_submitted(0),
+    options(options), fd(-1), memory(nullptr), current(0), next_offset(0), closed(true)
+{
+    fd = open_file(path, O_WRONLY | O_CREAT | O_TRUNC, options.direct_io, direct_active);
+    if (fd < 0) {
+        return;
+    }
+    memory = setup_slots(this->options, slots);
+    if (!memory) {
+        ::close(fd);
+        fd = -1;
+        return;
+    }
+    ring = setup_ring(this->options, slots, buffers_registered);
+    uring_active = ring != nullptr;
+    closed = false;
+    ok = true;
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    close();
+    ring.reset();
+    std::free(memory);
+}
+
+bool AsyncFileWriter::write_sync(AsyncIoSlot& slot) {
+    while (slot.in_flight) {
+        ssize_t result = pwrite(fd, slot.buffer + slot.done, slot.length - slot.done,
+                                static_cast<off_t>(slot.offset + slot.done));
+        complete_transfer(slot, result < 0 ? -errno : static_cast<int>(result), true);
+    }
+    return slot.error == 0;
+}
+
+void AsyncFileWriter::submit_write(unsigned index) {
+    AsyncIoSlot& slot = slots[index];
+    slot.offset = next_offset;
+    slot.done = 0;
+    slot.error = 0;
+    slot.in_flight = true;
+    next_offset += slot.length;
+    writes_submitted++;
+
+    if (ring) {
+        queue_transfer(*ring, fd, slot, index, true, buffers_registered, direct_active);
+        ring->submit();
+    }
+    else if (!write_sync(slot)) {
+        ok = false;
+    }
+}
+
+bool AsyncFileWriter::reap_one() {
+    io_uring_cqe* cqe = ring->wait_cqe();
+    if (!cqe) {
+        return false;
+    }
+    unsigned completed = static_cast<unsigned>(cqe->user_data);
+    int result = cqe->res;
+    ring->cqe_seen();
+
+    if (complete_transfer(slots[completed], result, true)) {
+        queue_transfer(*ring, fd, slots[completed], completed, true, buffers_registered, direct_active);
+        ring->submit();
+    }
+    return true;
+}
+
+bool AsyncFileWriter::wait_slot(unsigned index) {
+    AsyncIoSlot& slot = slots[index];
+    while (slot.in_flight) {
+        if (!ring || !reap_one()) {
+            return false;
+        }
+    }
+    return slot.error == 0;
+}
+
+bool AsyncFileWriter::write(const uint8_t* data, size_t length) {
+    if (closed || !ok) {
+        return false;
+    }
+
+    while (length > 0) {
+        AsyncIoSlot& slot = slots[current];
+        size_t space = options.buffer_size - slot.length;
+        size_t n = length < space ? length : space;
+        std::memcpy(slot.buffer + slot.length, data, n);
+        slot.length += n;
+        data += n;
+        length -= n;
+        bytes_written += n;
+
+        if (slot.length == options.buffer_size) {
+            submit_write(current);
+            current = (current + 1) % slots.size();
+            if (!wait_slot(current)) {
+                ok = false;
+                return false;
+            }
+            slots[current].length = 0;
+        }
+    }
+    return ok;
+}
+
+bool AsyncFileWriter::close() {
+    if (closed) {
+        return ok;
+    }
+    closed = true;
+
+    AsyncIoSlot& tail = slots[current];
+    uint64_t end = next_offset + tail.length;
+    if (ok && tail.length > 0) {
+        if (direct_active) {
+            size_t padded = align_up(tail.length);
+            std::memset(tail.buffer + tail.length, 0, padded - tail.length);
+            tail.length = padded;
+        }
+        submit_write(current);
+    }
+
+    for (unsigned i = 0; i < slots.size(); i++) {
+        if (!wait_slot(i)) {
+            ok = false;
+        }
+    }
+    if (direct_active && ftruncate(fd, static_cast<off_t>(end)) != 0) {
+        ok = false;
+    }
+    if (::close(fd) != 0) {
+        ok = false;
+    }
+    fd = -1;
+    return ok;
+}
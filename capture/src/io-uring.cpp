@@ -0,0 +1,164 @@
+#include "io-uring.hpp"
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/*
+    IoUring Class Implementation
+    - io_uring_setup / io_uring_enter / io_uring_register are called directly through syscall()
+    - The SQ and CQ rings are mmapped once (shared mapping when IORING_FEAT_SINGLE_MMAP is offered)
+    - Ring head/tail indices are shared with the kernel: tails are published with release stores,
+      heads written by the kernel are read with acquire loads
+*/
+
+static int io_uring_setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+static int io_uring_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+static unsigned* ring_field(void* ring, uint32_t offset) {
+    return reinterpret_cast<unsigned*>(static_cast<uint8_t*>(ring) + offset);
+}
+
+IoUring::IoUring(unsigned entries) :
+    ok(false), entries(0), fd(-1),
+    sq_ring(MAP_FAILED), sq_ring_size(0), cq_ring(MAP_FAILED), cq_ring_size(0),
+    sqes(static_cast<io_uring_sqe*>(MAP_FAILED)), sqes_size(0),
+    sq_head(nullptr), sq_tail(nullptr), sq_mask(0), cq_head(nullptr), cq_tail(nullptr), cq_mask(0),
+    cqes(nullptr), sqe_head(0), sqe_tail(0)
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    fd = io_uring_setup(entries, &params);
+    if (fd < 0) {
+        return;
+    }
+
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_ring_size = cq_ring_size = sq_ring_size > cq_ring_size ? sq_ring_size : cq_ring_size;
+    }
+
+    sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) {
+        return;
+    }
+    if (single_mmap) {
+        cq_ring = sq_ring;
+    }
+    else {
+        cq_ring = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) {
+            return;
+        }
+    }
+
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+                                           MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+    if (sqes == MAP_FAILED) {
+        return;
+    }
+
+    sq_head = ring_field(sq_ring, params.sq_off.head);
+    sq_tail = ring_field(sq_ring, params.sq_off.tail);
+    sq_mask = *ring_field(sq_ring, params.sq_off.ring_mask);
+    cq_head = ring_field(cq_ring, params.cq_off.head);
+    cq_tail = ring_field(cq_ring, params.cq_off.tail);
+    cq_mask = *ring_field(cq_ring, params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(static_cast<uint8_t*>(cq_ring) + params.cq_off.cqes);
+
+    // SQE slot i is always submitted through array slot i
+    unsigned* array = ring_field(sq_ring, params.sq_off.array);
+    for (unsigned i = 0; i < params.sq_entries; i++) {
+        array[i] = i;
+    }
+
+    sqe_head = sqe_tail = *sq_tail;
+    this->entries = params.sq_entries;
+    ok = true;
+}
+
+IoUring::~IoUring() {
+    if (sqes != MAP_FAILED) {
+        munmap(sqes, sqes_size);
+    }
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring) {
+        munmap(cq_ring, cq_ring_size);
+    }
+    if (sq_ring != MAP_FAILED) {
+        munmap(sq_ring, sq_ring_size);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+bool IoUring::register_buffers(const iovec* iov, unsigned count) {
+    return ok && io_uring_register(fd, IORING_REGISTER_BUFFERS, iov, count) == 0;
+}
+
+io_uring_sqe* IoUring::get_sqe() {
+    unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+    if (sqe_tail - head >= entries) {
+        return nullptr;
+    }
+    io_uring_sqe* sqe = &sqes[sqe_tail & sq_mask];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe_tail++;
+    return sqe;
+}
+
+int IoUring::enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+    int result;
+    do {
+        result = io_uring_enter(fd, to_submit, min_complete, flags);
+    } while (result < 0 && errno == EINTR);
+    return result < 0 ? -errno : result;
+}
+
+int IoUring::submit(unsigned wait_for) {
+    unsigned to_submit = sqe_tail - sqe_head;
+    __atomic_store_n(sq_tail, sqe_tail, __ATOMIC_RELEASE);
+    sqe_head = sqe_tail;
+
+    if (to_submit == 0 && wait_for == 0) {
+        return 0;
+    }
+    return enter(to_submit, wait_for, wait_for ? IORING_ENTER_GETEVENTS : 0);
+}
+
+io_uring_cqe* IoUring::peek_cqe() {
+    unsigned head = *cq_head;
+    if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+        return nullptr;
+    }
+    return &cqes[head & cq_mask];
+}
+
+io_uring_cqe* IoUring::wait_cqe() {
+    for (;;) {
+        io_uring_cqe* cqe = peek_cqe();
+        if (cqe) {
+            return cqe;
+        }
+        if (submit(1) < 0) {
+            return nullptr;
+        }
+    }
+}
+
+void IoUring::cqe_seen() {
+    __atomic_store_n(cq_head, *cq_head + 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,159 @@
+#include "pcap-file.hpp"
+#include <cstring>
+
+#define PCAP_FILE_HEADER_SIZE 24
+#define PCAP_RECORD_HEADER_SIZE 16
+
+/*
+    PcapReader / PcapWriter Implementation
+    - File header: magic, version 2.4, thiszone, sigfigs, snaplen, linktype
+    - Record header: ts_sec, ts_usec (or ts_nsec), incl_len, orig_len
+    - Reading walks the chunks handed out by AsyncFileReader; the next chunk is only requested
+      once the current one is used up, which is when its buffer goes back to the read-ahead queue
+*/
+
+static uint32_t swap32(uint32_t value) {
+    return __builtin_bswap32(value);
+}
+
+// ---- PcapReader ----
+
+PcapReader::PcapReader(const std::string& path, const AsyncIoOptions& options) :
+    ok(false), truncated(false), nanosecond(false), swapped(false), linktype(0), snaplen(0), records(0),
+    reader(path, options), position(0)
+{
+    const uint8_t* header;
+    if (!reader.ok || !read_bytes(PCAP_FILE_HEADER_SIZE, header)) {
+        return;
+    }
+
+    uint32_t magic;
+    std::memcpy(&magic, header, sizeof(magic));
+    if (magic == PCAP_MAGIC_USEC || magic == PCAP_MAGIC_NSEC) {
+        swapped = false;
+    }
+    else if (swap32(magic) == PCAP_MAGIC_USEC || swap32(magic) == PCAP_MAGIC_NSEC) {
+        swapped = true;
+        magic = swap32(magic);
+    }
+    else {
+        return;
+    }
+    nanosecond = magic == PCAP_MAGIC_NSEC;
+    snaplen = field(header + 16);
+    linktype = field(header + 20);
+    ok = true;
+}
+
+uint32_t PcapReader::field(const uint8_t* bytes) const {
+    uint32_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return swapped ? swap32(value) : value;
+}
+
+bool PcapReader::read_bytes(size_t n, const uint8_t*& out) {
+    // Common case: the bytes are inside the current chunk
+    if (chunk.size() - position >= n) {
+        out = chunk.data() + position;
+        position += n;
+        return true;
+    }
+
+    // Straddles chunk boundaries: collect into the spill buffer
+    spill.assign(chunk.begin() + position, chunk.end());
+    position = chunk.size();
+    while (spill.size() < n) {
+        if (!reader.next_chunk(chunk)) {
+            chunk = std::span<const uint8_t>();
+            position = 0;
+            return false;
+        }
+        size_t take = n - spill.size() < chunk.size() ? n - spill.size() : chunk.size();
+        spill.insert(spill.end(), chunk.begin(), chunk.begin() + take);
+        position = take;
+    }
+    out = spill.data();
+    return true;
+}
+
+bool PcapReader::next(PcapRecord& record) {
+    if (!ok) {
+        return false;
+    }
+
+    const uint8_t* header;
+    if (!read_bytes(PCAP_RECORD_HEADER_SIZE, header)) {
+        // Leftover bytes smaller than a record header mean a cut-off file
+        truncated = truncated || !spill.empty() || reader.failed;
+        return false;
+    }
+
+    uint64_t seconds = field(header);
+    uint64_t fraction = field(header + 4);
+    uint32_t captured = field(header + 8);
+    uint32_t original = field(header + 12);
+    if (captured > PCAP_MAX_RECORD_SIZE) {
+        truncated = true;
+        ok = false;
+        return false;
+    }
+
+    const uint8_t* data;
+    if (!read_bytes(captured, data)) {
+        truncated = true;
+        return false;
+    }
+
+    record.timestamp_ns = seconds * 1000000000ULL + (nanosecond ? fraction : fraction * 1000);
+    record.original_length = original;
+    record.data = std::span<const uint8_t>(data, captured);
+    records++;
+    return true;
+}
+
+// ---- PcapWriter ----
+
+PcapWriter::PcapWriter(const std::string& path, const AsyncIoOptions& options,
+                       bool nanosecond, uint32_t snaplen, uint32_t linktype) :
+    ok(false), records(0), writer(path, options), nanosecond(nanosecond), snaplen(snaplen)
+{
+    if (!writer.ok) {
+        return;
+    }
+
+    uint32_t header[6] = {
+        nanosecond ? PCAP_MAGIC_NSEC : PCAP_MAGIC_USEC,
+        PCAP_VERSION_MAJOR | (PCAP_VERSION_MINOR << 16),
+        0,              // thiszone
+        0,              // sigfigs
+        snaplen,
+        linktype
+    };
+    ok = writer.write(reinterpret_cast<const uint8_t*>(header), sizeof(header));
+}
+
+bool PcapWriter::write(uint64_t timestamp_ns, std::span<const uint8_t> packet, uint32_t original_length) {
+    if (!ok) {
+        return false;
+    }
+
+    uint32_t captured = static_cast<uint32_t>(packet.size() < snaplen ? packet.size() : snaplen);
+    uint32_t header[4] = {
+        static_cast<uint32_t>(timestamp_ns / 1000000000ULL),
+        static_cast<uint32_t>(nanosecond ? timestamp_ns % 1000000000ULL : timestamp_ns % 1000000000ULL / 1000),
+        captured,
+        original_length ? original_length : static_cast<uint32_t>(packet.size())
+    };
+
+    ok = writer.write(reinterpret_cast<const uint8_t*>(header), sizeof(header)) &&
+         writer.write(packet.data(), captured);
+    if (ok) {
+        records++;
+    }
+    return ok;
+}
+
+bool PcapWriter::close() {
+    ok = writer.close() && ok;
+    return ok;
+}
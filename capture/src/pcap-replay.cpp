@@ -0,0 +1,340 @@
+#include "pcap-replay.hpp"
+#include "parser.hpp"
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+#define REPLAY_CALIBRATION_NS 10000000
+#define IPV4_FRAGMENT_OFFSET 6
+#define IPV4_FRAGMENT_OFFSET_MASK 0x1FFF
+#define IPV4_CHECKSUM_OFFSET 10
+#define IPV4_ADDRS_OFFSET 12
+#define TCP_CHECKSUM_OFFSET 16
+#define UDP_CHECKSUM_OFFSET 6
+
+/*
+    PcapReplayer Implementation
+    - Frame i of loop l is due at start + (l * trace_span + t_i) / speed; the frame (and its rewritten copy)
+      is prepared before waiting so the hand-out lands as close to the due time as the clock allows
+    - Waiting sleeps the bulk of long gaps and busy-polls the rest; the TSC clock is an rdtsc and a multiply,
+      so the poll loop resolves well under a microsecond
+    - Lateness (hand-out time past due) is accumulated per frame: it shows when the consumer, not the pacing,
+      is the bottleneck
+    - Rewriting patches the IPv4 header checksum and the TCP/UDP checksum (pseudo-header) with RFC 1624
+      incremental updates instead of recomputing them; non-first IPv4 fragments only get their addresses
+      rewritten, the bytes where a port would be are payload
+    - Tunnel UDP checksums cover the rewritten inner headers: over IPv4 they are set to zero (checksum off),
+      over IPv6, where zero is not allowed, every changed word is folded into them as well, byte-swapped when
+      it sits at an odd offset from the tunnel's UDP header
+*/
+
+static uint64_t steady_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+#if defined(__x86_64__)
+static bool invariant_tsc() {
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return edx & (1u << 8);
+}
+#endif
+
+static void cpu_relax() {
+#if defined(__x86_64__)
+    _mm_pause();
+#endif
+}
+
+static uint16_t read16(const uint8_t* bytes) {
+    return static_cast<uint16_t>((bytes[0] << 8) | bytes[1]);
+}
+
+static void write16(uint8_t* bytes, uint16_t value) {
+    bytes[0] = static_cast<uint8_t>(value >> 8);
+    bytes[1] = static_cast<uint8_t>(value);
+}
+
+// RFC 1624 eqn. 3: HC' = ~(~HC + ~m + m')
+static uint16_t checksum_adjust(uint16_t checksum, uint16_t old_word, uint16_t new_word) {
+    uint32_t sum = static_cast<uint16_t>(~checksum) + static_cast<uint16_t>(~old_word) + new_word;
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    return static_cast<uint16_t>(~sum);
+}
+
+static uint16_t swap16(uint16_t value) {
+    return static_cast<uint16_t>((value << 8) | (value >> 8));
+}
+
+// UDP checksums of the tunnels around the rewritten headers, outermost first
+struct TunnelChecksums {
+    uint8_t* udp[ENCAP_MAX_LAYERS];         // tunnel UDP header, its checksum words are aligned from here
+    size_t count = 0;
+};
+
+// Writes a 16 bit word that lies inside the first depth tunnels and folds the change into their checksums,
+// each checksum update in turn into the tunnels around it
+static void store16(uint8_t* word, uint16_t value, const TunnelChecksums& tunnels, size_t depth) {
+    uint16_t old_word = read16(word);
+    write16(word, value);
+    for (size_t i = 0; i < depth; i++) {
+        bool swapped = (word - tunnels.udp[i]) & 1;
+        uint8_t* checksum = tunnels.udp[i] + UDP_CHECKSUM_OFFSET;
+        uint16_t adjusted = checksum_adjust(read16(checksum), swapped ? swap16(old_word) : old_word,
+                                            swapped ? swap16(value) : value);
+        store16(checksum, adjusted ? adjusted : 0xFFFF, tunnels, i);
+    }
+}
+
+// Replaces a 16 bit field and patches every checksum that covers it (null entries are skipped)
+static void rewrite16(uint8_t* field, uint16_t value, uint8_t* ip_checksum, uint8_t* l4_checksum,
+                      const TunnelChecksums& tunnels) {
+    uint16_t old_word = read16(field);
+    store16(field, value, tunnels, tunnels.count);
+    if (ip_checksum) {
+        store16(ip_checksum, checksum_adjust(read16(ip_checksum), old_word, value), tunnels, tunnels.count);
+    }
+    if (l4_checksum) {
+        store16(l4_checksum, checksum_adjust(read16(l4_checksum), old_word, value), tunnels, tunnels.count);
+    }
+}
+
+// ---- ReplayClock ----
+
+ReplayClock::ReplayClock() : tsc(false), ns_per_tick(1.0), base_ticks(0), base_ns(0) {
+#if defined(__x86_64__)
+    if (!invariant_tsc()) {
+        return;
+    }
+    uint64_t start_ns = steady_ns();
+    uint64_t start_ticks = __rdtsc();
+    uint64_t end_ns;
+    while ((end_ns = steady_ns()) - start_ns < REPLAY_CALIBRATION_NS) {
+        cpu_relax();
+    }
+    uint64_t end_ticks = __rdtsc();
+    if (end_ticks <= start_ticks) {
+        return;
+    }
+    ns_per_tick = static_cast<double>(end_ns - start_ns) / static_cast<double>(end_ticks - start_ticks);
+    base_ticks = end_ticks;
+    base_ns = end_ns;
+    tsc = true;
+#endif
+}
+
+uint64_t ReplayClock::now_ns() const {
+#if defined(__x86_64__)
+    if (tsc) {
+        return base_ns + static_cast<uint64_t>(static_cast<double>(__rdtsc() - base_ticks) * ns_per_tick);
+    }
+#endif
+    return steady_ns();
+}
+
+void ReplayClock::wait_until(uint64_t deadline_ns, uint64_t spin_ns) const {
+    uint64_t now = now_ns();
+    if (now >= deadline_ns) {
+        return;
+    }
+    if (deadline_ns - now > spin_ns) {
+        uint64_t sleep_ns = deadline_ns - now - spin_ns;
+        timespec duration{static_cast<time_t>(sleep_ns / 1000000000ULL), static_cast<long>(sleep_ns % 1000000000ULL)};
+        nanosleep(&duration, nullptr);
+    }
+    while (now_ns() < deadline_ns) {
+        cpu_relax();
+    }
+}
+
+// ---- PcapReplayer ----
+
+PcapReplayer::PcapReplayer(const std::string& path, const ReplayConfig& config) :
+    ok(false), truncated(false), config(config),
+    trace_packets(0), trace_bytes(0), trace_span_ns(0),
+    packets(0), bytes(0), rewritten(0), late(0), max_late_ns(0), total_late_ns(0),
+    index(0), loop(0), start_ns(0), first_ns(0)
+{
+    PcapReader reader(path);
+    if (!reader.ok) {
+        return;
+    }
+
+    PcapRecord record;
+    size_t largest = 0;
+    uint64_t previous = 0;
+    while (reader.next(record)) {
+        if (records.empty()) {
+            first_ns = record.timestamp_ns;
+        }
+        // Out-of-order timestamps are held at the previous one rather than sent early
+        uint64_t time_ns = record.timestamp_ns > first_ns ? record.timestamp_ns - first_ns : 0;
+        time_ns = time_ns < previous ? previous : time_ns;
+        previous = time_ns;
+
+        records.push_back(TraceRecord{trace.size(), static_cast<uint32_t>(record.data.size()), time_ns});
+        trace.insert(trace.end(), record.data.begin(), record.data.end());
+        largest = record.data.size() > largest ? record.data.size() : largest;
+    }
+    truncated = reader.truncated;
+    if (reader.file().failed) {
+        return;
+    }
+
+    trace_packets = records.size();
+    trace_bytes = trace.size();
+    if (trace_packets > 1) {
+        trace_span_ns = previous + previous / (trace_packets - 1);
+    }
+    scratch.resize(largest);
+    ok = true;
+}
+
+void PcapReplayer::rewrite(uint8_t* data, size_t length, uint32_t loop) {
+    ParsedPacket parsed = parse_packet(std::span<const uint8_t>(data, length));
+    const PacketView& view = parsed.view;
+    if (!view.has_ip || length < view.l3_offset + sizeof(IPv4Header)) {
+        return;
+    }
+
+    uint8_t* ip = data + view.l3_offset;
+    uint8_t* l4 = data + view.l4_offset;
+    uint8_t* l4_checksum = nullptr;
+    bool ports = false;
+    bool first_fragment = (read16(ip + IPV4_FRAGMENT_OFFSET) & IPV4_FRAGMENT_OFFSET_MASK) == 0;
+    if (first_fragment && view.has_tcp && length >= view.l4_offset + TCP_CHECKSUM_OFFSET + 2) {
+        l4_checksum = l4 + TCP_CHECKSUM_OFFSET;
+        ports = true;
+    }
+    else if (first_fragment && view.has_udp && length >= view.l4_offset + UDP_CHECKSUM_OFFSET + 2) {
+        // A zero UDP checksum means "not computed" and has to stay zero
+        l4_checksum = read16(l4 + UDP_CHECKSUM_OFFSET) ? l4 + UDP_CHECKSUM_OFFSET : nullptr;
+        ports = true;
+    }
+
+    uint32_t addr_delta = config.addr_step * loop;
+    uint16_t port_delta = static_cast<uint16_t>(config.port_step * loop);
+    if (!addr_delta && !(ports && port_delta)) {
+        return;
+    }
+
+    // A UDP header in the encapsulation is a tunnel (VXLAN) whose checksum covers everything rewritten below
+    TunnelChecksums tunnels;
+    for (size_t i = 1; i < view.encap_count; i++) {
+        if (view.encap[i].type != EncapType::UDP) {
+            continue;
+        }
+        uint8_t* udp = data + view.encap[i].offset;
+        if (read16(udp + UDP_CHECKSUM_OFFSET) == 0) {
+            continue;
+        }
+        if (view.encap[i - 1].type == EncapType::IPV4) {
+            store16(udp + UDP_CHECKSUM_OFFSET, 0, tunnels, tunnels.count);
+        }
+        else {
+            tunnels.udp[tunnels.count++] = udp;
+        }
+    }
+
+    if (addr_delta) {
+        for (size_t field = 0; field < 2; field++) {
+            uint8_t* addr = ip + IPV4_ADDRS_OFFSET + field * 4;
+            uint32_t value = ((static_cast<uint32_t>(read16(addr)) << 16) | read16(addr + 2)) + addr_delta;
+            rewrite16(addr, static_cast<uint16_t>(value >> 16), ip + IPV4_CHECKSUM_OFFSET, l4_checksum, tunnels);
+            rewrite16(addr + 2, static_cast<uint16_t>(value), ip + IPV4_CHECKSUM_OFFSET, l4_checksum, tunnels);
+        }
+    }
+
+    if (ports && port_delta) {
+        rewrite16(l4, static_cast<uint16_t>(read16(l4) + port_delta), nullptr, l4_checksum, tunnels);
+        rewrite16(l4 + 2, static_cast<uint16_t>(read16(l4 + 2) + port_delta), nullptr, l4_checksum, tunnels);
+    }
+
+    // 0 is reserved for "no checksum" in UDP, its ones-complement twin is sent instead
+    if (view.has_udp && l4_checksum && read16(l4_checksum) == 0) {
+        store16(l4_checksum, 0xFFFF, tunnels, tunnels.count);
+    }
+    rewritten++;
+}
+
+bool PcapReplayer::next(ReplayFrame& frame) {
+    if (!ok || records.empty()) {
+        return false;
+    }
+    if (index == records.size()) {
+        index = 0;
+        loop++;
+    }
+    if (loop >= config.loops) {
+        return false;
+    }
+    if (packets == 0) {
+        start_ns = clock.now_ns();
+    }
+
+    const TraceRecord& record = records[index++];
+    uint64_t trace_ns = loop * trace_span_ns + record.time_ns;
+
+    frame.timestamp_ns = first_ns + trace_ns;
+    frame.loop = loop;
+    frame.data = std::span<const uint8_t>(trace.data() + record.offset, record.length);
+    if (loop > 0 && (config.addr_step || config.port_step)) {
+        std::memcpy(scratch.data(), frame.data.data(), record.length);
+        rewrite(scratch.data(), record.length, loop);
+        frame.data = std::span<const uint8_t>(scratch.data(), record.length);
+    }
+
+    if (config.speed > 0.0) {
+        uint64_t due = start_ns + static_cast<uint64_t>(static_cast<double>(trace_ns) / config.speed);
+        clock.wait_until(due, config.spin_ns);
+        uint64_t now = clock.now_ns();
+        if (now > due) {
+            uint64_t lateness = now - due;
+            total_late_ns += lateness;
+            max_late_ns = lateness > max_late_ns ? lateness : max_late_ns;
+            late += lateness > REPLAY_LATE_NS;
+        }
+    }
+
+    packets++;
+    bytes += record.length;
+    return true;
+}
+
+uint64_t PcapReplayer::elapsed_ns() const {
+    return packets ? clock.now_ns() - start_ns : 0;
+}
+
+void PcapReplayer::print() const {
+    uint64_t elapsed = elapsed_ns();
+    double seconds = static_cast<double>(elapsed) / 1e9;
+
+    std::cout << "=== PCAP REPLAY ===\n";
+    std::cout << "Trace: " << trace_packets << " packets, " << trace_bytes << " bytes, span "
+              << trace_span_ns / 1000 << " us" << (truncated ? " (truncated)" : "") << '\n';
+    std::cout << "Replayed: " << packets << " packets, " << bytes << " bytes, " << rewritten << " rewritten in "
+              << elapsed / 1000 << " us\n";
+    if (seconds > 0.0) {
+        std::cout << "Rate: " << static_cast<double>(packets) / seconds / 1e6 << " Mpps, "
+                  << static_cast<double>(bytes) * 8.0 / seconds / 1e9 << " Gbit/s\n";
+    }
+    std::cout << "Pacing: ";
+    if (config.speed > 0.0) {
+        std::cout << config.speed << "x";
+    }
+    else {
+        std::cout << "flat out";
+    }
+    std::cout << " (" << (clock.tsc ? "TSC" : "steady_clock") << ") Late: " << late << " Max late: " << max_late_ns
+              << " ns Mean late: " << (packets ? total_late_ns / packets : 0) << " ns\n";
+    std::cout << "===================\n";
+}
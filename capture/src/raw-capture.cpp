@@ -0,0 +1,408 @@
+#include "raw-capture.hpp"
+#include <arpa/inet.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include <linux/if_packet.h>
+#include <linux/if_xdp.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+/*
+    Raw Capture Implementation
+    - PacketInjector: SOCK_RAW packet socket bound with protocol 0, so it only transmits and never
+      has received frames queued on it
+    - XdpSocket: XSKMAP + program load, then socket + UMEM registration, ring mmaps, bind, XSKMAP entry, and the
+      XDP program is linked to the interface (BPF_LINK_CREATE, so closing the link fd detaches it even if the
+      process dies)
+    - AUTO first binds with XDP_ZEROCOPY and attaches native; when the driver refuses either, the socket is
+      rebuilt and bound in copy mode, then attached native before falling back to generic (SKB) XDP
+    - Ring indices are shared with the kernel: our producer / consumer indices are published with release
+      stores, the kernel's are read with acquire loads, as in IoUring
+*/
+
+PacketInjector::PacketInjector(const std::string& interface) :
+    ok(false), qdisc_bypass(false), sent(0), failed(0), fd(-1)
+{
+    unsigned index = if_nametoindex(interface.c_str());
+    if (index == 0) {
+        return;
+    }
+    fd = socket(AF_PACKET, SOCK_RAW | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return;
+    }
+
+    sockaddr_ll address;
+    std::memset(&address, 0, sizeof(address));
+    address.sll_family = AF_PACKET;
+    address.sll_ifindex = static_cast<int>(index);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        return;
+    }
+
+    int one = 1;
+    qdisc_bypass = setsockopt(fd, SOL_PACKET, PACKET_QDISC_BYPASS, &one, sizeof(one)) == 0;
+    ok = true;
+}
+
+PacketInjector::~PacketInjector() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+bool PacketInjector::send(std::span<const uint8_t> frame) {
+    if (!ok || ::send(fd, frame.data(), frame.size(), 0) != static_cast<ssize_t>(frame.size())) {
+        failed++;
+        return false;
+    }
+    sent++;
+    return true;
+}
+
+// ---- XdpSocket ----
+
+static long bpf(int cmd, bpf_attr& attr) {
+    return syscall(__NR_bpf, cmd, &attr, sizeof(attr));
+}
+
+static bpf_insn instruction(uint8_t code, uint8_t dst, uint8_t src, int16_t offset, int32_t immediate) {
+    bpf_insn insn;
+    std::memset(&insn, 0, sizeof(insn));
+    insn.code = code;
+    insn.dst_reg = dst & 0x0F;
+    insn.src_reg = src & 0x0F;
+    insn.off = offset;
+    insn.imm = immediate;
+    return insn;
+}
+
+static bool map_ring(int fd, XdpRing& ring, const xdp_ring_offset& offsets, size_t entry_size, uint32_t count,
+                     off_t page_offset) {
+    ring.map_size = offsets.desc + count * entry_size;
+    void* map = mmap(nullptr, ring.map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, page_offset);
+    if (map == MAP_FAILED) {
+        ring.map = nullptr;
+        return false;
+    }
+    uint8_t* base = static_cast<uint8_t*>(map);
+    ring.map = map;
+    ring.producer = reinterpret_cast<uint32_t*>(base + offsets.producer);
+    ring.consumer = reinterpret_cast<uint32_t*>(base + offsets.consumer);
+    ring.flags = reinterpret_cast<uint32_t*>(base + offsets.flags);
+    ring.entries = base + offsets.desc;
+    ring.mask = count - 1;
+    return true;
+}
+
+static void unmap_ring(XdpRing& ring) {
+    if (ring.map) {
+        munmap(ring.map, ring.map_size);
+    }
+    std::memset(&ring, 0, sizeof(ring));
+}
+
+XdpSocket::XdpSocket(const std::string& interface, const XdpConfig& config) :
+    ok(false), mode(XdpMode::NONE), error(0), failed_step(nullptr), received(0), bytes(0), wakeups(0),
+    config(config), fd(-1), map_fd(-1), prog_fd(-1), link_fd(-1), umem(nullptr), umem_size(0),
+    fill{}, completion{}, rx{}, pending_count(0)
+{
+    XdpConfig& c = this->config;
+    c.frame_size = c.frame_size == 4096 ? 4096 : 2048;
+    c.frame_count = std::bit_ceil(c.frame_count < 64 ? 64u : c.frame_count);
+    c.ring_size = std::bit_ceil(c.ring_size < 64 ? 64u : c.ring_size);
+
+    unsigned ifindex = if_nametoindex(interface.c_str());
+    if (ifindex == 0) {
+        fail("if_nametoindex");
+        return;
+    }
+
+    umem_size = static_cast<size_t>(c.frame_count) * c.frame_size;
+    void* memory = mmap(nullptr, umem_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (memory == MAP_FAILED) {
+        fail("mmap umem");
+        return;
+    }
+    umem = static_cast<uint8_t*>(memory);
+
+    if (!load_program()) {
+        return;
+    }
+
+    // Zero-copy needs the program in the driver, copy mode takes native, then generic. A driver can accept a
+    // zero-copy bind and still refuse the native attach, so AUTO then rebuilds the socket in copy mode
+    uint16_t bind_flags[] = {XDP_ZEROCOPY, XDP_COPY};
+    for (uint16_t flags : bind_flags) {
+        if (flags == XDP_ZEROCOPY && c.mode != XdpMode::AUTO && c.mode != XdpMode::ZERO_COPY) {
+            continue;
+        }
+        if (flags == XDP_COPY && c.mode == XdpMode::ZERO_COPY) {
+            break;
+        }
+        if (!setup_rings()) {
+            return;
+        }
+        if (!bind_socket(ifindex, flags)) {
+            continue;
+        }
+        if (!map_socket()) {
+            return;
+        }
+
+        XdpMode attach_modes[] = {XdpMode::NATIVE, XdpMode::SKB};
+        for (XdpMode attach : attach_modes) {
+            if (flags == XDP_ZEROCOPY && attach != XdpMode::NATIVE) {
+                break;
+            }
+            if (flags == XDP_COPY && c.mode != XdpMode::AUTO && c.mode != attach) {
+                continue;
+            }
+            if (attach_program(ifindex, attach)) {
+                mode = flags == XDP_ZEROCOPY ? XdpMode::ZERO_COPY : attach;
+                ok = true;
+                error = 0;
+                failed_step = nullptr;
+                return;
+            }
+        }
+    }
+}
+
+XdpSocket::~XdpSocket() {
+    int fds[] = {link_fd, prog_fd, map_fd};
+    for (int descriptor : fds) {
+        if (descriptor >= 0) {
+            ::close(descriptor);
+        }
+    }
+    unmap_ring(rx);
+    unmap_ring(fill);
+    unmap_ring(completion);
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    if (umem) {
+        munmap(umem, umem_size);
+    }
+}
+
+bool XdpSocket::fail(const char* step) {
+    error = errno;
+    failed_step = step;
+    return false;
+}
+
+// Fresh socket with the UMEM registered, rings mapped and every frame in the fill ring
+bool XdpSocket::setup_rings() {
+    unmap_ring(rx);
+    unmap_ring(fill);
+    unmap_ring(completion);
+    if (fd >= 0) {
+        ::close(fd);
+    }
+
+    fd = socket(AF_XDP, SOCK_RAW | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return fail("socket");
+    }
+
+    xdp_umem_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.addr = reinterpret_cast<uint64_t>(umem);
+    reg.len = umem_size;
+    reg.chunk_size = config.frame_size;
+    if (setsockopt(fd, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) != 0) {
+        return fail("XDP_UMEM_REG");
+    }
+    if (setsockopt(fd, SOL_XDP, XDP_UMEM_FILL_RING, &config.frame_count, sizeof(config.frame_count)) != 0 ||
+        setsockopt(fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &config.ring_size, sizeof(config.ring_size)) != 0 ||
+        setsockopt(fd, SOL_XDP, XDP_RX_RING, &config.ring_size, sizeof(config.ring_size)) != 0) {
+        return fail("ring sizes");
+    }
+
+    xdp_mmap_offsets offsets;
+    socklen_t length = sizeof(offsets);
+    if (getsockopt(fd, SOL_XDP, XDP_MMAP_OFFSETS, &offsets, &length) != 0) {
+        return fail("XDP_MMAP_OFFSETS");
+    }
+    if (!map_ring(fd, fill, offsets.fr, sizeof(uint64_t), config.frame_count, XDP_UMEM_PGOFF_FILL_RING) ||
+        !map_ring(fd, completion, offsets.cr, sizeof(uint64_t), config.ring_size, XDP_UMEM_PGOFF_COMPLETION_RING) ||
+        !map_ring(fd, rx, offsets.rx, sizeof(xdp_desc), config.ring_size, XDP_PGOFF_RX_RING)) {
+        return fail("ring mmap");
+    }
+
+    uint64_t* addresses = static_cast<uint64_t*>(fill.entries);
+    for (uint32_t i = 0; i < config.frame_count; i++) {
+        addresses[i] = static_cast<uint64_t>(i) * config.frame_size;
+    }
+    __atomic_store_n(fill.producer, config.frame_count, __ATOMIC_RELEASE);
+    pending_count = 0;
+    return true;
+}
+
+bool XdpSocket::bind_socket(unsigned ifindex, uint16_t flags) {
+    sockaddr_xdp address;
+    std::memset(&address, 0, sizeof(address));
+    address.sxdp_family = AF_XDP;
+    address.sxdp_flags = flags | XDP_USE_NEED_WAKEUP;
+    address.sxdp_ifindex = ifindex;
+    address.sxdp_queue_id = config.queue;
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        return fail("bind");
+    }
+    return true;
+}
+
+// Points our queue's XSKMAP entry at the current socket, replacing a socket given up on
+bool XdpSocket::map_socket() {
+    bpf_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    uint32_t key = config.queue;
+    uint32_t value = static_cast<uint32_t>(fd);
+    attr.map_fd = static_cast<uint32_t>(map_fd);
+    attr.key = reinterpret_cast<uint64_t>(&key);
+    attr.value = reinterpret_cast<uint64_t>(&value);
+    if (bpf(BPF_MAP_UPDATE_ELEM, attr) != 0) {
+        return fail("xskmap update");
+    }
+    return true;
+}
+
+bool XdpSocket::attach_program(unsigned ifindex, XdpMode attach) {
+    bpf_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.link_create.prog_fd = static_cast<uint32_t>(prog_fd);
+    attr.link_create.target_ifindex = ifindex;
+    attr.link_create.attach_type = BPF_XDP;
+    attr.link_create.flags = attach == XdpMode::NATIVE ? XDP_FLAGS_DRV_MODE : XDP_FLAGS_SKB_MODE;
+    link_fd = static_cast<int>(bpf(BPF_LINK_CREATE, attr));
+    if (link_fd < 0) {
+        return fail("xdp attach");
+    }
+    return true;
+}
+
+// XSKMAP with one entry per queue up to ours and: return bpf_redirect_map(&xsks, ctx->rx_queue_index, XDP_PASS)
+bool XdpSocket::load_program() {
+    bpf_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.map_type = BPF_MAP_TYPE_XSKMAP;
+    attr.key_size = sizeof(uint32_t);
+    attr.value_size = sizeof(uint32_t);
+    attr.max_entries = config.queue + 1;
+    map_fd = static_cast<int>(bpf(BPF_MAP_CREATE, attr));
+    if (map_fd < 0) {
+        return fail("xskmap create");
+    }
+
+    bpf_insn program[] = {
+        instruction(BPF_LDX | BPF_W | BPF_MEM, BPF_REG_2, BPF_REG_1, offsetof(xdp_md, rx_queue_index), 0),
+        instruction(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD, 0, map_fd),
+        instruction(0, 0, 0, 0, 0),
+        instruction(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_3, 0, 0, XDP_PASS),
+        instruction(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map),
+        instruction(BPF_JMP | BPF_EXIT, 0, 0, 0, 0)
+    };
+    static const char license[] = "GPL";
+
+    std::memset(&attr, 0, sizeof(attr));
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.insns = reinterpret_cast<uint64_t>(program);
+    attr.insn_cnt = sizeof(program) / sizeof(program[0]);
+    attr.license = reinterpret_cast<uint64_t>(license);
+    prog_fd = static_cast<int>(bpf(BPF_PROG_LOAD, attr));
+    if (prog_fd < 0) {
+        return fail("xdp program load");
+    }
+    return true;
+}
+
+size_t XdpSocket::receive(std::span<const uint8_t>* frames, size_t max, int timeout_ms) {
+    if (!ok) {
+        return 0;
+    }
+    release();
+
+    uint32_t consumer = *rx.consumer;
+    uint32_t available = __atomic_load_n(rx.producer, __ATOMIC_ACQUIRE) - consumer;
+    if (available == 0 && timeout_ms != 0) {
+        pollfd descriptor{fd, POLLIN, 0};
+        poll(&descriptor, 1, timeout_ms);
+        wakeups++;
+        available = __atomic_load_n(rx.producer, __ATOMIC_ACQUIRE) - consumer;
+    }
+
+    size_t n = available < max ? available : max;
+    n = n < XDP_MAX_BATCH ? n : XDP_MAX_BATCH;
+    const xdp_desc* descriptors = static_cast<const xdp_desc*>(rx.entries);
+    uint64_t frame_mask = ~static_cast<uint64_t>(config.frame_size - 1);
+    for (size_t i = 0; i < n; i++) {
+        const xdp_desc& desc = descriptors[(consumer + i) & rx.mask];
+        frames[i] = std::span<const uint8_t>(umem + desc.addr, desc.len);
+        pending[i] = desc.addr & frame_mask;
+        bytes += desc.len;
+    }
+    pending_count = n;
+    received += n;
+    __atomic_store_n(rx.consumer, consumer + static_cast<uint32_t>(n), __ATOMIC_RELEASE);
+    return n;
+}
+
+void XdpSocket::release() {
+    if (pending_count == 0) {
+        return;
+    }
+    // Every frame is either in the fill ring, in flight in the kernel or pending here, so the fill ring
+    // (frame_count entries) always has room for the returned batch
+    uint32_t producer = *fill.producer;
+    uint64_t* addresses = static_cast<uint64_t*>(fill.entries);
+    for (size_t i = 0; i < pending_count; i++) {
+        addresses[(producer + i) & fill.mask] = pending[i];
+    }
+    __atomic_store_n(fill.producer, producer + static_cast<uint32_t>(pending_count), __ATOMIC_RELEASE);
+    pending_count = 0;
+
+    if (__atomic_load_n(fill.flags, __ATOMIC_ACQUIRE) & XDP_RING_NEED_WAKEUP) {
+        recvfrom(fd, nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+        wakeups++;
+    }
+}
+
+bool XdpSocket::statistics(uint64_t& rx_dropped, uint64_t& rx_ring_full, uint64_t& fill_ring_empty) const {
+    xdp_statistics stats;
+    std::memset(&stats, 0, sizeof(stats));
+    socklen_t length = sizeof(stats);
+    if (fd < 0 || getsockopt(fd, SOL_XDP, XDP_STATISTICS, &stats, &length) != 0) {
+        return false;
+    }
+    rx_dropped = stats.rx_dropped;
+    rx_ring_full = stats.rx_ring_full;
+    fill_ring_empty = stats.rx_fill_ring_empty_descs;
+    return true;
+}
+
+const char* XdpSocket::mode_name(XdpMode mode) {
+    switch (mode) {
+        case XdpMode::AUTO: return "auto";
+        case XdpMode::ZERO_COPY: return "zero-copy";
+        case XdpMode::NATIVE: return "native";
+        case XdpMode::SKB: return "skb";
+        default: return "none";
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "packet_view.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Returned when no rule matches
+#define ACL_NO_MATCH 0xFFFFFFFFu
+
+// Any-protocol wildcard for AclRule::protocol
+#define ACL_ANY_PROTOCOL 0xFFFF
+
+// One prioritized 5-tuple rule (addresses in host byte order)
+// Higher priority wins, ties go to the rule listed first
+struct AclRule {
+    uint32_t id;
+    uint32_t priority;
+
+    uint32_t src_addr;
+    uint8_t src_len;
+    uint32_t dest_addr;
+    uint8_t dest_len;
+
+    uint16_t src_port_lo;
+    uint16_t src_port_hi;
+    uint16_t dest_port_lo;
+    uint16_t dest_port_hi;
+
+    uint16_t protocol;          // IPv4 protocol number or ACL_ANY_PROTOCOL
+
+    // Match when (flags & tcp_flags_mask) == tcp_flags, a zero mask matches everything
+    uint8_t tcp_flags;
+    uint8_t tcp_flags_mask;
+};
+
+// Header fields a packet is classified on (host byte order)
+struct AclKey {
+    uint32_t src_addr;
+    uint32_t dest_addr;
+    uint16_t src_port;
+    uint16_t dest_port;
+    uint8_t protocol;
+    uint8_t tcp_flags;
+};
+
+// Rule classifier compiled offline into a HyperSplit-style decision tree
+// - inner nodes split one dimension (src, dst, sport, dport, proto) at a single threshold
+// - leaves hold at most a handful of rules in priority order, checked linearly
+class AclClassifier {
+public:
+    size_t rule_count;
+    size_t node_count;
+    size_t leaf_rule_refs;
+    size_t max_depth;
+
+    // Compile step -> the rule vector is not referenced afterwards
+    AclClassifier(const std::vector<AclRule>& rules);
+
+    // Returns the id of the highest-priority matching rule or ACL_NO_MATCH
+    uint32_t classify(const AclKey& key) const;
+
+    // Walks n keys through the tree in lockstep, prefetching the next node of each
+    void classify_batch(const AclKey* keys, uint32_t* ids, size_t n) const;
+
+    // Fills key from a parsed packet, false if the packet has no IPv4 header
+    static bool make_key(const PacketView& view, AclKey& key);
+
+private:
+    // Rule flattened into inclusive [lo, hi] ranges per dimension
+    struct CompiledRule {
+        uint32_t lo[5];
+        uint32_t hi[5];
+        uint8_t tcp_flags;
+        uint8_t tcp_flags_mask;
+        uint32_t id;
+    };
+
+    // Inner node: left child is the next node, right child is at 'right'
+    // Leaf node (dim == LEAF): rules are leaf_rules[first, first + count)
+    struct Node {
+        uint32_t value;     // threshold (go right if key >= value) or first leaf rule
+        uint32_t right;     // right child index or leaf rule count
+        uint8_t dim;
+    };
+
+    std::vector<CompiledRule> rules;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> leaf_rules;
+
+    void build(std::vector<uint32_t>& node_rules, uint32_t box_lo[5], uint32_t box_hi[5], size_t depth);
+    bool rule_matches(const CompiledRule& rule, const uint32_t fields[5], uint8_t tcp_flags) const;
+    uint32_t match_leaf(const Node& leaf, const AclKey& key) const;
+};
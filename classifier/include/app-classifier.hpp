@@ -0,0 +1,65 @@
+#pragma once
+#include "packet_view.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Supported Application (L7) Protocols
+enum class AppProtocol {
+    UNKNOWN,
+    DNS,
+    HTTP,
+    TLS
+};
+
+// Fields the classifier should extract
+// Parsing stops as soon as every requested field has been found
+enum AppField : uint8_t {
+    APP_FIELD_NONE       = 0x00,
+    APP_FIELD_HTTP_LINE  = 0x01,   // method, uri, version
+    APP_FIELD_HTTP_HOST  = 0x02,
+    APP_FIELD_TLS_SNI    = 0x04,
+    APP_FIELD_TLS_ALPN   = 0x08,
+    APP_FIELD_DNS_QUERY  = 0x10,
+    APP_FIELD_ALL        = 0xFF
+};
+
+class AppClassifier {
+public:
+    const PacketView& view;
+
+    // Application payload (bytes after the TCP/UDP header)
+    const uint8_t* app_data;
+    size_t app_len;
+
+    AppProtocol protocol;
+
+    // Extracted fields -> all views point into the original packet buffer
+    std::string_view http_method;
+    std::string_view http_uri;
+    std::string_view http_version;
+    std::string_view http_host;
+    std::string_view tls_sni;
+    std::string_view tls_alpn;     // first protocol offered by the client
+    std::string_view dns_query;    // QNAME in wire format (length-prefixed labels)
+    uint16_t dns_id;
+
+    AppClassifier(const PacketView& v, uint8_t wanted = APP_FIELD_ALL)
+        : view(v), app_data(nullptr), app_len(0),
+          protocol(AppProtocol::UNKNOWN), dns_id(0), wanted(wanted)
+    {
+        classify();
+    }
+
+    void classify();
+    void print() const;
+
+private:
+    uint8_t wanted;
+
+    bool classify_dns(uint16_t src_port, uint16_t dest_port);
+    bool classify_http();
+    bool classify_tls();
+
+    void find_http_host(size_t offset);
+};
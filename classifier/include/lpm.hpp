@@ -0,0 +1,90 @@
+#pragma once
+#include "packet_view.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Returned by batched lookups for addresses that match no prefix
+#define LPM_NO_LABEL 0xFFFFFFFFu
+
+// Maximum number of reader threads an LpmTableStore can track
+#define LPM_MAX_READERS 64
+
+// One prefix -> label mapping (prefix in host byte order)
+struct LpmRoute {
+    uint32_t prefix;
+    uint8_t length;
+    uint32_t label;
+};
+
+// Compiled, immutable IPv4 longest-prefix-match table (DIR-24-8 layout)
+// - tbl24 resolves every prefix up to /24 in a single memory access
+// - longer prefixes spill into 256-entry tbl8 groups, costing one extra access
+class LpmTable {
+public:
+    size_t route_count;
+    size_t rejected_routes;
+
+    // Compiles the table; invalid routes (length > 32, label too large) are skipped and counted
+    LpmTable(const std::vector<LpmRoute>& routes);
+
+    // Address in host byte order
+    bool lookup(uint32_t addr, uint32_t& label) const;
+
+    // Looks up n addresses (host byte order), prefetching across the batch
+    void lookup_batch(const uint32_t* addrs, uint32_t* labels, size_t n) const;
+
+    // Tags the IPv4 source/destination of each packet (LPM_NO_LABEL for non-IPv4 or no match)
+    void lookup_packets(const PacketView* const* views, size_t n, uint32_t* src_labels, uint32_t* dest_labels) const;
+
+    size_t tbl8_groups() const { return tbl8.size() / 256; }
+    size_t memory_usage() const;
+
+    // Reads "a.b.c.d/len label" lines, '#' starts a comment
+    static bool load_routes(const std::string& path, std::vector<LpmRoute>& routes);
+
+private:
+    std::vector<uint32_t> tbl24;
+    std::vector<uint32_t> tbl8;
+
+    void add_route(const LpmRoute& route);
+};
+
+// RCU-style holder for the active LpmTable
+// - readers bracket each batch with read_lock()/read_unlock(): read_lock() is one seq_cst store to the reader's own
+//   cache line (a full fence on x86), read_unlock() a plain release store; readers never write shared lines
+// - publish() swaps the table atomically, waits for readers still on the old one and then frees it
+class LpmTableStore {
+public:
+    LpmTableStore();
+    ~LpmTableStore();
+
+    LpmTableStore(const LpmTableStore&) = delete;
+    LpmTableStore& operator=(const LpmTableStore&) = delete;
+
+    // Returns a reader slot, or -1 if all LPM_MAX_READERS slots are taken
+    int register_reader();
+    void unregister_reader(int slot);
+
+    // The returned table stays valid until read_unlock() on the same slot
+    const LpmTable* read_lock(int slot);
+    void read_unlock(int slot);
+
+    // Installs a new table and reclaims the previous one once no reader can still see it
+    void publish(std::unique_ptr<LpmTable> table);
+
+private:
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch;   // 0 -> not inside a read section
+        std::atomic<bool> in_use;
+    };
+
+    std::atomic<const LpmTable*> current;
+    std::atomic<uint64_t> global_epoch;
+    std::mutex publish_lock;
+    ReaderSlot readers[LPM_MAX_READERS];
+};
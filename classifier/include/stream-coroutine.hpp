@@ -0,0 +1,153 @@
+#pragma once
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <span>
+#include <vector>
+
+#define STREAM_FRAME_ALIGN 64           // frame sizes are rounded up to a multiple of this
+#define STREAM_FRAME_CLASSES 32         // pooled up to 32 * 64 = 2 KiB, larger frames go to the heap
+#define STREAM_FRAME_CHUNK (64 * 1024)
+#define STREAM_CARRY_SIZE 128           // longest field (or line) a parser can get in one piece
+
+/*
+    Incremental stream parsing with C++20 coroutines
+    - A parser is a coroutine returning StreamTask that co_awaits bytes from a StreamReader, written top to bottom
+      like a parser over one buffer; the runtime resumes it from StreamReader::feed() when more payload arrives
+    - Awaited spans point into the fed payload when the field lies within one segment and into a small carry
+      buffer when it straddles segments, so whole messages are never buffered; they stay valid until the next co_await
+    - Frames come from the calling thread's StreamFramePool: a parser must be created and destroyed on one thread
+*/
+
+// Per-thread free lists of coroutine frames, one per 64 byte size class, carved from 64 KiB chunks
+class StreamFramePool {
+public:
+    uint64_t allocations;
+    uint64_t reused;            // served from a free list
+    uint64_t oversized;         // larger than the biggest class, passed to operator new
+    size_t in_use;
+    size_t chunk_bytes;
+    size_t largest_frame;
+
+    static StreamFramePool& local();
+
+    void* allocate(size_t size);
+    void deallocate(void* frame, size_t size);
+    void print() const;
+
+    StreamFramePool(const StreamFramePool&) = delete;
+    StreamFramePool& operator=(const StreamFramePool&) = delete;
+
+private:
+    struct FreeFrame {
+        FreeFrame* next;
+    };
+
+    struct alignas(STREAM_FRAME_ALIGN) Block {
+        uint8_t bytes[STREAM_FRAME_ALIGN];
+    };
+
+    FreeFrame* free_lists[STREAM_FRAME_CLASSES];
+    std::vector<std::unique_ptr<Block[]>> chunks;
+    uint8_t* bump;
+    size_t bump_left;
+
+    StreamFramePool();
+};
+
+// Owner of a running parser; destroying it frees the frame even while the parser is suspended
+class StreamTask {
+public:
+    struct promise_type {
+        StreamTask get_return_object() { return StreamTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_never initial_suspend() noexcept { return {}; }     // run up to the first co_await
+        std::suspend_always final_suspend() noexcept { return {}; }      // keep the frame until the task goes
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+
+        static void* operator new(size_t size) { return StreamFramePool::local().allocate(size); }
+        static void operator delete(void* frame, size_t size) { StreamFramePool::local().deallocate(frame, size); }
+    };
+
+    StreamTask() : handle(nullptr) {}
+    explicit StreamTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    StreamTask(StreamTask&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    StreamTask& operator=(StreamTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            handle = other.handle;
+            other.handle = nullptr;
+        }
+        return *this;
+    }
+    ~StreamTask() { reset(); }
+
+    StreamTask(const StreamTask&) = delete;
+    StreamTask& operator=(const StreamTask&) = delete;
+
+    bool running() const { return handle && !handle.done(); }
+    void reset() {
+        if (handle) {
+            handle.destroy();
+            handle = nullptr;
+        }
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+};
+
+// What a suspended parser is waiting for
+enum class StreamWant : uint8_t {
+    NONE,
+    BYTES,      // exactly n bytes
+    LINE,       // up to LF, without the CR LF
+    SKIP        // n bytes discarded
+};
+
+// Byte source for one direction of a flow
+class StreamReader {
+public:
+    uint64_t bytes_fed;
+    uint64_t resumes;           // times feed() woke the parser
+    bool closed;                // end of stream: pending and later awaits complete short
+    bool truncated;             // a line longer than STREAM_CARRY_SIZE was cut
+
+    StreamReader();
+
+    // Next in-order payload; the bytes only have to stay valid during the call
+    void feed(std::span<const uint8_t> data);
+    // Wakes the parser with what is buffered, every await from here on returns at once
+    void close();
+    bool waiting() const { return static_cast<bool>(waiter); }
+
+    struct Await {
+        StreamReader& reader;
+
+        bool await_ready() { return reader.complete(); }
+        void await_suspend(std::coroutine_handle<> handle) { reader.waiter = handle; }
+        std::span<const uint8_t> await_resume() { return reader.result; }
+    };
+
+    // n <= STREAM_CARRY_SIZE bytes, fewer only at end of stream
+    Await bytes(size_t n);
+    // Next line without the line ending, cut at STREAM_CARRY_SIZE (sets truncated); empty for a blank line
+    Await line();
+    // Discards n bytes, whatever their number of segments; resumes with an empty span
+    Await skip(uint64_t n);
+
+private:
+    std::span<const uint8_t> segment;       // unread part of the payload being fed
+    std::span<const uint8_t> result;
+    std::coroutine_handle<> waiter;
+    uint64_t want;
+    StreamWant kind;
+    bool discarding;                        // dropping the rest of an over-long line
+    uint16_t carried;
+    uint8_t carry[STREAM_CARRY_SIZE];
+
+    bool complete();
+    Await request(StreamWant kind, uint64_t n);
+};
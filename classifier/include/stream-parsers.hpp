@@ -0,0 +1,74 @@
+#pragma once
+#include "stream-coroutine.hpp"
+#include "app-classifier.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+// Fixed-capacity copy of an extracted field: the packets it came from are gone by the time it is read
+template <size_t N>
+struct StreamText {
+    static_assert(N < 256, "StreamText length is one byte");
+
+    uint8_t length = 0;
+    char data[N];
+
+    void assign(std::string_view text) {
+        length = static_cast<uint8_t>(text.size() < N ? text.size() : N);
+        std::memcpy(data, text.data(), length);
+    }
+    std::string_view view() const { return std::string_view(data, length); }
+    bool empty() const { return length == 0; }
+};
+
+// What the incremental parsers extracted from one direction of a connection
+struct StreamResult {
+    AppProtocol protocol = AppProtocol::UNKNOWN;
+    bool complete = false;          // HTTP: at least one whole message, TLS: every ClientHello extension walked
+    bool malformed = false;         // stopped on bytes that do not fit the protocol
+    uint16_t http_status = 0;       // first response
+    uint32_t messages = 0;          // HTTP messages consumed including their bodies
+    uint64_t body_bytes = 0;
+    StreamText<8> http_method;      // first request
+    StreamText<64> http_uri;        // first request, cut at 64 bytes
+    StreamText<64> http_host;
+    StreamText<64> tls_sni;
+    StreamText<16> tls_alpn;        // first protocol offered
+};
+
+// HTTP/1.x requests or responses back to back: start line, headers (Host, Content-Length, chunked), body skipped
+StreamTask parse_http_stream(StreamReader& in, StreamResult& out);
+// TLS record carrying a ClientHello, however many segments it spans: SNI and ALPN
+StreamTask parse_tls_client_hello(StreamReader& in, StreamResult& out);
+
+// One direction of a TCP connection: picks a parser from the first payload byte and feeds it in sequence order
+// - retransmitted bytes are trimmed; a hole ends the parse, there is no reassembly queue
+// - the parser refers to this object, so a session never moves once fed
+class StreamSession {
+public:
+    StreamResult result;
+    uint64_t segments;
+    uint64_t overlaps;          // segments trimmed as retransmissions
+    bool gap;                   // bytes went missing, the parser was dropped
+
+    StreamSession();
+
+    StreamSession(const StreamSession&) = delete;
+    StreamSession& operator=(const StreamSession&) = delete;
+
+    // seq = TCP sequence number of payload[0]
+    void feed(uint32_t seq, std::span<const uint8_t> payload);
+    // FIN / RST / idle: lets the parser finish on what it has
+    void close();
+
+    bool parsing() const { return task.running(); }
+    uint64_t resumes() const { return reader.resumes; }
+
+private:
+    StreamReader reader;
+    StreamTask task;
+    uint32_t next_seq;
+    bool started;
+};
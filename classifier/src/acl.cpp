@@ -0,0 +1,294 @@
+#include "acl.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+
+#define ACL_DIMENSIONS 5
+#define ACL_LEAF_DIM 0xFF
+#define ACL_BINTH 8
+#define ACL_MAX_DEPTH 48
+#define ACL_BATCH_BLOCK 16
+
+#define DIM_SRC_ADDR 0
+#define DIM_DEST_ADDR 1
+#define DIM_SRC_PORT 2
+#define DIM_DEST_PORT 3
+#define DIM_PROTOCOL 4
+
+/*
+    AclClassifier Class Implementation
+    - Offline compile of prioritized 5-tuple rules into a HyperSplit-style binary decision tree
+    - Each inner node cuts one dimension at the endpoint that best balances the rules on both sides
+    - Rules shadowed by a higher-priority rule covering the whole node region are pruned during the build
+    - Leaves keep at most ACL_BINTH rules (unless no cut can separate them), ordered by priority, so the first match wins
+    - TCP flag conditions are not a tree dimension and are only checked at the leaf
+*/
+
+static inline void prefix_range(uint32_t addr, uint8_t len, uint32_t& lo, uint32_t& hi) {
+    uint32_t mask = len == 0 ? 0 : ~0u << (32 - std::min<uint8_t>(len, 32));
+    lo = addr & mask;
+    hi = lo | ~mask;
+}
+
+static inline void key_fields(const AclKey& key, uint32_t fields[ACL_DIMENSIONS]) {
+    fields[DIM_SRC_ADDR] = key.src_addr;
+    fields[DIM_DEST_ADDR] = key.dest_addr;
+    fields[DIM_SRC_PORT] = key.src_port;
+    fields[DIM_DEST_PORT] = key.dest_port;
+    fields[DIM_PROTOCOL] = key.protocol;
+}
+
+AclClassifier::AclClassifier(const std::vector<AclRule>& input) :
+    rule_count(input.size()), node_count(0), leaf_rule_refs(0), max_depth(0)
+{
+    // Priority order is fixed once here, every leaf list keeps it
+    std::vector<uint32_t> order(input.size());
+    for (uint32_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return input[a].priority > input[b].priority;
+    });
+
+    rules.reserve(input.size());
+    for (uint32_t index : order) {
+        const AclRule& rule = input[index];
+        CompiledRule compiled;
+        prefix_range(rule.src_addr, rule.src_len, compiled.lo[DIM_SRC_ADDR], compiled.hi[DIM_SRC_ADDR]);
+        prefix_range(rule.dest_addr, rule.dest_len, compiled.lo[DIM_DEST_ADDR], compiled.hi[DIM_DEST_ADDR]);
+        compiled.lo[DIM_SRC_PORT] = rule.src_port_lo;
+        compiled.hi[DIM_SRC_PORT] = rule.src_port_hi;
+        compiled.lo[DIM_DEST_PORT] = rule.dest_port_lo;
+        compiled.hi[DIM_DEST_PORT] = rule.dest_port_hi;
+        compiled.lo[DIM_PROTOCOL] = rule.protocol == ACL_ANY_PROTOCOL ? 0 : rule.protocol;
+        compiled.hi[DIM_PROTOCOL] = rule.protocol == ACL_ANY_PROTOCOL ? 255 : rule.protocol;
+        compiled.tcp_flags = rule.tcp_flags & rule.tcp_flags_mask;
+        compiled.tcp_flags_mask = rule.tcp_flags_mask;
+        compiled.id = rule.id;
+        rules.push_back(compiled);
+    }
+
+    std::vector<uint32_t> all(rules.size());
+    for (uint32_t i = 0; i < all.size(); i++) {
+        all[i] = i;
+    }
+
+    uint32_t box_lo[ACL_DIMENSIONS] = {0, 0, 0, 0, 0};
+    uint32_t box_hi[ACL_DIMENSIONS] = {0xFFFFFFFF, 0xFFFFFFFF, 0xFFFF, 0xFFFF, 0xFF};
+    build(all, box_lo, box_hi, 0);
+
+    node_count = nodes.size();
+    leaf_rule_refs = leaf_rules.size();
+}
+
+void AclClassifier::build(std::vector<uint32_t>& node_rules, uint32_t box_lo[5], uint32_t box_hi[5], size_t depth) {
+    max_depth = std::max(max_depth, depth);
+
+    // Everything after a rule that covers the whole region unconditionally can never win
+    for (size_t i = 0; i < node_rules.size(); i++) {
+        const CompiledRule& rule = rules[node_rules[i]];
+        bool covers = rule.tcp_flags_mask == 0;
+        for (int d = 0; d < ACL_DIMENSIONS && covers; d++) {
+            covers = rule.lo[d] <= box_lo[d] && rule.hi[d] >= box_hi[d];
+        }
+        if (covers) {
+            node_rules.resize(i + 1);
+            break;
+        }
+    }
+
+    // Pick the cut minimising the larger side, then the total replication
+    int best_dim = -1;
+    uint32_t best_point = 0;
+    size_t best_max = node_rules.size();
+    size_t best_sum = 0;
+
+    if (node_rules.size() > ACL_BINTH && depth < ACL_MAX_DEPTH) {
+        std::vector<uint32_t> los;
+        std::vector<uint32_t> his;
+        std::vector<uint32_t> points;
+
+        for (int d = 0; d < ACL_DIMENSIONS; d++) {
+            los.clear();
+            his.clear();
+            points.clear();
+
+            for (uint32_t index : node_rules) {
+                uint32_t lo = std::max(rules[index].lo[d], box_lo[d]);
+                uint32_t hi = std::min(rules[index].hi[d], box_hi[d]);
+                los.push_back(lo);
+                his.push_back(hi);
+                if (lo > box_lo[d]) {
+                    points.push_back(lo);
+                }
+                if (hi < box_hi[d]) {
+                    points.push_back(hi + 1);
+                }
+            }
+            if (points.empty()) {
+                continue;
+            }
+
+            std::sort(los.begin(), los.end());
+            std::sort(his.begin(), his.end());
+            std::sort(points.begin(), points.end());
+            points.erase(std::unique(points.begin(), points.end()), points.end());
+
+            for (uint32_t point : points) {
+                // left side holds rules starting below the point, right side rules ending at or above it
+                size_t left = std::lower_bound(los.begin(), los.end(), point) - los.begin();
+                size_t right = his.end() - std::lower_bound(his.begin(), his.end(), point);
+                size_t larger = std::max(left, right);
+                if (larger < best_max || (larger == best_max && best_dim >= 0 && left + right < best_sum)) {
+                    best_dim = d;
+                    best_point = point;
+                    best_max = larger;
+                    best_sum = left + right;
+                }
+            }
+        }
+    }
+
+    uint32_t node_index = static_cast<uint32_t>(nodes.size());
+
+    if (best_dim < 0) {
+        Node leaf;
+        leaf.value = static_cast<uint32_t>(leaf_rules.size());
+        leaf.right = static_cast<uint32_t>(node_rules.size());
+        leaf.dim = ACL_LEAF_DIM;
+        nodes.push_back(leaf);
+        leaf_rules.insert(leaf_rules.end(), node_rules.begin(), node_rules.end());
+        return;
+    }
+
+    Node inner;
+    inner.value = best_point;
+    inner.right = 0;
+    inner.dim = static_cast<uint8_t>(best_dim);
+    nodes.push_back(inner);
+
+    std::vector<uint32_t> left_rules;
+    std::vector<uint32_t> right_rules;
+    for (uint32_t index : node_rules) {
+        if (rules[index].lo[best_dim] < best_point) {
+            left_rules.push_back(index);
+        }
+        if (rules[index].hi[best_dim] >= best_point) {
+            right_rules.push_back(index);
+        }
+    }
+    node_rules.clear();
+    node_rules.shrink_to_fit();
+
+    uint32_t saved = box_hi[best_dim];
+    box_hi[best_dim] = best_point - 1;
+    build(left_rules, box_lo, box_hi, depth + 1);
+    box_hi[best_dim] = saved;
+
+    nodes[node_index].right = static_cast<uint32_t>(nodes.size());
+
+    saved = box_lo[best_dim];
+    box_lo[best_dim] = best_point;
+    build(right_rules, box_lo, box_hi, depth + 1);
+    box_lo[best_dim] = saved;
+}
+
+bool AclClassifier::rule_matches(const CompiledRule& rule, const uint32_t fields[5], uint8_t tcp_flags) const {
+    for (int d = 0; d < ACL_DIMENSIONS; d++) {
+        if (fields[d] < rule.lo[d] || fields[d] > rule.hi[d]) {
+            return false;
+        }
+    }
+    return (tcp_flags & rule.tcp_flags_mask) == rule.tcp_flags;
+}
+
+uint32_t AclClassifier::match_leaf(const Node& leaf, const AclKey& key) const {
+    uint32_t fields[ACL_DIMENSIONS];
+    key_fields(key, fields);
+
+    for (uint32_t i = 0; i < leaf.right; i++) {
+        const CompiledRule& rule = rules[leaf_rules[leaf.value + i]];
+        if (rule_matches(rule, fields, key.tcp_flags)) {
+            return rule.id;
+        }
+    }
+    return ACL_NO_MATCH;
+}
+
+uint32_t AclClassifier::classify(const AclKey& key) const {
+    if (nodes.empty()) {
+        return ACL_NO_MATCH;
+    }
+
+    uint32_t fields[ACL_DIMENSIONS];
+    key_fields(key, fields);
+
+    uint32_t index = 0;
+    while (nodes[index].dim != ACL_LEAF_DIM) {
+        const Node& node = nodes[index];
+        index = fields[node.dim] >= node.value ? node.right : index + 1;
+    }
+    return match_leaf(nodes[index], key);
+}
+
+void AclClassifier::classify_batch(const AclKey* keys, uint32_t* ids, size_t n) const {
+    if (nodes.empty()) {
+        std::fill(ids, ids + n, ACL_NO_MATCH);
+        return;
+    }
+
+    const Node* tree = nodes.data();
+
+    for (size_t base = 0; base < n; base += ACL_BATCH_BLOCK) {
+        size_t count = std::min(static_cast<size_t>(ACL_BATCH_BLOCK), n - base);
+        uint32_t fields[ACL_BATCH_BLOCK][ACL_DIMENSIONS];
+        uint32_t cursor[ACL_BATCH_BLOCK];
+
+        for (size_t i = 0; i < count; i++) {
+            key_fields(keys[base + i], fields[i]);
+            cursor[i] = 0;
+        }
+
+        // One level per round for every key, so the node loads of the block overlap
+        size_t active = count;
+        while (active > 0) {
+            active = 0;
+            for (size_t i = 0; i < count; i++) {
+                const Node& node = tree[cursor[i]];
+                if (node.dim == ACL_LEAF_DIM) {
+                    continue;
+                }
+                cursor[i] = fields[i][node.dim] >= node.value ? node.right : cursor[i] + 1;
+                __builtin_prefetch(&tree[cursor[i]]);
+                active++;
+            }
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            ids[base + i] = match_leaf(tree[cursor[i]], keys[base + i]);
+        }
+    }
+}
+
+bool AclClassifier::make_key(const PacketView& view, AclKey& key) {
+    if (!view.has_ip || view.size() < view.l3_offset + sizeof(IPv4Header)) {
+        return false;
+    }
+
+    key.src_addr = ntohl(view.ip_layer.iph->src_addr);
+    key.dest_addr = ntohl(view.ip_layer.iph->dest_addr);
+    key.protocol = view.ip_layer.iph->protocol;
+    key.src_port = 0;
+    key.dest_port = 0;
+    key.tcp_flags = 0;
+
+    if (view.has_tcp && view.payload_len >= sizeof(TCPHeader)) {
+        key.src_port = ntohs(view.tcp_layer.tcph->src_port);
+        key.dest_port = ntohs(view.tcp_layer.tcph->dest_port);
+        key.tcp_flags = view.tcp_layer.tcph->flags;
+    }
+    else if (view.has_udp && view.payload_len >= sizeof(UDPHeader)) {
+        key.src_port = ntohs(view.udp_layer.udph->src);
+        key.dest_port = ntohs(view.udp_layer.udph->dest);
+    }
+    return true;
+}
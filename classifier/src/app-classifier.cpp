@@ -0,0 +1,407 @@
+#include "app-classifier.hpp"
+#include <iostream>
+#include <algorithm>
+#include <arpa/inet.h>
+
+#define MINIMUM_TCP_HEADER_SIZE 20
+#define UDP_HEADER_SIZE 8
+#define IPV6_FIXED_HEADER_SIZE 40
+
+#define DNS_PORT 53
+#define MDNS_PORT 5353
+#define DNS_HEADER_SIZE 12
+#define DNS_MAX_LABELS 127
+#define DNS_MAX_NAME_LENGTH 255
+#define DNS_MAX_SECTION_COUNT 64
+
+#define HTTP_MAX_LINE_LENGTH 2048
+#define HTTP_MAX_HEADER_LINES 64
+
+#define TLS_CONTENT_HANDSHAKE 0x16
+#define TLS_HANDSHAKE_CLIENT_HELLO 0x01
+#define TLS_RECORD_HEADER_SIZE 5
+#define TLS_HANDSHAKE_HEADER_SIZE 4
+#define TLS_RANDOM_SIZE 32
+#define TLS_EXT_SERVER_NAME 0x0000
+#define TLS_EXT_ALPN 0x0010
+#define TLS_MAX_EXTENSIONS 64
+
+/*
+    AppClassifier Class Implementation
+    - Lightweight L7 classification on top of a parsed PacketView
+    - Identifies DNS, HTTP/1.x and TLS and extracts a handful of fields as string_views into the packet buffer
+    - Every walk is bounded by the captured bytes and a hard iteration limit, and stops once the requested fields are found
+    - Not a dissector: anything that is not needed for labelling is skipped without being decoded
+*/
+
+// Reads a big-endian 16 bit value from a possibly unaligned position
+static inline uint16_t read_be16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+static inline std::string_view make_view(const uint8_t* p, size_t len) {
+    return std::string_view(reinterpret_cast<const char*>(p), len);
+}
+
+static bool iequals_prefix(std::string_view s, std::string_view prefix) {
+    if (s.size() < prefix.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < prefix.size(); i++) {
+        char c = s[i];
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if (c != prefix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+void AppClassifier::classify() {
+    protocol = AppProtocol::UNKNOWN;
+    app_data = nullptr;
+    app_len = 0;
+    http_method = http_uri = http_version = http_host = {};
+    tls_sni = tls_alpn = dns_query = {};
+    dns_id = 0;
+
+    if (!view.payload || (!view.has_ip && !view.has_ipv6)) {
+        return;
+    }
+
+    // view.payload starts at the L4 header, skip it to reach application data
+    size_t l4_header_len = 0;
+    uint16_t src_port = 0;
+    uint16_t dest_port = 0;
+
+    if (view.has_tcp) {
+        if (view.payload_len < MINIMUM_TCP_HEADER_SIZE) {
+            return;
+        }
+        l4_header_len = view.tcp_layer.header_size();
+        if (l4_header_len < MINIMUM_TCP_HEADER_SIZE) {
+            return;
+        }
+        src_port = ntohs(view.tcp_layer.tcph->src_port);
+        dest_port = ntohs(view.tcp_layer.tcph->dest_port);
+    }
+    else if (view.has_udp) {
+        if (view.payload_len < UDP_HEADER_SIZE) {
+            return;
+        }
+        l4_header_len = UDP_HEADER_SIZE;
+        src_port = ntohs(view.udp_layer.udph->src);
+        dest_port = ntohs(view.udp_layer.udph->dest);
+    }
+    else {
+        return;
+    }
+
+    if (l4_header_len > view.payload_len) {
+        return;
+    }
+
+    app_data = view.payload + l4_header_len;
+    app_len = view.payload_len - l4_header_len;
+
+    // Trim Ethernet padding using the IPv4 total length (IPv6: payload length) when it is sane
+    size_t ip_header_len = view.has_ip ? view.ip_layer.header_size() : view.ipv6_layer.header_size();
+    size_t ip_total_len = view.has_ip ? ntohs(view.ip_layer.iph->total_length)
+                                      : IPV6_FIXED_HEADER_SIZE + ntohs(view.ipv6_layer.ip6h->payload_length);
+    if (ip_total_len >= ip_header_len + l4_header_len) {
+        app_len = std::min(app_len, ip_total_len - ip_header_len - l4_header_len);
+    }
+
+    if (app_len == 0) {
+        return;
+    }
+
+    // First byte is enough to pick the single candidate worth trying
+    uint8_t first = app_data[0];
+    if (view.has_tcp && first == TLS_CONTENT_HANDSHAKE) {
+        classify_tls();
+    }
+    else if (view.has_tcp && first >= 'A' && first <= 'Z') {
+        classify_http();
+    }
+    else {
+        classify_dns(src_port, dest_port);
+    }
+}
+
+// DNS: header sanity plus a bounded QNAME walk
+// On the well-known ports the header alone is trusted, elsewhere the full heuristic must pass
+bool AppClassifier::classify_dns(uint16_t src_port, uint16_t dest_port) {
+    bool well_known = src_port == DNS_PORT || dest_port == DNS_PORT ||
+                      src_port == MDNS_PORT || dest_port == MDNS_PORT;
+
+    const uint8_t* p = app_data;
+    size_t len = app_len;
+
+    // DNS over TCP carries a 2 byte length prefix
+    if (view.has_tcp) {
+        if (!well_known || len < 2) {
+            return false;
+        }
+        p += 2;
+        len -= 2;
+    }
+
+    if (len < DNS_HEADER_SIZE) {
+        return false;
+    }
+
+    uint16_t flags = read_be16(p + 2);
+    uint16_t qdcount = read_be16(p + 4);
+
+    if (!well_known) {
+        uint8_t opcode = (flags >> 11) & 0x0F;
+        if (opcode > 5 || (flags & 0x0040) || qdcount != 1) {
+            return false;
+        }
+        if (read_be16(p + 6) > DNS_MAX_SECTION_COUNT ||
+            read_be16(p + 8) > DNS_MAX_SECTION_COUNT ||
+            read_be16(p + 10) > DNS_MAX_SECTION_COUNT) {
+            return false;
+        }
+    }
+
+    if (well_known && !(wanted & APP_FIELD_DNS_QUERY)) {
+        dns_id = read_be16(p);
+        protocol = AppProtocol::DNS;
+        return true;
+    }
+
+    // Walk the first QNAME without decompressing it
+    size_t off = DNS_HEADER_SIZE;
+    bool terminated = false;
+    for (size_t labels = 0; off < len && labels < DNS_MAX_LABELS; labels++) {
+        uint8_t label_len = p[off];
+        if (label_len == 0) {
+            terminated = true;
+            break;
+        }
+        if (label_len > 63) {
+            break;
+        }
+        off += 1 + label_len;
+    }
+
+    size_t name_len = off + 1 - DNS_HEADER_SIZE;
+    bool name_ok = terminated && qdcount > 0 && name_len <= DNS_MAX_NAME_LENGTH;
+
+    if (!well_known) {
+        // QTYPE + QCLASS must follow, QCLASS is IN/CH/HS/ANY (top bit is the mDNS unicast flag)
+        if (!name_ok || off + 5 > len) {
+            return false;
+        }
+        uint16_t qclass = read_be16(p + off + 3) & 0x7FFF;
+        if (qclass != 1 && qclass != 3 && qclass != 4 && qclass != 255) {
+            return false;
+        }
+    }
+
+    dns_id = read_be16(p);
+    if (name_ok) {
+        dns_query = make_view(p + DNS_HEADER_SIZE, name_len);
+    }
+    protocol = AppProtocol::DNS;
+    return true;
+}
+
+// HTTP/1.x: request line (or status line) and optionally the Host header
+bool AppClassifier::classify_http() {
+    static constexpr std::string_view methods[] = {
+        "GET", "POST", "HEAD", "PUT", "DELETE", "OPTIONS", "PATCH", "CONNECT", "TRACE"
+    };
+
+    std::string_view data = make_view(app_data, app_len);
+
+    // Responses are labelled but carry none of the request fields
+    if (data.starts_with("HTTP/1.")) {
+        protocol = AppProtocol::HTTP;
+        return true;
+    }
+
+    std::string_view method;
+    for (std::string_view m : methods) {
+        if (data.size() > m.size() && data.starts_with(m) && data[m.size()] == ' ') {
+            method = data.substr(0, m.size());
+            break;
+        }
+    }
+    if (method.empty()) {
+        return false;
+    }
+
+    // The request line must be complete to count as HTTP
+    std::string_view line = data.substr(0, std::min(data.size(), static_cast<size_t>(HTTP_MAX_LINE_LENGTH)));
+    size_t line_end = line.find("\r\n");
+    if (line_end == std::string_view::npos) {
+        return false;
+    }
+    line = line.substr(0, line_end);
+
+    size_t uri_start = method.size() + 1;
+    size_t uri_end = line.find(' ', uri_start);
+    if (uri_end == std::string_view::npos || uri_end == uri_start) {
+        return false;
+    }
+    std::string_view version = line.substr(uri_end + 1);
+    if (!version.starts_with("HTTP/1.")) {
+        return false;
+    }
+
+    protocol = AppProtocol::HTTP;
+
+    if (wanted & APP_FIELD_HTTP_LINE) {
+        http_method = method;
+        http_uri = line.substr(uri_start, uri_end - uri_start);
+        http_version = version;
+    }
+
+    if (wanted & APP_FIELD_HTTP_HOST) {
+        find_http_host(line_end + 2);
+    }
+
+    return true;
+}
+
+// Scans header lines until Host is found, the header block ends or the line budget runs out
+void AppClassifier::find_http_host(size_t offset) {
+    std::string_view data = make_view(app_data, app_len);
+
+    for (size_t lines = 0; offset < data.size() && lines < HTTP_MAX_HEADER_LINES; lines++) {
+        size_t end = data.find("\r\n", offset);
+        if (end == std::string_view::npos || end == offset) {
+            return;
+        }
+
+        std::string_view header = data.substr(offset, end - offset);
+        if (iequals_prefix(header, "host:")) {
+            http_host = trim(header.substr(5));
+            return;
+        }
+        offset = end + 2;
+    }
+}
+
+// TLS: record + ClientHello walk down to the extensions, stopping once SNI/ALPN are found
+bool AppClassifier::classify_tls() {
+    const uint8_t* p = app_data;
+    size_t len = app_len;
+
+    if (len < TLS_RECORD_HEADER_SIZE + TLS_HANDSHAKE_HEADER_SIZE) {
+        return false;
+    }
+    if (p[0] != TLS_CONTENT_HANDSHAKE || p[1] != 0x03 || p[2] > 0x04) {
+        return false;
+    }
+
+    protocol = AppProtocol::TLS;
+
+    bool want_sni = wanted & APP_FIELD_TLS_SNI;
+    bool want_alpn = wanted & APP_FIELD_TLS_ALPN;
+    if ((!want_sni && !want_alpn) || p[5] != TLS_HANDSHAKE_CLIENT_HELLO) {
+        return true;
+    }
+
+    // Never read past the record, even if more bytes were captured
+    len = std::min(len, static_cast<size_t>(TLS_RECORD_HEADER_SIZE + read_be16(p + 3)));
+
+    // client_version + random
+    size_t off = TLS_RECORD_HEADER_SIZE + TLS_HANDSHAKE_HEADER_SIZE + 2 + TLS_RANDOM_SIZE;
+
+    // session_id
+    if (off + 1 > len) {
+        return true;
+    }
+    off += 1 + p[off];
+
+    // cipher_suites
+    if (off + 2 > len) {
+        return true;
+    }
+    off += 2 + read_be16(p + off);
+
+    // compression_methods
+    if (off + 1 > len) {
+        return true;
+    }
+    off += 1 + p[off];
+
+    // extensions
+    if (off + 2 > len) {
+        return true;
+    }
+    size_t ext_end = std::min(len, off + 2 + read_be16(p + off));
+    off += 2;
+
+    for (size_t n = 0; off + 4 <= ext_end && n < TLS_MAX_EXTENSIONS; n++) {
+        uint16_t type = read_be16(p + off);
+        size_t ext_len = read_be16(p + off + 2);
+        size_t body = off + 4;
+        if (body + ext_len > ext_end) {
+            break;
+        }
+
+        // server_name_list -> first entry, host_name type only
+        if (type == TLS_EXT_SERVER_NAME && want_sni && ext_len >= 5) {
+            size_t name_len = read_be16(p + body + 3);
+            if (p[body + 2] == 0 && 5 + name_len <= ext_len) {
+                tls_sni = make_view(p + body + 5, name_len);
+            }
+        }
+
+        // protocol_name_list -> first entry
+        if (type == TLS_EXT_ALPN && want_alpn && ext_len >= 3) {
+            size_t proto_len = p[body + 2];
+            if (proto_len > 0 && 3 + proto_len <= ext_len) {
+                tls_alpn = make_view(p + body + 3, proto_len);
+            }
+        }
+
+        if ((!want_sni || !tls_sni.empty()) && (!want_alpn || !tls_alpn.empty())) {
+            break;
+        }
+        off = body + ext_len;
+    }
+
+    return true;
+}
+
+void AppClassifier::print() const {
+    std::cout << "=== APPLICATION LAYER ===\n";
+    switch (protocol) {
+        case AppProtocol::DNS:
+            std::cout << "Protocol: DNS\n";
+            std::cout << "Transaction ID: " << dns_id << '\n';
+            std::cout << "Query Name Length: " << dns_query.size() << '\n';
+            break;
+
+        case AppProtocol::HTTP:
+            std::cout << "Protocol: HTTP\n";
+            std::cout << "Request: " << http_method << " " << http_uri << " " << http_version << '\n';
+            std::cout << "Host: " << http_host << '\n';
+            break;
+
+        case AppProtocol::TLS:
+            std::cout << "Protocol: TLS\n";
+            std::cout << "SNI: " << tls_sni << '\n';
+            std::cout << "ALPN: " << tls_alpn << '\n';
+            break;
+
+        default:
+            std::cout << "Protocol: <unknown>\n";
+            break;
+    }
+    std::cout << "=========================\n";
+}
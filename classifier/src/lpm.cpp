@@ -0,0 +1,249 @@
+#include "lpm.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <arpa/inet.h>
+
+#define TBL24_SIZE (1u << 24)
+#define TBL8_GROUP_SIZE 256
+#define ENTRY_VALID 0x40000000u
+#define ENTRY_EXTENDED 0x80000000u
+#define ENTRY_VALUE_MASK 0x3FFFFFFFu
+#define LPM_BATCH_BLOCK 32
+
+/*
+    LpmTable / LpmTableStore Implementation
+    - DIR-24-8 longest-prefix-match for IPv4 site/tenant/ASN tagging
+    - Entry layout (32 bits): [EXTENDED | VALID | 30 bit value]
+        - VALID    -> value is the label of the longest matching prefix
+        - EXTENDED -> value is a tbl8 group index, resolve with the low 8 address bits
+    - Routes are inserted shortest-first, so a longer prefix always overwrites the ranges of its covering prefixes
+    - LpmTableStore hands the compiled table to the data path and swaps it with epoch-based reclamation
+*/
+
+
+// LPM TABLE
+LpmTable::LpmTable(const std::vector<LpmRoute>& routes) :
+    route_count(0), rejected_routes(0), tbl24(TBL24_SIZE, 0)
+{
+    std::vector<LpmRoute> sorted;
+    sorted.reserve(routes.size());
+    for (const LpmRoute& route : routes) {
+        if (route.length > 32 || route.label > ENTRY_VALUE_MASK) {
+            rejected_routes++;
+            continue;
+        }
+        sorted.push_back(route);
+    }
+
+    // Shortest prefixes first, input order kept for duplicates (last one wins)
+    std::stable_sort(sorted.begin(), sorted.end(), [](const LpmRoute& a, const LpmRoute& b) {
+        return a.length < b.length;
+    });
+
+    for (const LpmRoute& route : sorted) {
+        add_route(route);
+        route_count++;
+    }
+}
+
+void LpmTable::add_route(const LpmRoute& route) {
+    uint32_t mask = route.length == 0 ? 0 : ~0u << (32 - route.length);
+    uint32_t prefix = route.prefix & mask;
+    uint32_t entry = ENTRY_VALID | route.label;
+
+    if (route.length <= 24) {
+        // Shorter routes are inserted before any tbl8 group exists, so a plain fill is enough
+        uint32_t first = prefix >> 8;
+        uint32_t count = 1u << (24 - route.length);
+        std::fill(tbl24.begin() + first, tbl24.begin() + first + count, entry);
+        return;
+    }
+
+    uint32_t index24 = prefix >> 8;
+    uint32_t group;
+    if (tbl24[index24] & ENTRY_EXTENDED) {
+        group = tbl24[index24] & ENTRY_VALUE_MASK;
+    }
+    else {
+        // New group inherits the covering /0-/24 result for all 256 slots
+        group = static_cast<uint32_t>(tbl8.size() / TBL8_GROUP_SIZE);
+        tbl8.resize(tbl8.size() + TBL8_GROUP_SIZE, tbl24[index24]);
+        tbl24[index24] = ENTRY_EXTENDED | group;
+    }
+
+    uint32_t first = group * TBL8_GROUP_SIZE + (prefix & 0xFF);
+    uint32_t count = 1u << (32 - route.length);
+    std::fill(tbl8.begin() + first, tbl8.begin() + first + count, entry);
+}
+
+bool LpmTable::lookup(uint32_t addr, uint32_t& label) const {
+    uint32_t entry = tbl24[addr >> 8];
+    if (entry & ENTRY_EXTENDED) {
+        entry = tbl8[(entry & ENTRY_VALUE_MASK) * TBL8_GROUP_SIZE + (addr & 0xFF)];
+    }
+    if (!(entry & ENTRY_VALID)) {
+        return false;
+    }
+    label = entry & ENTRY_VALUE_MASK;
+    return true;
+}
+
+// Three passes per block so that the tbl24 and tbl8 misses of the whole block overlap
+void LpmTable::lookup_batch(const uint32_t* addrs, uint32_t* labels, size_t n) const {
+    const uint32_t* t24 = tbl24.data();
+    const uint32_t* t8 = tbl8.data();
+
+    for (size_t base = 0; base < n; base += LPM_BATCH_BLOCK) {
+        size_t count = std::min(static_cast<size_t>(LPM_BATCH_BLOCK), n - base);
+        uint32_t entries[LPM_BATCH_BLOCK];
+
+        for (size_t i = 0; i < count; i++) {
+            __builtin_prefetch(&t24[addrs[base + i] >> 8]);
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            uint32_t entry = t24[addrs[base + i] >> 8];
+            if (entry & ENTRY_EXTENDED) {
+                __builtin_prefetch(&t8[(entry & ENTRY_VALUE_MASK) * TBL8_GROUP_SIZE + (addrs[base + i] & 0xFF)]);
+            }
+            entries[i] = entry;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            uint32_t entry = entries[i];
+            if (entry & ENTRY_EXTENDED) {
+                entry = t8[(entry & ENTRY_VALUE_MASK) * TBL8_GROUP_SIZE + (addrs[base + i] & 0xFF)];
+            }
+            labels[base + i] = (entry & ENTRY_VALID) ? (entry & ENTRY_VALUE_MASK) : LPM_NO_LABEL;
+        }
+    }
+}
+
+void LpmTable::lookup_packets(const PacketView* const* views, size_t n, uint32_t* src_labels, uint32_t* dest_labels) const {
+    for (size_t base = 0; base < n; base += LPM_BATCH_BLOCK) {
+        size_t count = std::min(static_cast<size_t>(LPM_BATCH_BLOCK), n - base);
+        uint32_t addrs[LPM_BATCH_BLOCK * 2];
+        uint32_t labels[LPM_BATCH_BLOCK * 2];
+        bool has_addr[LPM_BATCH_BLOCK];
+
+        for (size_t i = 0; i < count; i++) {
+            const PacketView* view = views[base + i];
+            has_addr[i] = view->has_ip && view->size() >= view->l3_offset + sizeof(IPv4Header);
+            if (has_addr[i]) {
+                addrs[i * 2] = ntohl(view->ip_layer.iph->src_addr);
+                addrs[i * 2 + 1] = ntohl(view->ip_layer.iph->dest_addr);
+            }
+            else {
+                // 0.0.0.0 stands in for "no address", its result is discarded below
+                addrs[i * 2] = 0;
+                addrs[i * 2 + 1] = 0;
+            }
+        }
+
+        lookup_batch(addrs, labels, count * 2);
+
+        for (size_t i = 0; i < count; i++) {
+            src_labels[base + i] = has_addr[i] ? labels[i * 2] : LPM_NO_LABEL;
+            dest_labels[base + i] = has_addr[i] ? labels[i * 2 + 1] : LPM_NO_LABEL;
+        }
+    }
+}
+
+size_t LpmTable::memory_usage() const {
+    return (tbl24.size() + tbl8.size()) * sizeof(uint32_t);
+}
+
+bool LpmTable::load_routes(const std::string& path, std::vector<LpmRoute>& routes) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.resize(comment);
+        }
+
+        std::istringstream fields(line);
+        std::string cidr;
+        uint32_t label;
+        if (!(fields >> cidr >> label)) {
+            continue;
+        }
+
+        size_t slash = cidr.find('/');
+        std::string addr_text = cidr.substr(0, slash);
+        int length = slash == std::string::npos ? 32 : std::atoi(cidr.c_str() + slash + 1);
+
+        in_addr addr;
+        if (inet_pton(AF_INET, addr_text.c_str(), &addr) != 1 || length < 0 || length > 32) {
+            continue;
+        }
+        routes.push_back(LpmRoute{ntohl(addr.s_addr), static_cast<uint8_t>(length), label});
+    }
+    return true;
+}
+
+
+// LPM TABLE STORE
+LpmTableStore::LpmTableStore() : current(nullptr), global_epoch(1) {
+    for (ReaderSlot& slot : readers) {
+        slot.epoch.store(0, std::memory_order_relaxed);
+        slot.in_use.store(false, std::memory_order_relaxed);
+    }
+}
+
+LpmTableStore::~LpmTableStore() {
+    delete current.load();
+}
+
+int LpmTableStore::register_reader() {
+    for (int i = 0; i < LPM_MAX_READERS; i++) {
+        bool expected = false;
+        if (readers[i].in_use.compare_exchange_strong(expected, true)) {
+            readers[i].epoch.store(0);
+            return i;
+        }
+    }
+    return -1;
+}
+
+void LpmTableStore::unregister_reader(int slot) {
+    readers[slot].epoch.store(0);
+    readers[slot].in_use.store(false);
+}
+
+// Announce the epoch before loading the pointer (both seq_cst) so publish() can never miss this reader
+const LpmTable* LpmTableStore::read_lock(int slot) {
+    readers[slot].epoch.store(global_epoch.load());
+    return current.load();
+}
+
+void LpmTableStore::read_unlock(int slot) {
+    readers[slot].epoch.store(0, std::memory_order_release);
+}
+
+void LpmTableStore::publish(std::unique_ptr<LpmTable> table) {
+    std::lock_guard<std::mutex> guard(publish_lock);
+
+    const LpmTable* old = current.exchange(table.release());
+    uint64_t grace_epoch = global_epoch.fetch_add(1) + 1;
+
+    // Readers that announced an epoch older than grace_epoch may still hold the old table
+    for (ReaderSlot& slot : readers) {
+        while (true) {
+            uint64_t epoch = slot.epoch.load(std::memory_order_acquire);
+            if (epoch == 0 || epoch >= grace_epoch) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    delete old;
+}
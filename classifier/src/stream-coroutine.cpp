@@ -0,0 +1,205 @@
+#include "stream-coroutine.hpp"
+#include <cstring>
+#include <iostream>
+#include <new>
+
+/*
+    Stream Coroutine Runtime Implementation
+    - StreamReader::complete() is the whole state machine the parsers no longer write by hand: it tries to satisfy
+      the pending request from the current segment, and otherwise absorbs the segment (into the carry buffer for
+      BYTES / LINE, by counting for SKIP) so a suspended parser never leaves unread bytes behind
+    - await_ready() runs it first, so a field that is already in the segment costs no suspension at all
+    - feed() resumes the parser at most once; everything the parser awaits afterwards either completes in place
+      or suspends again having consumed the rest of the segment
+    - Frames are recycled through per-size-class free lists and never returned to the heap while the thread runs
+*/
+
+// ---- StreamFramePool ----
+
+StreamFramePool::StreamFramePool() :
+    allocations(0), reused(0), oversized(0), in_use(0), chunk_bytes(0), largest_frame(0),
+    free_lists{}, bump(nullptr), bump_left(0)
+{
+}
+
+StreamFramePool& StreamFramePool::local() {
+    thread_local StreamFramePool pool;
+    return pool;
+}
+
+void* StreamFramePool::allocate(size_t size) {
+    allocations++;
+    in_use++;
+    largest_frame = size > largest_frame ? size : largest_frame;
+
+    size_t blocks = (size + STREAM_FRAME_ALIGN - 1) / STREAM_FRAME_ALIGN;
+    if (blocks == 0 || blocks > STREAM_FRAME_CLASSES) {
+        oversized++;
+        return ::operator new(size);
+    }
+
+    FreeFrame*& head = free_lists[blocks - 1];
+    if (head) {
+        FreeFrame* frame = head;
+        head = frame->next;
+        reused++;
+        return frame;
+    }
+
+    size_t bytes = blocks * STREAM_FRAME_ALIGN;
+    if (bump_left < bytes) {
+        // The tail of the old chunk is abandoned, at most one frame class wide
+        chunks.push_back(std::make_unique<Block[]>(STREAM_FRAME_CHUNK / STREAM_FRAME_ALIGN));
+        bump = chunks.back()[0].bytes;
+        bump_left = STREAM_FRAME_CHUNK;
+        chunk_bytes += STREAM_FRAME_CHUNK;
+    }
+    void* frame = bump;
+    bump += bytes;
+    bump_left -= bytes;
+    return frame;
+}
+
+void StreamFramePool::deallocate(void* frame, size_t size) {
+    in_use--;
+    size_t blocks = (size + STREAM_FRAME_ALIGN - 1) / STREAM_FRAME_ALIGN;
+    if (blocks == 0 || blocks > STREAM_FRAME_CLASSES) {
+        ::operator delete(frame, size);
+        return;
+    }
+    FreeFrame* node = static_cast<FreeFrame*>(frame);
+    node->next = free_lists[blocks - 1];
+    free_lists[blocks - 1] = node;
+}
+
+void StreamFramePool::print() const {
+    std::cout << "=== STREAM FRAME POOL ===\n";
+    std::cout << "Frames: " << allocations << " allocated, " << reused << " reused, " << oversized << " oversized, "
+              << in_use << " live\n";
+    std::cout << "Largest frame: " << largest_frame << " bytes Chunks: " << chunk_bytes / 1024 << " KiB\n";
+}
+
+// ---- StreamReader ----
+
+StreamReader::StreamReader() :
+    bytes_fed(0), resumes(0), closed(false), truncated(false),
+    waiter(nullptr), want(0), kind(StreamWant::NONE), discarding(false), carried(0)
+{
+}
+
+StreamReader::Await StreamReader::request(StreamWant kind, uint64_t n) {
+    this->kind = kind;
+    want = n;
+    return Await{*this};
+}
+
+StreamReader::Await StreamReader::bytes(size_t n) {
+    return request(StreamWant::BYTES, n < STREAM_CARRY_SIZE ? n : STREAM_CARRY_SIZE);
+}
+
+StreamReader::Await StreamReader::line() {
+    return request(StreamWant::LINE, 0);
+}
+
+StreamReader::Await StreamReader::skip(uint64_t n) {
+    return request(StreamWant::SKIP, n);
+}
+
+bool StreamReader::complete() {
+    switch (kind) {
+        case StreamWant::BYTES: {
+            if (carried == 0 && segment.size() >= want) {
+                result = segment.first(want);
+                segment = segment.subspan(want);
+                break;
+            }
+            size_t take = want - carried < segment.size() ? want - carried : segment.size();
+            if (take > 0) {
+                std::memcpy(carry + carried, segment.data(), take);
+            }
+            carried = static_cast<uint16_t>(carried + take);
+            segment = segment.subspan(take);
+            if (carried < want && !closed) {
+                return false;
+            }
+            result = std::span<const uint8_t>(carry, carried);
+            carried = 0;
+            break;
+        }
+
+        case StreamWant::SKIP: {
+            size_t take = want < segment.size() ? want : segment.size();
+            segment = segment.subspan(take);
+            want -= take;
+            if (want > 0 && !closed) {
+                return false;
+            }
+            result = {};
+            break;
+        }
+
+        case StreamWant::LINE: {
+            const uint8_t* lf = segment.empty() ? nullptr
+                                                : static_cast<const uint8_t*>(std::memchr(segment.data(), '\n', segment.size()));
+            size_t length = lf ? static_cast<size_t>(lf - segment.data()) : segment.size();
+            if (carried == 0 && !discarding && lf && length <= STREAM_CARRY_SIZE) {
+                result = segment.first(length);
+                segment = segment.subspan(length + 1);
+            }
+            else {
+                if (!discarding) {
+                    size_t room = STREAM_CARRY_SIZE - carried;
+                    size_t take = length < room ? length : room;
+                    if (take > 0) {
+                        std::memcpy(carry + carried, segment.data(), take);
+                    }
+                    carried = static_cast<uint16_t>(carried + take);
+                    if (take < length) {
+                        discarding = true;
+                        truncated = true;
+                    }
+                }
+                segment = segment.subspan(lf ? length + 1 : length);
+                if (!lf && !closed) {
+                    return false;
+                }
+                result = std::span<const uint8_t>(carry, carried);
+                carried = 0;
+                discarding = false;
+            }
+            if (!result.empty() && result.back() == '\r') {
+                result = result.first(result.size() - 1);
+            }
+            break;
+        }
+
+        default:
+            result = {};
+            break;
+    }
+    kind = StreamWant::NONE;
+    return true;
+}
+
+void StreamReader::feed(std::span<const uint8_t> data) {
+    bytes_fed += data.size();
+    segment = data;
+    if (waiter && complete()) {
+        std::coroutine_handle<> handle = waiter;
+        waiter = nullptr;
+        resumes++;
+        handle.resume();
+    }
+    // Whatever the parser did not ask for is dropped, never referenced after the call
+    segment = {};
+}
+
+void StreamReader::close() {
+    closed = true;
+    if (waiter && complete()) {
+        std::coroutine_handle<> handle = waiter;
+        waiter = nullptr;
+        resumes++;
+        handle.resume();
+    }
+}
@@ -0,0 +1,353 @@
+#include "stream-parsers.hpp"
+
+#define HTTP_MAX_HEADER_LINES 256
+
+#define TLS_CONTENT_HANDSHAKE 0x16
+#define TLS_HANDSHAKE_CLIENT_HELLO 0x01
+#define TLS_RECORD_HEADER_SIZE 5
+#define TLS_HANDSHAKE_HEADER_SIZE 4
+#define TLS_RANDOM_SIZE 32
+#define TLS_EXT_SERVER_NAME 0x0000
+#define TLS_EXT_ALPN 0x0010
+
+/*
+    Stream Parsers Implementation
+    - Same fields and checks as the one-shot AppClassifier, written against StreamReader: every co_await may span
+      any number of segments, and bodies, cipher suites and uninteresting extensions are skipped without buffering
+    - Lengths are read once and checked against the enclosing length before anything is skipped, so a lying length
+      field ends the parse as malformed instead of desynchronising it
+    - An awaited field comes back short only at end of stream; every read checks the size it got
+*/
+
+static inline uint16_t read_be16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+static inline std::string_view make_view(std::span<const uint8_t> bytes) {
+    return std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+static bool iequals_prefix(std::string_view s, std::string_view prefix) {
+    if (s.size() < prefix.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < prefix.size(); i++) {
+        char c = s[i];
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if (c != prefix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// Decimal (base 10) or chunk size (base 16) prefix, false if there is no digit or it overflows
+static bool parse_number(std::string_view s, unsigned base, uint64_t& value) {
+    value = 0;
+    size_t digits = 0;
+    for (char c : s) {
+        unsigned digit;
+        if (c >= '0' && c <= '9') digit = static_cast<unsigned>(c - '0');
+        else if (base == 16 && c >= 'a' && c <= 'f') digit = static_cast<unsigned>(c - 'a' + 10);
+        else if (base == 16 && c >= 'A' && c <= 'F') digit = static_cast<unsigned>(c - 'A' + 10);
+        else break;
+        if (value > (UINT64_MAX - digit) / base) {
+            return false;
+        }
+        value = value * base + digit;
+        digits++;
+    }
+    return digits > 0;
+}
+
+static bool contains_chunked(std::string_view value) {
+    for (size_t i = 0; i + 7 <= value.size(); i++) {
+        if (iequals_prefix(value.substr(i), "chunked")) {
+            return true;
+        }
+    }
+    return false;
+}
+
+StreamTask parse_http_stream(StreamReader& in, StreamResult& out) {
+    static constexpr std::string_view methods[] = {
+        "GET", "POST", "HEAD", "PUT", "DELETE", "OPTIONS", "PATCH", "CONNECT", "TRACE"
+    };
+
+    while (!in.closed) {
+        std::string_view line = make_view(co_await in.line());
+        if (line.empty()) {
+            continue;       // stray CRLF between messages
+        }
+
+        // Start line: a response, or a known method followed by a URI (the version may be past a cut line)
+        bool response = line.starts_with("HTTP/1.");
+        uint16_t status = 0;
+        if (response) {
+            uint64_t code = 0;
+            if (line.size() >= 12 && parse_number(line.substr(9, 3), 10, code)) {
+                status = static_cast<uint16_t>(code);
+            }
+            if (out.http_status == 0) {
+                out.http_status = status;
+            }
+        }
+        else {
+            std::string_view method;
+            for (std::string_view m : methods) {
+                if (line.size() > m.size() && line.starts_with(m) && line[m.size()] == ' ') {
+                    method = line.substr(0, m.size());
+                    break;
+                }
+            }
+            if (method.empty()) {
+                out.malformed = true;
+                if (out.messages == 0) {
+                    out.protocol = AppProtocol::UNKNOWN;
+                }
+                co_return;
+            }
+            if (out.http_method.empty()) {
+                std::string_view uri = line.substr(method.size() + 1);
+                out.http_method.assign(method);
+                out.http_uri.assign(uri.substr(0, uri.find(' ')));
+            }
+        }
+        out.protocol = AppProtocol::HTTP;
+
+        uint64_t content_length = 0;
+        bool has_length = false;
+        bool chunked = false;
+        for (size_t lines = 0;; lines++) {
+            std::string_view header = make_view(co_await in.line());
+            if (header.empty()) {
+                break;
+            }
+            if (lines == HTTP_MAX_HEADER_LINES) {
+                out.malformed = true;
+                co_return;
+            }
+            if (iequals_prefix(header, "host:")) {
+                if (out.http_host.empty()) {
+                    out.http_host.assign(trim(header.substr(5)));
+                }
+            }
+            else if (iequals_prefix(header, "content-length:")) {
+                has_length = parse_number(trim(header.substr(15)), 10, content_length);
+            }
+            else if (iequals_prefix(header, "transfer-encoding:")) {
+                chunked = contains_chunked(header.substr(18));
+            }
+        }
+        if (in.closed) {
+            co_return;
+        }
+
+        if (chunked) {
+            for (;;) {
+                uint64_t size = 0;
+                if (!parse_number(make_view(co_await in.line()), 16, size)) {
+                    out.malformed = !in.closed;
+                    co_return;
+                }
+                if (size > UINT64_MAX - 2) {
+                    out.malformed = true;
+                    co_return;
+                }
+                if (size == 0) {
+                    // Trailer fields up to the blank line
+                    while (!(co_await in.line()).empty()) {
+                    }
+                    break;
+                }
+                co_await in.skip(size + 2);         // data + CRLF
+                out.body_bytes += size;
+                if (in.closed) {
+                    co_return;
+                }
+            }
+        }
+        else if (has_length) {
+            co_await in.skip(content_length);
+            out.body_bytes += content_length;
+        }
+        else if (response && status >= 200 && status != 204 && status != 304) {
+            // Delimited by the end of the connection
+            co_await in.skip(UINT64_MAX);
+            out.messages++;
+            out.complete = true;
+            co_return;
+        }
+        if (in.closed) {
+            co_return;
+        }
+        out.messages++;
+        out.complete = true;
+    }
+}
+
+StreamTask parse_tls_client_hello(StreamReader& in, StreamResult& out) {
+    std::span<const uint8_t> field = co_await in.bytes(TLS_RECORD_HEADER_SIZE);
+    if (field.size() < TLS_RECORD_HEADER_SIZE) {
+        co_return;
+    }
+    if (field[0] != TLS_CONTENT_HANDSHAKE || field[1] != 0x03 || field[2] > 0x04) {
+        out.malformed = true;
+        co_return;
+    }
+    out.protocol = AppProtocol::TLS;
+    uint64_t record = read_be16(field.data() + 3);
+
+    field = co_await in.bytes(TLS_HANDSHAKE_HEADER_SIZE);
+    if (field.size() < TLS_HANDSHAKE_HEADER_SIZE || field[0] != TLS_HANDSHAKE_CLIENT_HELLO) {
+        co_return;      // server side of the handshake: labelled, nothing to extract
+    }
+    // The hello is walked within its first record, like the one-shot classifier
+    uint64_t hello = (static_cast<uint64_t>(field[1]) << 16) | read_be16(field.data() + 2);
+    uint64_t left = record < TLS_HANDSHAKE_HEADER_SIZE ? 0 : record - TLS_HANDSHAKE_HEADER_SIZE;
+    left = hello < left ? hello : left;
+
+    // client_version + random, then the session_id length
+    if (left < 2 + TLS_RANDOM_SIZE + 1) {
+        out.malformed = true;
+        co_return;
+    }
+    co_await in.skip(2 + TLS_RANDOM_SIZE);
+    field = co_await in.bytes(1);
+    if (field.empty()) {
+        co_return;
+    }
+    left -= 2 + TLS_RANDOM_SIZE + 1;
+
+    // session_id, cipher_suites, compression_methods: each vector is skipped and the next length read
+    static constexpr size_t next_prefix[] = {2, 1, 2};
+    uint64_t vector_length = field[0];
+    for (size_t i = 0; i < 3; i++) {
+        if (left < vector_length + next_prefix[i]) {
+            // Only the extensions may be missing entirely
+            out.malformed = i < 2 || left != vector_length;
+            out.complete = !out.malformed;
+            co_return;
+        }
+        co_await in.skip(vector_length);
+        field = co_await in.bytes(next_prefix[i]);
+        if (field.size() < next_prefix[i]) {
+            co_return;
+        }
+        left -= vector_length + next_prefix[i];
+        vector_length = next_prefix[i] == 2 ? read_be16(field.data()) : field[0];
+    }
+
+    // vector_length is now the extensions length
+    uint64_t extensions = vector_length < left ? vector_length : left;
+    while (extensions >= 4) {
+        field = co_await in.bytes(4);
+        if (field.size() < 4) {
+            co_return;
+        }
+        uint16_t type = read_be16(field.data());
+        uint64_t length = read_be16(field.data() + 2);
+        extensions -= 4;
+        if (length > extensions) {
+            out.malformed = true;
+            co_return;
+        }
+        extensions -= length;
+
+        // server_name_list -> first entry, host_name type only
+        if (type == TLS_EXT_SERVER_NAME && length >= 5 && out.tls_sni.empty()) {
+            field = co_await in.bytes(5);
+            if (field.size() < 5) {
+                co_return;
+            }
+            uint64_t name_length = read_be16(field.data() + 3);
+            length -= 5;
+            if (field[2] == 0 && name_length <= length) {
+                field = co_await in.bytes(name_length);
+                out.tls_sni.assign(make_view(field));
+                length -= field.size();
+            }
+        }
+        // protocol_name_list -> first entry
+        else if (type == TLS_EXT_ALPN && length >= 3 && out.tls_alpn.empty()) {
+            field = co_await in.bytes(3);
+            if (field.size() < 3) {
+                co_return;
+            }
+            uint64_t protocol_length = field[2];
+            length -= 3;
+            if (protocol_length > 0 && protocol_length <= length) {
+                field = co_await in.bytes(protocol_length);
+                out.tls_alpn.assign(make_view(field));
+                length -= field.size();
+            }
+        }
+        co_await in.skip(length);
+        if (in.closed) {
+            co_return;
+        }
+    }
+    out.complete = true;
+}
+
+// ---- StreamSession ----
+
+StreamSession::StreamSession() :
+    segments(0), overlaps(0), gap(false), next_seq(0), started(false)
+{
+}
+
+void StreamSession::feed(uint32_t seq, std::span<const uint8_t> payload) {
+    if (payload.empty()) {
+        return;
+    }
+    segments++;
+
+    if (!started) {
+        // First byte is enough to pick the single candidate worth running
+        started = true;
+        next_seq = seq;
+        uint8_t first = payload[0];
+        if (first == TLS_CONTENT_HANDSHAKE) {
+            task = parse_tls_client_hello(reader, result);
+        }
+        else if (first >= 'A' && first <= 'Z') {
+            task = parse_http_stream(reader, result);
+        }
+    }
+    if (!task.running()) {
+        return;
+    }
+
+    int32_t offset = static_cast<int32_t>(seq - next_seq);
+    if (offset > 0) {
+        gap = true;
+        task.reset();
+        return;
+    }
+    if (offset < 0) {
+        overlaps++;
+        size_t overlap = static_cast<size_t>(-static_cast<int64_t>(offset));
+        if (overlap >= payload.size()) {
+            return;
+        }
+        payload = payload.subspan(overlap);
+    }
+    next_seq += static_cast<uint32_t>(payload.size());
+    reader.feed(payload);
+}
+
+void StreamSession::close() {
+    if (task.running()) {
+        reader.close();
+    }
+    task.reset();
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include "packet_view.hpp"
+#include "flow_key.hpp"
+#include "state-arena.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#define TCP_TRACKER_DEFAULT_CAPACITY (1 << 20)
+
+enum class TcpState : uint8_t {
+    FREE,               // empty table slot
+    SYN_SENT,           // half-open: SYN seen, no SYN-ACK yet
+    SYN_RECEIVED,       // half-open: SYN-ACK seen, waiting for the final ACK
+    ESTABLISHED,
+    HALF_CLOSED,        // one side sent FIN
+    CLOSING,            // both sides sent FIN
+    CLOSED,             // both FINs acknowledged
+    RESET,
+    COUNT
+};
+
+// Per-direction sequence tracking (direction 0 = endpoint A, the lower addr:port)
+#define TCP_DIR_SEEN 0x01           // seq_end is valid
+#define TCP_DIR_ACK 0x02            // ack / window are valid
+#define TCP_DIR_FIN 0x04
+#define TCP_DIR_ZERO_WINDOW 0x08    // currently advertising a zero window
+#define TCP_DIR_WSCALE 0x10         // sent the window scale option on its SYN
+
+struct TcpDirection {
+    uint32_t seq_end;       // highest sequence number sent + 1
+    uint32_t ack;           // highest ack sent
+    uint16_t window;        // last advertised (unscaled) window
+    uint8_t wscale;
+    uint8_t flags;          // TCP_DIR_* bits
+};
+
+#define TCP_FLOW_INITIATOR_B 0x01   // the SYN came from endpoint B
+#define TCP_FLOW_MIDSTREAM 0x02     // picked up without seeing the handshake
+#define TCP_FLOW_RTT 0x04           // both handshake RTT halves measured
+#define TCP_FLOW_IPV6 0x08          // addr_a / addr_b are ipv6_fold() values (flow_key.hpp)
+
+// One connection, exactly one cache line; times are microseconds, wrapping at 2^32
+// IPv6 endpoints are stored as 32 bit folds, two flows only share a slot if both folds and both ports collide
+struct alignas(64) TcpFlowSlot {
+    uint32_t addr_a;
+    uint32_t addr_b;
+    uint16_t port_a;
+    uint16_t port_b;
+    TcpState state;
+    uint8_t flags;                  // TCP_FLOW_* bits
+    uint16_t retransmissions;       // saturating
+    TcpDirection dir[2];
+    uint32_t last_seen_us;
+    uint32_t handshake_us;          // time of the latest SYN / SYN-ACK
+    uint32_t synack_rtt_us;         // SYN -> SYN-ACK (tap to responder and back)
+    uint32_t ack_rtt_us;            // SYN-ACK -> ACK (tap to initiator and back)
+    uint16_t zero_windows;          // saturating
+    uint16_t out_of_window;         // saturating
+    uint32_t packets;
+};
+
+static_assert(sizeof(TcpFlowSlot) == 64, "TcpFlowSlot must stay one cache line");
+
+struct TcpTrackerConfig {
+    size_t capacity = TCP_TRACKER_DEFAULT_CAPACITY;     // rounded up to a power of two
+    uint32_t handshake_timeout_s = 30;
+    uint32_t established_timeout_s = 600;
+    uint32_t closed_timeout_s = 10;                     // CLOSED / RESET kept briefly for trailing packets
+};
+
+// Fixed-size open-addressing table of TcpFlowSlot, keyed by the unordered endpoint pair
+// - O(1) per packet: one probe sequence plus a constant number of expiry steps
+// - linear probing with backward-shift deletion, so there are no tombstones
+// - the table can live in a StateArena section, so a restarted process resumes with every connection in place
+class TcpTracker {
+public:
+    uint64_t packets;
+    uint64_t ignored;           // not TCP over IPv4 / IPv6, or header incomplete
+    uint64_t flows_created;
+    uint64_t flows_closed;
+    uint64_t flows_reset;
+    uint64_t flows_expired;
+    uint64_t table_full;
+    uint64_t retransmissions;
+    uint64_t zero_windows;
+    uint64_t out_of_window;
+    uint64_t rtt_samples;
+    uint64_t rtt_total_us;
+    bool restored;              // the table came back from a StateArena snapshot
+
+    TcpTracker(const TcpTrackerConfig& config = TcpTrackerConfig());
+    // Table in the arena section name; a snapshot of another capacity starts empty
+    TcpTracker(StateArena& arena, std::string_view name, const TcpTrackerConfig& config = TcpTrackerConfig());
+
+    bool update(uint64_t timestamp_ns, const PacketView& view);
+
+    const TcpFlowSlot* find(const FlowKey& key) const;
+    size_t active_flows() const { return active; }
+    size_t capacity() const { return mask + 1; }
+    size_t count_state(TcpState state) const;     // full scan, for reporting
+
+    // Full sweep, the per-packet path already expires a few slots at a time
+    void expire(uint64_t timestamp_ns);
+
+    // Copies the counters into the arena section before a StateArena snapshot, no-op without an arena
+    void checkpoint();
+
+    void print() const;
+    static const char* state_name(TcpState state);
+
+private:
+    struct SavedState;
+
+    TcpTrackerConfig config;
+    TcpFlowSlot* slots;
+    std::unique_ptr<TcpFlowSlot[]> owned_slots;
+    SavedState* saved;
+    size_t mask;
+    size_t active;
+    size_t sweep;
+
+    void configure();
+
+    size_t home(uint32_t addr_a, uint32_t addr_b, uint16_t port_a, uint16_t port_b) const;
+    size_t lookup(uint32_t addr_a, uint32_t addr_b, uint16_t port_a, uint16_t port_b, uint8_t family) const;
+    bool expired(const TcpFlowSlot& slot, uint32_t now_us) const;
+    void remove(size_t index);
+    void sweep_step(uint32_t now_us);
+};
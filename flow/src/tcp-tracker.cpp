@@ -0,0 +1,514 @@
+#include "tcp-tracker.hpp"
+#include "flow_hash.hpp"
+#include <arpa/inet.h>
+#include <cstring>
+#include <iostream>
+
+#define TCP_MIN_HEADER_SIZE 20
+#define TCP_OPTION_END 0
+#define TCP_OPTION_NOP 1
+#define TCP_OPTION_WSCALE 3
+#define TCP_MAX_WSCALE 14
+#define TCP_TRACKER_EXPIRY_STEPS 2
+#define TCP_TRACKER_MAX_TIMEOUT_S 4000     // idle times are 32 bit microseconds
+#define TCP_TRACKER_STATE_VERSION 1
+#define TCP_TRACKER_SAVED_COUNTERS 12
+
+/*
+    TcpTracker Class Implementation
+    - Follows each connection through SYN / SYN-ACK / ACK, data, FIN and RST teardown in one 64 byte slot
+    - Handshake RTT is split at the tap: SYN -> SYN-ACK is the responder side, SYN-ACK -> ACK the initiator side
+    - Retransmissions: data starting below the sender's highest sequence (keepalives excluded) and repeated SYN / SYN-ACK
+    - Out-of-window: data past the receiver's advertised right edge, ACKs for data never sent, RSTs outside the window
+    - Zero windows are counted when a side starts advertising window 0, not for every segment while it stays closed
+    - Every packet also advances an expiry cursor by a couple of slots, so idle flows age out without a sweep pause
+    - In a StateArena the section is a SavedState header followed by the slot array; slots hold no pointers,
+      so the table is used in place after a restore and only the counters are copied, by checkpoint()
+*/
+
+// Arena section header, one cache line so the slots behind it stay aligned
+struct alignas(64) TcpTracker::SavedState {
+    uint32_t version;
+    uint32_t slot_size;
+    uint64_t capacity;
+    uint64_t active;
+    uint64_t sweep;
+    uint64_t counters[TCP_TRACKER_SAVED_COUNTERS];
+};
+
+// Counters kept across a restart, in SavedState::counters order
+static uint64_t TcpTracker::* const SAVED_COUNTERS[TCP_TRACKER_SAVED_COUNTERS] = {
+    &TcpTracker::packets, &TcpTracker::ignored, &TcpTracker::flows_created, &TcpTracker::flows_closed,
+    &TcpTracker::flows_reset, &TcpTracker::flows_expired, &TcpTracker::table_full, &TcpTracker::retransmissions,
+    &TcpTracker::zero_windows, &TcpTracker::out_of_window, &TcpTracker::rtt_samples, &TcpTracker::rtt_total_us
+};
+
+// Sequence space comparisons (RFC 1982 style, wrap-safe)
+static bool seq_before(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+static bool seq_after(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) > 0;
+}
+
+static void saturating_increment(uint16_t& counter) {
+    if (counter != UINT16_MAX) {
+        counter++;
+    }
+}
+
+// Window scale option of a SYN, -1 if absent
+static int parse_wscale(const uint8_t* options, size_t length) {
+    size_t i = 0;
+    while (i < length) {
+        uint8_t kind = options[i];
+        if (kind == TCP_OPTION_END) {
+            break;
+        }
+        if (kind == TCP_OPTION_NOP) {
+            i++;
+            continue;
+        }
+        if (i + 1 >= length || options[i + 1] < 2 || i + options[i + 1] > length) {
+            break;
+        }
+        if (kind == TCP_OPTION_WSCALE && options[i + 1] == 3) {
+            return options[i + 2] > TCP_MAX_WSCALE ? TCP_MAX_WSCALE : options[i + 2];
+        }
+        i += options[i + 1];
+    }
+    return -1;
+}
+
+TcpTracker::TcpTracker(const TcpTrackerConfig& config) :
+    packets(0), ignored(0), flows_created(0), flows_closed(0), flows_reset(0), flows_expired(0),
+    table_full(0), retransmissions(0), zero_windows(0), out_of_window(0), rtt_samples(0), rtt_total_us(0),
+    restored(false), config(config), slots(nullptr), saved(nullptr), mask(0), active(0), sweep(0)
+{
+    configure();
+    owned_slots = std::make_unique<TcpFlowSlot[]>(mask + 1);
+    slots = owned_slots.get();
+    std::memset(slots, 0, (mask + 1) * sizeof(TcpFlowSlot));
+}
+
+TcpTracker::TcpTracker(StateArena& arena, std::string_view name, const TcpTrackerConfig& config) :
+    packets(0), ignored(0), flows_created(0), flows_closed(0), flows_reset(0), flows_expired(0),
+    table_full(0), retransmissions(0), zero_windows(0), out_of_window(0), rtt_samples(0), rtt_total_us(0),
+    restored(false), config(config), slots(nullptr), saved(nullptr), mask(0), active(0), sweep(0)
+{
+    configure();
+    size_t capacity = mask + 1;
+    bool found = false;
+    saved = static_cast<SavedState*>(arena.section(name, sizeof(SavedState) + capacity * sizeof(TcpFlowSlot), &found));
+    if (!saved) {
+        owned_slots = std::make_unique<TcpFlowSlot[]>(capacity);
+        slots = owned_slots.get();
+        std::memset(slots, 0, capacity * sizeof(TcpFlowSlot));
+        return;
+    }
+    slots = reinterpret_cast<TcpFlowSlot*>(saved + 1);
+
+    restored = found && saved->version == TCP_TRACKER_STATE_VERSION && saved->slot_size == sizeof(TcpFlowSlot) &&
+               saved->capacity == capacity;
+    if (!restored) {
+        // A new section is already zero, only a stale one of the same size needs clearing
+        if (found) {
+            std::memset(static_cast<void*>(saved), 0, sizeof(SavedState) + capacity * sizeof(TcpFlowSlot));
+        }
+        return;
+    }
+    for (size_t i = 0; i < TCP_TRACKER_SAVED_COUNTERS; i++) {
+        this->*SAVED_COUNTERS[i] = saved->counters[i];
+    }
+    active = saved->active;
+    sweep = saved->sweep & mask;
+}
+
+void TcpTracker::configure() {
+    size_t capacity = 16;
+    while (capacity < config.capacity) {
+        capacity <<= 1;
+    }
+    mask = capacity - 1;
+
+    uint32_t* timeouts[] = {&config.handshake_timeout_s, &config.established_timeout_s, &config.closed_timeout_s};
+    for (uint32_t* timeout : timeouts) {
+        *timeout = *timeout > TCP_TRACKER_MAX_TIMEOUT_S ? TCP_TRACKER_MAX_TIMEOUT_S : *timeout;
+    }
+}
+
+void TcpTracker::checkpoint() {
+    if (!saved) {
+        return;
+    }
+    for (size_t i = 0; i < TCP_TRACKER_SAVED_COUNTERS; i++) {
+        saved->counters[i] = this->*SAVED_COUNTERS[i];
+    }
+    saved->version = TCP_TRACKER_STATE_VERSION;
+    saved->slot_size = sizeof(TcpFlowSlot);
+    saved->capacity = mask + 1;
+    saved->active = active;
+    saved->sweep = sweep;
+}
+
+size_t TcpTracker::home(uint32_t addr_a, uint32_t addr_b, uint16_t port_a, uint16_t port_b) const {
+    FlowKey key{addr_a, addr_b, port_a, port_b, IPPROTO_TCP};
+    return static_cast<size_t>(flow_hash(key)) & mask;
+}
+
+// Slot holding the connection, or the free slot ending its probe run
+size_t TcpTracker::lookup(uint32_t addr_a, uint32_t addr_b, uint16_t port_a, uint16_t port_b, uint8_t family) const {
+    size_t index = home(addr_a, addr_b, port_a, port_b);
+    while (slots[index].state != TcpState::FREE) {
+        const TcpFlowSlot& candidate = slots[index];
+        if (candidate.addr_a == addr_a && candidate.addr_b == addr_b && candidate.port_a == port_a &&
+            candidate.port_b == port_b && (candidate.flags & TCP_FLOW_IPV6) == family) {
+            break;
+        }
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+bool TcpTracker::expired(const TcpFlowSlot& slot, uint32_t now_us) const {
+    uint32_t timeout_s;
+    switch (slot.state) {
+        case TcpState::SYN_SENT:
+        case TcpState::SYN_RECEIVED:
+            timeout_s = config.handshake_timeout_s;
+            break;
+        case TcpState::CLOSED:
+        case TcpState::RESET:
+            timeout_s = config.closed_timeout_s;
+            break;
+        default:
+            timeout_s = config.established_timeout_s;
+            break;
+    }
+    return now_us - slot.last_seen_us > timeout_s * 1000000u;
+}
+
+// Backward-shift deletion: pull later members of the probe run into the hole
+void TcpTracker::remove(size_t index) {
+    size_t hole = index;
+    size_t next = index;
+    for (;;) {
+        next = (next + 1) & mask;
+        TcpFlowSlot& candidate = slots[next];
+        if (candidate.state == TcpState::FREE) {
+            break;
+        }
+        size_t ideal = home(candidate.addr_a, candidate.addr_b, candidate.port_a, candidate.port_b);
+        // Movable unless its home lies cyclically in (hole, next]
+        bool stays = hole <= next ? (ideal > hole && ideal <= next) : (ideal > hole || ideal <= next);
+        if (!stays) {
+            slots[hole] = candidate;
+            hole = next;
+        }
+    }
+    slots[hole].state = TcpState::FREE;
+    active--;
+}
+
+void TcpTracker::sweep_step(uint32_t now_us) {
+    for (size_t step = 0; step < TCP_TRACKER_EXPIRY_STEPS; step++) {
+        if (slots[sweep].state != TcpState::FREE && expired(slots[sweep], now_us)) {
+            // The shift may refill this index, look at it again next step
+            remove(sweep);
+            flows_expired++;
+        }
+        else {
+            sweep = (sweep + 1) & mask;
+        }
+    }
+}
+
+bool TcpTracker::update(uint64_t timestamp_ns, const PacketView& view) {
+    FlowKey key;
+    if (!view.has_tcp || view.payload_len < TCP_MIN_HEADER_SIZE || !make_flow_key(view, key)) {
+        ignored++;
+        return false;
+    }
+    const TCPHeader* tcp = view.tcp_layer.tcph;
+    size_t header_len = view.tcp_layer.header_size();
+    if (header_len < TCP_MIN_HEADER_SIZE || header_len > view.payload_len) {
+        ignored++;
+        return false;
+    }
+
+    // Segment length from the IP length fields, so snaplen-truncated captures still count correctly
+    size_t ip_header_len;
+    size_t ip_length;
+    if (key.ipv6) {
+        ip_header_len = view.ipv6_layer.header_size();
+        ip_length = sizeof(IPv6Header) + ntohs(view.ipv6_layer.ip6h->payload_length);
+    }
+    else {
+        ip_header_len = (view.ip_layer.iph->version_ihl & 0x0F) * 4;
+        ip_length = ntohs(view.ip_layer.iph->total_length);
+    }
+    uint32_t seg_len = ip_length >= ip_header_len + header_len
+        ? static_cast<uint32_t>(ip_length - ip_header_len - header_len)
+        : static_cast<uint32_t>(view.payload_len - header_len);
+
+    uint8_t tcp_flags = tcp->flags;
+    uint32_t seq = ntohl(tcp->seq_num);
+    uint32_t ack = ntohl(tcp->ack_num);
+    uint16_t window = ntohs(tcp->window);
+    uint32_t src_addr = key.src_addr;
+    uint32_t dest_addr = key.dest_addr;
+    uint16_t src_port = key.src_port;
+    uint16_t dest_port = key.dest_port;
+    uint8_t family = key.ipv6 ? TCP_FLOW_IPV6 : 0;
+
+    // Endpoint A is the lower addr:port, both directions land in the same slot
+    bool from_a = src_addr < dest_addr || (src_addr == dest_addr && src_port <= dest_port);
+    uint32_t addr_a = from_a ? src_addr : dest_addr;
+    uint32_t addr_b = from_a ? dest_addr : src_addr;
+    uint16_t port_a = from_a ? src_port : dest_port;
+    uint16_t port_b = from_a ? dest_port : src_port;
+    int d = from_a ? 0 : 1;
+
+    uint32_t now_us = static_cast<uint32_t>(timestamp_ns / 1000);
+    packets++;
+    sweep_step(now_us);
+
+    size_t index = lookup(addr_a, addr_b, port_a, port_b, family);
+
+    TcpFlowSlot& slot = slots[index];
+    bool syn = tcp_flags & SYN_FLAG;
+    bool is_ack = tcp_flags & ACK_FLAG;
+
+    // A new SYN on a finished connection starts a fresh one in the same slot
+    bool reuse = slot.state != TcpState::FREE && syn && !is_ack &&
+                 (slot.state == TcpState::CLOSED || slot.state == TcpState::RESET);
+
+    if (slot.state == TcpState::FREE || reuse) {
+        if (tcp_flags & RST_FLAG) {
+            ignored++;
+            return false;
+        }
+        // Keep the load factor at 7/8 so probe runs stay short
+        if (!reuse && active >= capacity() - capacity() / 8) {
+            table_full++;
+            return false;
+        }
+
+        std::memset(&slot, 0, sizeof(slot));
+        slot.addr_a = addr_a;
+        slot.addr_b = addr_b;
+        slot.port_a = port_a;
+        slot.port_b = port_b;
+        if (syn && !is_ack) {
+            slot.state = TcpState::SYN_SENT;
+            slot.flags = d ? TCP_FLOW_INITIATOR_B : 0;
+        }
+        else if (syn) {
+            // SYN was missed, the sender of the SYN-ACK is the responder
+            slot.state = TcpState::SYN_RECEIVED;
+            slot.flags = TCP_FLOW_MIDSTREAM | (d ? 0 : TCP_FLOW_INITIATOR_B);
+        }
+        else {
+            slot.state = TcpState::ESTABLISHED;
+            slot.flags = TCP_FLOW_MIDSTREAM | (d ? TCP_FLOW_INITIATOR_B : 0);
+        }
+        slot.flags |= family;
+        if (!reuse) {
+            active++;
+        }
+        flows_created++;
+    }
+
+    TcpDirection& self = slot.dir[d];
+    TcpDirection& peer = slot.dir[1 - d];
+    int initiator = (slot.flags & TCP_FLOW_INITIATOR_B) ? 1 : 0;
+    uint32_t seq_len = seg_len + (syn ? 1 : 0) + ((tcp_flags & FIN_FLAG) ? 1 : 0);
+    uint32_t end = seq + seq_len;
+
+    // Receiver's right window edge; scaling is only known when the handshake was seen
+    bool scaled = (self.flags & TCP_DIR_WSCALE) && (peer.flags & TCP_DIR_WSCALE);
+    bool window_known = (peer.flags & TCP_DIR_ACK) && !(slot.flags & TCP_FLOW_MIDSTREAM);
+    uint32_t right_edge = peer.ack + (static_cast<uint32_t>(peer.window) << (scaled ? peer.wscale : 0));
+
+    slot.packets++;
+    slot.last_seen_us = now_us;
+
+    if (tcp_flags & RST_FLAG) {
+        // RFC 5961: a RST outside the receive window is not acted on
+        if (window_known && (seq_before(seq, peer.ack) || seq_after(seq, right_edge))) {
+            out_of_window++;
+            saturating_increment(slot.out_of_window);
+            return true;
+        }
+        if (slot.state != TcpState::RESET && slot.state != TcpState::CLOSED) {
+            slot.state = TcpState::RESET;
+            flows_reset++;
+        }
+        return true;
+    }
+
+    if (syn) {
+        bool repeated = (self.flags & TCP_DIR_SEEN) && end == self.seq_end;
+        if (repeated) {
+            retransmissions++;
+            saturating_increment(slot.retransmissions);
+        }
+        else if (!is_ack) {
+            slot.handshake_us = now_us;
+        }
+        else if (slot.state == TcpState::SYN_SENT && d != initiator && ack == peer.seq_end) {
+            slot.state = TcpState::SYN_RECEIVED;
+            slot.synack_rtt_us = now_us - slot.handshake_us;
+            slot.handshake_us = now_us;
+        }
+
+        int wscale = parse_wscale(reinterpret_cast<const uint8_t*>(tcp) + TCP_MIN_HEADER_SIZE,
+                                  header_len - TCP_MIN_HEADER_SIZE);
+        if (wscale >= 0) {
+            self.wscale = static_cast<uint8_t>(wscale);
+            self.flags |= TCP_DIR_WSCALE;
+        }
+        self.seq_end = end;
+        self.flags |= TCP_DIR_SEEN;
+    }
+    else {
+        if (self.flags & TCP_DIR_SEEN) {
+            bool keepalive = seg_len <= 1 && !(tcp_flags & FIN_FLAG) && seq == self.seq_end - 1;
+            if (seq_len > 0 && seq_before(seq, self.seq_end) && !keepalive) {
+                retransmissions++;
+                saturating_increment(slot.retransmissions);
+            }
+        }
+
+        // Zero-window probes (1 byte into a closed window) are expected, not anomalies
+        bool probe = peer.window == 0 && seg_len <= 1;
+        bool beyond_window = window_known && seq_len > 0 && !probe && seq_after(end, right_edge);
+        bool acks_unsent = is_ack && (peer.flags & TCP_DIR_SEEN) && seq_after(ack, peer.seq_end);
+        if (beyond_window || acks_unsent) {
+            // The receiver drops such segments, so they do not move the tracked state either
+            out_of_window++;
+            saturating_increment(slot.out_of_window);
+            return true;
+        }
+
+        if (slot.state == TcpState::SYN_RECEIVED && is_ack && d == initiator && ack == peer.seq_end) {
+            slot.state = TcpState::ESTABLISHED;
+            if (!(slot.flags & TCP_FLOW_MIDSTREAM)) {
+                slot.ack_rtt_us = now_us - slot.handshake_us;
+                slot.flags |= TCP_FLOW_RTT;
+                rtt_samples++;
+                rtt_total_us += static_cast<uint64_t>(slot.synack_rtt_us) + slot.ack_rtt_us;
+            }
+        }
+
+        if (tcp_flags & FIN_FLAG) {
+            self.flags |= TCP_DIR_FIN;
+            if (slot.state == TcpState::ESTABLISHED || slot.state == TcpState::SYN_RECEIVED ||
+                slot.state == TcpState::HALF_CLOSED) {
+                slot.state = (peer.flags & TCP_DIR_FIN) ? TcpState::CLOSING : TcpState::HALF_CLOSED;
+            }
+        }
+        else if (slot.state == TcpState::CLOSING && is_ack && ack == peer.seq_end &&
+                 (peer.flags & TCP_DIR_ACK) && peer.ack == self.seq_end) {
+            // Last ACK: both FINs are now acknowledged
+            slot.state = TcpState::CLOSED;
+            flows_closed++;
+        }
+
+        if (!(self.flags & TCP_DIR_SEEN) || seq_after(end, self.seq_end)) {
+            self.seq_end = end;
+        }
+        self.flags |= TCP_DIR_SEEN;
+    }
+
+    if (is_ack) {
+        if (!(self.flags & TCP_DIR_ACK) || seq_after(ack, self.ack)) {
+            self.ack = ack;
+        }
+        self.window = window;
+        self.flags |= TCP_DIR_ACK;
+
+        if (window == 0 && !syn) {
+            if (!(self.flags & TCP_DIR_ZERO_WINDOW)) {
+                self.flags |= TCP_DIR_ZERO_WINDOW;
+                zero_windows++;
+                saturating_increment(slot.zero_windows);
+            }
+        }
+        else {
+            self.flags &= ~TCP_DIR_ZERO_WINDOW;
+        }
+    }
+    return true;
+}
+
+const TcpFlowSlot* TcpTracker::find(const FlowKey& key) const {
+    bool from_a = key.src_addr < key.dest_addr || (key.src_addr == key.dest_addr && key.src_port <= key.dest_port);
+    uint32_t addr_a = from_a ? key.src_addr : key.dest_addr;
+    uint32_t addr_b = from_a ? key.dest_addr : key.src_addr;
+    uint16_t port_a = from_a ? key.src_port : key.dest_port;
+    uint16_t port_b = from_a ? key.dest_port : key.src_port;
+
+    size_t index = lookup(addr_a, addr_b, port_a, port_b, key.ipv6 ? TCP_FLOW_IPV6 : 0);
+    return slots[index].state != TcpState::FREE ? &slots[index] : nullptr;
+}
+
+size_t TcpTracker::count_state(TcpState state) const {
+    size_t count = 0;
+    for (size_t i = 0; i <= mask; i++) {
+        count += slots[i].state == state;
+    }
+    return count;
+}
+
+void TcpTracker::expire(uint64_t timestamp_ns) {
+    uint32_t now_us = static_cast<uint32_t>(timestamp_ns / 1000);
+    size_t index = 0;
+    size_t visited = 0;
+    // Removal can shift a later slot into the current index, so only advance when nothing was removed
+    while (visited <= mask) {
+        if (slots[index].state != TcpState::FREE && expired(slots[index], now_us)) {
+            remove(index);
+            flows_expired++;
+        }
+        else {
+            index = (index + 1) & mask;
+            visited++;
+        }
+    }
+}
+
+const char* TcpTracker::state_name(TcpState state) {
+    switch (state) {
+        case TcpState::FREE: return "FREE";
+        case TcpState::SYN_SENT: return "SYN_SENT";
+        case TcpState::SYN_RECEIVED: return "SYN_RECEIVED";
+        case TcpState::ESTABLISHED: return "ESTABLISHED";
+        case TcpState::HALF_CLOSED: return "HALF_CLOSED";
+        case TcpState::CLOSING: return "CLOSING";
+        case TcpState::CLOSED: return "CLOSED";
+        case TcpState::RESET: return "RESET";
+        default: return "UNKNOWN";
+    }
+}
+
+void TcpTracker::print() const {
+    std::cout << "=== TCP CONNECTIONS ===\n";
+    std::cout << "Packets: " << packets << " Ignored: " << ignored << " Active flows: " << active
+              << " / " << capacity() << '\n';
+    std::cout << "Created: " << flows_created << " Closed: " << flows_closed << " Reset: " << flows_reset
+              << " Expired: " << flows_expired << " Table full: " << table_full << '\n';
+    for (size_t state = 1; state < static_cast<size_t>(TcpState::COUNT); state++) {
+        std::cout << "  " << state_name(static_cast<TcpState>(state)) << ": "
+                  << count_state(static_cast<TcpState>(state)) << '\n';
+    }
+    std::cout << "Retransmissions: " << retransmissions << " Zero windows: " << zero_windows
+              << " Out of window: " << out_of_window << '\n';
+    std::cout << "Handshake RTT samples: " << rtt_samples;
+    if (rtt_samples) {
+        std::cout << " avg " << rtt_total_us / rtt_samples << " us";
+    }
+    std::cout << '\n';
+    std::cout << "=======================\n";
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Fast LZ77 block compression (LZ4 block format, no frame header)
+// Used for column chunks and recorder blocks where speed matters more than ratio
+
+// Worst-case compressed size for n input bytes
+size_t block_compress_bound(size_t n);
+
+// Returns the compressed size, or 0 if the result would not fit in dst_capacity
+size_t block_compress(const uint8_t* src, size_t n, uint8_t* dst, size_t dst_capacity);
+
+// Returns the decompressed size, or SIZE_MAX on malformed input / insufficient capacity
+size_t block_decompress(const uint8_t* src, size_t n, uint8_t* dst, size_t dst_capacity);
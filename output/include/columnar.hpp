@@ -0,0 +1,145 @@
+#pragma once
+#include "packet_view.hpp"
+#include "validation.hpp"
+#include "output-buffer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define COLUMNAR_MAGIC "DPKC"
+#define COLUMNAR_VERSION 1
+#define COLUMNAR_DEFAULT_ROW_GROUP 65536
+
+// Columns of the packet metadata file (one uint64 value per row)
+enum class Column : uint8_t {
+    TIMESTAMP,          // ns, caller supplied
+    SRC_MAC,            // 48 bit
+    DEST_MAC,
+    ETHERTYPE,
+    SRC_IP,             // host byte order
+    DEST_IP,
+    PROTOCOL,
+    SRC_PORT,
+    DEST_PORT,
+    TCP_FLAGS,
+    LENGTH,             // frame length
+    PAYLOAD_LENGTH,
+    LAYERS,             // METADATA_LAYER_* bits (packet-metadata.hpp)
+    ERROR_MASK,         // PacketValidator::error_mask()
+    SRC_IP6_HI,         // IPv6 address as two big endian halves, 0 for IPv4 (SRC_IP / DEST_IP are 0 for IPv6)
+    SRC_IP6_LO,
+    DEST_IP6_HI,
+    DEST_IP6_LO,
+    COUNT
+};
+
+#define COLUMN_COUNT static_cast<size_t>(Column::COUNT)
+#define COLUMN_BIT(column) (1u << static_cast<uint32_t>(column))
+#define ALL_COLUMNS ((1u << COLUMN_COUNT) - 1)
+
+// Per-chunk encodings
+enum class ColumnEncoding : uint8_t {
+    BITPACK,        // frame of reference (min) + fixed bit width
+    DELTA,          // first value + zigzag varint deltas
+    DICTIONARY      // distinct values + bit-packed indices
+};
+
+enum class ColumnCompression : uint8_t {
+    NONE,
+    BLOCK           // block-codec.hpp, only kept when it actually shrinks the chunk
+};
+
+struct ColumnarOptions {
+    size_t row_group_size = COLUMNAR_DEFAULT_ROW_GROUP;
+    bool compress = true;
+};
+
+// Decoded columns of one row group, unprojected columns stay empty
+struct ColumnBatch {
+    size_t rows;
+    std::vector<uint64_t> columns[COLUMN_COUNT];
+};
+
+// Where a column chunk lives in the file and how it is stored
+struct ColumnChunkInfo {
+    uint64_t offset;
+    uint32_t stored_size;
+    uint32_t raw_size;
+    ColumnEncoding encoding;
+    ColumnCompression compression;
+};
+
+struct RowGroupInfo {
+    uint32_t rows;
+    ColumnChunkInfo chunks[COLUMN_COUNT];
+};
+
+/*
+    File layout (little endian)
+    - header: magic[4], u16 version, u16 column count, u64 reserved
+    - row groups: column chunks back to back
+    - footer: u32 group count, per group { u32 rows, per column { u64 offset, u32 stored, u32 raw, u8 encoding, u8 compression } },
+              u64 footer offset, magic[4]
+*/
+
+// Buffers rows into column vectors and writes one encoded row group at a time
+class ColumnarWriter {
+public:
+    bool ok;
+    uint64_t rows_written;
+
+    ColumnarWriter(const std::string& path, const ColumnarOptions& options = ColumnarOptions());
+    ~ColumnarWriter();
+
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    // validator may be null, the error mask is then 0
+    void append(uint64_t timestamp_ns, const PacketView& view, const PacketValidator* validator);
+
+    // Writes the pending row group and the footer, returns false on any I/O error
+    bool close();
+
+    uint64_t bytes_written() const;
+
+private:
+    ColumnarOptions options;
+    int fd;
+    std::unique_ptr<OutputBuffer> out;
+    bool closed;
+    std::vector<uint64_t> columns[COLUMN_COUNT];
+    std::vector<RowGroupInfo> groups;
+
+    // Reused between chunks
+    std::vector<uint8_t> encoded;
+    std::vector<uint8_t> compressed;
+    std::vector<uint64_t> dictionary;
+    std::unordered_map<uint64_t, uint32_t> dictionary_index;
+
+    void flush_row_group();
+    void encode_column(const std::vector<uint64_t>& values, bool prefer_delta, ColumnEncoding& encoding);
+};
+
+// Reads row groups back, decoding only the projected columns
+class ColumnarReader {
+public:
+    bool ok;
+    uint64_t row_count;
+    std::vector<RowGroupInfo> groups;
+
+    ColumnarReader(const std::string& path);
+    ~ColumnarReader();
+
+    ColumnarReader(const ColumnarReader&) = delete;
+    ColumnarReader& operator=(const ColumnarReader&) = delete;
+
+    bool read_row_group(size_t group, uint32_t column_mask, ColumnBatch& batch);
+
+private:
+    int fd;
+    std::vector<uint8_t> stored;
+    std::vector<uint8_t> raw;
+};
@@ -0,0 +1,152 @@
+#pragma once
+#include "packet_view.hpp"
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#define METRICS_SNAPSHOT_MAGIC 0x4E535044      // "DPSN"
+#define METRICS_SNAPSHOT_VERSION 1
+#define METRICS_MAX_SHARDS 64
+#define METRICS_ERROR_SLOTS 32                  // one per PacketValidator::error_mask() bit
+#define METRICS_LATENCY_BUCKETS 160             // 4 per power of two, up to 2^40 ns
+
+// Packet / byte counters are kept per transport
+enum class MetricsProtocol : uint8_t {
+    TCP,
+    UDP,
+    OTHER_IP,       // IPv4 / IPv6 without TCP or UDP (ICMP, GRE outer, fragments ...)
+    NON_IP,
+    COUNT
+};
+
+enum class MetricsDrop : uint8_t {
+    RING_OVERRUN,   // lapped by the producer of a DROP-policy ring
+    SHED,           // sampled out by the load shedder
+    DUPLICATE,      // suppressed by the deduplicator
+    RECORDER,       // recorder queue full
+    COUNT
+};
+
+// Timed pipeline stages, the same split as ShedStage
+enum class MetricsStage : uint8_t {
+    PARSE,
+    VALIDATE,
+    HEADERS,
+    PAYLOAD,
+    COUNT
+};
+
+#define METRICS_PROTOCOLS static_cast<size_t>(MetricsProtocol::COUNT)
+#define METRICS_DROPS static_cast<size_t>(MetricsDrop::COUNT)
+#define METRICS_STAGES static_cast<size_t>(MetricsStage::COUNT)
+
+// Log-linear latency bucket: exact below 4 ns, then 4 sub-buckets per power of two (<= 25% wide)
+inline size_t metrics_latency_bucket(uint64_t ns) {
+    if (ns < 4) {
+        return static_cast<size_t>(ns);
+    }
+    unsigned exponent = static_cast<unsigned>(std::bit_width(ns)) - 1;
+    size_t index = (exponent - 1) * 4 + ((ns >> (exponent - 2)) & 3);
+    return index < METRICS_LATENCY_BUCKETS ? index : METRICS_LATENCY_BUCKETS - 1;
+}
+
+// Counters of one worker thread
+// - only the owning thread writes, with relaxed load + store (no locked instruction), the exporter reads
+//   with relaxed loads: no worker ever waits for a scrape
+// - one shard per thread keeps the cache lines it writes private to that thread's core
+class alignas(64) MetricsShard {
+public:
+    std::atomic<uint64_t> packets[METRICS_PROTOCOLS];
+    std::atomic<uint64_t> bytes[METRICS_PROTOCOLS];
+    std::atomic<uint64_t> validation_errors[METRICS_ERROR_SLOTS];
+    std::atomic<uint64_t> drops[METRICS_DROPS];
+    std::atomic<uint64_t> ring_backlog;
+    std::atomic<uint64_t> ring_capacity;
+    std::atomic<uint64_t> latency_count[METRICS_STAGES];
+    std::atomic<uint64_t> latency_sum_ns[METRICS_STAGES];
+    std::atomic<uint64_t> latency_buckets[METRICS_STAGES][METRICS_LATENCY_BUCKETS];
+
+    void count_packet(const PacketView& view) {
+        MetricsProtocol protocol = view.has_tcp ? MetricsProtocol::TCP
+                                 : view.has_udp ? MetricsProtocol::UDP
+                                 : (view.has_ip || view.has_ipv6) ? MetricsProtocol::OTHER_IP
+                                 : MetricsProtocol::NON_IP;
+        add(packets[static_cast<size_t>(protocol)], 1);
+        add(bytes[static_cast<size_t>(protocol)], view.size());
+    }
+
+    // PacketValidator::error_mask()
+    void count_errors(uint32_t mask) {
+        while (mask) {
+            add(validation_errors[std::countr_zero(mask)], 1);
+            mask &= mask - 1;
+        }
+    }
+
+    void count_drops(MetricsDrop reason, uint64_t n) { add(drops[static_cast<size_t>(reason)], n); }
+
+    void record_latency(MetricsStage stage, uint64_t ns) {
+        size_t s = static_cast<size_t>(stage);
+        add(latency_count[s], 1);
+        add(latency_sum_ns[s], ns);
+        add(latency_buckets[s][metrics_latency_bucket(ns)], 1);
+    }
+
+    void set_ring(size_t backlog, size_t capacity) {
+        ring_backlog.store(backlog, std::memory_order_relaxed);
+        ring_capacity.store(capacity, std::memory_order_relaxed);
+    }
+
+private:
+    static void add(std::atomic<uint64_t>& counter, uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
+
+// Plain copy of every shard summed up (gauges per shard), also the binary snapshot served over HTTP
+struct MetricsSnapshot {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t taken_ns;          // CLOCK_REALTIME
+    uint32_t shards;
+    uint32_t reserved;
+    uint64_t packets[METRICS_PROTOCOLS];
+    uint64_t bytes[METRICS_PROTOCOLS];
+    uint64_t validation_errors[METRICS_ERROR_SLOTS];
+    uint64_t drops[METRICS_DROPS];
+    uint64_t ring_backlog[METRICS_MAX_SHARDS];
+    uint64_t ring_capacity[METRICS_MAX_SHARDS];
+    uint64_t latency_count[METRICS_STAGES];
+    uint64_t latency_sum_ns[METRICS_STAGES];
+    uint64_t latency_buckets[METRICS_STAGES][METRICS_LATENCY_BUCKETS];
+};
+
+// Fixed set of shards handed out at startup; snapshot() may run on any thread at any time
+class MetricsRegistry {
+public:
+    MetricsRegistry(size_t max_shards = METRICS_MAX_SHARDS);
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // One per worker thread, null once max_shards are taken
+    MetricsShard* add_shard();
+    size_t shard_count() const { return count.load(std::memory_order_acquire); }
+
+    // No allocation: fills a caller-owned snapshot
+    void snapshot(MetricsSnapshot& out) const;
+
+private:
+    std::unique_ptr<MetricsShard[]> shards;
+    size_t capacity;
+    std::atomic<size_t> count;
+};
+
+// Upper bound of the bucket holding quantile q (0..1), 0 without samples
+uint64_t metrics_latency_quantile(const MetricsSnapshot& snapshot, MetricsStage stage, double q);
+
+// Prometheus text exposition format (0.0.4) into a caller-owned buffer
+// Returns the length written, 0 if it did not fit
+size_t render_prometheus(const MetricsSnapshot& snapshot, char* out, size_t capacity);
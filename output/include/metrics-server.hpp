@@ -0,0 +1,46 @@
+#pragma once
+#include "live-metrics.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#define METRICS_DEFAULT_PORT 9464
+#define METRICS_REQUEST_SIZE 2048
+#define METRICS_RESPONSE_SIZE (64 * 1024)
+
+// Minimal HTTP/1.0 endpoint on 127.0.0.1, served from its own thread
+// - GET /metrics   -> Prometheus text exposition
+// - GET /snapshot  -> the MetricsSnapshot struct as is (application/octet-stream, host byte order)
+// - one connection at a time, closed after the response; the snapshot and both buffers are allocated up front
+class MetricsServer {
+public:
+    bool ok;
+    std::atomic<uint64_t> scrapes;
+    std::atomic<uint64_t> snapshots;
+    std::atomic<uint64_t> bad_requests;
+
+    // port 0 picks a free one, see port()
+    MetricsServer(const MetricsRegistry& registry, uint16_t port = METRICS_DEFAULT_PORT);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    uint16_t port() const { return bound_port; }
+    void stop();
+
+private:
+    const MetricsRegistry& registry;
+    int listen_fd;
+    uint16_t bound_port;
+    std::atomic<bool> stopping;
+    std::thread thread;
+    std::unique_ptr<MetricsSnapshot> snapshot;
+    std::unique_ptr<char[]> body;
+    char request[METRICS_REQUEST_SIZE];
+
+    void run();
+    void serve(int fd);
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unistd.h>
+
+#define OUTPUT_BUFFER_DEFAULT_CAPACITY (1 << 20)
+
+// Large reusable write buffer in front of a file descriptor
+// - appends never allocate, the buffer is flushed with one write() when it fills up
+// - numbers go through std::to_chars, header fields through the field_format lookup tables
+class OutputBuffer {
+public:
+    uint64_t bytes_written;
+    uint64_t write_calls;
+    bool failed;
+
+    OutputBuffer(int fd = STDOUT_FILENO, size_t capacity = OUTPUT_BUFFER_DEFAULT_CAPACITY);
+    ~OutputBuffer();
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void append(std::string_view text);
+    void append(char c);
+    void append_uint(uint64_t value);
+    void append_hex(uint64_t value, int width);
+    void append_mac(const uint8_t* mac);
+    void append_ipv4(uint32_t addr);     // network byte order
+    void append_ipv6(const uint8_t* addr);
+
+    size_t pending() const { return used; }
+    bool flush();
+
+private:
+    int fd;
+    size_t capacity;
+    size_t used;
+    std::unique_ptr<char[]> buffer;
+
+    // Guarantees n contiguous free bytes (n <= capacity), flushing first if needed
+    char* reserve(size_t n);
+};
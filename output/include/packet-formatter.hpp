@@ -0,0 +1,39 @@
+#pragma once
+#include "output-buffer.hpp"
+#include "packet_view.hpp"
+#include "validation.hpp"
+#include <string_view>
+
+// Supported dissection output formats
+enum class OutputFormat {
+    TEXT,       // one human-readable summary line per packet
+    JSON,       // JSON lines, absent layers are omitted
+    CSV         // fixed columns, absent fields left empty
+};
+
+struct PacketFields;
+
+// Writes one record per packet into an OutputBuffer without allocating
+class PacketFormatter {
+public:
+    OutputBuffer& out;
+    OutputFormat format;
+
+    PacketFormatter(OutputBuffer& out, OutputFormat format) : out(out), format(format) {}
+
+    // CSV column row, no-op for the other formats
+    void write_header();
+
+    // validator may be null when validation was not run
+    void write_packet(const PacketView& view, const PacketValidator* validator = nullptr);
+
+    // "text", "json" or "csv"
+    static bool parse_format(std::string_view name, OutputFormat& format);
+
+private:
+    void write_text(const PacketView& view, const PacketValidator* validator);
+    void write_json(const PacketView& view, const PacketValidator* validator);
+    void write_csv(const PacketView& view, const PacketValidator* validator);
+    void write_errors(const PacketValidator* validator, char separator, bool quoted);
+    void write_address(const PacketFields& fields, bool source, bool bracketed);
+};
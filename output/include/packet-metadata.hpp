@@ -0,0 +1,38 @@
+#pragma once
+#include "packet_view.hpp"
+#include "validation.hpp"
+#include <cstdint>
+
+#define METADATA_LAYER_ETH 0x01
+#define METADATA_LAYER_IP 0x02
+#define METADATA_LAYER_TCP 0x04
+#define METADATA_LAYER_UDP 0x08
+#define METADATA_LAYER_IPV6 0x10
+
+// Fixed-layout summary of one parsed packet, shared by the exporters
+// - plain data, no pointers, so it can be written to files and shared memory as is
+// - IPv4 addresses and ports in host byte order, MACs and IPv6 addresses in wire order
+// - IPv6 packets set METADATA_LAYER_IPV6 and the 16 byte addresses, src_ip / dest_ip stay 0
+struct PacketMetadata {
+    uint64_t timestamp_ns;
+    uint32_t src_ip;
+    uint32_t dest_ip;
+    uint32_t length;
+    uint32_t payload_len;
+    uint32_t error_mask;        // PacketValidator::error_mask()
+    uint16_t ethertype;
+    uint16_t src_port;
+    uint16_t dest_port;
+    uint8_t protocol;
+    uint8_t tcp_flags;
+    uint8_t layers;             // METADATA_LAYER_* bits
+    uint8_t src_mac[6];
+    uint8_t dest_mac[6];
+    uint8_t src_ip6[16];
+    uint8_t dest_ip6[16];
+};
+
+// Fields are only read when the parser saw enough bytes for them, missing ones stay 0
+// validator may be null, the error mask is then 0
+void make_packet_metadata(uint64_t timestamp_ns, const PacketView& view, const PacketValidator* validator,
+                          PacketMetadata& metadata);
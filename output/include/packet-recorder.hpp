@@ -0,0 +1,218 @@
+#pragma once
+#include "flow_key.hpp"
+#include "output-buffer.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define RECORDER_MAGIC "DPRS"
+#define RECORDER_VERSION 1
+#define RECORDER_DEFAULT_BUDGET (16ULL << 30)
+#define RECORDER_DEFAULT_SEGMENT_SIZE (256ULL << 20)
+#define RECORDER_DEFAULT_BLOCK_SIZE (256 << 10)
+#define RECORDER_DEFAULT_QUEUE_SIZE (64 << 20)
+#define RECORDER_DEFAULT_SNAPLEN 65535
+#define RECORDER_DEFAULT_FLUSH_NS 1000000000ULL
+
+struct RecorderConfig {
+    uint64_t disk_budget = RECORDER_DEFAULT_BUDGET;         // all segments together, the oldest are deleted first
+    uint64_t segment_size = RECORDER_DEFAULT_SEGMENT_SIZE;  // a segment is closed once its file reaches this
+    uint32_t block_size = RECORDER_DEFAULT_BLOCK_SIZE;      // raw record bytes compressed as one block
+    size_t queue_size = RECORDER_DEFAULT_QUEUE_SIZE;        // bytes between record() and the writer, power of two
+    uint32_t snaplen = RECORDER_DEFAULT_SNAPLEN;
+    uint64_t flush_ns = RECORDER_DEFAULT_FLUSH_NS;          // a partly filled block is written after this long
+};
+
+/*
+    Segment file layout (host byte order)
+    - header: RecorderSegmentHeader
+    - blocks: RecorderBlockHeader + stored bytes; raw content is records back to back,
+              each RecorderRecordHeader + captured bytes
+    - footer: RecorderBlockIndex per block, then RecorderFlowEntry sorted by (flow, block)
+    - trailer: RecorderSegmentTrailer
+    A segment still being written (or cut short by a crash) has no trailer: readers walk the block headers instead
+*/
+
+struct RecorderSegmentHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t sequence;
+};
+
+struct RecorderBlockHeader {
+    uint32_t stored_size;
+    uint32_t raw_size;
+    uint32_t records;
+    uint32_t compressed;        // 0 = stored raw, compression did not shrink it
+    uint64_t min_ns;
+    uint64_t max_ns;
+};
+
+struct RecorderRecordHeader {
+    uint64_t timestamp_ns;
+    uint32_t original_length;
+    uint32_t length;            // captured bytes that follow
+};
+
+struct RecorderBlockIndex {
+    uint64_t offset;            // of the block header
+    RecorderBlockHeader header;
+};
+
+// Blocks holding at least one packet of a flow; flow = high half of the symmetric flow_hash()
+struct RecorderFlowEntry {
+    uint32_t flow;
+    uint32_t block;
+};
+
+struct RecorderSegmentTrailer {
+    uint64_t footer_offset;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t records;
+    uint32_t block_count;
+    uint32_t flow_count;
+    uint32_t version;
+    char magic[4];
+};
+
+static_assert(sizeof(RecorderBlockHeader) == 32, "RecorderBlockHeader layout is part of the file format");
+static_assert(sizeof(RecorderSegmentTrailer) == 48, "RecorderSegmentTrailer layout is part of the file format");
+
+// Continuous recording into rolling segment files under one directory
+// - record() only copies the frame into a lock-free single-producer queue; a writer thread batches the
+//   records into blocks, compresses them and indexes them by time and flow, so the caller never waits on disk
+// - a full queue drops the frame (counted), it never blocks
+// - segments left by an earlier run are kept and count against the budget
+class PacketRecorder {
+public:
+    bool ok;
+
+    // Capture thread
+    uint64_t recorded;
+    uint64_t dropped;           // queue full
+    uint64_t truncated;         // frames cut to snaplen
+
+    // Writer thread, safe to read while recording
+    std::atomic<uint64_t> blocks_written;
+    std::atomic<uint64_t> raw_bytes;            // record bytes before compression
+    std::atomic<uint64_t> stored_bytes;         // segment bytes on disk, headers and indexes included
+    std::atomic<uint64_t> segments_closed;
+    std::atomic<uint64_t> segments_deleted;
+    std::atomic<uint64_t> write_errors;
+
+    PacketRecorder(const std::string& directory, const RecorderConfig& config = RecorderConfig());
+    ~PacketRecorder();
+
+    PacketRecorder(const PacketRecorder&) = delete;
+    PacketRecorder& operator=(const PacketRecorder&) = delete;
+
+    // Capture thread only; original_length 0 means frame.size()
+    bool record(uint64_t timestamp_ns, std::span<const uint8_t> frame, uint32_t original_length = 0);
+
+    // Drains the queue, writes the last block and closes the open segment; false if any write failed
+    bool close();
+
+    size_t queue_used() const;
+    size_t queue_capacity() const { return queue_mask + 1; }
+    uint64_t disk_used() const { return disk_bytes.load(std::memory_order_relaxed); }
+    void print() const;
+
+private:
+    struct Segment {
+        uint64_t sequence;
+        uint64_t bytes;
+    };
+
+    RecorderConfig config;
+    std::string directory;
+
+    // Queue: byte ring of 8 byte aligned entries, positions count bytes and never wrap
+    std::unique_ptr<uint64_t[]> queue;
+    size_t queue_mask;
+    alignas(64) std::atomic<uint64_t> queue_head;     // producer
+    uint64_t cached_tail;
+    alignas(64) std::atomic<uint64_t> queue_tail;     // writer
+    std::atomic<bool> stopping;
+    std::thread writer;
+    bool closed;
+
+    // Writer state
+    std::vector<Segment> segments;          // closed segments, oldest first
+    std::atomic<uint64_t> disk_bytes;
+    uint64_t next_sequence;
+    int fd;
+    std::unique_ptr<OutputBuffer> out;
+    uint64_t segment_offset;
+    RecorderSegmentTrailer trailer;
+    std::vector<RecorderBlockIndex> blocks;
+    std::vector<RecorderFlowEntry> flows;
+    std::vector<uint8_t> block;
+    std::vector<uint8_t> compressed;
+    std::vector<uint32_t> block_flows;
+    RecorderBlockHeader block_header;
+    uint64_t block_started_ns;
+
+    void run();
+    size_t drain();
+    void append(const RecorderRecordHeader& header, const uint8_t* data, uint32_t flow);
+    bool open_segment();
+    void write_block();
+    void close_segment();
+    void enforce_budget(uint64_t incoming);
+    std::string segment_path(uint64_t sequence) const;
+};
+
+struct RecordedPacket {
+    uint64_t timestamp_ns;
+    uint32_t original_length;
+    std::span<const uint8_t> data;      // captured bytes
+};
+
+// Packets of a time range (and optionally one flow, either direction) read back from a recorder directory
+// - segments and blocks outside the range, or without the flow in their index, are skipped undecompressed
+// - packets come in recording order; data is valid until the next call
+class RecordingReader {
+public:
+    bool ok;
+    bool corrupt;               // a block did not decode, the rest of its segment was skipped
+    uint64_t segments_read;
+    uint64_t blocks_decoded;
+    uint64_t blocks_skipped;
+    uint64_t records;
+
+    // [from_ns, to_ns)
+    RecordingReader(const std::string& directory, uint64_t from_ns, uint64_t to_ns, const FlowKey* flow = nullptr);
+    ~RecordingReader();
+
+    RecordingReader(const RecordingReader&) = delete;
+    RecordingReader& operator=(const RecordingReader&) = delete;
+
+    bool next(RecordedPacket& packet);
+
+private:
+    std::string directory;
+    std::vector<uint64_t> sequences;
+    size_t segment_index;
+    uint64_t from_ns;
+    uint64_t to_ns;
+    bool filter_flow;
+    FlowKey flow;
+    uint32_t flow_tag;
+
+    int fd;
+    std::vector<RecorderBlockIndex> blocks;     // candidates of the open segment
+    size_t block_index;
+    std::vector<uint8_t> stored;
+    std::vector<uint8_t> raw;
+    size_t raw_length;
+    size_t position;
+
+    bool open_segment();
+    bool load_block();
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include "packet-metadata.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#define SHM_RING_MAGIC 0x44504B52       // "DPKR"
+#define SHM_RING_VERSION 1
+#define SHM_RING_MAX_CONSUMERS 16
+#define SHM_RING_DEFAULT_SLOTS 4096
+#define SHM_RING_DEFAULT_FRAME 2048
+
+// What the producer does when the slowest consumer is a full ring behind
+enum class ShmOverflowPolicy : uint32_t {
+    DROP,           // overwrite, lapped consumers skip ahead and count the loss
+    BLOCK           // wait for the slowest live consumer
+};
+
+struct ShmRingConfig {
+    uint32_t slot_count = SHM_RING_DEFAULT_SLOTS;   // rounded up to a power of two
+    uint32_t max_frame = SHM_RING_DEFAULT_FRAME;    // raw frame bytes kept per slot, 0 = metadata only
+    ShmOverflowPolicy policy = ShmOverflowPolicy::DROP;
+};
+
+// ---- Shared memory layout (identical in every attached process) ----
+
+struct alignas(64) ShmConsumerState {
+    std::atomic<int32_t> owner;         // pid of the attached consumer, 0 while the slot is free
+    std::atomic<uint64_t> cursor;       // next sequence this consumer will read
+    std::atomic<uint64_t> dropped;
+};
+
+struct alignas(64) ShmRingHeader {
+    std::atomic<uint32_t> magic;        // written last by the producer
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    uint32_t max_frame;
+    ShmOverflowPolicy policy;
+    int32_t producer_pid;
+
+    alignas(64) std::atomic<uint64_t> write_sequence;    // next sequence to publish
+    ShmConsumerState consumers[SHM_RING_MAX_CONSUMERS];
+};
+
+// Slot for sequence s: state = 2s+1 while being written, 2s+2 once published
+struct alignas(64) ShmSlot {
+    std::atomic<uint64_t> state;
+    uint32_t frame_length;      // captured bytes in frame[]
+    uint32_t reserved;
+    PacketMetadata metadata;
+    // uint8_t frame[max_frame] follows
+};
+
+// Record handed to a consumer, pointing straight into the shared ring
+struct ShmRecord {
+    uint64_t sequence;
+    const PacketMetadata* metadata;
+    std::span<const uint8_t> frame;
+};
+
+// Creates the ring (replacing a stale one of the same name) and publishes into it
+class ShmRingProducer {
+public:
+    bool ok;
+    uint64_t published;
+    uint64_t blocked_waits;     // publishes that had to wait for a consumer (BLOCK)
+
+    ShmRingProducer(const std::string& name, const ShmRingConfig& config = ShmRingConfig());
+    ~ShmRingProducer();        // unlinks the ring name, attached consumers keep their mapping
+
+    ShmRingProducer(const ShmRingProducer&) = delete;
+    ShmRingProducer& operator=(const ShmRingProducer&) = delete;
+
+    bool publish(uint64_t timestamp_ns, const PacketView& view, const PacketValidator* validator);
+
+private:
+    std::string name;
+    ShmRingHeader* header;
+    uint8_t* slots;
+    size_t mapped_size;
+    uint64_t mask;
+    uint64_t min_cursor;        // cached slowest consumer cursor (BLOCK)
+
+    uint64_t slowest_cursor();
+    void wait_for_space(uint64_t sequence);
+};
+
+// Attaches to an existing ring with its own cursor, starting at the current write position
+class ShmRingConsumer {
+public:
+    bool ok;
+    uint64_t received;
+    uint64_t dropped;
+
+    ShmRingConsumer(const std::string& name);
+    ~ShmRingConsumer();        // releases the consumer slot
+
+    ShmRingConsumer(const ShmRingConsumer&) = delete;
+    ShmRingConsumer& operator=(const ShmRingConsumer&) = delete;
+
+    // Next record in place, false if nothing new has been published
+    bool next(ShmRecord& record);
+
+    // Finishes the record from next() and advances the cursor
+    // False means the producer overwrote the slot meanwhile (DROP policy): discard what was read
+    bool release();
+
+    bool producer_alive() const;
+
+    // Records published but not yet consumed, capped at capacity() (anything older was overwritten)
+    uint64_t backlog() const;
+    size_t capacity() const { return mask + 1; }
+
+private:
+    ShmRingHeader* header;
+    uint8_t* slots;
+    size_t mapped_size;
+    uint64_t mask;
+    int index;
+    uint64_t cursor;
+    bool reading;
+};
@@ -0,0 +1,180 @@
+#include "block-codec.hpp"
+#include <cstring>
+
+#define HASH_LOG 12
+#define HASH_SIZE (1 << HASH_LOG)
+#define MIN_MATCH 4
+#define LAST_LITERALS 5
+#define MATCH_SAFE_DISTANCE 12
+#define MAX_OFFSET 65535
+
+/*
+    Block Codec Implementation
+    - Greedy LZ77 with a 4K-entry hash of 4-byte sequences, emitted in the LZ4 block format:
+        token [lit_len:4 | match_len-4:4], extra literal length bytes, literals, 16 bit LE offset, extra match length bytes
+    - The last LAST_LITERALS bytes are always literals and no match starts within MATCH_SAFE_DISTANCE of the end
+    - The decoder checks every length and offset against both buffers before copying
+*/
+
+static inline uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint32_t hash_sequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_LOG);
+}
+
+// Writes the 255-run encoding of a length remainder
+static inline uint8_t* write_length(uint8_t* out, size_t length) {
+    while (length >= 255) {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = static_cast<uint8_t>(length);
+    return out;
+}
+
+size_t block_compress_bound(size_t n) {
+    return n + n / 255 + 16;
+}
+
+size_t block_compress(const uint8_t* src, size_t n, uint8_t* dst, size_t dst_capacity) {
+    if (dst_capacity < block_compress_bound(n)) {
+        return 0;
+    }
+
+    uint32_t table[HASH_SIZE];
+    std::memset(table, 0, sizeof(table));
+
+    const uint8_t* ip = src;
+    const uint8_t* anchor = src;
+    const uint8_t* end = src + n;
+    uint8_t* op = dst;
+
+    if (n > MATCH_SAFE_DISTANCE) {
+        const uint8_t* match_limit = end - MATCH_SAFE_DISTANCE;
+        const uint8_t* copy_limit = end - LAST_LITERALS;
+        ip++;
+
+        while (ip < match_limit) {
+            uint32_t sequence = read32(ip);
+            uint32_t h = hash_sequence(sequence);
+            const uint8_t* candidate = src + table[h];
+            table[h] = static_cast<uint32_t>(ip - src);
+
+            if (candidate >= ip || ip - candidate > MAX_OFFSET || read32(candidate) != sequence) {
+                ip++;
+                continue;
+            }
+
+            // Extend the match forwards, never into the trailing literals
+            size_t match_len = MIN_MATCH;
+            while (ip + match_len < copy_limit && candidate[match_len] == ip[match_len]) {
+                match_len++;
+            }
+
+            size_t literal_len = static_cast<size_t>(ip - anchor);
+            uint8_t* token = op++;
+            *token = static_cast<uint8_t>((literal_len >= 15 ? 15 : literal_len) << 4);
+            if (literal_len >= 15) {
+                op = write_length(op, literal_len - 15);
+            }
+            std::memcpy(op, anchor, literal_len);
+            op += literal_len;
+
+            uint16_t offset = static_cast<uint16_t>(ip - candidate);
+            *op++ = static_cast<uint8_t>(offset & 0xFF);
+            *op++ = static_cast<uint8_t>(offset >> 8);
+
+            size_t extra = match_len - MIN_MATCH;
+            *token |= static_cast<uint8_t>(extra >= 15 ? 15 : extra);
+            if (extra >= 15) {
+                op = write_length(op, extra - 15);
+            }
+
+            ip += match_len;
+            anchor = ip;
+        }
+    }
+
+    // Final literal run
+    size_t literal_len = static_cast<size_t>(end - anchor);
+    uint8_t* token = op++;
+    *token = static_cast<uint8_t>((literal_len >= 15 ? 15 : literal_len) << 4);
+    if (literal_len >= 15) {
+        op = write_length(op, literal_len - 15);
+    }
+    std::memcpy(op, anchor, literal_len);
+    op += literal_len;
+
+    return static_cast<size_t>(op - dst);
+}
+
+size_t block_decompress(const uint8_t* src, size_t n, uint8_t* dst, size_t dst_capacity) {
+    const uint8_t* ip = src;
+    const uint8_t* end = src + n;
+    uint8_t* op = dst;
+    uint8_t* out_end = dst + dst_capacity;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+
+        size_t literal_len = token >> 4;
+        if (literal_len == 15) {
+            uint8_t byte;
+            do {
+                if (ip >= end) {
+                    return SIZE_MAX;
+                }
+                byte = *ip++;
+                literal_len += byte;
+            } while (byte == 255);
+        }
+        if (literal_len > static_cast<size_t>(end - ip) || literal_len > static_cast<size_t>(out_end - op)) {
+            return SIZE_MAX;
+        }
+        std::memcpy(op, ip, literal_len);
+        ip += literal_len;
+        op += literal_len;
+
+        // The last sequence has literals only
+        if (ip == end) {
+            break;
+        }
+
+        if (end - ip < 2) {
+            return SIZE_MAX;
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst)) {
+            return SIZE_MAX;
+        }
+
+        size_t match_len = (token & 0x0F) + MIN_MATCH;
+        if ((token & 0x0F) == 15) {
+            uint8_t byte;
+            do {
+                if (ip >= end) {
+                    return SIZE_MAX;
+                }
+                byte = *ip++;
+                match_len += byte;
+            } while (byte == 255);
+        }
+        if (match_len > static_cast<size_t>(out_end - op)) {
+            return SIZE_MAX;
+        }
+
+        // Byte copy: matches may overlap their own output
+        const uint8_t* match = op - offset;
+        for (size_t i = 0; i < match_len; i++) {
+            op[i] = match[i];
+        }
+        op += match_len;
+    }
+
+    return static_cast<size_t>(op - dst);
+}
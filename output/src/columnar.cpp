@@ -0,0 +1,568 @@
+#include "columnar.hpp"
+#include "block-codec.hpp"
+#include "packet-metadata.hpp"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define COLUMNAR_HEADER_SIZE 16
+#define COLUMNAR_TRAILER_SIZE 12
+#define COLUMNAR_CHUNK_ENTRY_SIZE 18
+#define COLUMNAR_MIN_COMPRESS_SIZE 64
+#define COLUMNAR_MAX_DICTIONARY 4096
+
+/*
+    ColumnarWriter / ColumnarReader Implementation
+    - Rows are buffered per column as uint64 values and encoded one row group at a time
+    - Timestamps are delta + zigzag varint coded, every other column picks the smaller of
+      frame-of-reference bit packing and dictionary coding (low cardinality IPs, ports, MACs)
+    - Encoded chunks go through block compression when enabled and kept compressed only if smaller
+    - The footer indexes every chunk, so the reader only preads the projected columns
+*/
+
+// ---- Byte helpers (little endian) ----
+
+static void put_u8(std::vector<uint8_t>& out, uint8_t value) {
+    out.push_back(value);
+}
+
+static void put_le(std::vector<uint8_t>& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+static void put_varint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static size_t varint_size(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+static uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+static unsigned bit_width(uint64_t range) {
+    unsigned width = 0;
+    while (range) {
+        width++;
+        range >>= 1;
+    }
+    return width;
+}
+
+// Bounds checked cursor over an encoded chunk / the footer
+struct ByteReader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    bool ok;
+
+    uint64_t le(size_t bytes) {
+        if (!ok || size - pos < bytes) {
+            ok = false;
+            return 0;
+        }
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; i++) {
+            value |= static_cast<uint64_t>(data[pos + i]) << (8 * i);
+        }
+        pos += bytes;
+        return value;
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (!ok || pos >= size) {
+                ok = false;
+                return 0;
+            }
+            uint8_t byte = data[pos++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+};
+
+static size_t packed_size(size_t rows, unsigned width) {
+    return (rows * width + 7) / 8;
+}
+
+// Appends value_at(i) packed LSB first at a fixed bit width, in pieces of at most 32 bits
+// so the accumulator never holds more than 39 live bits
+template <typename Transform>
+static void pack_bits(std::vector<uint8_t>& out, size_t rows, unsigned width, Transform value_at) {
+    uint64_t acc = 0;
+    unsigned bits = 0;
+    for (size_t i = 0; i < rows; i++) {
+        uint64_t value = value_at(i);
+        for (unsigned done = 0; done < width;) {
+            unsigned take = width - done < 32 ? width - done : 32;
+            acc |= ((value >> done) & ((1ULL << take) - 1)) << bits;
+            bits += take;
+            done += take;
+            while (bits >= 8) {
+                out.push_back(static_cast<uint8_t>(acc));
+                acc >>= 8;
+                bits -= 8;
+            }
+        }
+    }
+    if (bits) {
+        out.push_back(static_cast<uint8_t>(acc));
+    }
+}
+
+static bool unpack_bits(ByteReader& in, size_t rows, unsigned width, uint64_t* out) {
+    if (width > 64) {
+        return false;
+    }
+    if (width == 0) {
+        std::memset(out, 0, rows * sizeof(uint64_t));
+        return true;
+    }
+    size_t bytes = packed_size(rows, width);
+    if (in.size - in.pos < bytes) {
+        return false;
+    }
+    const uint8_t* data = in.data + in.pos;
+
+    uint64_t acc = 0;
+    unsigned bits = 0;
+    size_t byte = 0;
+    for (size_t i = 0; i < rows; i++) {
+        uint64_t value = 0;
+        for (unsigned done = 0; done < width;) {
+            unsigned take = width - done < 32 ? width - done : 32;
+            while (bits < take) {
+                acc |= static_cast<uint64_t>(data[byte++]) << bits;
+                bits += 8;
+            }
+            value |= (acc & ((1ULL << take) - 1)) << done;
+            acc >>= take;
+            bits -= take;
+            done += take;
+        }
+        out[i] = value;
+    }
+    in.pos += bytes;
+    return true;
+}
+
+// ---- Row extraction ----
+
+static uint64_t mac_value(const uint8_t* mac) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 6; i++) {
+        value = (value << 8) | mac[i];
+    }
+    return value;
+}
+
+static uint64_t address_half(const uint8_t* half) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; i++) {
+        value = (value << 8) | half[i];
+    }
+    return value;
+}
+
+static void extract_row(uint64_t timestamp_ns, const PacketView& view, const PacketValidator* validator,
+                        uint64_t row[COLUMN_COUNT]) {
+    PacketMetadata metadata;
+    make_packet_metadata(timestamp_ns, view, validator, metadata);
+
+    row[static_cast<size_t>(Column::TIMESTAMP)] = metadata.timestamp_ns;
+    row[static_cast<size_t>(Column::SRC_MAC)] = mac_value(metadata.src_mac);
+    row[static_cast<size_t>(Column::DEST_MAC)] = mac_value(metadata.dest_mac);
+    row[static_cast<size_t>(Column::ETHERTYPE)] = metadata.ethertype;
+    row[static_cast<size_t>(Column::SRC_IP)] = metadata.src_ip;
+    row[static_cast<size_t>(Column::DEST_IP)] = metadata.dest_ip;
+    row[static_cast<size_t>(Column::PROTOCOL)] = metadata.protocol;
+    row[static_cast<size_t>(Column::SRC_PORT)] = metadata.src_port;
+    row[static_cast<size_t>(Column::DEST_PORT)] = metadata.dest_port;
+    row[static_cast<size_t>(Column::TCP_FLAGS)] = metadata.tcp_flags;
+    row[static_cast<size_t>(Column::LENGTH)] = metadata.length;
+    row[static_cast<size_t>(Column::PAYLOAD_LENGTH)] = metadata.payload_len;
+    row[static_cast<size_t>(Column::LAYERS)] = metadata.layers;
+    row[static_cast<size_t>(Column::ERROR_MASK)] = metadata.error_mask;
+    row[static_cast<size_t>(Column::SRC_IP6_HI)] = address_half(metadata.src_ip6);
+    row[static_cast<size_t>(Column::SRC_IP6_LO)] = address_half(metadata.src_ip6 + 8);
+    row[static_cast<size_t>(Column::DEST_IP6_HI)] = address_half(metadata.dest_ip6);
+    row[static_cast<size_t>(Column::DEST_IP6_LO)] = address_half(metadata.dest_ip6 + 8);
+}
+
+// ---- ColumnarWriter ----
+
+ColumnarWriter::ColumnarWriter(const std::string& path, const ColumnarOptions& options) :
+    ok(false), rows_written(0), options(options), fd(-1), closed(false)
+{
+    if (this->options.row_group_size == 0 || this->options.row_group_size > UINT32_MAX) {
+        this->options.row_group_size = COLUMNAR_DEFAULT_ROW_GROUP;
+    }
+
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        closed = true;
+        return;
+    }
+    out = std::make_unique<OutputBuffer>(fd);
+
+    for (size_t c = 0; c < COLUMN_COUNT; c++) {
+        columns[c].reserve(this->options.row_group_size);
+    }
+
+    std::vector<uint8_t> header;
+    header.insert(header.end(), COLUMNAR_MAGIC, COLUMNAR_MAGIC + 4);
+    put_le(header, COLUMNAR_VERSION, 2);
+    put_le(header, COLUMN_COUNT, 2);
+    put_le(header, 0, 8);
+    out->append(std::string_view(reinterpret_cast<const char*>(header.data()), header.size()));
+    ok = true;
+}
+
+ColumnarWriter::~ColumnarWriter() {
+    close();
+}
+
+uint64_t ColumnarWriter::bytes_written() const {
+    return out ? out->bytes_written + out->pending() : 0;
+}
+
+void ColumnarWriter::append(uint64_t timestamp_ns, const PacketView& view, const PacketValidator* validator) {
+    if (closed || !ok) {
+        return;
+    }
+
+    uint64_t row[COLUMN_COUNT];
+    extract_row(timestamp_ns, view, validator, row);
+    for (size_t c = 0; c < COLUMN_COUNT; c++) {
+        columns[c].push_back(row[c]);
+    }
+    rows_written++;
+
+    if (columns[0].size() >= options.row_group_size) {
+        flush_row_group();
+    }
+}
+
+void ColumnarWriter::encode_column(const std::vector<uint64_t>& values, bool prefer_delta, ColumnEncoding& encoding) {
+    size_t rows = values.size();
+    encoded.clear();
+
+    if (prefer_delta) {
+        encoding = ColumnEncoding::DELTA;
+        put_varint(encoded, values[0]);
+        for (size_t i = 1; i < rows; i++) {
+            put_varint(encoded, zigzag(static_cast<int64_t>(values[i] - values[i - 1])));
+        }
+        return;
+    }
+
+    uint64_t min = values[0];
+    uint64_t max = values[0];
+    for (uint64_t value : values) {
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+    }
+    unsigned width = bit_width(max - min);
+    size_t bitpack_bytes = varint_size(min) + 1 + packed_size(rows, width);
+
+    // Dictionary only pays off for low cardinality, give up as soon as it cannot win
+    dictionary.clear();
+    dictionary_index.clear();
+    size_t dictionary_bytes = 0;
+    bool use_dictionary = width > 1;
+    for (size_t i = 0; i < rows && use_dictionary; i++) {
+        auto inserted = dictionary_index.try_emplace(values[i], static_cast<uint32_t>(dictionary.size()));
+        if (inserted.second) {
+            dictionary.push_back(values[i]);
+            dictionary_bytes += varint_size(values[i]);
+            if (dictionary.size() > COLUMNAR_MAX_DICTIONARY || dictionary_bytes >= bitpack_bytes) {
+                use_dictionary = false;
+            }
+        }
+    }
+    if (use_dictionary) {
+        unsigned index_width = bit_width(dictionary.size() - 1);
+        dictionary_bytes += varint_size(dictionary.size()) + 1 + packed_size(rows, index_width);
+        use_dictionary = dictionary_bytes < bitpack_bytes;
+
+        if (use_dictionary) {
+            encoding = ColumnEncoding::DICTIONARY;
+            put_varint(encoded, dictionary.size());
+            for (uint64_t value : dictionary) {
+                put_varint(encoded, value);
+            }
+            put_u8(encoded, static_cast<uint8_t>(index_width));
+            pack_bits(encoded, rows, index_width, [&](size_t i) {
+                return static_cast<uint64_t>(dictionary_index.find(values[i])->second);
+            });
+            return;
+        }
+    }
+
+    encoding = ColumnEncoding::BITPACK;
+    put_varint(encoded, min);
+    put_u8(encoded, static_cast<uint8_t>(width));
+    pack_bits(encoded, rows, width, [&](size_t i) { return values[i] - min; });
+}
+
+void ColumnarWriter::flush_row_group() {
+    size_t rows = columns[0].size();
+    if (rows == 0) {
+        return;
+    }
+
+    RowGroupInfo group;
+    group.rows = static_cast<uint32_t>(rows);
+
+    for (size_t c = 0; c < COLUMN_COUNT; c++) {
+        ColumnChunkInfo& chunk = group.chunks[c];
+        encode_column(columns[c], c == static_cast<size_t>(Column::TIMESTAMP), chunk.encoding);
+
+        const uint8_t* bytes = encoded.data();
+        size_t size = encoded.size();
+        chunk.compression = ColumnCompression::NONE;
+        if (options.compress && size >= COLUMNAR_MIN_COMPRESS_SIZE) {
+            compressed.resize(block_compress_bound(size));
+            size_t packed = block_compress(encoded.data(), size, compressed.data(), compressed.size());
+            if (packed > 0 && packed < size) {
+                chunk.compression = ColumnCompression::BLOCK;
+                bytes = compressed.data();
+                size = packed;
+            }
+        }
+
+        chunk.offset = bytes_written();
+        chunk.stored_size = static_cast<uint32_t>(size);
+        chunk.raw_size = static_cast<uint32_t>(encoded.size());
+        out->append(std::string_view(reinterpret_cast<const char*>(bytes), size));
+        columns[c].clear();
+    }
+
+    groups.push_back(group);
+    if (out->failed) {
+        ok = false;
+    }
+}
+
+bool ColumnarWriter::close() {
+    if (closed) {
+        return ok;
+    }
+    closed = true;
+
+    if (ok) {
+        flush_row_group();
+
+        std::vector<uint8_t> footer;
+        uint64_t footer_offset = bytes_written();
+        put_le(footer, groups.size(), 4);
+        for (const RowGroupInfo& group : groups) {
+            put_le(footer, group.rows, 4);
+            for (size_t c = 0; c < COLUMN_COUNT; c++) {
+                const ColumnChunkInfo& chunk = group.chunks[c];
+                put_le(footer, chunk.offset, 8);
+                put_le(footer, chunk.stored_size, 4);
+                put_le(footer, chunk.raw_size, 4);
+                put_u8(footer, static_cast<uint8_t>(chunk.encoding));
+                put_u8(footer, static_cast<uint8_t>(chunk.compression));
+            }
+        }
+        put_le(footer, footer_offset, 8);
+        footer.insert(footer.end(), COLUMNAR_MAGIC, COLUMNAR_MAGIC + 4);
+        out->append(std::string_view(reinterpret_cast<const char*>(footer.data()), footer.size()));
+        ok = out->flush() && !out->failed;
+    }
+
+    if (::close(fd) != 0) {
+        ok = false;
+    }
+    fd = -1;
+    return ok;
+}
+
+// ---- ColumnarReader ----
+
+ColumnarReader::ColumnarReader(const std::string& path) : ok(false), row_count(0), fd(-1) {
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < COLUMNAR_HEADER_SIZE + COLUMNAR_TRAILER_SIZE) {
+        return;
+    }
+    uint64_t file_size = static_cast<uint64_t>(st.st_size);
+
+    uint8_t header[COLUMNAR_HEADER_SIZE];
+    uint8_t trailer[COLUMNAR_TRAILER_SIZE];
+    if (pread(fd, header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+        pread(fd, trailer, sizeof(trailer), file_size - sizeof(trailer)) != static_cast<ssize_t>(sizeof(trailer))) {
+        return;
+    }
+    if (std::memcmp(header, COLUMNAR_MAGIC, 4) != 0 || std::memcmp(trailer + 8, COLUMNAR_MAGIC, 4) != 0) {
+        return;
+    }
+
+    ByteReader head{header, sizeof(header), 4, true};
+    uint64_t version = head.le(2);
+    uint64_t column_count = head.le(2);
+    if (version != COLUMNAR_VERSION || column_count != COLUMN_COUNT) {
+        return;
+    }
+
+    ByteReader tail{trailer, sizeof(trailer), 0, true};
+    uint64_t footer_offset = tail.le(8);
+    if (footer_offset < COLUMNAR_HEADER_SIZE || footer_offset > file_size - COLUMNAR_TRAILER_SIZE) {
+        return;
+    }
+
+    std::vector<uint8_t> footer(file_size - COLUMNAR_TRAILER_SIZE - footer_offset);
+    if (pread(fd, footer.data(), footer.size(), footer_offset) != static_cast<ssize_t>(footer.size())) {
+        return;
+    }
+
+    ByteReader in{footer.data(), footer.size(), 0, true};
+    uint64_t group_count = in.le(4);
+    if (group_count > footer.size() / (4 + COLUMN_COUNT * COLUMNAR_CHUNK_ENTRY_SIZE)) {
+        return;
+    }
+    groups.resize(group_count);
+    for (RowGroupInfo& group : groups) {
+        group.rows = static_cast<uint32_t>(in.le(4));
+        for (size_t c = 0; c < COLUMN_COUNT; c++) {
+            ColumnChunkInfo& chunk = group.chunks[c];
+            chunk.offset = in.le(8);
+            chunk.stored_size = static_cast<uint32_t>(in.le(4));
+            chunk.raw_size = static_cast<uint32_t>(in.le(4));
+            chunk.encoding = static_cast<ColumnEncoding>(in.le(1));
+            chunk.compression = static_cast<ColumnCompression>(in.le(1));
+            if (chunk.offset > footer_offset || chunk.stored_size > footer_offset - chunk.offset) {
+                in.ok = false;
+            }
+        }
+        row_count += group.rows;
+    }
+    ok = in.ok;
+}
+
+ColumnarReader::~ColumnarReader() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+static bool decode_chunk(const uint8_t* data, size_t size, ColumnEncoding encoding, size_t rows, uint64_t* out) {
+    ByteReader in{data, size, 0, true};
+
+    switch (encoding) {
+        case ColumnEncoding::DELTA: {
+            uint64_t value = in.varint();
+            out[0] = value;
+            for (size_t i = 1; i < rows; i++) {
+                value += static_cast<uint64_t>(unzigzag(in.varint()));
+                out[i] = value;
+            }
+            return in.ok;
+        }
+        case ColumnEncoding::BITPACK: {
+            uint64_t min = in.varint();
+            unsigned width = static_cast<unsigned>(in.le(1));
+            if (!in.ok || !unpack_bits(in, rows, width, out)) {
+                return false;
+            }
+            for (size_t i = 0; i < rows; i++) {
+                out[i] += min;
+            }
+            return true;
+        }
+        case ColumnEncoding::DICTIONARY: {
+            uint64_t count = in.varint();
+            if (!in.ok || count == 0 || count > in.size - in.pos) {
+                return false;
+            }
+            std::vector<uint64_t> values(count);
+            for (uint64_t& value : values) {
+                value = in.varint();
+            }
+            unsigned width = static_cast<unsigned>(in.le(1));
+            if (!in.ok || !unpack_bits(in, rows, width, out)) {
+                return false;
+            }
+            for (size_t i = 0; i < rows; i++) {
+                if (out[i] >= count) {
+                    return false;
+                }
+                out[i] = values[out[i]];
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool ColumnarReader::read_row_group(size_t group, uint32_t column_mask, ColumnBatch& batch) {
+    if (!ok || group >= groups.size()) {
+        return false;
+    }
+    const RowGroupInfo& info = groups[group];
+    batch.rows = info.rows;
+
+    for (size_t c = 0; c < COLUMN_COUNT; c++) {
+        if (!(column_mask & (1u << c))) {
+            batch.columns[c].clear();
+            continue;
+        }
+        const ColumnChunkInfo& chunk = info.chunks[c];
+
+        stored.resize(chunk.stored_size);
+        if (pread(fd, stored.data(), stored.size(), chunk.offset) != static_cast<ssize_t>(stored.size())) {
+            return false;
+        }
+
+        const uint8_t* bytes = stored.data();
+        size_t size = stored.size();
+        if (chunk.compression == ColumnCompression::BLOCK) {
+            raw.resize(chunk.raw_size);
+            if (block_decompress(stored.data(), stored.size(), raw.data(), raw.size()) != chunk.raw_size) {
+                return false;
+            }
+            bytes = raw.data();
+            size = raw.size();
+        }
+        else if (chunk.compression != ColumnCompression::NONE) {
+            return false;
+        }
+
+        batch.columns[c].resize(info.rows);
+        if (info.rows && !decode_chunk(bytes, size, chunk.encoding, info.rows, batch.columns[c].data())) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,214 @@
+#include "live-metrics.hpp"
+#include "packet-error.hpp"
+#include <charconv>
+#include <cstring>
+#include <ctime>
+#include <string_view>
+
+/*
+    Live Metrics Implementation
+    - Shards are allocated once, in the registry constructor; add_shard() only bumps a counter
+    - snapshot() sums the shards with relaxed loads: each counter is exact, counters of one snapshot may be a few
+      packets apart from each other, which is what any scrape of a running pipeline sees anyway
+    - Rendering writes straight into the caller's buffer through std::to_chars, nothing is allocated per scrape
+*/
+
+static const char* const PROTOCOL_NAMES[METRICS_PROTOCOLS] = {"tcp", "udp", "other_ip", "non_ip"};
+static const char* const DROP_NAMES[METRICS_DROPS] = {"ring_overrun", "shed", "duplicate", "recorder"};
+static const char* const STAGE_NAMES[METRICS_STAGES] = {"parse", "validate", "headers", "payload"};
+static const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+static const char* const QUANTILE_LABELS[] = {"0.5", "0.9", "0.99", "0.999"};
+
+// Bucket bounds matching metrics_latency_bucket()
+static uint64_t bucket_upper(size_t index) {
+    if (index < 4) {
+        return index;
+    }
+    unsigned exponent = static_cast<unsigned>(index / 4 + 1);
+    uint64_t width = 1ULL << (exponent - 2);
+    return ((4 + index % 4) << (exponent - 2)) + width - 1;
+}
+
+// ---- MetricsRegistry ----
+
+MetricsRegistry::MetricsRegistry(size_t max_shards) :
+    shards(std::make_unique<MetricsShard[]>(max_shards == 0 || max_shards > METRICS_MAX_SHARDS ? METRICS_MAX_SHARDS
+                                                                                            : max_shards)),
+    capacity(max_shards == 0 || max_shards > METRICS_MAX_SHARDS ? METRICS_MAX_SHARDS : max_shards),
+    count(0)
+{
+}
+
+MetricsShard* MetricsRegistry::add_shard() {
+    size_t index = count.load(std::memory_order_relaxed);
+    while (index < capacity) {
+        if (count.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel)) {
+            return &shards[index];
+        }
+    }
+    return nullptr;
+}
+
+void MetricsRegistry::snapshot(MetricsSnapshot& out) const {
+    std::memset(static_cast<void*>(&out), 0, sizeof(out));
+    out.magic = METRICS_SNAPSHOT_MAGIC;
+    out.version = METRICS_SNAPSHOT_VERSION;
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    out.taken_ns = static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+
+    size_t n = shard_count();
+    out.shards = static_cast<uint32_t>(n);
+    for (size_t s = 0; s < n; s++) {
+        const MetricsShard& shard = shards[s];
+        for (size_t p = 0; p < METRICS_PROTOCOLS; p++) {
+            out.packets[p] += shard.packets[p].load(std::memory_order_relaxed);
+            out.bytes[p] += shard.bytes[p].load(std::memory_order_relaxed);
+        }
+        for (size_t e = 0; e < METRICS_ERROR_SLOTS; e++) {
+            out.validation_errors[e] += shard.validation_errors[e].load(std::memory_order_relaxed);
+        }
+        for (size_t d = 0; d < METRICS_DROPS; d++) {
+            out.drops[d] += shard.drops[d].load(std::memory_order_relaxed);
+        }
+        out.ring_backlog[s] = shard.ring_backlog.load(std::memory_order_relaxed);
+        out.ring_capacity[s] = shard.ring_capacity.load(std::memory_order_relaxed);
+        for (size_t t = 0; t < METRICS_STAGES; t++) {
+            out.latency_count[t] += shard.latency_count[t].load(std::memory_order_relaxed);
+            out.latency_sum_ns[t] += shard.latency_sum_ns[t].load(std::memory_order_relaxed);
+            for (size_t b = 0; b < METRICS_LATENCY_BUCKETS; b++) {
+                out.latency_buckets[t][b] += shard.latency_buckets[t][b].load(std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+uint64_t metrics_latency_quantile(const MetricsSnapshot& snapshot, MetricsStage stage, double q) {
+    size_t t = static_cast<size_t>(stage);
+    // Ranked against the bucket total, which may run a few samples ahead of latency_count
+    uint64_t total = 0;
+    for (size_t b = 0; b < METRICS_LATENCY_BUCKETS; b++) {
+        total += snapshot.latency_buckets[t][b];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total));
+    rank = rank < total ? rank : total - 1;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < METRICS_LATENCY_BUCKETS; b++) {
+        seen += snapshot.latency_buckets[t][b];
+        if (seen > rank) {
+            return bucket_upper(b);
+        }
+    }
+    return bucket_upper(METRICS_LATENCY_BUCKETS - 1);
+}
+
+// ---- Prometheus text ----
+
+// Bounded writer over the caller's buffer, latches overflow instead of checking every append
+struct PrometheusWriter {
+    char* position;
+    char* end;
+    bool overflow;
+
+    void text(std::string_view s) {
+        if (static_cast<size_t>(end - position) < s.size()) {
+            overflow = true;
+            position = end;
+            return;
+        }
+        std::memcpy(position, s.data(), s.size());
+        position += s.size();
+    }
+
+    void number(uint64_t value) {
+        std::to_chars_result result = std::to_chars(position, end, value);
+        if (result.ec != std::errc()) {
+            overflow = true;
+            position = end;
+            return;
+        }
+        position = result.ptr;
+    }
+
+    void header(std::string_view name, std::string_view type, std::string_view help) {
+        text("# HELP ");
+        text(name);
+        text(" ");
+        text(help);
+        text("\n# TYPE ");
+        text(name);
+        text(" ");
+        text(type);
+        text("\n");
+    }
+
+    // name{label="value"} number
+    void sample(std::string_view name, std::string_view label, std::string_view value, uint64_t n) {
+        text(name);
+        text("{");
+        text(label);
+        text("=\"");
+        text(value);
+        text("\"} ");
+        number(n);
+        text("\n");
+    }
+};
+
+size_t render_prometheus(const MetricsSnapshot& snapshot, char* out, size_t capacity) {
+    PrometheusWriter w{out, out + capacity, false};
+
+    w.header("deeppacket_packets_total", "counter", "Packets seen by the workers, by transport");
+    for (size_t p = 0; p < METRICS_PROTOCOLS; p++) {
+        w.sample("deeppacket_packets_total", "protocol", PROTOCOL_NAMES[p], snapshot.packets[p]);
+    }
+    w.header("deeppacket_bytes_total", "counter", "Frame bytes seen by the workers, by transport");
+    for (size_t p = 0; p < METRICS_PROTOCOLS; p++) {
+        w.sample("deeppacket_bytes_total", "protocol", PROTOCOL_NAMES[p], snapshot.bytes[p]);
+    }
+
+    w.header("deeppacket_validation_errors_total", "counter", "Packets failing each validation check");
+    for (size_t e = 1; e < METRICS_ERROR_SLOTS; e++) {
+        std::string_view name = validation_error_name(static_cast<ValidationError>(e));
+        if (name != "UNKNOWN") {
+            w.sample("deeppacket_validation_errors_total", "error", name, snapshot.validation_errors[e]);
+        }
+    }
+
+    w.header("deeppacket_drops_total", "counter", "Packets not processed, by reason");
+    for (size_t d = 0; d < METRICS_DROPS; d++) {
+        w.sample("deeppacket_drops_total", "reason", DROP_NAMES[d], snapshot.drops[d]);
+    }
+
+    char worker[24];
+    w.header("deeppacket_ring_backlog", "gauge", "Records waiting in each worker's input ring");
+    for (uint32_t s = 0; s < snapshot.shards && s < METRICS_MAX_SHARDS; s++) {
+        *std::to_chars(worker, worker + sizeof(worker) - 1, s).ptr = '\0';
+        w.sample("deeppacket_ring_backlog", "worker", worker, snapshot.ring_backlog[s]);
+    }
+    w.header("deeppacket_ring_capacity", "gauge", "Slots of each worker's input ring");
+    for (uint32_t s = 0; s < snapshot.shards && s < METRICS_MAX_SHARDS; s++) {
+        *std::to_chars(worker, worker + sizeof(worker) - 1, s).ptr = '\0';
+        w.sample("deeppacket_ring_capacity", "worker", worker, snapshot.ring_capacity[s]);
+    }
+
+    w.header("deeppacket_stage_latency_ns", "summary", "Time per packet in each pipeline stage (sampled)");
+    for (size_t t = 0; t < METRICS_STAGES; t++) {
+        for (size_t q = 0; q < sizeof(QUANTILES) / sizeof(QUANTILES[0]); q++) {
+            w.text("deeppacket_stage_latency_ns{stage=\"");
+            w.text(STAGE_NAMES[t]);
+            w.text("\",quantile=\"");
+            w.text(QUANTILE_LABELS[q]);
+            w.text("\"} ");
+            w.number(metrics_latency_quantile(snapshot, static_cast<MetricsStage>(t), QUANTILES[q]));
+            w.text("\n");
+        }
+        w.sample("deeppacket_stage_latency_ns_sum", "stage", STAGE_NAMES[t], snapshot.latency_sum_ns[t]);
+        w.sample("deeppacket_stage_latency_ns_count", "stage", STAGE_NAMES[t], snapshot.latency_count[t]);
+    }
+
+    return w.overflow ? 0 : static_cast<size_t>(w.position - out);
+}
@@ -0,0 +1,171 @@
+#include "metrics-server.hpp"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define METRICS_POLL_MS 100
+#define METRICS_IO_TIMEOUT_MS 1000
+#define METRICS_HEADER_SIZE 256
+
+/*
+    MetricsServer Class Implementation
+    - The listening socket is bound to the loopback address only: the counters are for the local agent / Prometheus
+    - The thread polls the listener with a short timeout so stop() is noticed without a wake-up pipe
+    - A scrape snapshots the registry into the preallocated MetricsSnapshot and renders into the preallocated body
+      buffer, the header goes into a stack array: steady-state scrapes do not allocate
+    - Clients get a one second send / receive timeout, a stuck client cannot hold the endpoint for longer
+*/
+
+static bool send_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool send_response(int fd, std::string_view status, std::string_view content_type, std::string_view body) {
+    char header[METRICS_HEADER_SIZE];
+    char* p = header;
+    char* end = header + sizeof(header);
+    auto put = [&](std::string_view s) {
+        size_t n = s.size() < static_cast<size_t>(end - p) ? s.size() : static_cast<size_t>(end - p);
+        std::memcpy(p, s.data(), n);
+        p += n;
+    };
+    put("HTTP/1.0 ");
+    put(status);
+    put("\r\nContent-Type: ");
+    put(content_type);
+    put("\r\nContent-Length: ");
+    p = std::to_chars(p, end, body.size()).ptr;
+    put("\r\nConnection: close\r\n\r\n");
+    return send_all(fd, header, static_cast<size_t>(p - header)) && send_all(fd, body.data(), body.size());
+}
+
+MetricsServer::MetricsServer(const MetricsRegistry& registry, uint16_t port) :
+    ok(false), scrapes(0), snapshots(0), bad_requests(0),
+    registry(registry), listen_fd(-1), bound_port(0), stopping(false),
+    snapshot(std::make_unique<MetricsSnapshot>()), body(std::make_unique<char[]>(METRICS_RESPONSE_SIZE))
+{
+    listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        return;
+    }
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    socklen_t length = sizeof(address);
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listen_fd, 16) != 0 ||
+        getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        close(listen_fd);
+        listen_fd = -1;
+        return;
+    }
+    bound_port = ntohs(address.sin_port);
+    ok = true;
+    thread = std::thread(&MetricsServer::run, this);
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+void MetricsServer::stop() {
+    stopping.store(true, std::memory_order_relaxed);
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+    }
+}
+
+void MetricsServer::run() {
+    pollfd listener{listen_fd, POLLIN, 0};
+    while (!stopping.load(std::memory_order_relaxed)) {
+        int ready = poll(&listener, 1, METRICS_POLL_MS);
+        if (ready <= 0) {
+            continue;
+        }
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        timeval timeout{METRICS_IO_TIMEOUT_MS / 1000, (METRICS_IO_TIMEOUT_MS % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        serve(fd);
+        close(fd);
+    }
+}
+
+void MetricsServer::serve(int fd) {
+    // Only the request line matters; headers past the buffer are left unread
+    size_t used = 0;
+    std::string_view line;
+    while (used < sizeof(request)) {
+        ssize_t n = recv(fd, request + used, sizeof(request) - used, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        used += static_cast<size_t>(n);
+        std::string_view received(request, used);
+        size_t end = received.find("\r\n");
+        if (end != std::string_view::npos) {
+            line = received.substr(0, end);
+            break;
+        }
+    }
+
+    std::string_view path;
+    if (line.starts_with("GET ")) {
+        path = line.substr(4);
+        path = path.substr(0, path.find(' '));
+        path = path.substr(0, path.find('?'));
+    }
+
+    if (path == "/metrics") {
+        registry.snapshot(*snapshot);
+        size_t length = render_prometheus(*snapshot, body.get(), METRICS_RESPONSE_SIZE);
+        scrapes.fetch_add(1, std::memory_order_relaxed);
+        if (length > 0) {
+            send_response(fd, "200 OK", "text/plain; version=0.0.4", std::string_view(body.get(), length));
+            return;
+        }
+        send_response(fd, "500 Internal Server Error", "text/plain", "metrics too large\n");
+        return;
+    }
+    if (path == "/snapshot") {
+        registry.snapshot(*snapshot);
+        snapshots.fetch_add(1, std::memory_order_relaxed);
+        send_response(fd, "200 OK", "application/octet-stream",
+                      std::string_view(reinterpret_cast<const char*>(snapshot.get()), sizeof(MetricsSnapshot)));
+        return;
+    }
+    bad_requests.fetch_add(1, std::memory_order_relaxed);
+    send_response(fd, "404 Not Found", "text/plain", "try /metrics or /snapshot\n");
+}
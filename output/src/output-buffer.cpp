@@ -0,0 +1,117 @@
+#include "output-buffer.hpp"
+#include "field_format.hpp"
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+
+/*
+    OutputBuffer Class Implementation
+    - Single heap allocation at construction, reused for the lifetime of the buffer
+    - Text that does not fit in the free space triggers a flush, oversized text bypasses the buffer
+    - Write errors latch 'failed' and drop further output instead of throwing on the hot path
+*/
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+OutputBuffer::OutputBuffer(int fd, size_t capacity) :
+    bytes_written(0), write_calls(0), failed(false),
+    fd(fd), capacity(capacity < 256 ? 256 : capacity), used(0),
+    buffer(new char[this->capacity])
+{
+}
+
+OutputBuffer::~OutputBuffer() {
+    flush();
+}
+
+bool OutputBuffer::flush() {
+    size_t offset = 0;
+    while (offset < used && !failed) {
+        ssize_t n = ::write(fd, buffer.get() + offset, used - offset);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            failed = true;
+            break;
+        }
+        offset += static_cast<size_t>(n);
+        bytes_written += static_cast<uint64_t>(n);
+        write_calls++;
+    }
+    used = 0;
+    return !failed;
+}
+
+char* OutputBuffer::reserve(size_t n) {
+    if (capacity - used < n) {
+        flush();
+    }
+    return buffer.get() + used;
+}
+
+void OutputBuffer::append(std::string_view text) {
+    if (text.size() > capacity) {
+        // Too large to stage, write it straight through
+        flush();
+        size_t offset = 0;
+        while (offset < text.size() && !failed) {
+            ssize_t n = ::write(fd, text.data() + offset, text.size() - offset);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                failed = true;
+                break;
+            }
+            offset += static_cast<size_t>(n);
+            bytes_written += static_cast<uint64_t>(n);
+            write_calls++;
+        }
+        return;
+    }
+    char* out = reserve(text.size());
+    std::memcpy(out, text.data(), text.size());
+    used += text.size();
+}
+
+void OutputBuffer::append(char c) {
+    *reserve(1) = c;
+    used++;
+}
+
+void OutputBuffer::append_uint(uint64_t value) {
+    char* out = reserve(20);
+    std::to_chars_result result = std::to_chars(out, out + 20, value);
+    used += static_cast<size_t>(result.ptr - out);
+}
+
+void OutputBuffer::append_hex(uint64_t value, int width) {
+    if (width < 1) {
+        width = 1;
+    }
+    if (width > 16) {
+        width = 16;
+    }
+    char* out = reserve(static_cast<size_t>(width));
+    for (int i = width - 1; i >= 0; i--) {
+        out[i] = HEX_DIGITS[value & 0x0F];
+        value >>= 4;
+    }
+    used += static_cast<size_t>(width);
+}
+
+void OutputBuffer::append_mac(const uint8_t* mac) {
+    char* out = reserve(MAC_STRING_LENGTH);
+    used += format_mac(mac, out);
+}
+
+void OutputBuffer::append_ipv4(uint32_t addr) {
+    char* out = reserve(IPV4_STRING_MAX_LENGTH);
+    used += format_ipv4(addr, out);
+}
+
+void OutputBuffer::append_ipv6(const uint8_t* addr) {
+    char* out = reserve(IPV6_STRING_MAX_LENGTH);
+    used += format_ipv6(addr, out);
+}
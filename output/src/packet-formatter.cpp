@@ -0,0 +1,264 @@
+#include "packet-formatter.hpp"
+#include "field_format.hpp"
+#include <arpa/inet.h>
+
+/*
+    PacketFormatter Class Implementation
+    - Text, JSON lines and CSV renderers over the same bounds-checked field extraction
+    - Every field is written straight into the OutputBuffer, there are no intermediate strings
+    - Fields are only read when the parser saw enough bytes for them
+*/
+
+// Header fields the formatters can safely read from a PacketView
+struct PacketFields {
+    bool has_eth;
+    bool has_ip;                // IPv4 or IPv6
+    bool ipv6;
+    bool has_ports;
+    bool has_flags;
+    const EthernetHeader* eth;
+    uint32_t src_ip;            // network byte order
+    uint32_t dest_ip;
+    const uint8_t* src_ip6;     // wire order, ipv6 only
+    const uint8_t* dest_ip6;
+    uint8_t protocol;
+    uint16_t src_port;
+    uint16_t dest_port;
+    uint8_t tcp_flags;
+};
+
+static PacketFields extract_fields(const PacketView& view) {
+    PacketFields fields = {};
+    fields.has_eth = view.has_eth;
+    fields.eth = view.eth_layer.eth;
+
+    if (view.has_ip && view.size() >= view.l3_offset + sizeof(IPv4Header)) {
+        fields.has_ip = true;
+        fields.src_ip = view.ip_layer.iph->src_addr;
+        fields.dest_ip = view.ip_layer.iph->dest_addr;
+        fields.protocol = view.ip_layer.iph->protocol;
+    }
+    else if (view.has_ipv6 && view.size() >= view.l3_offset + sizeof(IPv6Header)) {
+        fields.has_ip = true;
+        fields.ipv6 = true;
+        fields.src_ip6 = view.ipv6_layer.ip6h->src_addr;
+        fields.dest_ip6 = view.ipv6_layer.ip6h->dest_addr;
+        fields.protocol = view.ipv6_layer.upper_protocol;
+    }
+
+    if (view.has_tcp && view.payload_len >= 4) {
+        fields.has_ports = true;
+        fields.src_port = ntohs(view.tcp_layer.tcph->src_port);
+        fields.dest_port = ntohs(view.tcp_layer.tcph->dest_port);
+        if (view.payload_len >= 14) {
+            fields.has_flags = true;
+            fields.tcp_flags = view.tcp_layer.tcph->flags;
+        }
+    }
+    else if (view.has_udp && view.payload_len >= 4) {
+        fields.has_ports = true;
+        fields.src_port = ntohs(view.udp_layer.udph->src);
+        fields.dest_port = ntohs(view.udp_layer.udph->dest);
+    }
+    return fields;
+}
+
+bool PacketFormatter::parse_format(std::string_view name, OutputFormat& format) {
+    if (name == "text") {
+        format = OutputFormat::TEXT;
+    }
+    else if (name == "json") {
+        format = OutputFormat::JSON;
+    }
+    else if (name == "csv") {
+        format = OutputFormat::CSV;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+void PacketFormatter::write_header() {
+    if (format == OutputFormat::CSV) {
+        out.append("len,src_mac,dst_mac,ethertype,src_ip,dst_ip,protocol,src_port,dst_port,tcp_flags,payload_len,errors\n");
+    }
+}
+
+void PacketFormatter::write_packet(const PacketView& view, const PacketValidator* validator) {
+    switch (format) {
+        case OutputFormat::JSON:
+            write_json(view, validator);
+            break;
+        case OutputFormat::CSV:
+            write_csv(view, validator);
+            break;
+        case OutputFormat::TEXT:
+        default:
+            write_text(view, validator);
+            break;
+    }
+}
+
+void PacketFormatter::write_errors(const PacketValidator* validator, char separator, bool quoted) {
+    for (size_t i = 0; i < validator->errors.size(); i++) {
+        if (i > 0) {
+            out.append(separator);
+        }
+        if (quoted) {
+            out.append('"');
+        }
+        out.append(validation_error_name(validator->errors[i]));
+        if (quoted) {
+            out.append('"');
+        }
+    }
+}
+
+// IPv6 in brackets when a port follows, as in URLs: [2001:db8::1]:443
+void PacketFormatter::write_address(const PacketFields& fields, bool source, bool bracketed) {
+    if (!fields.ipv6) {
+        out.append_ipv4(source ? fields.src_ip : fields.dest_ip);
+        return;
+    }
+    if (bracketed) {
+        out.append('[');
+    }
+    out.append_ipv6(source ? fields.src_ip6 : fields.dest_ip6);
+    if (bracketed) {
+        out.append(']');
+    }
+}
+
+// 54 66:77:88:99:AA:BB > 00:11:22:33:44:55 0800 192.168.1.2:1234 > 192.168.1.3:80 proto 6 [SYN] payload 20 NONE
+void PacketFormatter::write_text(const PacketView& view, const PacketValidator* validator) {
+    PacketFields fields = extract_fields(view);
+
+    out.append_uint(view.size());
+    if (fields.has_eth) {
+        out.append(' ');
+        out.append_mac(fields.eth->src_mac);
+        out.append(" > ");
+        out.append_mac(fields.eth->dest_mac);
+        out.append(' ');
+        out.append_hex(ntohs(fields.eth->ether_type), 4);
+    }
+    if (fields.has_ip) {
+        out.append(' ');
+        write_address(fields, true, fields.has_ports);
+        if (fields.has_ports) {
+            out.append(':');
+            out.append_uint(fields.src_port);
+        }
+        out.append(" > ");
+        write_address(fields, false, fields.has_ports);
+        if (fields.has_ports) {
+            out.append(':');
+            out.append_uint(fields.dest_port);
+        }
+        out.append(" proto ");
+        out.append_uint(fields.protocol);
+    }
+    if (fields.has_flags) {
+        out.append(" [");
+        out.append(tcp_flags_string(fields.tcp_flags));
+        out.append(']');
+    }
+    out.append(" payload ");
+    out.append_uint(view.payload_len);
+    if (validator) {
+        out.append(' ');
+        write_errors(validator, ',', false);
+    }
+    out.append('\n');
+}
+
+void PacketFormatter::write_json(const PacketView& view, const PacketValidator* validator) {
+    PacketFields fields = extract_fields(view);
+
+    out.append("{\"len\":");
+    out.append_uint(view.size());
+    if (fields.has_eth) {
+        out.append(",\"src_mac\":\"");
+        out.append_mac(fields.eth->src_mac);
+        out.append("\",\"dst_mac\":\"");
+        out.append_mac(fields.eth->dest_mac);
+        out.append("\",\"ethertype\":");
+        out.append_uint(ntohs(fields.eth->ether_type));
+    }
+    if (fields.has_ip) {
+        out.append(",\"src_ip\":\"");
+        write_address(fields, true, false);
+        out.append("\",\"dst_ip\":\"");
+        write_address(fields, false, false);
+        out.append("\",\"protocol\":");
+        out.append_uint(fields.protocol);
+    }
+    if (fields.has_ports) {
+        out.append(",\"src_port\":");
+        out.append_uint(fields.src_port);
+        out.append(",\"dst_port\":");
+        out.append_uint(fields.dest_port);
+    }
+    if (fields.has_flags) {
+        out.append(",\"tcp_flags\":\"");
+        out.append(tcp_flags_string(fields.tcp_flags));
+        out.append('"');
+    }
+    out.append(",\"payload_len\":");
+    out.append_uint(view.payload_len);
+    if (validator) {
+        out.append(",\"errors\":[");
+        write_errors(validator, ',', true);
+        out.append(']');
+    }
+    out.append("}\n");
+}
+
+void PacketFormatter::write_csv(const PacketView& view, const PacketValidator* validator) {
+    PacketFields fields = extract_fields(view);
+
+    out.append_uint(view.size());
+    out.append(',');
+    if (fields.has_eth) {
+        out.append_mac(fields.eth->src_mac);
+        out.append(',');
+        out.append_mac(fields.eth->dest_mac);
+        out.append(',');
+        out.append_uint(ntohs(fields.eth->ether_type));
+    }
+    else {
+        out.append(",,");
+    }
+    out.append(',');
+    if (fields.has_ip) {
+        write_address(fields, true, false);
+        out.append(',');
+        write_address(fields, false, false);
+        out.append(',');
+        out.append_uint(fields.protocol);
+    }
+    else {
+        out.append(",,");
+    }
+    out.append(',');
+    if (fields.has_ports) {
+        out.append_uint(fields.src_port);
+        out.append(',');
+        out.append_uint(fields.dest_port);
+    }
+    else {
+        out.append(',');
+    }
+    out.append(',');
+    if (fields.has_flags) {
+        out.append(tcp_flags_string(fields.tcp_flags));
+    }
+    out.append(',');
+    out.append_uint(view.payload_len);
+    out.append(',');
+    if (validator) {
+        write_errors(validator, '|', false);
+    }
+    out.append('\n');
+}
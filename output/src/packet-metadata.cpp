@@ -0,0 +1,53 @@
+#include "packet-metadata.hpp"
+#include <arpa/inet.h>
+#include <cstring>
+
+/*
+    PacketMetadata Extraction
+    - Same bounds checks as the text formatters: IP fields need a full IPv4 / IPv6 fixed header,
+      ports need 4 bytes of L4 header and TCP flags 14
+    - For IPv6 the protocol is the upper-layer protocol that ended the extension header walk
+*/
+
+void make_packet_metadata(uint64_t timestamp_ns, const PacketView& view, const PacketValidator* validator,
+                          PacketMetadata& metadata) {
+    std::memset(&metadata, 0, sizeof(metadata));
+    metadata.timestamp_ns = timestamp_ns;
+    metadata.length = static_cast<uint32_t>(view.size());
+    metadata.payload_len = static_cast<uint32_t>(view.payload_len);
+    metadata.error_mask = validator ? validator->error_mask() : 0;
+
+    if (view.has_eth) {
+        metadata.layers |= METADATA_LAYER_ETH;
+        std::memcpy(metadata.src_mac, view.eth_layer.eth->src_mac, sizeof(metadata.src_mac));
+        std::memcpy(metadata.dest_mac, view.eth_layer.eth->dest_mac, sizeof(metadata.dest_mac));
+        metadata.ethertype = view.ethertype;
+    }
+
+    if (view.has_ip && view.size() >= view.l3_offset + sizeof(IPv4Header)) {
+        metadata.layers |= METADATA_LAYER_IP;
+        metadata.src_ip = ntohl(view.ip_layer.iph->src_addr);
+        metadata.dest_ip = ntohl(view.ip_layer.iph->dest_addr);
+        metadata.protocol = view.ip_layer.iph->protocol;
+    }
+    else if (view.has_ipv6 && view.size() >= view.l3_offset + sizeof(IPv6Header)) {
+        metadata.layers |= METADATA_LAYER_IPV6;
+        std::memcpy(metadata.src_ip6, view.ipv6_layer.ip6h->src_addr, sizeof(metadata.src_ip6));
+        std::memcpy(metadata.dest_ip6, view.ipv6_layer.ip6h->dest_addr, sizeof(metadata.dest_ip6));
+        metadata.protocol = view.ipv6_layer.upper_protocol;
+    }
+
+    if (view.has_tcp && view.payload_len >= 4) {
+        metadata.layers |= METADATA_LAYER_TCP;
+        metadata.src_port = ntohs(view.tcp_layer.tcph->src_port);
+        metadata.dest_port = ntohs(view.tcp_layer.tcph->dest_port);
+        if (view.payload_len >= 14) {
+            metadata.tcp_flags = view.tcp_layer.tcph->flags;
+        }
+    }
+    else if (view.has_udp && view.payload_len >= 4) {
+        metadata.layers |= METADATA_LAYER_UDP;
+        metadata.src_port = ntohs(view.udp_layer.udph->src);
+        metadata.dest_port = ntohs(view.udp_layer.udph->dest);
+    }
+}
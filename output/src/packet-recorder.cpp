@@ -0,0 +1,628 @@
+#include "packet-recorder.hpp"
+#include "block-codec.hpp"
+#include "flow_hash.hpp"
+#include "parser.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iostream>
+#include <string_view>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define RECORDER_MIN_BLOCK_SIZE 4096
+#define RECORDER_MAX_BLOCK_SIZE (64 << 20)
+#define RECORDER_MIN_QUEUE_SIZE (64 << 10)
+#define RECORDER_QUEUE_ALIGN 8
+#define RECORDER_QUEUE_PAD UINT32_MAX
+#define RECORDER_IDLE_SLEEP_US 100
+#define RECORDER_SEGMENT_PREFIX "segment-"
+#define RECORDER_SEGMENT_SUFFIX ".dps"
+
+/*
+    PacketRecorder / RecordingReader Implementation
+    - The queue is a single-producer single-consumer byte ring: record() copies header + frame behind queue_head
+      and publishes with one release store, the writer releases space with one store per record; an entry that
+      would straddle the end of the ring is preceded by a pad entry (or by a tail too short to hold a header)
+    - The writer thread does everything else: flow tags (parse + symmetric flow_hash), block packing, compression,
+      buffered writes, segment rotation and the disk budget; it sleeps briefly whenever the queue runs dry
+    - Before a segment is opened the oldest closed segments are unlinked until a full new segment fits the budget
+    - Segments are only closed (footer + trailer + fdatasync) when full or at close(); a partly filled block is
+      written after flush_ns so a live segment stays readable up to the last flush
+    - The reader checks each segment's trailer time range, then picks blocks from the block index (time) and the
+      flow index (blocks holding the flow); segments without a trailer are walked block header by block header
+*/
+
+static uint64_t monotonic_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static size_t round_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static std::string_view bytes_view(const void* data, size_t length) {
+    return std::string_view(static_cast<const char*>(data), length);
+}
+
+// Never 0, which marks packets without an IPv4 / IPv6 flow
+static uint32_t recorder_flow_tag(const FlowKey& key) {
+    uint32_t tag = static_cast<uint32_t>(flow_hash(key) >> 32);
+    return tag ? tag : 1;
+}
+
+static uint32_t frame_flow_tag(const uint8_t* data, size_t length) {
+    ParsedPacket packet = parse_packet(std::span<const uint8_t>(data, length));
+    FlowKey key;
+    return make_flow_key(packet.view, key) ? recorder_flow_tag(key) : 0;
+}
+
+static std::string segment_name(const std::string& directory, uint64_t sequence) {
+    char name[64];
+    std::snprintf(name, sizeof(name), RECORDER_SEGMENT_PREFIX "%012llu" RECORDER_SEGMENT_SUFFIX,
+                  static_cast<unsigned long long>(sequence));
+    return directory + "/" + name;
+}
+
+// Sequence numbers and sizes of the segment files in a directory, oldest first
+static bool list_segments(const std::string& directory, std::vector<std::pair<uint64_t, uint64_t>>& found) {
+    found.clear();
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        return false;
+    }
+    std::string_view prefix = RECORDER_SEGMENT_PREFIX;
+    std::string_view suffix = RECORDER_SEGMENT_SUFFIX;
+    while (dirent* entry = readdir(dir)) {
+        std::string_view name = entry->d_name;
+        if (name.size() <= prefix.size() + suffix.size() || !name.starts_with(prefix) || !name.ends_with(suffix)) {
+            continue;
+        }
+        std::string_view digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+        uint64_t sequence = 0;
+        bool numeric = true;
+        for (char c : digits) {
+            numeric = numeric && c >= '0' && c <= '9';
+            sequence = sequence * 10 + static_cast<uint64_t>(c - '0');
+        }
+        struct stat info;
+        if (numeric && stat((directory + "/" + std::string(name)).c_str(), &info) == 0 && S_ISREG(info.st_mode)) {
+            found.emplace_back(sequence, static_cast<uint64_t>(info.st_size));
+        }
+    }
+    closedir(dir);
+    std::sort(found.begin(), found.end());
+    return true;
+}
+
+// ---- PacketRecorder ----
+
+PacketRecorder::PacketRecorder(const std::string& directory, const RecorderConfig& config) :
+    ok(false), recorded(0), dropped(0), truncated(0),
+    blocks_written(0), raw_bytes(0), stored_bytes(0), segments_closed(0), segments_deleted(0), write_errors(0),
+    config(config), directory(directory), queue_mask(0), queue_head(0), cached_tail(0), queue_tail(0),
+    stopping(false), closed(true), disk_bytes(0), next_sequence(0), fd(-1), segment_offset(0),
+    trailer{}, block_header{}, block_started_ns(0)
+{
+    RecorderConfig& c = this->config;
+    c.snaplen = c.snaplen == 0 ? RECORDER_DEFAULT_SNAPLEN : c.snaplen;
+    c.block_size = std::clamp<uint32_t>(c.block_size, RECORDER_MIN_BLOCK_SIZE, RECORDER_MAX_BLOCK_SIZE);
+    c.segment_size = c.segment_size < c.block_size ? c.block_size : c.segment_size;
+
+    // Room for a few of the largest entries, whatever was asked for
+    size_t largest_entry = round_up(sizeof(RecorderRecordHeader) + c.snaplen, RECORDER_QUEUE_ALIGN);
+    size_t minimum = std::max<size_t>(RECORDER_MIN_QUEUE_SIZE, 4 * largest_entry);
+    size_t capacity = RECORDER_MIN_QUEUE_SIZE;
+    while (capacity < c.queue_size || capacity < minimum) {
+        capacity <<= 1;
+    }
+    queue_mask = capacity - 1;
+
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        return;
+    }
+    std::vector<std::pair<uint64_t, uint64_t>> existing;
+    if (!list_segments(directory, existing)) {
+        return;
+    }
+    uint64_t total = 0;
+    for (const auto& [sequence, bytes] : existing) {
+        segments.push_back(Segment{sequence, bytes});
+        total += bytes;
+        next_sequence = sequence + 1;
+    }
+    disk_bytes.store(total, std::memory_order_relaxed);
+
+    queue = std::make_unique<uint64_t[]>(capacity / sizeof(uint64_t));
+    block.reserve(c.block_size + sizeof(RecorderRecordHeader) + c.snaplen);
+    compressed.resize(block_compress_bound(block.capacity()));
+
+    closed = false;
+    ok = true;
+    writer = std::thread(&PacketRecorder::run, this);
+}
+
+PacketRecorder::~PacketRecorder() {
+    close();
+}
+
+bool PacketRecorder::record(uint64_t timestamp_ns, std::span<const uint8_t> frame, uint32_t original_length) {
+    if (closed) {
+        return false;
+    }
+    uint32_t length = static_cast<uint32_t>(frame.size() < config.snaplen ? frame.size() : config.snaplen);
+    if (length < frame.size()) {
+        truncated++;
+    }
+
+    size_t capacity = queue_mask + 1;
+    size_t entry = round_up(sizeof(RecorderRecordHeader) + length, RECORDER_QUEUE_ALIGN);
+    uint64_t head = queue_head.load(std::memory_order_relaxed);
+    size_t offset = head & queue_mask;
+    size_t to_end = capacity - offset;
+    size_t needed = entry <= to_end ? entry : to_end + entry;
+    if (head + needed - cached_tail > capacity) {
+        cached_tail = queue_tail.load(std::memory_order_acquire);
+        if (head + needed - cached_tail > capacity) {
+            dropped++;
+            return false;
+        }
+    }
+
+    uint8_t* ring = reinterpret_cast<uint8_t*>(queue.get());
+    if (entry > to_end) {
+        if (to_end >= sizeof(RecorderRecordHeader)) {
+            RecorderRecordHeader pad{0, 0, RECORDER_QUEUE_PAD};
+            std::memcpy(ring + offset, &pad, sizeof(pad));
+        }
+        head += to_end;
+        offset = 0;
+    }
+    RecorderRecordHeader header{timestamp_ns, original_length ? original_length : static_cast<uint32_t>(frame.size()),
+                                length};
+    std::memcpy(ring + offset, &header, sizeof(header));
+    if (length > 0) {
+        std::memcpy(ring + offset + sizeof(header), frame.data(), length);
+    }
+    queue_head.store(head + entry, std::memory_order_release);
+    recorded++;
+    return true;
+}
+
+size_t PacketRecorder::queue_used() const {
+    return static_cast<size_t>(queue_head.load(std::memory_order_relaxed) -
+                               queue_tail.load(std::memory_order_relaxed));
+}
+
+bool PacketRecorder::close() {
+    if (closed) {
+        return ok && write_errors.load(std::memory_order_relaxed) == 0;
+    }
+    closed = true;
+    stopping.store(true, std::memory_order_release);
+    if (writer.joinable()) {
+        writer.join();
+    }
+    return write_errors.load(std::memory_order_relaxed) == 0;
+}
+
+void PacketRecorder::run() {
+    for (;;) {
+        // Read before draining: every record() that happened before close() is visible to this drain
+        bool stop = stopping.load(std::memory_order_acquire);
+        if (drain() > 0) {
+            continue;
+        }
+        if (stop) {
+            break;
+        }
+        if (block_header.records > 0 && monotonic_ns() - block_started_ns >= config.flush_ns) {
+            write_block();
+            if (out && !out->flush()) {
+                write_errors.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(RECORDER_IDLE_SLEEP_US));
+    }
+    write_block();
+    close_segment();
+}
+
+size_t PacketRecorder::drain() {
+    const uint8_t* ring = reinterpret_cast<const uint8_t*>(queue.get());
+    size_t capacity = queue_mask + 1;
+    uint64_t tail = queue_tail.load(std::memory_order_relaxed);
+    uint64_t head = queue_head.load(std::memory_order_acquire);
+    size_t drained = 0;
+
+    while (tail != head) {
+        size_t offset = tail & queue_mask;
+        size_t to_end = capacity - offset;
+        RecorderRecordHeader header;
+        if (to_end >= sizeof(header)) {
+            std::memcpy(&header, ring + offset, sizeof(header));
+        }
+        if (to_end < sizeof(header) || header.length == RECORDER_QUEUE_PAD) {
+            tail += to_end;
+            continue;
+        }
+        const uint8_t* data = ring + offset + sizeof(header);
+        append(header, data, frame_flow_tag(data, header.length));
+        tail += round_up(sizeof(header) + header.length, RECORDER_QUEUE_ALIGN);
+        queue_tail.store(tail, std::memory_order_release);
+        drained++;
+    }
+    return drained;
+}
+
+void PacketRecorder::append(const RecorderRecordHeader& header, const uint8_t* data, uint32_t flow) {
+    size_t bytes = sizeof(header) + header.length;
+    if (block_header.records > 0 && block.size() + bytes > config.block_size) {
+        write_block();
+    }
+    if (block_header.records == 0) {
+        block_header.min_ns = header.timestamp_ns;
+        block_header.max_ns = header.timestamp_ns;
+        block_started_ns = monotonic_ns();
+    }
+    block_header.min_ns = std::min(block_header.min_ns, header.timestamp_ns);
+    block_header.max_ns = std::max(block_header.max_ns, header.timestamp_ns);
+    block_header.records++;
+
+    const uint8_t* h = reinterpret_cast<const uint8_t*>(&header);
+    block.insert(block.end(), h, h + sizeof(header));
+    block.insert(block.end(), data, data + header.length);
+    if (flow) {
+        block_flows.push_back(flow);
+    }
+}
+
+std::string PacketRecorder::segment_path(uint64_t sequence) const {
+    return segment_name(directory, sequence);
+}
+
+void PacketRecorder::enforce_budget(uint64_t incoming) {
+    while (!segments.empty() && disk_bytes.load(std::memory_order_relaxed) + incoming > config.disk_budget) {
+        const Segment& oldest = segments.front();
+        if (unlink(segment_path(oldest.sequence).c_str()) != 0 && errno != ENOENT) {
+            write_errors.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        disk_bytes.fetch_sub(oldest.bytes, std::memory_order_relaxed);
+        segments.erase(segments.begin());
+        segments_deleted.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool PacketRecorder::open_segment() {
+    // A segment can run past segment_size by one block and its footer
+    enforce_budget(config.segment_size + block_compress_bound(config.block_size));
+
+    uint64_t sequence = next_sequence++;
+    fd = ::open(segment_path(sequence).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    out = std::make_unique<OutputBuffer>(fd);
+
+    RecorderSegmentHeader header{};
+    std::memcpy(header.magic, RECORDER_MAGIC, sizeof(header.magic));
+    header.version = RECORDER_VERSION;
+    header.sequence = sequence;
+    out->append(bytes_view(&header, sizeof(header)));
+    segment_offset = sizeof(header);
+    disk_bytes.fetch_add(sizeof(header), std::memory_order_relaxed);
+
+    trailer = RecorderSegmentTrailer{};
+    trailer.min_ns = UINT64_MAX;
+    blocks.clear();
+    flows.clear();
+    return true;
+}
+
+void PacketRecorder::write_block() {
+    if (block_header.records == 0) {
+        return;
+    }
+    if (fd < 0 && !open_segment()) {
+        // Nowhere to write: the block is lost, the next one tries again
+        write_errors.fetch_add(1, std::memory_order_relaxed);
+        block.clear();
+        block_flows.clear();
+        block_header = RecorderBlockHeader{};
+        return;
+    }
+
+    size_t size = block_compress(block.data(), block.size(), compressed.data(), compressed.size());
+    bool shrunk = size > 0 && size < block.size();
+    const uint8_t* payload = shrunk ? compressed.data() : block.data();
+    block_header.raw_size = static_cast<uint32_t>(block.size());
+    block_header.stored_size = static_cast<uint32_t>(shrunk ? size : block.size());
+    block_header.compressed = shrunk ? 1 : 0;
+
+    uint32_t number = static_cast<uint32_t>(blocks.size());
+    blocks.push_back(RecorderBlockIndex{segment_offset, block_header});
+    std::sort(block_flows.begin(), block_flows.end());
+    block_flows.erase(std::unique(block_flows.begin(), block_flows.end()), block_flows.end());
+    for (uint32_t flow : block_flows) {
+        flows.push_back(RecorderFlowEntry{flow, number});
+    }
+
+    out->append(bytes_view(&block_header, sizeof(block_header)));
+    out->append(bytes_view(payload, block_header.stored_size));
+    uint64_t written = sizeof(block_header) + block_header.stored_size;
+    segment_offset += written;
+    disk_bytes.fetch_add(written, std::memory_order_relaxed);
+    stored_bytes.fetch_add(written, std::memory_order_relaxed);
+    raw_bytes.fetch_add(block.size(), std::memory_order_relaxed);
+    blocks_written.fetch_add(1, std::memory_order_relaxed);
+
+    trailer.min_ns = std::min(trailer.min_ns, block_header.min_ns);
+    trailer.max_ns = std::max(trailer.max_ns, block_header.max_ns);
+    trailer.records += block_header.records;
+
+    block.clear();
+    block_flows.clear();
+    block_header = RecorderBlockHeader{};
+    if (segment_offset >= config.segment_size) {
+        close_segment();
+    }
+}
+
+void PacketRecorder::close_segment() {
+    if (fd < 0) {
+        return;
+    }
+    std::sort(flows.begin(), flows.end(), [](const RecorderFlowEntry& a, const RecorderFlowEntry& b) {
+        return a.flow != b.flow ? a.flow < b.flow : a.block < b.block;
+    });
+    trailer.footer_offset = segment_offset;
+    trailer.block_count = static_cast<uint32_t>(blocks.size());
+    trailer.flow_count = static_cast<uint32_t>(flows.size());
+    trailer.version = RECORDER_VERSION;
+    std::memcpy(trailer.magic, RECORDER_MAGIC, sizeof(trailer.magic));
+    out->append(bytes_view(blocks.data(), blocks.size() * sizeof(RecorderBlockIndex)));
+    out->append(bytes_view(flows.data(), flows.size() * sizeof(RecorderFlowEntry)));
+    out->append(bytes_view(&trailer, sizeof(trailer)));
+    uint64_t footer = blocks.size() * sizeof(RecorderBlockIndex) + flows.size() * sizeof(RecorderFlowEntry) +
+                      sizeof(trailer);
+    segment_offset += footer;
+    disk_bytes.fetch_add(footer, std::memory_order_relaxed);
+    stored_bytes.fetch_add(footer, std::memory_order_relaxed);
+
+    if (!out->flush() || fdatasync(fd) != 0) {
+        write_errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    out.reset();
+    ::close(fd);
+    fd = -1;
+    segments.push_back(Segment{next_sequence - 1, segment_offset});
+    segments_closed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PacketRecorder::print() const {
+    uint64_t raw = raw_bytes.load(std::memory_order_relaxed);
+    uint64_t stored = stored_bytes.load(std::memory_order_relaxed);
+    std::cout << "=== PACKET RECORDER ===\n";
+    std::cout << "Recorded: " << recorded << " Dropped: " << dropped << " Truncated: " << truncated << '\n';
+    std::cout << "Blocks: " << blocks_written.load(std::memory_order_relaxed) << " Raw: " << raw
+              << " bytes Stored: " << stored << " bytes ("
+              << (stored ? static_cast<double>(raw) / static_cast<double>(stored) : 0.0) << "x)\n";
+    std::cout << "Segments: " << segments_closed.load(std::memory_order_relaxed) << " closed, "
+              << segments_deleted.load(std::memory_order_relaxed) << " deleted, " << segments.size()
+              << " on disk (" << disk_used() << " of " << config.disk_budget << " bytes)\n";
+    std::cout << "Write errors: " << write_errors.load(std::memory_order_relaxed) << '\n';
+}
+
+// ---- RecordingReader ----
+
+RecordingReader::RecordingReader(const std::string& directory, uint64_t from_ns, uint64_t to_ns,
+                                 const FlowKey* flow) :
+    ok(false), corrupt(false), segments_read(0), blocks_decoded(0), blocks_skipped(0), records(0),
+    directory(directory), segment_index(0), from_ns(from_ns), to_ns(to_ns), filter_flow(flow != nullptr),
+    flow{}, flow_tag(0), fd(-1), block_index(0), raw_length(0), position(0)
+{
+    if (flow) {
+        this->flow = *flow;
+        flow_tag = recorder_flow_tag(*flow);
+    }
+    std::vector<std::pair<uint64_t, uint64_t>> found;
+    if (!list_segments(directory, found)) {
+        return;
+    }
+    for (const auto& entry : found) {
+        sequences.push_back(entry.first);
+    }
+    ok = true;
+}
+
+RecordingReader::~RecordingReader() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+bool RecordingReader::open_segment() {
+    while (segment_index < sequences.size()) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        blocks.clear();
+        block_index = 0;
+        // Deleted by the recorder since the listing: just gone
+        fd = ::open(segment_name(directory, sequences[segment_index++]).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+
+        RecorderSegmentHeader header;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+            std::memcmp(header.magic, RECORDER_MAGIC, sizeof(header.magic)) != 0 || header.version != RECORDER_VERSION) {
+            continue;
+        }
+        uint64_t size = static_cast<uint64_t>(info.st_size);
+
+        RecorderSegmentTrailer trailer;
+        bool indexed = size >= sizeof(header) + sizeof(trailer) &&
+                       pread(fd, &trailer, sizeof(trailer), static_cast<off_t>(size - sizeof(trailer))) ==
+                           static_cast<ssize_t>(sizeof(trailer)) &&
+                       std::memcmp(trailer.magic, RECORDER_MAGIC, sizeof(trailer.magic)) == 0 &&
+                       trailer.version == RECORDER_VERSION &&
+                       trailer.footer_offset + uint64_t(trailer.block_count) * sizeof(RecorderBlockIndex) +
+                           uint64_t(trailer.flow_count) * sizeof(RecorderFlowEntry) + sizeof(trailer) == size;
+
+        if (indexed) {
+            if (trailer.block_count == 0 || trailer.max_ns < from_ns || trailer.min_ns >= to_ns) {
+                blocks_skipped += trailer.block_count;
+                continue;
+            }
+            std::vector<RecorderBlockIndex> index(trailer.block_count);
+            size_t index_bytes = index.size() * sizeof(RecorderBlockIndex);
+            if (pread(fd, index.data(), index_bytes, static_cast<off_t>(trailer.footer_offset)) !=
+                static_cast<ssize_t>(index_bytes)) {
+                corrupt = true;
+                continue;
+            }
+
+            // Only the blocks the flow index names, in block order
+            std::vector<uint8_t> wanted(index.size(), filter_flow ? 0 : 1);
+            if (filter_flow) {
+                std::vector<RecorderFlowEntry> entries(trailer.flow_count);
+                size_t entry_bytes = entries.size() * sizeof(RecorderFlowEntry);
+                if (pread(fd, entries.data(), entry_bytes, static_cast<off_t>(trailer.footer_offset + index_bytes)) !=
+                    static_cast<ssize_t>(entry_bytes)) {
+                    corrupt = true;
+                    continue;
+                }
+                auto it = std::lower_bound(entries.begin(), entries.end(), flow_tag,
+                                           [](const RecorderFlowEntry& e, uint32_t tag) { return e.flow < tag; });
+                for (; it != entries.end() && it->flow == flow_tag; ++it) {
+                    if (it->block < wanted.size()) {
+                        wanted[it->block] = 1;
+                    }
+                }
+            }
+            for (size_t i = 0; i < index.size(); i++) {
+                const RecorderBlockHeader& b = index[i].header;
+                if (wanted[i] && b.max_ns >= from_ns && b.min_ns < to_ns) {
+                    blocks.push_back(index[i]);
+                }
+            }
+            blocks_skipped += index.size() - blocks.size();
+        }
+        else {
+            // Live or cut short: every complete block, filtered by time only
+            uint64_t offset = sizeof(header);
+            RecorderBlockIndex entry;
+            while (offset + sizeof(entry.header) <= size &&
+                   pread(fd, &entry.header, sizeof(entry.header), static_cast<off_t>(offset)) ==
+                       static_cast<ssize_t>(sizeof(entry.header))) {
+                // Stops at a half-written block, or at footer bytes of a segment whose trailer was cut off
+                const RecorderBlockHeader& b = entry.header;
+                bool plausible = b.records > 0 && b.compressed <= 1 && b.raw_size <= RECORDER_MAX_BLOCK_SIZE * 2 &&
+                                 (b.compressed ? b.stored_size < b.raw_size : b.stored_size == b.raw_size) &&
+                                 b.min_ns <= b.max_ns;
+                if (!plausible || offset + sizeof(b) + b.stored_size > size) {
+                    break;
+                }
+                entry.offset = offset;
+                if (entry.header.max_ns >= from_ns && entry.header.min_ns < to_ns) {
+                    blocks.push_back(entry);
+                }
+                else {
+                    blocks_skipped++;
+                }
+                offset += sizeof(entry.header) + entry.header.stored_size;
+            }
+        }
+        if (!blocks.empty()) {
+            segments_read++;
+            return true;
+        }
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    return false;
+}
+
+bool RecordingReader::load_block() {
+    for (;;) {
+        if (fd >= 0 && block_index < blocks.size()) {
+            const RecorderBlockIndex& entry = blocks[block_index++];
+            const RecorderBlockHeader& b = entry.header;
+            stored.resize(b.stored_size);
+            off_t offset = static_cast<off_t>(entry.offset + sizeof(RecorderBlockHeader));
+            bool valid = pread(fd, stored.data(), stored.size(), offset) == static_cast<ssize_t>(stored.size());
+            if (valid && b.compressed) {
+                raw.resize(b.raw_size);
+                valid = block_decompress(stored.data(), stored.size(), raw.data(), raw.size()) == b.raw_size;
+            }
+            else if (valid) {
+                raw.swap(stored);
+            }
+            if (!valid) {
+                corrupt = true;
+                block_index = blocks.size();
+                continue;
+            }
+            raw_length = b.raw_size;
+            position = 0;
+            blocks_decoded++;
+            return true;
+        }
+        if (!open_segment()) {
+            return false;
+        }
+    }
+}
+
+bool RecordingReader::next(RecordedPacket& packet) {
+    if (!ok) {
+        return false;
+    }
+    for (;;) {
+        while (position < raw_length) {
+            RecorderRecordHeader header;
+            if (raw_length - position < sizeof(header)) {
+                corrupt = true;
+                position = raw_length;
+                break;
+            }
+            std::memcpy(&header, raw.data() + position, sizeof(header));
+            if (header.length > raw_length - position - sizeof(header)) {
+                corrupt = true;
+                position = raw_length;
+                break;
+            }
+            std::span<const uint8_t> data(raw.data() + position + sizeof(header), header.length);
+            position += sizeof(header) + header.length;
+
+            if (header.timestamp_ns < from_ns || header.timestamp_ns >= to_ns) {
+                continue;
+            }
+            if (filter_flow) {
+                ParsedPacket parsed = parse_packet(data);
+                FlowKey key;
+                if (!make_flow_key(parsed.view, key) || !same_flow(key, flow)) {
+                    continue;
+                }
+            }
+            packet.timestamp_ns = header.timestamp_ns;
+            packet.original_length = header.original_length;
+            packet.data = data;
+            records++;
+            return true;
+        }
+        if (!load_block()) {
+            return false;
+        }
+    }
+}
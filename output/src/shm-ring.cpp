@@ -0,0 +1,294 @@
+#include "shm-ring.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SHM_RING_LIVENESS_SPINS 4096
+
+/*
+    Shared-Memory Ring Implementation
+    - Single producer, up to SHM_RING_MAX_CONSUMERS consumer processes, one POSIX shm object
+    - Every slot carries a per-slot sequence word used as a seqlock: odd while the producer writes it,
+      even (2s+2) once sequence s is complete; write_sequence is advanced after the slot is published
+    - Consumers read in place and re-check the slot word afterwards, so DROP mode never stalls the producer
+    - BLOCK mode waits on the slowest live consumer cursor; the minimum is cached and only rescanned
+      when the producer gets a full ring ahead of it, and dead consumer processes are evicted
+*/
+
+static std::string shm_name(const std::string& name) {
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+static uint32_t round_pow2(uint32_t value) {
+    uint32_t result = 2;
+    while (result < value && result < (1u << 31)) {
+        result <<= 1;
+    }
+    return result;
+}
+
+static uint32_t slot_bytes(uint32_t max_frame) {
+    return static_cast<uint32_t>((sizeof(ShmSlot) + max_frame + 63) / 64 * 64);
+}
+
+static bool process_gone(int32_t pid) {
+    return pid > 0 && kill(pid, 0) != 0 && errno == ESRCH;
+}
+
+// ---- ShmRingProducer ----
+
+ShmRingProducer::ShmRingProducer(const std::string& name, const ShmRingConfig& config) :
+    ok(false), published(0), blocked_waits(0),
+    name(shm_name(name)), header(nullptr), slots(nullptr), mapped_size(0), mask(0), min_cursor(0)
+{
+    uint32_t slot_count = round_pow2(config.slot_count);
+    uint32_t slot_size = slot_bytes(config.max_frame);
+    mapped_size = sizeof(ShmRingHeader) + static_cast<size_t>(slot_count) * slot_size;
+
+    shm_unlink(this->name.c_str());
+    int fd = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        return;
+    }
+    if (ftruncate(fd, static_cast<off_t>(mapped_size)) != 0) {
+        ::close(fd);
+        shm_unlink(this->name.c_str());
+        return;
+    }
+    void* memory = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        shm_unlink(this->name.c_str());
+        return;
+    }
+
+    // ftruncate zero-fills: all slot words, cursors and flags start at 0
+    header = static_cast<ShmRingHeader*>(memory);
+    slots = static_cast<uint8_t*>(memory) + sizeof(ShmRingHeader);
+    mask = slot_count - 1;
+
+    header->version = SHM_RING_VERSION;
+    header->slot_count = slot_count;
+    header->slot_size = slot_size;
+    header->max_frame = config.max_frame;
+    header->policy = config.policy;
+    header->producer_pid = getpid();
+    header->write_sequence.store(0, std::memory_order_relaxed);
+    header->magic.store(SHM_RING_MAGIC, std::memory_order_release);
+    ok = true;
+}
+
+ShmRingProducer::~ShmRingProducer() {
+    if (header) {
+        munmap(header, mapped_size);
+        shm_unlink(name.c_str());
+    }
+}
+
+uint64_t ShmRingProducer::slowest_cursor() {
+    uint64_t slowest = published;
+    for (size_t i = 0; i < SHM_RING_MAX_CONSUMERS; i++) {
+        ShmConsumerState& consumer = header->consumers[i];
+        if (consumer.owner.load(std::memory_order_acquire)) {
+            uint64_t cursor = consumer.cursor.load(std::memory_order_acquire);
+            slowest = cursor < slowest ? cursor : slowest;
+        }
+    }
+    return slowest;
+}
+
+void ShmRingProducer::wait_for_space(uint64_t sequence) {
+    uint64_t slot_count = mask + 1;
+    if (sequence - min_cursor < slot_count) {
+        return;
+    }
+    min_cursor = slowest_cursor();
+    if (sequence - min_cursor < slot_count) {
+        return;
+    }
+
+    blocked_waits++;
+    for (uint64_t spins = 1; sequence - min_cursor >= slot_count; spins++) {
+        if (spins % SHM_RING_LIVENESS_SPINS == 0) {
+            for (size_t i = 0; i < SHM_RING_MAX_CONSUMERS; i++) {
+                ShmConsumerState& consumer = header->consumers[i];
+                int32_t owner = consumer.owner.load(std::memory_order_acquire);
+                // CAS so a slot another consumer claimed meanwhile is left alone
+                if (process_gone(owner)) {
+                    consumer.owner.compare_exchange_strong(owner, 0, std::memory_order_acq_rel);
+                }
+            }
+        }
+        sched_yield();
+        min_cursor = slowest_cursor();
+    }
+}
+
+bool ShmRingProducer::publish(uint64_t timestamp_ns, const PacketView& view, const PacketValidator* validator) {
+    if (!ok) {
+        return false;
+    }
+
+    uint64_t sequence = published;
+    if (header->policy == ShmOverflowPolicy::BLOCK) {
+        wait_for_space(sequence);
+    }
+
+    ShmSlot* slot = reinterpret_cast<ShmSlot*>(slots + (sequence & mask) * header->slot_size);
+    slot->state.store(2 * sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    make_packet_metadata(timestamp_ns, view, validator, slot->metadata);
+    uint32_t frame_length = static_cast<uint32_t>(view.size() < header->max_frame ? view.size() : header->max_frame);
+    if (frame_length) {
+        std::memcpy(reinterpret_cast<uint8_t*>(slot + 1), view.data, frame_length);
+    }
+    slot->frame_length = frame_length;
+
+    slot->state.store(2 * sequence + 2, std::memory_order_release);
+    header->write_sequence.store(sequence + 1, std::memory_order_release);
+    published++;
+    return true;
+}
+
+// ---- ShmRingConsumer ----
+
+ShmRingConsumer::ShmRingConsumer(const std::string& name) :
+    ok(false), received(0), dropped(0),
+    header(nullptr), slots(nullptr), mapped_size(0), mask(0), index(-1), cursor(0), reading(false)
+{
+    int fd = shm_open(shm_name(name).c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ShmRingHeader)) {
+        ::close(fd);
+        return;
+    }
+    mapped_size = static_cast<size_t>(st.st_size);
+    void* memory = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        return;
+    }
+    header = static_cast<ShmRingHeader*>(memory);
+    slots = static_cast<uint8_t*>(memory) + sizeof(ShmRingHeader);
+
+    if (header->magic.load(std::memory_order_acquire) != SHM_RING_MAGIC ||
+        header->version != SHM_RING_VERSION ||
+        header->slot_size < slot_bytes(header->max_frame) ||
+        sizeof(ShmRingHeader) + static_cast<size_t>(header->slot_count) * header->slot_size > mapped_size) {
+        return;
+    }
+    mask = header->slot_count - 1;
+
+    // The slot is claimed with our pid in one CAS, so the producer never sees an active slot without its owner
+    int32_t pid = getpid();
+    for (int i = 0; i < SHM_RING_MAX_CONSUMERS; i++) {
+        int32_t expected = 0;
+        if (header->consumers[i].owner.compare_exchange_strong(expected, pid, std::memory_order_acq_rel)) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        return;
+    }
+
+    ShmConsumerState& state = header->consumers[index];
+    cursor = header->write_sequence.load(std::memory_order_acquire);
+    state.dropped.store(0, std::memory_order_relaxed);
+    state.cursor.store(cursor, std::memory_order_release);
+    ok = true;
+}
+
+ShmRingConsumer::~ShmRingConsumer() {
+    if (header) {
+        if (index >= 0) {
+            header->consumers[index].owner.store(0, std::memory_order_release);
+        }
+        munmap(header, mapped_size);
+    }
+}
+
+bool ShmRingConsumer::next(ShmRecord& record) {
+    if (!ok) {
+        return false;
+    }
+    if (reading) {
+        release();
+    }
+
+    uint64_t slot_count = mask + 1;
+    for (;;) {
+        uint64_t written = header->write_sequence.load(std::memory_order_acquire);
+        if (cursor == written) {
+            return false;
+        }
+
+        // Lapped (DROP): everything older than one ring behind the producer is gone
+        if (written - cursor > slot_count) {
+            uint64_t lost = written - slot_count - cursor;
+            dropped += lost;
+            header->consumers[index].dropped.fetch_add(lost, std::memory_order_relaxed);
+            cursor = written - slot_count;
+        }
+
+        const ShmSlot* slot = reinterpret_cast<const ShmSlot*>(slots + (cursor & mask) * header->slot_size);
+        uint64_t state = slot->state.load(std::memory_order_acquire);
+        if (state != 2 * cursor + 2) {
+            // Being rewritten for a later sequence, skip it
+            dropped++;
+            header->consumers[index].dropped.fetch_add(1, std::memory_order_relaxed);
+            cursor++;
+            continue;
+        }
+
+        uint32_t frame_length = slot->frame_length < header->max_frame ? slot->frame_length : header->max_frame;
+        record.sequence = cursor;
+        record.metadata = &slot->metadata;
+        record.frame = std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(slot + 1), frame_length);
+        reading = true;
+        return true;
+    }
+}
+
+bool ShmRingConsumer::release() {
+    if (!reading) {
+        return false;
+    }
+    reading = false;
+
+    const ShmSlot* slot = reinterpret_cast<const ShmSlot*>(slots + (cursor & mask) * header->slot_size);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    bool intact = slot->state.load(std::memory_order_relaxed) == 2 * cursor + 2;
+
+    cursor++;
+    header->consumers[index].cursor.store(cursor, std::memory_order_release);
+    if (intact) {
+        received++;
+    }
+    else {
+        dropped++;
+        header->consumers[index].dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    return intact;
+}
+
+bool ShmRingConsumer::producer_alive() const {
+    return header && !process_gone(header->producer_pid);
+}
+
+uint64_t ShmRingConsumer::backlog() const {
+    if (!ok) {
+        return 0;
+    }
+    uint64_t pending = header->write_sequence.load(std::memory_order_acquire) - cursor;
+    return pending > mask + 1 ? mask + 1 : pending;
+}
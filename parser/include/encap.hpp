@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#define ENCAP_MAX_LAYERS 8
+#define ENCAP_DEFAULT_DEPTH ENCAP_MAX_LAYERS
+
+// Encapsulation headers peeled off in front of the innermost packet
+enum class EncapType : uint8_t {
+    NONE,
+    VLAN,           // 802.1Q C-tag
+    QINQ,           // 802.1ad S-tag (or the legacy 0x9100 tag)
+    MPLS,           // one label stack entry
+    GRE,
+    VXLAN,
+    IPV4,           // outer IPv4 header carrying a tunnel
+    IPV6,           // outer IPv6 header carrying a tunnel
+    UDP             // outer UDP header carrying a tunnel
+};
+
+// Decoder result, checked by the validation module
+enum class EncapStatus : uint8_t {
+    OK,
+    TRUNCATED,      // a tag / label / tunnel header runs past the captured bytes
+    TOO_DEEP        // the tags / labels / tunnels did not end within the configured depth
+};
+
+// One peeled header: what it is and where it starts in the packet
+struct EncapLayer {
+    uint16_t offset;
+    EncapType type;
+};
+
+// Dispatch tables: ethertype / IP protocol / UDP destination port -> decoder case
+// Kept tiny and separate so the common IPv4 TCP packet only pays a compare or two
+struct EncapRule {
+    uint16_t value;
+    EncapType type;
+};
+
+inline constexpr EncapRule ENCAP_ETHERTYPE_RULES[] = {
+    { 0x8100, EncapType::VLAN },
+    { 0x88A8, EncapType::QINQ },
+    { 0x9100, EncapType::QINQ },
+    { 0x8847, EncapType::MPLS },        // unicast
+    { 0x8848, EncapType::MPLS }         // multicast
+};
+
+inline constexpr EncapRule ENCAP_IP_PROTOCOL_RULES[] = {
+    { 47, EncapType::GRE }
+};
+
+inline constexpr EncapRule ENCAP_UDP_PORT_RULES[] = {
+    { 4789, EncapType::VXLAN }
+};
+
+template <size_t N>
+constexpr EncapType encap_lookup(const EncapRule (&rules)[N], uint16_t value) {
+    for (size_t i = 0; i < N; i++) {
+        if (rules[i].value == value) {
+            return rules[i].type;
+        }
+    }
+    return EncapType::NONE;
+}
+
+std::string_view encap_type_name(EncapType type);
+
+// Identifier carried by the header at data + layer.offset (VLAN ID, MPLS label, VXLAN VNI, GRE key),
+// 0 when the type has none
+uint32_t encap_id(const uint8_t* data, const EncapLayer& layer);
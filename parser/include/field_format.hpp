@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Longest strings produced by the formatters below (no terminator is written)
+#define MAC_STRING_LENGTH 17
+#define IPV4_STRING_MAX_LENGTH 15
+#define IPV6_STRING_MAX_LENGTH 39
+
+// Table-driven header field formatting shared by print() and the output module
+// - no allocation, no locale, no iostream state
+
+// "AA:BB:CC:DD:EE:FF" -> always MAC_STRING_LENGTH bytes
+size_t format_mac(const uint8_t* mac, char* out);
+
+// Dotted quad from a network byte order address, returns the length written
+size_t format_ipv4(uint32_t addr, char* out);
+
+// RFC 5952 text (lower case, longest zero run compressed to "::"), returns the length written
+size_t format_ipv6(const uint8_t* addr, char* out);
+
+// Space separated flag names ("SYN ACK"), empty view for no flags
+std::string_view tcp_flags_string(uint8_t flags);
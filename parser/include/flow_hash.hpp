@@ -0,0 +1,65 @@
+#pragma once
+#include "flow_key.hpp"
+#include <cstddef>
+#include <cstdint>
+
+#define RSS_KEY_SIZE 40
+#define RSS_IPV4_TUPLE_SIZE 12      // src addr, dest addr, src port, dest port (network order)
+
+// Microsoft RSS verification key, the default of most NIC drivers
+inline constexpr uint8_t RSS_DEFAULT_KEY[RSS_KEY_SIZE] = {
+    0x6D, 0x5A, 0x56, 0xDA, 0x25, 0x5B, 0x0E, 0xC2, 0x41, 0x67,
+    0x25, 0x3D, 0x43, 0xA3, 0x8F, 0xB0, 0xD0, 0xCA, 0x2B, 0xCB,
+    0xAE, 0x7B, 0x30, 0xB4, 0x77, 0xCB, 0x2D, 0xA3, 0x80, 0x30,
+    0xF2, 0x0C, 0x6A, 0x42, 0xB7, 0x3B, 0xBE, 0xAC, 0x01, 0xFA
+};
+
+// 0x6D5A repeated: a key with a 16 bit period hashes a tuple and its reverse to the same value
+// (symmetric RSS), so both directions of a connection land on the same NIC queue
+inline constexpr uint8_t RSS_SYMMETRIC_KEY[RSS_KEY_SIZE] = {
+    0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A,
+    0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A,
+    0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A,
+    0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A
+};
+
+// A batch of tuples stored column by column, e.g. decoded once for a burst of packets
+struct FlowColumns {
+    const uint32_t* src_addr;
+    const uint32_t* dest_addr;
+    const uint16_t* src_port;
+    const uint16_t* dest_port;
+    const uint8_t* protocol;
+};
+
+// Bit-serial Toeplitz hash as written in the RSS spec, any input up to key_len - 4 bytes
+uint32_t toeplitz_hash(const uint8_t* key, size_t key_len, const uint8_t* data, size_t len);
+
+// Table-driven Toeplitz over the IPv4 4-tuple: twelve lookups and XORs per tuple
+// - Matches what an RSS NIC computes for TCP/UDP over IPv4 with the same key (protocol is not hashed)
+// - Only as symmetric as the key, use RSS_SYMMETRIC_KEY for direction-independent placement
+class ToeplitzHasher {
+public:
+    ToeplitzHasher(const uint8_t* key = RSS_SYMMETRIC_KEY);
+
+    uint32_t hash(const FlowKey& key) const;
+    void hash_batch(const FlowColumns& columns, size_t n, uint32_t* out) const;
+
+private:
+    uint32_t table[RSS_IPV4_TUPLE_SIZE][256];
+};
+
+// Software hashes below are symmetric by construction: the two addr:port endpoints are put in order
+// before hashing, so a tuple and its reverse always collide and nothing else is special about them
+
+// Multiply-shift over the ordered endpoints plus a 64 bit finalizer; the default for flow tables and sampling
+// flow_hash_batch takes the AVX2 path when the CPU has it, flow_hash_batch_scalar is the portable loop
+uint64_t flow_hash(const FlowKey& key, uint64_t seed = 0);
+void flow_hash_batch(const FlowColumns& columns, size_t n, uint64_t seed, uint64_t* out);
+void flow_hash_batch_scalar(const FlowColumns& columns, size_t n, uint64_t seed, uint64_t* out);
+bool flow_hash_batch_avx2();
+
+// CRC32C of the ordered endpoints, on the SSE4.2 crc32 instruction when the CPU has it
+uint32_t flow_hash_crc32c(const FlowKey& key, uint32_t seed = 0);
+void flow_hash_crc32c_batch(const FlowColumns& columns, size_t n, uint32_t seed, uint32_t* out);
+bool flow_hash_crc32c_hardware();
@@ -0,0 +1,27 @@
+#pragma once
+#include "packet_view.hpp"
+#include <cstdint>
+
+// Transport 5-tuple of an IPv4 or IPv6 packet (host byte order)
+// Ports are zero for protocols other than TCP/UDP
+// For IPv6, src_addr / dest_addr hold ipv6_fold() of each address so hashes and 32 bit keyed tables work
+// unchanged; the full addresses (wire order) are in src_addr6 / dest_addr6 for exact matching and printing
+struct FlowKey {
+    uint32_t src_addr;
+    uint32_t dest_addr;
+    uint16_t src_port;
+    uint16_t dest_port;
+    uint8_t protocol;
+    bool ipv6 = false;
+    uint8_t src_addr6[16] = {};
+    uint8_t dest_addr6[16] = {};
+};
+
+// Fills key from a parsed packet, false if the packet has no complete IPv4 or IPv6 header
+bool make_flow_key(const PacketView& view, FlowKey& key);
+
+// 32 bit digest of an IPv6 address (16 bytes, wire order)
+uint32_t ipv6_fold(const uint8_t* addr);
+
+// Same addresses, ports and protocol in either direction
+bool same_flow(const FlowKey& a, const FlowKey& b);
@@ -3,8 +3,7 @@
 #include "packet.hpp"
 #include <cstddef>
 #include <cstdint>
-#include <string>
-#include <vector>
+#include <string_view>
 
 
 // LAYER 2 -> Ethernet Layer
@@ -22,7 +21,7 @@ public:
     size_t header_size() const;
 
 private:
-    static std::string print_mac(const uint8_t *mac);
+    static std::string_view print_mac(const uint8_t *mac, char *out);
 };
 
 
@@ -41,7 +40,47 @@ public:
     size_t header_size() const;
 
 private:
-    static std::string print_ip(uint32_t ip);
+    static std::string_view print_ip(uint32_t ip, char *out);
+};
+
+
+// LAYER 3 -> IPv6 Layer
+// Extension header walk result, checked by the validation module
+enum class IPv6ExtensionStatus : uint8_t {
+    OK,
+    TRUNCATED,              // an extension header runs past the captured bytes
+    TOO_MANY,               // more than IPV6_MAX_EXTENSION_HEADERS in the chain
+    MISPLACED_HOP_BY_HOP    // Hop-by-Hop options anywhere but first
+};
+
+#define IPV6_MAX_EXTENSION_HEADERS 8
+
+class IPv6Layer {
+public:
+    const IPv6Header *ip6h;
+
+    // Filled by walk_extensions()
+    uint16_t extension_length;      // bytes of extension headers after the fixed header
+    uint8_t extension_count;
+    uint8_t upper_protocol;         // next header value that ended the walk
+    bool fragment;                  // a Fragment header was present
+    uint16_t fragment_offset;       // in 8 byte units, non-zero means no L4 header in this packet
+    IPv6ExtensionStatus status;
+
+    // Default Constructor, the walk fields are only set once there is a header
+    IPv6Layer() : ip6h(nullptr) {}
+    // IPv6Layer Constructor
+    IPv6Layer(const uint8_t *packet);
+
+    // Walks the extension header chain within available bytes after the fixed header
+    // Bounded by IPV6_MAX_EXTENSION_HEADERS iterations, never allocates
+    void walk_extensions(size_t available);
+
+    void print() const;
+    size_t header_size() const;     // fixed header + extension headers
+
+private:
+    static std::string_view print_ip(const uint8_t *ip, char *out);
 };
 
 
@@ -60,7 +99,7 @@ public:
     size_t header_size() const;
 
 private:
-    static std::vector<std::string> decode_tcp_flags(uint8_t flags);
+    static std::string_view decode_tcp_flags(uint8_t flags);
 };
 
 
@@ -22,6 +22,40 @@ struct IPv4Header {
     uint32_t dest_addr;         // Destination IP address
 };
 
+// LAYER 3 -> IPv6 Header (fixed part, extension headers follow)
+struct IPv6Header {
+    uint32_t version_class_flow;  // Version (4 bits) + Traffic Class (8 bits) + Flow Label (20 bits)
+    uint16_t payload_length;      // Length after this header, extension headers included
+    uint8_t  next_header;         // First extension header or upper-layer protocol
+    uint8_t  hop_limit;
+    uint8_t  src_addr[16];
+    uint8_t  dest_addr[16];
+};
+
+// Generic extension header prefix (Hop-by-Hop, Routing, Destination Options)
+struct IPv6ExtensionHeader {
+    uint8_t next_header;
+    uint8_t length;               // In 8 byte units, not counting the first 8 bytes
+};
+
+// IPv6 Fragment extension header (always 8 bytes)
+struct IPv6FragmentHeader {
+    uint8_t  next_header;
+    uint8_t  reserved;
+    uint16_t offset_flags;        // Fragment offset (13 bits) + 2 reserved + M flag
+    uint32_t identification;
+};
+
+// TCP FLAG OFFSETS
+#define FIN_FLAG 0x01
+#define SYN_FLAG 0x02
+#define RST_FLAG 0x04
+#define PSH_FLAG 0x08
+#define ACK_FLAG 0x10
+#define URG_FLAG 0x20
+#define ECE_FLAG 0x40
+#define CWR_FLAG 0x80
+
 // LAYER 4 -> TCP Header
 struct TCPHeader {
     uint16_t src_port;
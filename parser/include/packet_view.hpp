@@ -1,5 +1,6 @@
 #pragma  once
 #include "layers.hpp"
+#include "encap.hpp"
 #include <cstddef>
 #include <cstdint>
 
@@ -13,26 +14,37 @@ public:
     // Layer Presence Flags
     bool has_eth;
     bool has_ip;
+    bool has_ipv6;
     bool has_tcp;
     bool has_udp;
 
+    // Encapsulation peeled in front of the layers below, outermost first
+    // The outer Ethernet header is always at offset 0, eth_layer is the innermost one
+    EncapLayer encap[ENCAP_MAX_LAYERS];     // only the first encap_count are valid
+    uint8_t encap_count;
+    EncapStatus encap_status;
+    uint16_t ethertype;     // EtherType of the innermost L3 header (host order)
+    size_t l3_offset;       // offset of the innermost IP header in data, 0 if never reached
+
     // Layer Objects
     EthernetLayer eth_layer;
     IPv4Layer ip_layer;
+    IPv6Layer ipv6_layer;
     TCPLayer tcp_layer;
     UDPLayer udp_layer;
     const uint8_t* payload;
     size_t payload_len;
+    size_t l4_offset;       // offset of the L4 header in data, 0 if never reached
 
     // Supported Layer 4 Protocols
     L4Type l4_type;
 
-    // PacketView Constructor
-    PacketView(const uint8_t* packet, size_t length);
+    // PacketView Constructor, max_encap_depth = 0 parses only a bare Ethernet + IP packet
+    PacketView(const uint8_t* packet, size_t length, size_t max_encap_depth = ENCAP_DEFAULT_DEPTH);
 
 
-    // Print Packet Details
-    void print() const;
+    // Print Packet Details, l3_error (a validation_error_name()) is shown when the network layer is invalid
+    void print(const char* l3_error = nullptr) const;
 
     // Get Packet Size
     size_t size() const { return length; }
@@ -40,5 +52,13 @@ public:
     
 // CAN BE IGNORED FOR NOW
 private:
-    void parse_layers();
+    void parse_layers(size_t max_encap_depth);
+    bool parse_ipv6(size_t ip_offset);
+    void parse_transport(uint8_t protocol, size_t offset);
+    bool parse_tunnel(EncapType ip_type, uint8_t protocol, size_t ip_offset, size_t tunnel_offset,
+                      size_t depth, size_t& inner_offset);
+    void parse_inner_ethernet(size_t& offset);
+    void parse_encapsulated(size_t offset, size_t max_encap_depth);
+    bool may_tunnel(uint8_t protocol, size_t transport_offset) const;
+    bool push_encap(EncapType type, size_t offset, size_t depth);
 };
\ No newline at end of file
@@ -8,9 +8,9 @@ public:
     std::span<const uint8_t> buffer;
     PacketView view;
 
-    ParsedPacket(std::span<const uint8_t> buf)
-        : buffer(buf), view(buf.data(), buf.size()) {}
+    ParsedPacket(std::span<const uint8_t> buf, size_t max_encap_depth = ENCAP_DEFAULT_DEPTH)
+        : buffer(buf), view(buf.data(), buf.size(), max_encap_depth) {}
 };
 
-// Main parser API 
-ParsedPacket parse_packet(std::span<const uint8_t> buffer);
+// Main parser API, max_encap_depth bounds how many VLAN/MPLS/tunnel headers are peeled
+ParsedPacket parse_packet(std::span<const uint8_t> buffer, size_t max_encap_depth = ENCAP_DEFAULT_DEPTH);
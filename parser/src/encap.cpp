@@ -0,0 +1,51 @@
+#include "encap.hpp"
+
+#define GRE_FLAG_CHECKSUM 0x8000
+#define GRE_FLAG_KEY 0x2000
+
+/*
+    Encapsulation helpers
+    - Names and identifiers for the layers recorded by PacketView's decoder
+    - The decoder itself lives in packet_view.cpp so the dispatch stays inlined in parse_layers()
+*/
+
+static uint16_t read16(const uint8_t* bytes) {
+    return static_cast<uint16_t>((bytes[0] << 8) | bytes[1]);
+}
+
+std::string_view encap_type_name(EncapType type) {
+    switch (type) {
+        case EncapType::VLAN: return "VLAN";
+        case EncapType::QINQ: return "QinQ";
+        case EncapType::MPLS: return "MPLS";
+        case EncapType::GRE: return "GRE";
+        case EncapType::VXLAN: return "VXLAN";
+        case EncapType::IPV4: return "IPv4";
+        case EncapType::IPV6: return "IPv6";
+        case EncapType::UDP: return "UDP";
+        default: return "NONE";
+    }
+}
+
+uint32_t encap_id(const uint8_t* data, const EncapLayer& layer) {
+    const uint8_t* header = data + layer.offset;
+    switch (layer.type) {
+        case EncapType::VLAN:
+        case EncapType::QINQ:
+            return read16(header) & 0x0FFF;
+        case EncapType::MPLS:
+            return (static_cast<uint32_t>(read16(header)) << 4) | (header[2] >> 4);
+        case EncapType::VXLAN:
+            return (static_cast<uint32_t>(header[4]) << 16) | (header[5] << 8) | header[6];
+        case EncapType::GRE: {
+            uint16_t flags = read16(header);
+            if (!(flags & GRE_FLAG_KEY)) {
+                return 0;
+            }
+            const uint8_t* key = header + 4 + ((flags & GRE_FLAG_CHECKSUM) ? 4 : 0);
+            return (static_cast<uint32_t>(read16(key)) << 16) | read16(key + 2);
+        }
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,136 @@
+#include "field_format.hpp"
+#include <cstring>
+#include <arpa/inet.h>
+
+/*
+    Field Formatting Implementation
+    - Byte -> two hex digits and octet -> decimal text come from small lookup tables
+    - All 256 TCP flag combinations are rendered once, lookups return views into that table
+*/
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+// Decimal text of 0-255, up to 3 chars + length
+struct OctetTable {
+    char text[256][4];
+    uint8_t length[256];
+
+    OctetTable() {
+        for (int i = 0; i < 256; i++) {
+            int n = 0;
+            if (i >= 100) {
+                text[i][n++] = static_cast<char>('0' + i / 100);
+            }
+            if (i >= 10) {
+                text[i][n++] = static_cast<char>('0' + (i / 10) % 10);
+            }
+            text[i][n++] = static_cast<char>('0' + i % 10);
+            length[i] = static_cast<uint8_t>(n);
+        }
+    }
+};
+
+// "FIN SYN RST PSH ACK URG ECE CWR" is the longest combination (31 chars)
+struct TcpFlagTable {
+    char text[256][32];
+    uint8_t length[256];
+
+    TcpFlagTable() {
+        static const char* names[8] = {"FIN", "SYN", "RST", "PSH", "ACK", "URG", "ECE", "CWR"};
+        for (int flags = 0; flags < 256; flags++) {
+            size_t n = 0;
+            for (int bit = 0; bit < 8; bit++) {
+                if (!(flags & (1 << bit))) {
+                    continue;
+                }
+                if (n > 0) {
+                    text[flags][n++] = ' ';
+                }
+                std::memcpy(&text[flags][n], names[bit], 3);
+                n += 3;
+            }
+            length[flags] = static_cast<uint8_t>(n);
+        }
+    }
+};
+
+static const OctetTable octets;
+static const TcpFlagTable tcp_flags;
+
+size_t format_mac(const uint8_t* mac, char* out) {
+    for (int i = 0; i < 6; i++) {
+        out[i * 3] = HEX_DIGITS[mac[i] >> 4];
+        out[i * 3 + 1] = HEX_DIGITS[mac[i] & 0x0F];
+        if (i < 5) {
+            out[i * 3 + 2] = ':';
+        }
+    }
+    return MAC_STRING_LENGTH;
+}
+
+size_t format_ipv4(uint32_t addr, char* out) {
+    uint32_t ip = ntohl(addr);
+    size_t n = 0;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        uint8_t octet = (ip >> shift) & 0xFF;
+        std::memcpy(out + n, octets.text[octet], 3);
+        n += octets.length[octet];
+        if (shift > 0) {
+            out[n++] = '.';
+        }
+    }
+    return n;
+}
+
+size_t format_ipv6(const uint8_t* addr, char* out) {
+    static const char LOWER_HEX[] = "0123456789abcdef";
+    uint16_t groups[8];
+    for (int i = 0; i < 8; i++) {
+        groups[i] = static_cast<uint16_t>(addr[i * 2] << 8 | addr[i * 2 + 1]);
+    }
+
+    // Longest run of two or more zero groups, first one wins a tie
+    int best_start = -1;
+    int best_length = 1;
+    for (int i = 0; i < 8;) {
+        if (groups[i] != 0) {
+            i++;
+            continue;
+        }
+        int start = i;
+        while (i < 8 && groups[i] == 0) {
+            i++;
+        }
+        if (i - start > best_length) {
+            best_start = start;
+            best_length = i - start;
+        }
+    }
+
+    size_t n = 0;
+    for (int i = 0; i < 8; i++) {
+        if (i == best_start) {
+            out[n++] = ':';
+            out[n++] = ':';
+            i += best_length - 1;
+            continue;
+        }
+        if (i > 0 && i != best_start + best_length) {
+            out[n++] = ':';
+        }
+        bool leading = true;
+        for (int shift = 12; shift >= 0; shift -= 4) {
+            uint8_t digit = (groups[i] >> shift) & 0x0F;
+            if (leading && digit == 0 && shift > 0) {
+                continue;
+            }
+            leading = false;
+            out[n++] = LOWER_HEX[digit];
+        }
+    }
+    return n;
+}
+
+std::string_view tcp_flags_string(uint8_t flags) {
+    return std::string_view(tcp_flags.text[flags], tcp_flags.length[flags]);
+}
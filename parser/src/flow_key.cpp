@@ -0,0 +1,70 @@
+#include "flow_key.hpp"
+#include <arpa/inet.h>
+#include <cstring>
+
+static void read_ports(const PacketView& view, FlowKey& key) {
+    key.src_port = 0;
+    key.dest_port = 0;
+    if (view.has_tcp && view.payload_len >= 4) {
+        key.src_port = ntohs(view.tcp_layer.tcph->src_port);
+        key.dest_port = ntohs(view.tcp_layer.tcph->dest_port);
+    }
+    else if (view.has_udp && view.payload_len >= 4) {
+        key.src_port = ntohs(view.udp_layer.udph->src);
+        key.dest_port = ntohs(view.udp_layer.udph->dest);
+    }
+}
+
+// Extracts the 5-tuple without touching bytes the parser did not bounds-check
+bool make_flow_key(const PacketView& view, FlowKey& key) {
+    if (view.has_ip && view.size() >= view.l3_offset + sizeof(IPv4Header)) {
+        key.src_addr = ntohl(view.ip_layer.iph->src_addr);
+        key.dest_addr = ntohl(view.ip_layer.iph->dest_addr);
+        key.protocol = view.ip_layer.iph->protocol;
+        key.ipv6 = false;
+        read_ports(view, key);
+        return true;
+    }
+
+    // The extension walk only runs on a whole fixed header, upper_protocol is valid from there on
+    if (view.has_ipv6 && view.size() >= view.l3_offset + sizeof(IPv6Header)) {
+        const IPv6Header* ip6h = view.ipv6_layer.ip6h;
+        std::memcpy(key.src_addr6, ip6h->src_addr, sizeof(key.src_addr6));
+        std::memcpy(key.dest_addr6, ip6h->dest_addr, sizeof(key.dest_addr6));
+        key.src_addr = ipv6_fold(ip6h->src_addr);
+        key.dest_addr = ipv6_fold(ip6h->dest_addr);
+        key.protocol = view.ipv6_layer.upper_protocol;
+        key.ipv6 = true;
+        read_ports(view, key);
+        return true;
+    }
+    return false;
+}
+
+// Multiply-xorshift over both halves; distinct addresses of one flow table collide with p ~ 2^-32
+uint32_t ipv6_fold(const uint8_t* addr) {
+    uint64_t hi;
+    uint64_t lo;
+    std::memcpy(&hi, addr, sizeof(hi));
+    std::memcpy(&lo, addr + 8, sizeof(lo));
+    uint64_t h = (hi ^ (lo * 0x9E3779B97F4A7C15ULL)) * 0xC2B2AE3D27D4EB4FULL;
+    return static_cast<uint32_t>((h ^ (h >> 29)) >> 32);
+}
+
+bool same_flow(const FlowKey& a, const FlowKey& b) {
+    if (a.protocol != b.protocol || a.ipv6 != b.ipv6) {
+        return false;
+    }
+    bool forward = a.src_addr == b.src_addr && a.dest_addr == b.dest_addr &&
+                   a.src_port == b.src_port && a.dest_port == b.dest_port;
+    bool reverse = a.src_addr == b.dest_addr && a.dest_addr == b.src_addr &&
+                   a.src_port == b.dest_port && a.dest_port == b.src_port;
+    if (!a.ipv6) {
+        return forward || reverse;
+    }
+    // The folds matched, confirm on the full addresses
+    return (forward && std::memcmp(a.src_addr6, b.src_addr6, 16) == 0 &&
+            std::memcmp(a.dest_addr6, b.dest_addr6, 16) == 0) ||
+           (reverse && std::memcmp(a.src_addr6, b.dest_addr6, 16) == 0 &&
+            std::memcmp(a.dest_addr6, b.src_addr6, 16) == 0);
+}
@@ -1,26 +1,18 @@
 #include "layers.hpp"
+#include "field_format.hpp"
 #include <iostream>
 #include <iomanip>
-#include <sstream>
 #include <arpa/inet.h>
 
-// TCP FLAG OFFSETS
-#define FIN_FLAG 0x01
-#define SYN_FLAG 0x02
-#define RST_FLAG 0x04
-#define PSH_FLAG 0x08
-#define ACK_FLAG 0x10
-#define URG_FLAG 0x20
-#define ECE_FLAG 0x40
-#define CWR_FLAG 0x80
-
 /*
     Network Layers Implementation
     - This file constains implementations of the following classes:
         - EthernetLayer
         - IPv4Layer
+        - IPv6Layer
         - TCPLayer
         - UDPLayer
+    - print() writes through std::cout without per-line flushes, field text comes from field_format lookup tables
 */
 
 
@@ -30,26 +22,20 @@ EthernetLayer::EthernetLayer(const uint8_t* packet) {
 }
 
 void EthernetLayer::print() const {
-    std::cout << "=== ETHERNET LAYER ===" << std::endl;
-    std::cout << "Source MAC: " << print_mac(eth->src_mac) << std::endl;
-    std::cout << "Destination MAC: " << print_mac(eth->dest_mac) << std::endl;
-    std::cout << "EtherType: " << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << ntohs(eth->ether_type) << std::dec << std::endl;
-    std::cout << "=======================" << std::endl;
+    std::cout << "=== ETHERNET LAYER ===\n";
+    char mac[MAC_STRING_LENGTH];
+    std::cout << "Source MAC: " << print_mac(eth->src_mac, mac) << '\n';
+    std::cout << "Destination MAC: " << print_mac(eth->dest_mac, mac) << '\n';
+    std::cout << "EtherType: " << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << ntohs(eth->ether_type) << std::dec << '\n';
+    std::cout << "=======================\n";
 }
 
 size_t EthernetLayer::header_size() const {
     return sizeof(EthernetHeader);
 }
 
-std::string EthernetLayer::print_mac(const uint8_t *mac){
-    std::ostringstream oss;
-    for(int i =0; i < 6; i++) {
-        oss << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << (int)mac[i];
-        if(i < 5){
-            oss << ":";
-        }
-    }
-    return oss.str();
+std::string_view EthernetLayer::print_mac(const uint8_t *mac, char *out){
+    return std::string_view(out, format_mac(mac, out));
 }
 
 
@@ -59,11 +45,12 @@ IPv4Layer::IPv4Layer(const uint8_t *packet) {
 }
 
 void IPv4Layer::print() const {
-    std::cout << "=== IPv4 Layer ===" << std::endl;
-    std::cout << "Source IP: " << print_ip(iph->src_addr) << std::endl;
-    std::cout << "Destination IP: " << print_ip(iph->dest_addr) << std::endl;
-    std::cout << "Protocol: " << (int) iph->protocol << std::endl;
-    std::cout << "==================" << std::endl;
+    std::cout << "=== IPv4 Layer ===\n";
+    char ip[IPV4_STRING_MAX_LENGTH];
+    std::cout << "Source IP: " << print_ip(iph->src_addr, ip) << '\n';
+    std::cout << "Destination IP: " << print_ip(iph->dest_addr, ip) << '\n';
+    std::cout << "Protocol: " << (int) iph->protocol << '\n';
+    std::cout << "==================\n";
 
 }
 
@@ -71,14 +58,113 @@ size_t IPv4Layer::header_size() const {
     return (iph->version_ihl & 0x0F) * 4;
 }
 
-std::string IPv4Layer::print_ip(uint32_t ip){
-    std::ostringstream oss;
-    ip = ntohl(ip);
-    oss << ((ip >> 24) & 0xFF) << "."
-        << ((ip >> 16) & 0xFF) << "."
-        << ((ip >> 8) & 0xFF) << "."
-        << (ip & 0xFF);
-        return oss.str();
+std::string_view IPv4Layer::print_ip(uint32_t ip, char *out){
+    return std::string_view(out, format_ipv4(ip, out));
+}
+
+
+// LAYER 3 -> IPv6 Layer
+#define IPV6_HEADER_SIZE 40
+#define IPV6_HOP_BY_HOP 0
+#define IPV6_ROUTING 43
+#define IPV6_FRAGMENT 44
+#define IPV6_AUTHENTICATION 51
+#define IPV6_DESTINATION_OPTIONS 60
+#define IPV6_FRAGMENT_HEADER_SIZE 8
+
+IPv6Layer::IPv6Layer(const uint8_t *packet) :
+    ip6h(reinterpret_cast<const IPv6Header*>(packet)), extension_length(0), extension_count(0),
+    upper_protocol(0), fragment(false), fragment_offset(0), status(IPv6ExtensionStatus::OK) {}
+
+void IPv6Layer::walk_extensions(size_t available) {
+    const uint8_t* cursor = reinterpret_cast<const uint8_t*>(ip6h) + IPV6_HEADER_SIZE;
+    uint8_t next = ip6h->next_header;
+    size_t offset = 0;
+
+    extension_count = 0;
+    fragment = false;
+    fragment_offset = 0;
+    status = IPv6ExtensionStatus::OK;
+
+    for (int i = 0; i < IPV6_MAX_EXTENSION_HEADERS; i++) {
+        size_t length;
+        switch (next) {
+            case IPV6_HOP_BY_HOP:
+            case IPV6_ROUTING:
+            case IPV6_DESTINATION_OPTIONS:
+            case IPV6_AUTHENTICATION:
+                if (next == IPV6_HOP_BY_HOP && i > 0) {
+                    status = IPv6ExtensionStatus::MISPLACED_HOP_BY_HOP;
+                    upper_protocol = next;
+                    extension_length = static_cast<uint16_t>(offset);
+                    return;
+                }
+                if (available - offset < sizeof(IPv6ExtensionHeader)) {
+                    status = IPv6ExtensionStatus::TRUNCATED;
+                    upper_protocol = next;
+                    extension_length = static_cast<uint16_t>(offset);
+                    return;
+                }
+                // AH counts its length in 4 byte units minus 2, the others in 8 byte units minus 1
+                length = next == IPV6_AUTHENTICATION ? (cursor[offset + 1] + 2) * 4 : (cursor[offset + 1] + 1) * 8;
+                break;
+
+            case IPV6_FRAGMENT:
+                length = IPV6_FRAGMENT_HEADER_SIZE;
+                break;
+
+            default:
+                // Upper-layer protocol (or No Next Header / ESP): the chain ends here
+                upper_protocol = next;
+                extension_length = static_cast<uint16_t>(offset);
+                return;
+        }
+
+        if (available - offset < length) {
+            status = IPv6ExtensionStatus::TRUNCATED;
+            upper_protocol = next;
+            extension_length = static_cast<uint16_t>(offset);
+            return;
+        }
+
+        if (next == IPV6_FRAGMENT) {
+            const IPv6FragmentHeader* frag = reinterpret_cast<const IPv6FragmentHeader*>(cursor + offset);
+            fragment = true;
+            fragment_offset = ntohs(frag->offset_flags) >> 3;
+        }
+
+        next = cursor[offset];
+        offset += length;
+        extension_count++;
+    }
+
+    // Bound reached with extension headers still pending
+    status = IPv6ExtensionStatus::TOO_MANY;
+    upper_protocol = next;
+    extension_length = static_cast<uint16_t>(offset);
+}
+
+void IPv6Layer::print() const {
+    std::cout << "=== IPv6 Layer ===\n";
+    char ip[IPV6_STRING_MAX_LENGTH];
+    std::cout << "Source IP: " << print_ip(ip6h->src_addr, ip) << '\n';
+    std::cout << "Destination IP: " << print_ip(ip6h->dest_addr, ip) << '\n';
+    std::cout << "Next Header: " << (int) upper_protocol << '\n';
+    if (extension_count) {
+        std::cout << "Extension Headers: " << (int) extension_count << " (" << extension_length << " bytes)\n";
+    }
+    if (fragment) {
+        std::cout << "Fragment Offset: " << fragment_offset * 8 << '\n';
+    }
+    std::cout << "==================\n";
+}
+
+size_t IPv6Layer::header_size() const {
+    return IPV6_HEADER_SIZE + extension_length;
+}
+
+std::string_view IPv6Layer::print_ip(const uint8_t *ip, char *out){
+    return std::string_view(out, format_ipv6(ip, out));
 }
 
 
@@ -88,49 +174,20 @@ TCPLayer::TCPLayer(const uint8_t *packet){
 }
 
 void TCPLayer::print() const {
-    std::cout << "=== TCP Layer ===" << std::endl;
-    std::cout << "Source Port: " << ntohs(tcph->src_port) << std::endl;
-    std::cout << "Destination Port: " << ntohs(tcph->dest_port) << std::endl;
-    std::cout << "Flags: ";
-    std::vector<std::string> flags = decode_tcp_flags(tcph->flags);
-    for(size_t i = 0; i < flags.size(); i++){
-        std::cout << flags[i];
-        if(i < flags.size() - 1) {
-            std::cout << " ";
-        }
-    }
-    std::cout << std::endl;
-    std::cout << "=================" << std::endl;
+    std::cout << "=== TCP Layer ===\n";
+    std::cout << "Source Port: " << ntohs(tcph->src_port) << '\n';
+    std::cout << "Destination Port: " << ntohs(tcph->dest_port) << '\n';
+    std::cout << "Flags: " << decode_tcp_flags(tcph->flags) << '\n';
+    std::cout << "=================\n";
 }
 
 size_t TCPLayer::header_size() const {
     return ((tcph->data_offset >> 4) & 0x0F) * 4;
 }
 
-// Decodes TCP flag field
-std::vector<std::string> TCPLayer::decode_tcp_flags(uint8_t flags) {
-
-    std::vector<std::string> result;
-
-    bool fin = flags & FIN_FLAG;
-    bool syn = flags & SYN_FLAG;
-    bool rst = flags & RST_FLAG;
-    bool psh = flags & PSH_FLAG;
-    bool ack = flags & ACK_FLAG;
-    bool urg = flags & URG_FLAG;
-    bool ece = flags & ECE_FLAG;
-    bool cwr = flags & CWR_FLAG;
-
-    if(fin) result.push_back("FIN");
-    if(syn) result.push_back("SYN");
-    if(rst) result.push_back("RST");
-    if(psh) result.push_back("PSH");
-    if(ack) result.push_back("ACK");
-    if(urg) result.push_back("URG");
-    if(ece) result.push_back("ECE");
-    if(cwr) result.push_back("CWR");
-
-    return result;
+// Decodes TCP flag field -> view into a table of all 256 combinations
+std::string_view TCPLayer::decode_tcp_flags(uint8_t flags) {
+    return tcp_flags_string(flags);
 }
 
 
@@ -140,12 +197,12 @@ UDPLayer::UDPLayer(const uint8_t *packet) {
 }
 
 void UDPLayer::print() const {
-    std::cout << "=== UDP Layer ===" << std::endl;
-    std::cout << "Source Port: " << ntohs(udph->src) << std::endl;
-    std::cout << "Destination Port: " << ntohs(udph->dest) << std::endl;
-    std::cout << "Length: " << ntohs(udph->length) << std::endl;
-    std::cout << "Checksum: " << ntohs(udph->checksum) << std::endl;
-    std::cout << "=================" << std::endl;
+    std::cout << "=== UDP Layer ===\n";
+    std::cout << "Source Port: " << ntohs(udph->src) << '\n';
+    std::cout << "Destination Port: " << ntohs(udph->dest) << '\n';
+    std::cout << "Length: " << ntohs(udph->length) << '\n';
+    std::cout << "Checksum: " << ntohs(udph->checksum) << '\n';
+    std::cout << "=================\n";
 }
 
 size_t UDPLayer::header_size() const {
@@ -7,27 +7,50 @@
 #define TCP_PROTOCOL_VALUE 6
 #define UDP_PROTOCOL_VALUE 17
 #define IPv4_ETHERTYPE 0x0800
+#define IPv6_ETHERTYPE 0x86DD
+#define TEB_ETHERTYPE 0x6558
 #define MINIMUM_TCP_HEADER_SIZE 20
 #define MINIMUM_UDP_HEADER_SIZE 8
+#define MINIMUM_IPV4_HEADER_SIZE 20
+#define IPV4_FRAGMENT_OFFSET_MASK 0x1FFF
+#define VLAN_TAG_SIZE 4
+#define MPLS_LABEL_SIZE 4
+#define MPLS_BOTTOM_OF_STACK 0x01
+#define GRE_BASE_HEADER_SIZE 4
+#define GRE_FLAG_CHECKSUM 0x8000
+#define GRE_FLAG_KEY 0x2000
+#define GRE_FLAG_SEQUENCE 0x1000
+#define GRE_VERSION_MASK 0x0007
+#define VXLAN_HEADER_SIZE 8
+#define VXLAN_FLAG_VNI 0x08
 
 /*
     PacketView Class Implementation
     - This class provides a structural view of a raw network packet
-    - parses raw byte buffer into supported protocol layers (Ethernet, IPv4, TCP, UDP)
+    - parses raw byte buffer into supported protocol layers (Ethernet, IPv4, IPv6, TCP, UDP)
+    - VLAN / QinQ tags, MPLS labels and GRE / VXLAN tunnels are peeled in one loop driven by the
+      encap.hpp dispatch tables; every peeled header is recorded with its offset and the existing
+      layers describe the innermost packet
     - Does not handle validation -> that is to be done separately by the validation module
 */
 
+static uint16_t read16(const uint8_t* bytes) {
+    return static_cast<uint16_t>((bytes[0] << 8) | bytes[1]);
+}
+
+
 // PacketView Constructor
-PacketView::PacketView(const uint8_t* packet, size_t length) :
+PacketView::PacketView(const uint8_t* packet, size_t length, size_t max_encap_depth) :
     data(packet), length(length), 
-    has_eth(false), has_ip(false), has_tcp(false), has_udp(false),
-    payload(nullptr), payload_len(0), l4_type(L4Type::UNKNOWN)
+    has_eth(false), has_ip(false), has_ipv6(false), has_tcp(false), has_udp(false),
+    encap_count(0), encap_status(EncapStatus::OK), ethertype(0), l3_offset(0),
+    payload(nullptr), payload_len(0), l4_offset(0), l4_type(L4Type::UNKNOWN)
 {
-    parse_layers();
+    parse_layers(max_encap_depth);
 }
 
 // Parse Layers
-void PacketView::parse_layers() {
+void PacketView::parse_layers(size_t max_encap_depth) {
 
     // Ethernet Layer
     if (length < sizeof(EthernetHeader)) {
@@ -36,73 +59,326 @@ void PacketView::parse_layers() {
     eth_layer = EthernetLayer(data);
     has_eth = true;
 
-    // EtherType check for IPv4
-    uint16_t ethertype = ntohs(eth_layer.eth->ether_type);
-    if (ethertype != IPv4_ETHERTYPE) {
-        return; 
+    size_t offset = sizeof(EthernetHeader);
+    ethertype = ntohs(eth_layer.eth->ether_type);
+
+    // Fast path: untagged IPv4 that is not a tunnel never enters the decoder loop
+    if (ethertype == IPv4_ETHERTYPE) {
+        l3_offset = offset;
+        if (length < offset + 1) {
+            return;
+        }
+        ip_layer = IPv4Layer(data + offset);
+        has_ip = true;
+
+        // Looking at ihl bits to determine IPv4 header size
+        size_t ihl = (ip_layer.iph->version_ihl & 0x0F) * 4;
+        uint8_t protocol = ip_layer.iph->protocol;
+        if (max_encap_depth == 0 || !may_tunnel(protocol, offset + ihl)) {
+            parse_transport(protocol, offset + ihl);
+            return;
+        }
     }
+    parse_encapsulated(offset, max_encap_depth);
+}
 
-    // IPv4 Layer
-    size_t ip_offset = sizeof(EthernetHeader);
-    if (length < ip_offset + 1) {
+// Decoder loop for everything off the fast path: tags, labels, tunnels and IPv6
+void PacketView::parse_encapsulated(size_t offset, size_t max_encap_depth) {
+    size_t depth = max_encap_depth < ENCAP_MAX_LAYERS ? max_encap_depth : ENCAP_MAX_LAYERS;
+
+    // Every pass either reaches an IP header or records a layer, so at most depth + 1 passes
+    // (a tunnel records its own layers and restarts at the inner EtherType)
+    for (;;) {
+        // IPv4 (a tunnel seen on the fast path re-reads its outer header here)
+        if (ethertype == IPv4_ETHERTYPE) {
+            l3_offset = offset;
+            if (length < offset + 1) {
+                return;
+            }
+            ip_layer = IPv4Layer(data + offset);
+            has_ip = true;
+
+            // Looking at ihl bits to determine IPv4 header size
+            size_t ihl = (ip_layer.iph->version_ihl & 0x0F) * 4;
+            uint8_t protocol = ip_layer.iph->protocol;
+
+            // Tunnels are only entered from a whole, first-fragment IPv4 header
+            if (depth > 0 && may_tunnel(protocol, offset + ihl) && ihl >= MINIMUM_IPV4_HEADER_SIZE &&
+                length >= offset + ihl && !(ntohs(ip_layer.iph->flags_fragment) & IPV4_FRAGMENT_OFFSET_MASK)) {
+                if (parse_tunnel(EncapType::IPV4, protocol, offset, offset + ihl, depth, offset)) {
+                    has_ip = false;
+                    continue;
+                }
+                // A tunnel past the depth or cut short is not an L4 header
+                if (encap_status != EncapStatus::OK) {
+                    return;
+                }
+            }
+
+            // Adding ihl to ip_offset to point to L4 header
+            parse_transport(protocol, offset + ihl);
+            return;
+        }
+
+        // IPv6
+        if (ethertype == IPv6_ETHERTYPE) {
+            l3_offset = offset;
+            if (!parse_ipv6(offset)) {
+                return;
+            }
+            uint8_t protocol = ipv6_layer.upper_protocol;
+            size_t transport_offset = offset + ipv6_layer.header_size();
+            if (depth > 0 && may_tunnel(protocol, transport_offset)) {
+                if (parse_tunnel(EncapType::IPV6, protocol, offset, transport_offset, depth, offset)) {
+                    has_ipv6 = false;
+                    continue;
+                }
+                if (encap_status != EncapStatus::OK) {
+                    return;
+                }
+            }
+            parse_transport(protocol, transport_offset);
+            return;
+        }
+
+        // L2 encapsulation, anything else is left for the validator to reject
+        EncapType type = encap_lookup(ENCAP_ETHERTYPE_RULES, ethertype);
+        switch (type) {
+            case EncapType::VLAN:
+            case EncapType::QINQ:
+                if (length < offset + VLAN_TAG_SIZE) {
+                    encap_status = EncapStatus::TRUNCATED;
+                    return;
+                }
+                if (!push_encap(type, offset, depth)) {
+                    return;
+                }
+                ethertype = read16(data + offset + 2);
+                offset += VLAN_TAG_SIZE;
+                break;
+
+            case EncapType::MPLS: {
+                // Label stack entries down to the bottom of stack bit
+                bool bottom = false;
+                while (!bottom) {
+                    if (length < offset + MPLS_LABEL_SIZE) {
+                        encap_status = EncapStatus::TRUNCATED;
+                        return;
+                    }
+                    if (!push_encap(type, offset, depth)) {
+                        return;
+                    }
+                    bottom = data[offset + 2] & MPLS_BOTTOM_OF_STACK;
+                    offset += MPLS_LABEL_SIZE;
+                }
+
+                // MPLS carries no payload type, the IP version nibble stands in for it
+                if (length < offset + 1) {
+                    encap_status = EncapStatus::TRUNCATED;
+                    return;
+                }
+                uint8_t version = data[offset] >> 4;
+                ethertype = version == 4 ? IPv4_ETHERTYPE : version == 6 ? IPv6_ETHERTYPE : 0;
+                if (!ethertype) {
+                    return;
+                }
+                break;
+            }
+
+            default:
+                return;
+        }
+    }
+}
+
+// Cheap screen before parse_tunnel: an IP protocol rule, or a UDP destination port rule
+bool PacketView::may_tunnel(uint8_t protocol, size_t transport_offset) const {
+    if (protocol == UDP_PROTOCOL_VALUE) {
+        return length >= transport_offset + 4 &&
+               encap_lookup(ENCAP_UDP_PORT_RULES, read16(data + transport_offset + 2)) != EncapType::NONE;
+    }
+    return encap_lookup(ENCAP_IP_PROTOCOL_RULES, protocol) != EncapType::NONE;
+}
+
+// Records one peeled header, TOO_DEEP once the configured depth is used up
+bool PacketView::push_encap(EncapType type, size_t offset, size_t depth) {
+    if (encap_count >= depth) {
+        encap_status = EncapStatus::TOO_DEEP;
+        return false;
+    }
+    encap[encap_count].offset = static_cast<uint16_t>(offset);
+    encap[encap_count].type = type;
+    encap_count++;
+    return true;
+}
+
+// GRE (IP protocol 47) or VXLAN (UDP port 4789) behind an IP header
+// Records the outer IP header and the tunnel headers, then points at the inner packet
+// False with encap_status still OK means it is no tunnel and the outer packet is parsed as it is;
+// a tunnel cut short is TRUNCATED and one that needs more layers than the depth has left is TOO_DEEP
+bool PacketView::parse_tunnel(EncapType ip_type, uint8_t protocol, size_t ip_offset, size_t tunnel_offset,
+                              size_t depth, size_t& inner_offset) {
+    size_t room = depth - encap_count;
+
+    if (encap_lookup(ENCAP_IP_PROTOCOL_RULES, protocol) == EncapType::GRE) {
+        if (length < tunnel_offset + GRE_BASE_HEADER_SIZE) {
+            return false;
+        }
+        // Only version 0, version 1 is PPTP's enhanced GRE
+        uint16_t flags = read16(data + tunnel_offset);
+        if (flags & GRE_VERSION_MASK) {
+            return false;
+        }
+        size_t gre_length = GRE_BASE_HEADER_SIZE + ((flags & GRE_FLAG_CHECKSUM) ? 4 : 0) +
+                            ((flags & GRE_FLAG_KEY) ? 4 : 0) + ((flags & GRE_FLAG_SEQUENCE) ? 4 : 0);
+        if (length < tunnel_offset + gre_length) {
+            encap_status = EncapStatus::TRUNCATED;
+            return false;
+        }
+        // Outer IP + GRE
+        if (room < 2) {
+            encap_status = EncapStatus::TOO_DEEP;
+            return false;
+        }
+
+        push_encap(ip_type, ip_offset, depth);
+        push_encap(EncapType::GRE, tunnel_offset, depth);
+        ethertype = read16(data + tunnel_offset + 2);
+        inner_offset = tunnel_offset + gre_length;
+        if (ethertype == TEB_ETHERTYPE) {
+            parse_inner_ethernet(inner_offset);
+        }
+        return true;
+    }
+
+    if (protocol == UDP_PROTOCOL_VALUE && length >= tunnel_offset + MINIMUM_UDP_HEADER_SIZE &&
+        encap_lookup(ENCAP_UDP_PORT_RULES, read16(data + tunnel_offset + 2)) == EncapType::VXLAN) {
+        size_t vxlan_offset = tunnel_offset + MINIMUM_UDP_HEADER_SIZE;
+        if (length < vxlan_offset + VXLAN_HEADER_SIZE) {
+            encap_status = EncapStatus::TRUNCATED;
+            return false;
+        }
+        // The I flag marks a valid VNI, anything else on port 4789 is left as plain UDP
+        if (!(data[vxlan_offset] & VXLAN_FLAG_VNI)) {
+            return false;
+        }
+        // Outer IP + UDP + VXLAN
+        if (room < 3) {
+            encap_status = EncapStatus::TOO_DEEP;
+            return false;
+        }
+
+        push_encap(ip_type, ip_offset, depth);
+        push_encap(EncapType::UDP, tunnel_offset, depth);
+        push_encap(EncapType::VXLAN, vxlan_offset, depth);
+        inner_offset = vxlan_offset + VXLAN_HEADER_SIZE;
+        parse_inner_ethernet(inner_offset);
+        return true;
+    }
+
+    return false;
+}
+
+// Inner Ethernet of a bridged tunnel (VXLAN, GRE TEB) replaces eth_layer
+// The tunnel is already recorded, so a cut-off inner frame ends parsing instead of falling back
+void PacketView::parse_inner_ethernet(size_t& offset) {
+    if (length < offset + sizeof(EthernetHeader)) {
+        encap_status = EncapStatus::TRUNCATED;
+        ethertype = 0;
         return;
     }
-    ip_layer = IPv4Layer(data + ip_offset);
-    has_ip = true;
+    eth_layer = EthernetLayer(data + offset);
+    ethertype = ntohs(eth_layer.eth->ether_type);
+    offset += sizeof(EthernetHeader);
+}
+
+// IPv6 Layer: fixed header, then the bounded extension header walk
+// True when the L4 header (or a tunnel) can follow
+bool PacketView::parse_ipv6(size_t ip_offset) {
+    if (length < ip_offset + 1) {
+        return false;
+    }
+    ipv6_layer = IPv6Layer(data + ip_offset);
+    has_ipv6 = true;
+
+    // The walk needs the whole fixed header, the validator reports anything shorter
+    if (length < ip_offset + sizeof(IPv6Header)) {
+        return false;
+    }
+    ipv6_layer.walk_extensions(length - ip_offset - sizeof(IPv6Header));
 
-    // Looking at ihl bits to determine IPv4 header size
-    size_t ihl = (ip_layer.iph->version_ihl & 0x0F) * 4;
+    // Broken chains and non-first fragments carry no L4 header to parse
+    return ipv6_layer.status == IPv6ExtensionStatus::OK && ipv6_layer.fragment_offset == 0;
+}
 
-    // Adding ihl to ip_offset to point to L4 header
-    size_t l4_offset = ip_offset + ihl;    
+// Layer 4, shared by IPv4 and IPv6
+void PacketView::parse_transport(uint8_t protocol, size_t offset) {
+    l4_offset = offset;
 
     // Determining Layer 4 Protocol
-    if(ip_layer.iph->protocol == TCP_PROTOCOL_VALUE) {
+    if(protocol == TCP_PROTOCOL_VALUE) {
         l4_type = L4Type::TCP;
-        if (length < l4_offset + 1) {
+        if (length < offset + 1) {
             return;
         }
-        tcp_layer = TCPLayer(data + l4_offset);
+        tcp_layer = TCPLayer(data + offset);
         has_tcp = true;
-        payload = (l4_offset < length) ? data + l4_offset : nullptr;
-        payload_len = (l4_offset < length) ? (length - l4_offset) : 0;        
+        payload = data + offset;
+        payload_len = length - offset;
         return;
     }
-    else if(ip_layer.iph->protocol == UDP_PROTOCOL_VALUE) {
+    else if(protocol == UDP_PROTOCOL_VALUE) {
         l4_type = L4Type::UDP;
-        if (length < l4_offset + 1) {
+        if (length < offset + 1) {
             return;
         }
-        udp_layer = UDPLayer(data + l4_offset);
+        udp_layer = UDPLayer(data + offset);
         has_udp = true;
-        payload = (l4_offset < length) ? data + l4_offset : nullptr;
-        payload_len = (l4_offset < length) ? (length - l4_offset) : 0;
+        payload = data + offset;
+        payload_len = length - offset;
         return;
     }
     else {
         // Unsupported L4 Protocol
         l4_type = L4Type::UNKNOWN;
     }
-   
-}   
+}
 
 // Print Packet View Details
-void PacketView::print() const {
+void PacketView::print(const char* l3_error) const {
     std::cout << "=========== PACKET VIEW =============\n";
 
     if(has_eth) {
         eth_layer.print();
     }
     else { 
-        std::cout << "Ethernet: <invalid>" << std::endl; 
+        std::cout << "Ethernet: <invalid>\n"; 
         return; 
     }
 
+    for(size_t i = 0; i < encap_count; i++) {
+        std::cout << "Encapsulation: " << encap_type_name(encap[i].type) << " at " << encap[i].offset;
+        uint32_t id = encap_id(data, encap[i]);
+        if(id) {
+            std::cout << " (id " << id << ")";
+        }
+        std::cout << '\n';
+    }
+
     if(has_ip) {
         ip_layer.print();
     } 
+    else if(has_ipv6 && length >= l3_offset + sizeof(IPv6Header)) {
+        ipv6_layer.print();
+    }
     else { 
-        std::cout << "IPv4: <invalid>" << std::endl;
+        // Name the layer the innermost EtherType asked for, a broken IPv6 header is not an IPv4 problem
+        const char* layer = ethertype == IPv6_ETHERTYPE ? "IPv6" : ethertype == IPv4_ETHERTYPE ? "IPv4" : "L3";
+        std::cout << layer << ": <invalid>";
+        if (l3_error) {
+            std::cout << " (" << l3_error << ")";
+        }
+        std::cout << "\n";
         return; 
     }
 
@@ -113,10 +389,10 @@ void PacketView::print() const {
         udp_layer.print();
     }
     else {
-        std::cout << "Transport: <unsupported>" << std::endl;
+        std::cout << "Transport: <unsupported>\n";
     } 
 
-    std::cout << "Payload Length: " << payload_len << " bytes" << std::endl;
-    std::cout << "=====================================" << std::endl;
+    std::cout << "Payload Length: " << payload_len << " bytes\n";
+    std::cout << "=====================================\n";
 }
 
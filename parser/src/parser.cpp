@@ -1,6 +1,6 @@
 #include "parser.hpp"
 
 // Parser entry point
-ParsedPacket parse_packet(std::span<const uint8_t> buffer) {
-    return ParsedPacket(buffer);
+ParsedPacket parse_packet(std::span<const uint8_t> buffer, size_t max_encap_depth) {
+    return ParsedPacket(buffer, max_encap_depth);
 }
@@ -0,0 +1,96 @@
+#pragma once
+#include "packet_view.hpp"
+#include "flow_key.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Pipeline stages timed by the shedder, per packet that actually ran them
+enum class ShedStage : uint8_t {
+    PARSE,          // paid by every offered packet, the flow key is needed to sample
+    VALIDATE,
+    HEADERS,        // header counters / sketches
+    PAYLOAD,        // application payload inspection, the first stage to go
+    COUNT
+};
+
+// Degradation steps, entered in order as pressure rises and left in reverse as it falls
+enum class ShedLevel : uint8_t {
+    NORMAL,         // every stage runs on every packet
+    NO_PAYLOAD,     // payload inspection skipped, header counters stay exact
+    SAMPLING        // no payload inspection, and only 1 in 2^sample_shift flows is processed
+};
+
+struct LoadShedderConfig {
+    // Pressure = max(backlog / capacity, projected ns per packet / packet_budget_ns)
+    double high_watermark = 0.5;        // above this -> one step more shedding
+    double low_watermark = 0.2;         // below this (at the next lighter step) -> one step back
+    uint32_t calm_intervals = 4;        // consecutive calm evaluations needed before stepping back
+
+    uint64_t packet_budget_ns = 0;      // per-packet time budget across all stages, 0 = backlog only
+    uint32_t interval = 1024;           // offered packets between evaluations
+    uint8_t max_sample_shift = 8;       // deepest sampling keeps 1 flow in 256
+    double smoothing = 0.25;            // EWMA weight of the newest backlog / latency sample
+
+    uint64_t seed = 0x9E3779B9;         // flow_hash() seed, share it between cooperating consumers
+};
+
+// Watches consumer backlog and per-stage latency and decides, per packet, how much work to do
+// - Sampling is flow-consistent: a flow is kept or dropped as a whole, in both directions, and the
+//   flows kept at 1/2^(k+1) are a subset of those kept at 1/2^k
+// - Every admitted packet carries weight(), itself plus the packets sampled out since the previous admitted one,
+//   so weighted counters add up to the offered traffic however few flows there are or how often the shift moves
+class LoadShedder {
+public:
+    LoadShedderConfig config;
+    ShedLevel level;
+    uint8_t sample_shift;           // 0 unless SAMPLING
+
+    uint64_t packets;               // offered
+    uint64_t admitted;
+    uint64_t admitted_weight;       // sum of weight() over admitted packets, offered minus pending_weight()
+    uint64_t sampled_out;
+    uint64_t payload_inspected;
+    uint64_t payload_skipped;
+    uint64_t escalations;
+    uint64_t recoveries;
+
+    double backlog;                         // smoothed backlog / capacity
+    double stage_ns[static_cast<size_t>(ShedStage::COUNT)];     // smoothed ns per packet
+
+    LoadShedder(const LoadShedderConfig& config = LoadShedderConfig());
+
+    // Consumer queue depth, e.g. ShmRingConsumer::backlog(), sampled every so often
+    void observe_backlog(size_t depth, size_t capacity);
+
+    // Time spent in one stage for n packets
+    void record(ShedStage stage, uint64_t ns, size_t n);
+
+    // Per packet, after parsing: false -> the packet's flow is not sampled, skip everything else
+    bool admit(const PacketView& view);
+
+    // Per admitted packet: whether to run payload inspection
+    bool inspect_payload();
+
+    // Scale factor for counters fed by the current admitted packet
+    uint32_t weight() const { return current_weight; }
+
+    // Packets sampled out since the last admitted one, not yet carried by any weight()
+    uint64_t pending_weight() const { return pool; }
+
+    // Fractions of offered traffic that got the header stages / payload inspection so far
+    double sample_rate() const;
+    double payload_rate() const;
+
+    void print() const;
+    static const char* level_name(ShedLevel level);
+
+private:
+    uint32_t since_evaluation;
+    uint32_t calm;
+    uint64_t unkeyed;               // packets without a flow key, sampled systematically
+    uint64_t pool;                  // sampled out since the last admitted packet
+    uint32_t current_weight;
+
+    double pressure(ShedLevel at, uint8_t shift) const;
+    void evaluate();
+};
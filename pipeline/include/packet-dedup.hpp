@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#define DEDUP_BUCKET_WAYS 4
+#define DEDUP_MAX_HASH_BYTES 256
+
+struct DedupConfig {
+    size_t capacity = 1 << 16;          // remembered packets, rounded up to a power of two
+    uint64_t window_ns = 100000;        // copies further apart than this are different packets
+    size_t hash_bytes = 64;             // bytes hashed from the L3 header on (capped at DEDUP_MAX_HASH_BYTES);
+                                        // with the L3 length this covers IP ID, ports, TCP seq / ack and the L4 checksum
+};
+
+// One bucket, one cache line
+struct alignas(64) DedupBucket {
+    uint64_t fingerprint[DEDUP_BUCKET_WAYS];    // 0 = empty
+    uint64_t timestamp_ns[DEDUP_BUCKET_WAYS];
+};
+
+// Drops copies of a frame delivered again within a short window (several taps / SPAN ports on one path)
+// - fingerprints the invariant part of the packet: L2 headers (MACs, VLAN tags) are skipped, and the IPv4 TTL and
+//   header checksum (IPv6 hop limit) are zeroed, so copies taken before and after a router still match
+// - fixed memory: 4-way buckets that overwrite their oldest entry, with no allocation after construction
+// - meant to run on the raw frame before parse_packet() / PacketValidator, so it only walks the L2 tags itself
+class PacketDeduplicator {
+public:
+    DedupConfig config;
+
+    uint64_t packets;
+    uint64_t duplicates;
+    uint64_t evicted_live;      // entries overwritten while still inside the window: capacity too small for the rate
+
+    PacketDeduplicator(const DedupConfig& config = DedupConfig());
+
+    // True if the same invariant bytes were seen within window_ns of timestamp_ns (in either order)
+    // Only first copies are remembered, so a third copy is matched against the first one
+    bool duplicate(uint64_t timestamp_ns, std::span<const uint8_t> frame);
+    // Same decisions as calling duplicate() on each frame in order, out[i] = duplicate
+    void duplicate_batch(const uint64_t* timestamps, const std::span<const uint8_t>* frames, size_t n, bool* out);
+
+    double dedup_rate() const;
+    void clear();
+    void print() const;
+
+    static uint64_t fingerprint(std::span<const uint8_t> frame, size_t hash_bytes);
+
+private:
+    std::unique_ptr<DedupBucket[]> buckets;
+    size_t mask;
+
+    bool probe(uint64_t tag, uint64_t timestamp_ns);
+};
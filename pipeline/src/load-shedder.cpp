@@ -0,0 +1,202 @@
+#include "load-shedder.hpp"
+#include "flow_hash.hpp"
+#include <iostream>
+
+#define STAGES static_cast<size_t>(ShedStage::COUNT)
+#define SHED_MAX_SHIFT 16
+
+/*
+    LoadShedder Class Implementation
+    - Callers feed smoothed inputs (consumer backlog, ns per packet per stage); the level is only re-evaluated
+      every config.interval offered packets, so the per-packet cost is a counter and, while sampling, one hash
+    - Escalation: NORMAL -> NO_PAYLOAD -> SAMPLING 1/2 -> 1/4 -> ... -> 1/2^max_sample_shift, one step per evaluation
+    - Recovery needs the projected pressure of the next lighter step under the low watermark for calm_intervals
+      evaluations in a row; the gap between the watermarks keeps the level from flapping
+    - Flows are kept when the top sample_shift bits of their symmetric flow_hash() are zero, so deeper sampling only
+      ever drops flows that were kept before, never picks up new ones halfway through
+    - IPv4 and IPv6 packets are sampled on their flow key; only frames without one (non-IP, truncated) fall back
+      to 1 in 2^sample_shift by arrival order
+    - Weights follow the sample pool rather than 2^sample_shift: a fixed hash over a handful of flows can keep far
+      more or less than 1/2^k of the packets, and a shift change mid-window leaves no single factor that is right
+*/
+
+static double smooth(double current, double sample, double weight) {
+    return current == 0.0 ? sample : current + weight * (sample - current);
+}
+
+LoadShedder::LoadShedder(const LoadShedderConfig& config) :
+    config(config), level(ShedLevel::NORMAL), sample_shift(0),
+    packets(0), admitted(0), admitted_weight(0), sampled_out(0), payload_inspected(0), payload_skipped(0),
+    escalations(0), recoveries(0), backlog(0.0), stage_ns{},
+    since_evaluation(0), calm(0), unkeyed(0), pool(0), current_weight(1)
+{
+    if (this->config.max_sample_shift > SHED_MAX_SHIFT) {
+        this->config.max_sample_shift = SHED_MAX_SHIFT;
+    }
+    if (this->config.interval == 0) {
+        this->config.interval = 1;
+    }
+}
+
+void LoadShedder::observe_backlog(size_t depth, size_t capacity) {
+    if (capacity == 0) {
+        return;
+    }
+    double fill = depth >= capacity ? 1.0 : static_cast<double>(depth) / static_cast<double>(capacity);
+    // An empty queue is a real sample, not "no data yet"
+    backlog = backlog + config.smoothing * (fill - backlog);
+}
+
+void LoadShedder::record(ShedStage stage, uint64_t ns, size_t n) {
+    if (n == 0 || stage >= ShedStage::COUNT) {
+        return;
+    }
+    size_t index = static_cast<size_t>(stage);
+    stage_ns[index] = smooth(stage_ns[index], static_cast<double>(ns) / static_cast<double>(n), config.smoothing);
+}
+
+bool LoadShedder::admit(const PacketView& view) {
+    packets++;
+    if (++since_evaluation >= config.interval) {
+        evaluate();
+    }
+
+    bool keep = true;
+    if (level == ShedLevel::SAMPLING) {
+        FlowKey key;
+        if (make_flow_key(view, key)) {
+            keep = (flow_hash(key, config.seed) >> (64 - sample_shift)) == 0;
+        }
+        else {
+            keep = (unkeyed++ & ((1u << sample_shift) - 1)) == 0;
+        }
+    }
+
+    if (!keep) {
+        sampled_out++;
+        pool++;
+        return false;
+    }
+
+    // This packet stands in for itself and everything dropped since the previous admitted one
+    admitted++;
+    admitted_weight += pool + 1;
+    current_weight = pool < UINT32_MAX ? static_cast<uint32_t>(pool + 1) : UINT32_MAX;
+    pool = 0;
+    return true;
+}
+
+bool LoadShedder::inspect_payload() {
+    if (level == ShedLevel::NORMAL) {
+        payload_inspected++;
+        return true;
+    }
+    payload_skipped++;
+    return false;
+}
+
+double LoadShedder::sample_rate() const {
+    return packets ? static_cast<double>(admitted) / static_cast<double>(packets) : 1.0;
+}
+
+double LoadShedder::payload_rate() const {
+    return packets ? static_cast<double>(payload_inspected) / static_cast<double>(packets) : 1.0;
+}
+
+// Pressure the consumer would be under at the given step, from the current smoothed inputs
+double LoadShedder::pressure(ShedLevel at, uint8_t shift) const {
+    double result = backlog;
+    if (config.packet_budget_ns) {
+        double admitted_ns = stage_ns[static_cast<size_t>(ShedStage::VALIDATE)] +
+                             stage_ns[static_cast<size_t>(ShedStage::HEADERS)];
+        if (at == ShedLevel::NORMAL) {
+            admitted_ns += stage_ns[static_cast<size_t>(ShedStage::PAYLOAD)];
+        }
+        double per_packet = stage_ns[static_cast<size_t>(ShedStage::PARSE)] +
+                            admitted_ns / static_cast<double>(1u << shift);
+        double latency = per_packet / static_cast<double>(config.packet_budget_ns);
+        result = latency > result ? latency : result;
+    }
+    return result;
+}
+
+void LoadShedder::evaluate() {
+    since_evaluation = 0;
+
+    if (pressure(level, sample_shift) > config.high_watermark) {
+        calm = 0;
+        if (level == ShedLevel::NORMAL) {
+            level = ShedLevel::NO_PAYLOAD;
+        }
+        else if (level == ShedLevel::NO_PAYLOAD) {
+            level = ShedLevel::SAMPLING;
+            sample_shift = 1;
+        }
+        else if (sample_shift < config.max_sample_shift) {
+            sample_shift++;
+        }
+        else {
+            return;
+        }
+        escalations++;
+        return;
+    }
+
+    if (level == ShedLevel::NORMAL) {
+        calm = 0;
+        return;
+    }
+
+    // The next lighter step
+    ShedLevel lighter = ShedLevel::NO_PAYLOAD;
+    uint8_t lighter_shift = 0;
+    if (level == ShedLevel::NO_PAYLOAD) {
+        lighter = ShedLevel::NORMAL;
+    }
+    else if (sample_shift > 1) {
+        lighter = ShedLevel::SAMPLING;
+        lighter_shift = sample_shift - 1;
+    }
+
+    if (pressure(lighter, lighter_shift) >= config.low_watermark) {
+        calm = 0;
+        return;
+    }
+    if (++calm < config.calm_intervals) {
+        return;
+    }
+    calm = 0;
+    level = lighter;
+    sample_shift = lighter_shift;
+    recoveries++;
+}
+
+const char* LoadShedder::level_name(ShedLevel level) {
+    switch (level) {
+        case ShedLevel::NORMAL: return "NORMAL";
+        case ShedLevel::NO_PAYLOAD: return "NO_PAYLOAD";
+        case ShedLevel::SAMPLING: return "SAMPLING";
+        default: return "UNKNOWN";
+    }
+}
+
+void LoadShedder::print() const {
+    static const char* stage_names[STAGES] = {"parse", "validate", "headers", "payload"};
+
+    std::cout << "=== LOAD SHEDDING ===\n";
+    std::cout << "Level: " << level_name(level);
+    if (level == ShedLevel::SAMPLING) {
+        std::cout << " (1 in " << (1u << sample_shift) << " flows)";
+    }
+    std::cout << " Escalations: " << escalations << " Recoveries: " << recoveries << '\n';
+    std::cout << "Offered: " << packets << " Admitted: " << admitted << " Sampled out: " << sampled_out
+              << " (rate " << sample_rate() << ", weighted " << admitted_weight << " + " << pool << " pending)\n";
+    std::cout << "Payload inspected: " << payload_inspected << " Skipped: " << payload_skipped
+              << " (rate " << payload_rate() << ")\n";
+    std::cout << "Backlog: " << static_cast<int>(backlog * 100.0) << "% ns/packet:";
+    for (size_t stage = 0; stage < STAGES; stage++) {
+        std::cout << ' ' << stage_names[stage] << ' ' << static_cast<uint64_t>(stage_ns[stage]);
+    }
+    std::cout << '\n';
+    std::cout << "=====================\n";
+}
@@ -0,0 +1,227 @@
+#include "packet-dedup.hpp"
+#include "encap.hpp"
+#include <bit>
+#include <cstring>
+#include <iostream>
+
+#define ETHERNET_HEADER_SIZE 14
+#define VLAN_TAG_SIZE 4
+#define IPV4_ETHERTYPE 0x0800
+#define IPV6_ETHERTYPE 0x86DD
+#define IPV4_TTL_OFFSET 8
+#define IPV4_CHECKSUM_OFFSET 10
+#define IPV6_HOP_LIMIT_OFFSET 7
+// Mutable fields cleared from the first two little-endian words of the L3 header (byte k = bits 8k..8k+7)
+#define IPV4_KEEP_MASK ~((0xFFULL << ((IPV4_TTL_OFFSET - 8) * 8)) | (0xFFFFULL << ((IPV4_CHECKSUM_OFFSET - 8) * 8)))
+#define IPV6_KEEP_MASK ~(0xFFULL << (IPV6_HOP_LIMIT_OFFSET * 8))
+#define DEDUP_BATCH_BLOCK 16
+#define DEDUP_M1 0x9E3779B97F4A7C15ULL
+#define DEDUP_M2 0xC2B2AE3D27D4EB4FULL
+#define DEDUP_S0 0xA0761D6478BD642FULL
+#define DEDUP_S1 0xE7037ED1A0B428DBULL
+#define DEDUP_S2 0x8EBC6AF09C88C6E3ULL
+#define DEDUP_S3 0x589965CC75374CC3ULL
+
+/*
+    PacketDeduplicator Class Implementation
+    - The hashed region (from the L3 header, at most hash_bytes) is hashed in place, 16 bytes per 64x64->128 multiply;
+      blocks do not depend on each other, so the cost is close to one multiply latency regardless of length
+    - Mutable fields are masked out of the loaded words rather than zeroed in a copy, which would stall the loads
+      on store forwarding
+    - The L3 length (frame minus Ethernet header and tags) seeds the hash, so truncated or padded copies never match
+      but a copy that only gained or lost a VLAN tag on the way to another tap still does
+    - Lookup and insert touch one 64 byte bucket; a miss replaces the way with the oldest timestamp, which also
+      reclaims expired entries without a sweep
+    - duplicate_batch() fingerprints a block first and prefetches its buckets, so the table misses overlap
+*/
+
+static uint16_t read16(const uint8_t* bytes) {
+    return static_cast<uint16_t>((bytes[0] << 8) | bytes[1]);
+}
+
+static uint64_t read64(const uint8_t* bytes) {
+    uint64_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+// 64x64 -> 128 bit multiply folded back to 64 bits
+__extension__ typedef unsigned __int128 DedupWide;
+
+static inline uint64_t mum(uint64_t a, uint64_t b) {
+    DedupWide product = static_cast<DedupWide>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+
+// Same as the KEEP masks for a word loaded at any position (only the tail of a short region needs it)
+static uint64_t keep_mask(uint16_t ethertype, size_t position) {
+    static const size_t ipv4_fields[] = {IPV4_TTL_OFFSET, IPV4_CHECKSUM_OFFSET, IPV4_CHECKSUM_OFFSET + 1};
+    static const size_t ipv6_fields[] = {IPV6_HOP_LIMIT_OFFSET};
+
+    std::span<const size_t> fields;
+    if (ethertype == IPV4_ETHERTYPE) {
+        fields = ipv4_fields;
+    }
+    else if (ethertype == IPV6_ETHERTYPE) {
+        fields = ipv6_fields;
+    }
+    uint64_t mask = ~0ULL;
+    for (size_t field : fields) {
+        if (field >= position && field < position + 8) {
+            mask &= ~(0xFFULL << ((field - position) * 8));
+        }
+    }
+    return mask;
+}
+
+PacketDeduplicator::PacketDeduplicator(const DedupConfig& config) :
+    config(config), packets(0), duplicates(0), evicted_live(0)
+{
+    size_t capacity = std::bit_ceil(config.capacity < DEDUP_BUCKET_WAYS ? static_cast<size_t>(DEDUP_BUCKET_WAYS) : config.capacity);
+    size_t bucket_count = capacity / DEDUP_BUCKET_WAYS;
+    this->config.capacity = capacity;
+    this->config.hash_bytes = config.hash_bytes > DEDUP_MAX_HASH_BYTES ? DEDUP_MAX_HASH_BYTES : config.hash_bytes;
+    mask = bucket_count - 1;
+    buckets = std::make_unique<DedupBucket[]>(bucket_count);
+    clear();
+}
+
+uint64_t PacketDeduplicator::fingerprint(std::span<const uint8_t> frame, size_t hash_bytes) {
+    const uint8_t* data = frame.data();
+    size_t length = frame.size();
+
+    // Skip the Ethernet header and any VLAN / QinQ tags: they differ between taps
+    size_t offset = ETHERNET_HEADER_SIZE;
+    uint16_t ethertype = length >= ETHERNET_HEADER_SIZE ? read16(data + 12) : 0;
+    for (;;) {
+        EncapType type = encap_lookup(ENCAP_ETHERTYPE_RULES, ethertype);
+        if ((type != EncapType::VLAN && type != EncapType::QINQ) || length < offset + VLAN_TAG_SIZE) {
+            break;
+        }
+        ethertype = read16(data + offset + 2);
+        offset += VLAN_TAG_SIZE;
+    }
+    offset = offset < length ? offset : length;
+
+    const uint8_t* region = data + offset;
+    size_t l3_length = length - offset;
+    size_t n = l3_length < hash_bytes ? l3_length : hash_bytes;
+
+    uint64_t first[2] = {~0ULL, ~0ULL};
+    if (ethertype == IPV4_ETHERTYPE) {
+        first[1] = IPV4_KEEP_MASK;
+    }
+    else if (ethertype == IPV6_ETHERTYPE) {
+        first[0] = IPV6_KEEP_MASK;
+    }
+
+    // Each 16 byte block is folded on its own (position-dependent secrets), so the blocks hash in parallel
+    uint64_t h = (l3_length * DEDUP_M2) ^ ethertype;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint64_t w0 = read64(region + i) & first[0];
+        uint64_t w1 = read64(region + i + 8) & first[1];
+        first[0] = ~0ULL;
+        first[1] = ~0ULL;
+        h ^= mum(w0 ^ (DEDUP_S0 + i), w1 ^ (DEDUP_S1 + i));
+    }
+    if (i < n) {
+        // Tail: the last 16 bytes, overlapping the previous block, or a zero-padded copy for tiny regions;
+        // only regions under 32 bytes need the mutable fields cleared at a shifted position
+        uint64_t w0 = 0;
+        uint64_t w1 = 0;
+        size_t at = n >= 16 ? n - 16 : 0;
+        if (n >= 16) {
+            w0 = read64(region + at);
+            w1 = read64(region + at + 8);
+        }
+        else {
+            uint8_t tail[16] = {};
+            std::memcpy(tail, region, n);
+            w0 = read64(tail);
+            w1 = read64(tail + 8);
+        }
+        if (at < 16) {
+            w0 &= keep_mask(ethertype, at);
+            w1 &= keep_mask(ethertype, at + 8);
+        }
+        h ^= mum(w0 ^ DEDUP_S2, w1 ^ (DEDUP_S3 + n));
+    }
+
+    h = mum(h ^ DEDUP_S0, l3_length ^ DEDUP_M1);
+    return h | 1;
+}
+
+bool PacketDeduplicator::duplicate(uint64_t timestamp_ns, std::span<const uint8_t> frame) {
+    return probe(fingerprint(frame, config.hash_bytes), timestamp_ns);
+}
+
+void PacketDeduplicator::duplicate_batch(const uint64_t* timestamps, const std::span<const uint8_t>* frames, size_t n,
+                                         bool* out) {
+    uint64_t tags[DEDUP_BATCH_BLOCK];
+
+    for (size_t base = 0; base < n; base += DEDUP_BATCH_BLOCK) {
+        size_t count = n - base < DEDUP_BATCH_BLOCK ? n - base : DEDUP_BATCH_BLOCK;
+
+        for (size_t i = 0; i < count; i++) {
+            tags[i] = fingerprint(frames[base + i], config.hash_bytes);
+            __builtin_prefetch(&buckets[(tags[i] >> 32) & mask], 1);
+        }
+        for (size_t i = 0; i < count; i++) {
+            out[base + i] = probe(tags[i], timestamps[base + i]);
+        }
+    }
+}
+
+bool PacketDeduplicator::probe(uint64_t tag, uint64_t timestamp_ns) {
+    packets++;
+    DedupBucket& bucket = buckets[(tag >> 32) & mask];
+
+    // Whether a copy arrives is unpredictable, so the ways are scanned without early exits: selects, not branches
+    size_t match = DEDUP_BUCKET_WAYS;
+    size_t victim = 0;
+    uint64_t oldest = UINT64_MAX;
+    for (size_t way = 0; way < DEDUP_BUCKET_WAYS; way++) {
+        match = bucket.fingerprint[way] == tag ? way : match;
+        uint64_t age = bucket.fingerprint[way] ? bucket.timestamp_ns[way] : 0;    // empty ways go first
+        victim = age < oldest ? way : victim;
+        oldest = age < oldest ? age : oldest;
+    }
+
+    if (match != DEDUP_BUCKET_WAYS) {
+        uint64_t seen = bucket.timestamp_ns[match];
+        uint64_t gap = timestamp_ns > seen ? timestamp_ns - seen : seen - timestamp_ns;
+        if (gap <= config.window_ns) {
+            duplicates++;
+            return true;
+        }
+        // Same bytes but too long ago: a new first copy, refresh the way in place
+        victim = match;
+    }
+    else if (bucket.fingerprint[victim] && timestamp_ns - oldest < config.window_ns) {
+        evicted_live++;
+    }
+
+    bucket.fingerprint[victim] = tag;
+    bucket.timestamp_ns[victim] = timestamp_ns;
+    return false;
+}
+
+double PacketDeduplicator::dedup_rate() const {
+    return packets ? static_cast<double>(duplicates) / static_cast<double>(packets) : 0.0;
+}
+
+void PacketDeduplicator::clear() {
+    std::memset(static_cast<void*>(buckets.get()), 0, (mask + 1) * sizeof(DedupBucket));
+    packets = 0;
+    duplicates = 0;
+    evicted_live = 0;
+}
+
+void PacketDeduplicator::print() const {
+    std::cout << "=== DEDUP ===\n";
+    std::cout << "Packets: " << packets << " Duplicates: " << duplicates << " (rate " << dedup_rate() << ")\n";
+    std::cout << "Window: " << config.window_ns << " ns Capacity: " << config.capacity
+              << " Evicted inside window: " << evicted_live << '\n';
+    std::cout << "=============\n";
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <utility>
+#include <vector>
+
+#define STATE_ARENA_MAGIC 0x3145544154535044ULL     // "DPSTATE1"
+#define STATE_ARENA_VERSION 1
+#define STATE_ARENA_HEADER_SIZE 4096
+#define STATE_ARENA_MAX_SECTIONS 56
+#define STATE_ARENA_NAME_SIZE 40
+#define STATE_ARENA_DEFAULT_CAPACITY (1ULL << 30)
+
+// One named block of state; the offset is from the arena start, so a snapshot maps back at any address
+struct StateSection {
+    char name[STATE_ARENA_NAME_SIZE];
+    uint64_t offset;
+    uint64_t size;
+};
+
+// First page of the arena and of every snapshot file
+struct StateArenaHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t section_count;
+    uint64_t used;              // arena bytes in use, header included: what a snapshot writes
+    uint64_t generation;        // snapshots taken in this arena's lineage
+    uint64_t snapshot_ns;       // CLOCK_REALTIME of the latest snapshot
+    StateSection sections[STATE_ARENA_MAX_SECTIONS];
+};
+
+static_assert(sizeof(StateArenaHeader) <= STATE_ARENA_HEADER_SIZE, "StateArenaHeader must fit its page");
+
+// Long-lived state (flow tables, sketches, counters) kept in one contiguous, pointer-free region
+// - components ask for named sections and keep only process-local pointers into them
+// - snapshot_background() forks: the child writes the arena while the parent keeps running on copy-on-write pages
+// - restoring maps the snapshot file MAP_PRIVATE over the arena, so startup costs one mmap and pages fault in
+//   from the page cache as they are first touched
+class StateArena {
+public:
+    bool ok;
+    bool restored;              // the sections came from a snapshot file
+    uint64_t snapshots;
+    uint64_t snapshot_failures;
+    uint64_t last_fork_ns;      // pause of the caller for the latest background snapshot
+    uint64_t last_write_ns;     // fork to writer exit for the latest background snapshot
+
+    // Empty arena; capacity is reserved address space, pages are only backed once touched
+    StateArena(size_t capacity = STATE_ARENA_DEFAULT_CAPACITY);
+    // Restores the snapshot at path when it is valid and fits, otherwise starts empty
+    // ok is only false when the address space cannot be reserved
+    StateArena(const std::string& path, size_t capacity = STATE_ARENA_DEFAULT_CAPACITY);
+    ~StateArena();             // waits for a running background snapshot
+
+    StateArena(const StateArena&) = delete;
+    StateArena& operator=(const StateArena&) = delete;
+
+    // 64 byte aligned section: a restored section of the same size keeps its contents
+    // (*found = true), anything else is allocated zeroed; nullptr once the arena is full
+    void* section(std::string_view name, size_t bytes, bool* found = nullptr);
+
+    // Writes the arena to path (temporary file, fsync, rename), in the calling thread
+    bool snapshot(const std::string& path);
+    // Same, from a forked child; false if the previous one is still being written
+    bool snapshot_background(const std::string& path);
+    // Reaps a background snapshot, true once none is running; wait blocks until the child exits
+    bool snapshot_poll(bool wait = false);
+
+    size_t used() const;
+    size_t capacity() const { return size; }
+    uint64_t generation() const;
+    void print() const;
+
+private:
+    uint8_t* base;
+    size_t size;
+    pid_t writer;
+    uint64_t writer_start_ns;
+
+    StateArenaHeader* header() const { return reinterpret_cast<StateArenaHeader*>(base); }
+    bool reserve(size_t capacity);
+    void initialize();
+    bool map_snapshot(const std::string& path);
+    void stamp();
+};
+
+// Fixed-length array placed in an arena section, or on the heap without an arena
+// Copies always own heap storage, so a copied sketch never aliases the arena
+template <typename T>
+class StateArray {
+public:
+    StateArray(size_t count, T value) : owned(count, value), items(owned.data()), count(count) {}
+
+    // Keeps restored contents (*found = true), otherwise fills with value; falls back to the heap if the arena is full
+    // The arena must outlive the array
+    StateArray(StateArena& arena, std::string_view name, size_t count, T value, bool* found = nullptr) :
+        items(nullptr), count(count)
+    {
+        bool restored = false;
+        items = static_cast<T*>(arena.section(name, count * sizeof(T), &restored));
+        if (!items) {
+            owned.assign(count, value);
+            items = owned.data();
+        }
+        else if (!restored) {
+            std::fill(items, items + count, value);
+        }
+        if (found) {
+            *found = restored;
+        }
+    }
+
+    StateArray(const StateArray& other) : owned(other.begin(), other.end()), items(owned.data()), count(other.count) {}
+    StateArray(StateArray&& other) noexcept : owned(std::move(other.owned)), items(other.items), count(other.count) {}
+
+    StateArray& operator=(const StateArray& other) {
+        if (this != &other) {
+            owned.assign(other.begin(), other.end());
+            items = owned.data();
+            count = other.count;
+        }
+        return *this;
+    }
+
+    StateArray& operator=(StateArray&& other) noexcept {
+        owned = std::move(other.owned);
+        items = other.items;
+        count = other.count;
+        return *this;
+    }
+
+    T& operator[](size_t i) { return items[i]; }
+    const T& operator[](size_t i) const { return items[i]; }
+    T* data() { return items; }
+    const T* data() const { return items; }
+    size_t size() const { return count; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+
+private:
+    std::vector<T> owned;
+    T* items;
+    size_t count;
+};
@@ -0,0 +1,299 @@
+#include "state-arena.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define STATE_ARENA_PAGE 4096
+#define STATE_ARENA_ALIGN 64
+#define STATE_ARENA_WRITE_CHUNK (1 << 20)
+
+/*
+    StateArena Class Implementation
+    - One MAP_NORESERVE anonymous reservation; sections are bump allocated after the header page and never freed,
+      a section re-requested with another size is moved to a fresh allocation
+    - Memory past header->used has never been written, so new sections come out zeroed without a memset
+    - A snapshot is the first header->used bytes, written to <path>.tmp, fsynced and renamed over <path>:
+      a reader (or a process still mapping the previous snapshot) never sees a partial file
+    - The background writer is a fork()ed child that only makes system calls before _exit(), so it is safe
+      to fork from a multi-threaded process
+    - Restore validates the header against the file before mapping it MAP_PRIVATE | MAP_FIXED over the
+      reservation; writes afterwards stay private to the process
+*/
+
+static uint64_t monotonic_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static uint64_t realtime_ns() {
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+}
+
+static size_t round_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Only system calls: also runs in the forked writer
+static bool write_snapshot(const uint8_t* data, size_t length, const char* tmp_path, const char* path) {
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    size_t done = 0;
+    while (done < length) {
+        size_t chunk = length - done < STATE_ARENA_WRITE_CHUNK ? length - done : STATE_ARENA_WRITE_CHUNK;
+        ssize_t written = write(fd, data + done, chunk);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            close(fd);
+            unlink(tmp_path);
+            return false;
+        }
+        done += static_cast<size_t>(written);
+    }
+    if (fsync(fd) != 0) {
+        close(fd);
+        unlink(tmp_path);
+        return false;
+    }
+    close(fd);
+    if (rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+StateArena::StateArena(size_t capacity) :
+    ok(false), restored(false), snapshots(0), snapshot_failures(0), last_fork_ns(0), last_write_ns(0),
+    base(nullptr), size(0), writer(0), writer_start_ns(0)
+{
+    if (!reserve(capacity)) {
+        return;
+    }
+    initialize();
+    ok = true;
+}
+
+StateArena::StateArena(const std::string& path, size_t capacity) :
+    ok(false), restored(false), snapshots(0), snapshot_failures(0), last_fork_ns(0), last_write_ns(0),
+    base(nullptr), size(0), writer(0), writer_start_ns(0)
+{
+    if (!reserve(capacity)) {
+        return;
+    }
+    restored = map_snapshot(path);
+    if (!base) {
+        return;
+    }
+    if (!restored) {
+        initialize();
+    }
+    ok = true;
+}
+
+StateArena::~StateArena() {
+    snapshot_poll(true);
+    if (base) {
+        munmap(base, size);
+    }
+}
+
+bool StateArena::reserve(size_t capacity) {
+    size = round_up(capacity < 2 * STATE_ARENA_HEADER_SIZE ? 2 * STATE_ARENA_HEADER_SIZE : capacity, STATE_ARENA_PAGE);
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (memory == MAP_FAILED) {
+        base = nullptr;
+        size = 0;
+        return false;
+    }
+    base = static_cast<uint8_t*>(memory);
+    return true;
+}
+
+void StateArena::initialize() {
+    StateArenaHeader* h = header();
+    std::memset(static_cast<void*>(h), 0, sizeof(StateArenaHeader));
+    h->magic = STATE_ARENA_MAGIC;
+    h->version = STATE_ARENA_VERSION;
+    h->used = STATE_ARENA_HEADER_SIZE;
+}
+
+bool StateArena::map_snapshot(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    StateArenaHeader saved;
+    struct stat info;
+    bool valid = fstat(fd, &info) == 0 &&
+                 pread(fd, &saved, sizeof(saved), 0) == static_cast<ssize_t>(sizeof(saved)) &&
+                 saved.magic == STATE_ARENA_MAGIC &&
+                 saved.version == STATE_ARENA_VERSION &&
+                 saved.used >= STATE_ARENA_HEADER_SIZE &&
+                 saved.used <= static_cast<uint64_t>(info.st_size) &&
+                 saved.used <= size &&
+                 saved.section_count <= STATE_ARENA_MAX_SECTIONS;
+    for (uint32_t i = 0; valid && i < saved.section_count; i++) {
+        const StateSection& section = saved.sections[i];
+        valid = section.offset >= STATE_ARENA_HEADER_SIZE && section.offset <= saved.used &&
+                section.size <= saved.used - section.offset;
+    }
+    if (!valid) {
+        close(fd);
+        return false;
+    }
+
+    void* memory = mmap(base, saved.used, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        // A failed MAP_FIXED may have dropped the old mapping: reserve again
+        munmap(base, size);
+        reserve(size);
+        return false;
+    }
+    return true;
+}
+
+void* StateArena::section(std::string_view name, size_t bytes, bool* found) {
+    if (found) {
+        *found = false;
+    }
+    if (!ok) {
+        return nullptr;
+    }
+
+    StateArenaHeader* h = header();
+    char key[STATE_ARENA_NAME_SIZE] = {};
+    std::memcpy(key, name.data(), name.size() < STATE_ARENA_NAME_SIZE - 1 ? name.size() : STATE_ARENA_NAME_SIZE - 1);
+
+    StateSection* entry = nullptr;
+    for (uint32_t i = 0; i < h->section_count; i++) {
+        if (std::memcmp(h->sections[i].name, key, STATE_ARENA_NAME_SIZE) == 0) {
+            entry = &h->sections[i];
+            break;
+        }
+    }
+    if (entry && entry->size == bytes) {
+        if (found) {
+            *found = true;
+        }
+        return base + entry->offset;
+    }
+
+    // New, or reshaped by a config change: the old bytes stay behind as garbage until the next fresh start
+    size_t offset = round_up(h->used, STATE_ARENA_ALIGN);
+    if (offset > size || bytes > size - offset || (!entry && h->section_count == STATE_ARENA_MAX_SECTIONS)) {
+        return nullptr;
+    }
+    if (!entry) {
+        entry = &h->sections[h->section_count++];
+        std::memcpy(entry->name, key, STATE_ARENA_NAME_SIZE);
+    }
+    entry->offset = offset;
+    entry->size = bytes;
+    h->used = offset + bytes;
+    return base + offset;
+}
+
+void StateArena::stamp() {
+    header()->generation++;
+    header()->snapshot_ns = realtime_ns();
+}
+
+bool StateArena::snapshot(const std::string& path) {
+    if (!ok) {
+        return false;
+    }
+    // Both would write the same temporary file
+    snapshot_poll(true);
+    stamp();
+    std::string tmp_path = path + ".tmp";
+    if (!write_snapshot(base, header()->used, tmp_path.c_str(), path.c_str())) {
+        snapshot_failures++;
+        return false;
+    }
+    snapshots++;
+    return true;
+}
+
+bool StateArena::snapshot_background(const std::string& path) {
+    if (!ok || !snapshot_poll(false)) {
+        return false;
+    }
+    stamp();
+    // Everything the child needs is prepared here: it must not allocate
+    std::string tmp_path = path + ".tmp";
+    size_t length = header()->used;
+
+    uint64_t start = monotonic_ns();
+    pid_t pid = fork();
+    if (pid < 0) {
+        snapshot_failures++;
+        return false;
+    }
+    if (pid == 0) {
+        _exit(write_snapshot(base, length, tmp_path.c_str(), path.c_str()) ? 0 : 1);
+    }
+    last_fork_ns = monotonic_ns() - start;
+    writer = pid;
+    writer_start_ns = start;
+    return true;
+}
+
+bool StateArena::snapshot_poll(bool wait) {
+    if (writer <= 0) {
+        return true;
+    }
+    int status = 0;
+    pid_t result;
+    do {
+        result = waitpid(writer, &status, wait ? 0 : WNOHANG);
+    } while (result < 0 && errno == EINTR);
+    if (result == 0) {
+        return false;
+    }
+
+    if (result == writer && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        snapshots++;
+    }
+    else {
+        snapshot_failures++;
+    }
+    last_write_ns = monotonic_ns() - writer_start_ns;
+    writer = 0;
+    return true;
+}
+
+size_t StateArena::used() const {
+    return ok ? header()->used : 0;
+}
+
+uint64_t StateArena::generation() const {
+    return ok ? header()->generation : 0;
+}
+
+void StateArena::print() const {
+    std::cout << "=== STATE ARENA ===\n";
+    if (!ok) {
+        std::cout << "Not reserved\n";
+        return;
+    }
+    const StateArenaHeader* h = header();
+    std::cout << "Used: " << h->used << " of " << size << " bytes in " << h->section_count << " sections\n";
+    std::cout << "Restored: " << (restored ? "yes" : "no") << " Generation: " << h->generation << '\n';
+    std::cout << "Snapshots: " << snapshots << " Failures: " << snapshot_failures
+              << " Last fork: " << last_fork_ns / 1000 << " us Last write: " << last_write_ns / 1000 << " us\n";
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <iostream>
+
+// Minimal checks for the test executables, no framework: a failed CHECK prints the expression and its location
+// and is counted, main() returns test_result() so ctest sees a non-zero exit
+
+inline int& test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                        \
+    do {                                                                                        \
+        if (!(condition)) {                                                                     \
+            std::cerr << __FILE__ << ':' << __LINE__ << ": CHECK failed: " #condition "\n";     \
+            test_failures()++;                                                                  \
+        }                                                                                       \
+    } while (0)
+
+inline int test_result(const char* name) {
+    if (test_failures()) {
+        std::cerr << name << ": " << test_failures() << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << name << ": ok\n";
+    return 0;
+}
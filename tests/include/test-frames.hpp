@@ -0,0 +1,118 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Frame builder shared by the test executables: Ethernet (optionally 802.1Q tagged) + IPv4 or IPv6 + TCP or UDP +
+// payload, with the length fields filled in from what follows them. Checksums are taken as given, the parser does
+// not verify them
+
+#define TEST_ETHERTYPE_IPV4 0x0800
+#define TEST_ETHERTYPE_IPV6 0x86DD
+#define TEST_ETHERTYPE_VLAN 0x8100
+#define TEST_PROTOCOL_TCP 6
+#define TEST_PROTOCOL_UDP 17
+
+inline void put16(std::vector<uint8_t>& frame, uint16_t value) {
+    frame.push_back(static_cast<uint8_t>(value >> 8));
+    frame.push_back(static_cast<uint8_t>(value));
+}
+
+inline void put32(std::vector<uint8_t>& frame, uint32_t value) {
+    put16(frame, static_cast<uint16_t>(value >> 16));
+    put16(frame, static_cast<uint16_t>(value));
+}
+
+inline void put48(std::vector<uint8_t>& frame, uint64_t value) {
+    put16(frame, static_cast<uint16_t>(value >> 32));
+    put32(frame, static_cast<uint32_t>(value));
+}
+
+// 2000::<last>, enough to tell test hosts apart
+inline std::array<uint8_t, 16> test_ip6(uint8_t last) {
+    std::array<uint8_t, 16> address = {};
+    address[0] = 0x20;
+    address[15] = last;
+    return address;
+}
+
+struct TestFrame {
+    uint64_t dest_mac = 0x020000000001ULL;
+    uint64_t src_mac = 0x020000000002ULL;
+    size_t vlan_tags = 0;               // tag i carries VLAN id 100 + i
+
+    bool ipv6 = false;
+    uint32_t src_ip = 0x0A000001;       // 10.0.0.1
+    uint32_t dest_ip = 0x0A000002;      // 10.0.0.2
+    std::array<uint8_t, 16> src_ip6 = test_ip6(1);
+    std::array<uint8_t, 16> dest_ip6 = test_ip6(2);
+    uint8_t ttl = 64;                   // hop limit for IPv6
+    uint16_t ip_id = 0;
+    uint16_t frag = 0x4000;             // DF
+    uint16_t ip_checksum = 0;
+
+    uint8_t protocol = TEST_PROTOCOL_TCP;
+    uint16_t src_port = 40000;
+    uint16_t dest_port = 443;
+    uint32_t seq = 0;
+    uint32_t ack = 0;
+    uint8_t tcp_flags = 0x10;           // ACK
+    uint16_t window = 0x2000;
+    uint16_t l4_checksum = 0;
+
+    std::vector<uint8_t> payload;
+};
+
+inline std::vector<uint8_t> build_frame(const TestFrame& spec) {
+    std::vector<uint8_t> frame;
+    size_t l4_size = (spec.protocol == TEST_PROTOCOL_TCP ? 20 : 8) + spec.payload.size();
+
+    put48(frame, spec.dest_mac);
+    put48(frame, spec.src_mac);
+    for (size_t i = 0; i < spec.vlan_tags; i++) {
+        put16(frame, TEST_ETHERTYPE_VLAN);
+        put16(frame, static_cast<uint16_t>(100 + i));
+    }
+
+    if (spec.ipv6) {
+        put16(frame, TEST_ETHERTYPE_IPV6);
+        put32(frame, 0x60000000);
+        put16(frame, static_cast<uint16_t>(l4_size));
+        frame.push_back(spec.protocol);
+        frame.push_back(spec.ttl);
+        frame.insert(frame.end(), spec.src_ip6.begin(), spec.src_ip6.end());
+        frame.insert(frame.end(), spec.dest_ip6.begin(), spec.dest_ip6.end());
+    }
+    else {
+        put16(frame, TEST_ETHERTYPE_IPV4);
+        frame.push_back(0x45);
+        frame.push_back(0);
+        put16(frame, static_cast<uint16_t>(20 + l4_size));
+        put16(frame, spec.ip_id);
+        put16(frame, spec.frag);
+        frame.push_back(spec.ttl);
+        frame.push_back(spec.protocol);
+        put16(frame, spec.ip_checksum);
+        put32(frame, spec.src_ip);
+        put32(frame, spec.dest_ip);
+    }
+
+    put16(frame, spec.src_port);
+    put16(frame, spec.dest_port);
+    if (spec.protocol == TEST_PROTOCOL_TCP) {
+        put32(frame, spec.seq);
+        put32(frame, spec.ack);
+        frame.push_back(0x50);
+        frame.push_back(spec.tcp_flags);
+        put16(frame, spec.window);
+        put16(frame, spec.l4_checksum);
+        put16(frame, 0);
+    }
+    else {
+        put16(frame, static_cast<uint16_t>(l4_size));
+        put16(frame, spec.l4_checksum);
+    }
+    frame.insert(frame.end(), spec.payload.begin(), spec.payload.end());
+    return frame;
+}
@@ -0,0 +1,230 @@
+#include "test-check.hpp"
+#include "test-frames.hpp"
+#include "parser.hpp"
+#include "state-arena.hpp"
+#include "tcp-tracker.hpp"
+#include "traffic-sketches.hpp"
+#include <cstdio>
+#include <unistd.h>
+#include <vector>
+
+#define FLOWS 500
+#define HALF_OPEN 100               // the last HALF_OPEN flows only send their SYN
+#define RESET_FLOWS 50              // reset in the live tracker while the snapshot is being written
+#define TRACKER_CAPACITY 4096
+#define ARENA_SIZE (64 << 20)
+#define SERVER_ADDR 0xC0A80103u
+#define SERVER_PORT 443
+
+#define TCP_SYN 0x02
+#define TCP_RST 0x04
+#define TCP_ACK 0x10
+
+/*
+    Checkpoint Test
+    - Handshakes for FLOWS connections go through a TcpTracker and TrafficSketches living in one StateArena; after
+      checkpoint() the arena is written by a forked child while the parent keeps resetting connections, so the file
+      must hold the state as of the fork, not as of the write
+    - Reopening the file must restore both components: flow count and states, per-flow slots, tracker counters,
+      sketch totals, estimates and distinct counts, and the restored tracker must keep tracking
+    - A tracker or sketch of another shape, and a cut-off snapshot file, must start empty instead
+*/
+
+static std::vector<uint8_t> tcp_frame(uint32_t src, uint32_t dest, uint16_t src_port, uint16_t dest_port,
+                                      uint32_t seq, uint32_t ack, uint8_t flags) {
+    TestFrame spec;
+    spec.src_ip = src;
+    spec.dest_ip = dest;
+    spec.src_port = src_port;
+    spec.dest_port = dest_port;
+    spec.seq = seq;
+    spec.ack = ack;
+    spec.tcp_flags = flags;
+    spec.window = 0xFFFF;
+    return build_frame(spec);
+}
+
+static uint32_t client_addr(size_t flow) {
+    return 0x0A000000u | static_cast<uint32_t>(flow >> 4);
+}
+
+static uint16_t client_port(size_t flow) {
+    return static_cast<uint16_t>(40000 + (flow & 0xF));
+}
+
+static FlowKey flow_key(size_t flow) {
+    return FlowKey{client_addr(flow), SERVER_ADDR, client_port(flow), SERVER_PORT, 6};
+}
+
+struct Feeder {
+    TcpTracker& tracker;
+    TrafficSketches& sketches;
+    uint64_t timestamp_ns = 1000000000ULL;
+
+    void send(const std::vector<uint8_t>& frame) {
+        ParsedPacket packet = parse_packet(frame);
+        tracker.update(timestamp_ns, packet.view);
+        sketches.update(packet.view);
+        timestamp_ns += 1000;
+    }
+
+    void handshake(size_t flow, bool complete) {
+        uint32_t client = client_addr(flow);
+        uint16_t port = client_port(flow);
+        send(tcp_frame(client, SERVER_ADDR, port, SERVER_PORT, 1000, 0, TCP_SYN));
+        if (complete) {
+            send(tcp_frame(SERVER_ADDR, client, SERVER_PORT, port, 5000, 1001, TCP_SYN | TCP_ACK));
+            send(tcp_frame(client, SERVER_ADDR, port, SERVER_PORT, 1001, 5001, TCP_ACK));
+        }
+    }
+
+    void reset(size_t flow) {
+        send(tcp_frame(client_addr(flow), SERVER_ADDR, client_port(flow), SERVER_PORT, 1001, 5001, TCP_RST | TCP_ACK));
+    }
+};
+
+// What the components held when the snapshot was taken
+struct Expected {
+    size_t active;
+    size_t established;
+    size_t half_open;
+    uint64_t packets;
+    uint64_t flows_created;
+    uint64_t sketch_packets;
+    uint64_t port_estimate;
+    double distinct_sources;
+    uint64_t timestamp_ns;
+};
+
+static Expected write_snapshot(const std::string& path) {
+    StateArena arena(ARENA_SIZE);
+    CHECK(arena.ok);
+    TcpTrackerConfig config;
+    config.capacity = TRACKER_CAPACITY;
+    TcpTracker tracker(arena, "tcp", config);
+    TrafficSketches sketches(arena, "sketch");
+    CHECK(!tracker.restored && !sketches.restored);
+
+    Feeder feeder{tracker, sketches};
+    for (size_t flow = 0; flow < FLOWS; flow++) {
+        feeder.handshake(flow, flow < FLOWS - HALF_OPEN);
+    }
+
+    Expected expected;
+    expected.active = tracker.active_flows();
+    expected.established = tracker.count_state(TcpState::ESTABLISHED);
+    expected.half_open = tracker.count_state(TcpState::SYN_SENT);
+    expected.packets = tracker.packets;
+    expected.flows_created = tracker.flows_created;
+    expected.sketch_packets = sketches.packets;
+    expected.port_estimate = sketches.estimate(SketchDimension::DEST_PORT, SketchKey{0, SERVER_PORT});
+    expected.distinct_sources = sketches.distinct_count(SketchDimension::SRC_ADDR);
+    expected.timestamp_ns = feeder.timestamp_ns;
+    CHECK(expected.active == FLOWS);
+    CHECK(expected.established == FLOWS - HALF_OPEN);
+    CHECK(expected.half_open == HALF_OPEN);
+
+    tracker.checkpoint();
+    sketches.checkpoint();
+    CHECK(arena.snapshot_background(path));
+    // The parent keeps running on copy-on-write pages: none of this may reach the file
+    for (size_t flow = 0; flow < RESET_FLOWS; flow++) {
+        feeder.reset(flow);
+    }
+    tracker.checkpoint();
+    sketches.checkpoint();
+    CHECK(arena.snapshot_poll(true));
+    CHECK(arena.snapshots == 1);
+    CHECK(arena.snapshot_failures == 0);
+    CHECK(tracker.find(flow_key(0))->state == TcpState::RESET);
+    return expected;
+}
+
+static void check_restore(const std::string& path, const Expected& expected) {
+    StateArena arena(path, ARENA_SIZE);
+    CHECK(arena.ok);
+    CHECK(arena.restored);
+    CHECK(arena.generation() == 1);
+    TcpTrackerConfig config;
+    config.capacity = TRACKER_CAPACITY;
+    TcpTracker tracker(arena, "tcp", config);
+    TrafficSketches sketches(arena, "sketch");
+    CHECK(tracker.restored);
+    CHECK(sketches.restored);
+
+    CHECK(tracker.active_flows() == expected.active);
+    CHECK(tracker.count_state(TcpState::ESTABLISHED) == expected.established);
+    CHECK(tracker.count_state(TcpState::SYN_SENT) == expected.half_open);
+    CHECK(tracker.count_state(TcpState::RESET) == 0);
+    CHECK(tracker.packets == expected.packets);
+    CHECK(tracker.flows_created == expected.flows_created);
+
+    size_t missing = 0;
+    size_t wrong = 0;
+    for (size_t flow = 0; flow < FLOWS; flow++) {
+        const TcpFlowSlot* slot = tracker.find(flow_key(flow));
+        if (!slot) {
+            missing++;
+            continue;
+        }
+        bool complete = flow < FLOWS - HALF_OPEN;
+        wrong += slot->state != (complete ? TcpState::ESTABLISHED : TcpState::SYN_SENT);
+        wrong += slot->packets != (complete ? 3u : 1u);
+    }
+    CHECK(missing == 0);
+    CHECK(wrong == 0);
+
+    CHECK(sketches.packets == expected.sketch_packets);
+    CHECK(sketches.estimate(SketchDimension::DEST_PORT, SketchKey{0, SERVER_PORT}) == expected.port_estimate);
+    CHECK(sketches.distinct_count(SketchDimension::SRC_ADDR) == expected.distinct_sources);
+
+    // The restored state keeps working: a reset closes a restored flow, a new SYN opens another
+    Feeder feeder{tracker, sketches, expected.timestamp_ns};
+    feeder.reset(0);
+    feeder.handshake(FLOWS, false);
+    CHECK(tracker.find(flow_key(0))->state == TcpState::RESET);
+    CHECK(tracker.find(flow_key(FLOWS)) != nullptr);
+    CHECK(tracker.active_flows() == expected.active + 1);
+    CHECK(sketches.packets == expected.sketch_packets + 2);
+}
+
+static void check_mismatch(const std::string& path) {
+    {
+        StateArena arena(path, ARENA_SIZE);
+        CHECK(arena.restored);
+        TcpTrackerConfig config;
+        config.capacity = TRACKER_CAPACITY * 2;
+        TcpTracker tracker(arena, "tcp", config);
+        TrafficSketchConfig sketch_config;
+        sketch_config.seed++;
+        TrafficSketches sketches(arena, "sketch", sketch_config);
+        CHECK(!tracker.restored);
+        CHECK(tracker.active_flows() == 0);
+        CHECK(!sketches.restored);
+        CHECK(sketches.packets == 0);
+    }
+
+    CHECK(truncate(path.c_str(), STATE_ARENA_HEADER_SIZE / 2) == 0);
+    StateArena arena(path, ARENA_SIZE);
+    CHECK(arena.ok);
+    CHECK(!arena.restored);
+    TcpTrackerConfig config;
+    config.capacity = TRACKER_CAPACITY;
+    TcpTracker tracker(arena, "tcp", config);
+    CHECK(!tracker.restored);
+    CHECK(tracker.active_flows() == 0);
+}
+
+int main() {
+    char path[] = "/tmp/checkpoint-test-XXXXXX";
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    close(fd);
+
+    Expected expected = write_snapshot(path);
+    check_restore(path, expected);
+    check_mismatch(path);
+
+    std::remove(path);
+    return test_result("checkpoint-test");
+}
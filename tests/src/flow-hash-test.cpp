@@ -0,0 +1,170 @@
+#include "test-check.hpp"
+#include "flow_hash.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#define QUALITY_KEYS (1 << 18)
+#define QUALITY_BUCKETS 1024
+#define AVALANCHE_KEYS 4096
+#define INPUT_BITS 104              // src addr, dest addr, src port, dest port, protocol
+#define TEST_SEED 0x5EED
+
+/*
+    Flow Hash Test
+    - Bucket uniformity: chi-square per degree of freedom over QUALITY_BUCKETS buckets, for random tuples and for one
+      client walking its source port; with 1023 degrees of freedom the statistic has a standard deviation of about
+      0.044, so the 1.25 bound is several deviations out and the fixed seeds keep the run deterministic
+    - flow_hash is checked on its low bits (table index) and its top bits (LoadShedder sampling)
+    - Avalanche: flipping any one input bit must flip every flow_hash output bit with probability 0.5 +/- 0.05;
+      CRC32C and Toeplitz are linear, so a flip always toggles the same output bits and they are not held to this
+    - Symmetry and batch == scalar for every hash; flow_hash_batch is also compared with flow_hash_batch_scalar at
+      lengths that leave every possible tail after the 4-tuple AVX2 vectors
+*/
+
+static FlowKey random_key(std::mt19937& rng) {
+    return FlowKey{static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng()),
+                   static_cast<uint16_t>(rng()), static_cast<uint16_t>(rng()),
+                   static_cast<uint8_t>(rng() & 1 ? 6 : 17)};
+}
+
+static FlowKey sequential_key(size_t i) {
+    return FlowKey{0x0A000000u | static_cast<uint32_t>(i >> 16), 0x0A010001u, static_cast<uint16_t>(i), 443, 6};
+}
+
+static FlowKey flip_bit(FlowKey key, size_t bit) {
+    if (bit < 32) {
+        key.src_addr ^= 1u << bit;
+    }
+    else if (bit < 64) {
+        key.dest_addr ^= 1u << (bit - 32);
+    }
+    else if (bit < 80) {
+        key.src_port ^= static_cast<uint16_t>(1u << (bit - 64));
+    }
+    else if (bit < 96) {
+        key.dest_port ^= static_cast<uint16_t>(1u << (bit - 80));
+    }
+    else {
+        key.protocol ^= static_cast<uint8_t>(1u << (bit - 96));
+    }
+    return key;
+}
+
+// Chi-square per degree of freedom of bucket(key) over QUALITY_KEYS keys
+template <typename Bucket>
+static double chi_square(const std::vector<FlowKey>& keys, Bucket bucket) {
+    std::vector<uint64_t> counts(QUALITY_BUCKETS);
+    for (const FlowKey& key : keys) {
+        counts[bucket(key) & (QUALITY_BUCKETS - 1)]++;
+    }
+    double expected = static_cast<double>(keys.size()) / QUALITY_BUCKETS;
+    double chi = 0.0;
+    for (uint64_t count : counts) {
+        double d = static_cast<double>(count) - expected;
+        chi += d * d / expected;
+    }
+    return chi / (QUALITY_BUCKETS - 1);
+}
+
+static void check_uniformity(const std::vector<FlowKey>& random, const std::vector<FlowKey>& sequential) {
+    ToeplitzHasher toeplitz;
+    auto flow_low = [](const FlowKey& key) { return flow_hash(key); };
+    auto flow_top = [](const FlowKey& key) { return flow_hash(key) >> 54; };
+    auto crc = [](const FlowKey& key) { return flow_hash_crc32c(key); };
+    auto rss = [&](const FlowKey& key) { return toeplitz.hash(key); };
+
+    CHECK(chi_square(random, flow_low) < 1.25);
+    CHECK(chi_square(random, flow_top) < 1.25);
+    CHECK(chi_square(random, crc) < 1.25);
+    CHECK(chi_square(random, rss) < 1.25);
+
+    // A walking source port is the usual worst case for table indexing, RSS is not used to index tables
+    CHECK(chi_square(sequential, flow_low) < 1.25);
+    CHECK(chi_square(sequential, flow_top) < 1.25);
+    CHECK(chi_square(sequential, crc) < 1.25);
+}
+
+static void check_avalanche(std::mt19937& rng) {
+    std::vector<FlowKey> keys;
+    for (size_t i = 0; i < AVALANCHE_KEYS; i++) {
+        keys.push_back(random_key(rng));
+    }
+
+    double worst = 0.0;
+    for (size_t bit = 0; bit < INPUT_BITS; bit++) {
+        uint32_t flips[64] = {};
+        for (const FlowKey& key : keys) {
+            uint64_t diff = flow_hash(key) ^ flow_hash(flip_bit(key, bit));
+            for (size_t out = 0; out < 64; out++) {
+                flips[out] += (diff >> out) & 1;
+            }
+        }
+        for (size_t out = 0; out < 64; out++) {
+            double bias = static_cast<double>(flips[out]) / AVALANCHE_KEYS - 0.5;
+            worst = std::max(worst, bias < 0 ? -bias : bias);
+        }
+    }
+    CHECK(worst < 0.05);
+}
+
+static void check_symmetry_and_batch(const std::vector<FlowKey>& random) {
+    ToeplitzHasher toeplitz;
+    size_t n = 4096;
+    std::vector<uint32_t> src_addr, dest_addr;
+    std::vector<uint16_t> src_port, dest_port;
+    std::vector<uint8_t> protocol;
+    for (size_t i = 0; i < n; i++) {
+        const FlowKey& key = random[i];
+        FlowKey reverse{key.dest_addr, key.src_addr, key.dest_port, key.src_port, key.protocol};
+        CHECK(flow_hash(key, TEST_SEED) == flow_hash(reverse, TEST_SEED));
+        CHECK(flow_hash_crc32c(key, TEST_SEED) == flow_hash_crc32c(reverse, TEST_SEED));
+        CHECK(toeplitz.hash(key) == toeplitz.hash(reverse));
+
+        src_addr.push_back(key.src_addr);
+        dest_addr.push_back(key.dest_addr);
+        src_port.push_back(key.src_port);
+        dest_port.push_back(key.dest_port);
+        protocol.push_back(key.protocol);
+    }
+
+    FlowColumns columns{src_addr.data(), dest_addr.data(), src_port.data(), dest_port.data(), protocol.data()};
+    std::vector<uint64_t> out64(n);
+    std::vector<uint32_t> crc32(n);
+    std::vector<uint32_t> rss32(n);
+    flow_hash_batch(columns, n, TEST_SEED, out64.data());
+    flow_hash_crc32c_batch(columns, n, TEST_SEED, crc32.data());
+    toeplitz.hash_batch(columns, n, rss32.data());
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; i++) {
+        mismatches += out64[i] != flow_hash(random[i], TEST_SEED);
+        mismatches += crc32[i] != flow_hash_crc32c(random[i], TEST_SEED);
+        mismatches += rss32[i] != toeplitz.hash(random[i]);
+    }
+    CHECK(mismatches == 0);
+
+    std::vector<uint64_t> scalar64(n);
+    for (size_t length : {n, n - 1, n - 2, n - 3, size_t(3), size_t(1)}) {
+        std::fill(out64.begin(), out64.end(), 0);
+        std::fill(scalar64.begin(), scalar64.end(), 0);
+        flow_hash_batch(columns, length, TEST_SEED, out64.data());
+        flow_hash_batch_scalar(columns, length, TEST_SEED, scalar64.data());
+        CHECK(out64 == scalar64);
+    }
+}
+
+int main() {
+    std::mt19937 rng(TEST_SEED);
+    std::vector<FlowKey> random;
+    std::vector<FlowKey> sequential;
+    for (size_t i = 0; i < QUALITY_KEYS; i++) {
+        random.push_back(random_key(rng));
+        sequential.push_back(sequential_key(i));
+    }
+
+    check_uniformity(random, sequential);
+    check_avalanche(rng);
+    check_symmetry_and_batch(random);
+    std::cout << "flow_hash_batch AVX2 path: " << (flow_hash_batch_avx2() ? "yes" : "no, scalar only") << '\n';
+    return test_result("flow-hash-test");
+}
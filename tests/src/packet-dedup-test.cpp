@@ -0,0 +1,102 @@
+#include "test-check.hpp"
+#include "test-frames.hpp"
+#include "packet-dedup.hpp"
+#include <vector>
+
+#define HASH_BYTES 64
+
+/*
+    Packet Dedup Test
+    - Copies of one IPv4 / TCP frame as different taps would see them: another VLAN tag stack, other MACs, one router
+      hop later (TTL and header checksum changed); all of them must fingerprint alike and be dropped in the window
+    - Frames that really differ (payload, truncation, padding) must not match, and neither may a copy outside the window
+*/
+
+// Ethernet + IPv4 + TCP with a 64 byte payload as one tap saw it; the header checksum follows the TTL like a router's
+static TestFrame tap_copy(size_t vlan_tags, uint8_t ttl, uint8_t payload_seed) {
+    TestFrame spec;
+    spec.vlan_tags = vlan_tags;
+    spec.ttl = ttl;
+    spec.ip_id = 0x1234;
+    spec.ip_checksum = static_cast<uint16_t>(((0xA0 + ttl) << 8) | 0x55);
+    spec.seq = 0x1000;
+    spec.ack = 0x2000;
+    spec.l4_checksum = 0x1234;
+    for (size_t i = 0; i < 64; i++) {
+        spec.payload.push_back(static_cast<uint8_t>(payload_seed + i));
+    }
+    return spec;
+}
+
+static std::vector<uint8_t> make_frame(size_t vlan_tags, uint8_t ttl, uint8_t payload_seed) {
+    return build_frame(tap_copy(vlan_tags, ttl, payload_seed));
+}
+
+static uint64_t fingerprint(const std::vector<uint8_t>& frame) {
+    return PacketDeduplicator::fingerprint(frame, HASH_BYTES);
+}
+
+static void check_fingerprints() {
+    std::vector<uint8_t> untagged = make_frame(0, 64, 0);
+    std::vector<uint8_t> tagged = make_frame(1, 64, 0);
+    std::vector<uint8_t> qinq = make_frame(2, 64, 0);
+    std::vector<uint8_t> next_hop = make_frame(1, 63, 0);
+
+    CHECK(fingerprint(untagged) == fingerprint(tagged));
+    CHECK(fingerprint(untagged) == fingerprint(qinq));
+    CHECK(fingerprint(untagged) == fingerprint(next_hop));
+
+    std::vector<uint8_t> other_macs = untagged;
+    other_macs[5] = 0x77;
+    other_macs[11] = 0x88;
+    CHECK(fingerprint(untagged) == fingerprint(other_macs));
+
+    // The same headers with another payload differ in the L4 checksum the hash covers
+    TestFrame other_spec = tap_copy(0, 64, 1);
+    other_spec.l4_checksum = 0x4334;
+    std::vector<uint8_t> other_payload = build_frame(other_spec);
+    CHECK(fingerprint(untagged) != fingerprint(other_payload));
+
+    std::vector<uint8_t> truncated(untagged.begin(), untagged.end() - 1);
+    std::vector<uint8_t> padded = untagged;
+    padded.push_back(0);
+    CHECK(fingerprint(untagged) != fingerprint(truncated));
+    CHECK(fingerprint(untagged) != fingerprint(padded));
+    CHECK(fingerprint(tagged) != fingerprint(truncated));
+}
+
+static void check_window() {
+    DedupConfig config;
+    config.capacity = 1024;
+    config.window_ns = 1000;
+    config.hash_bytes = HASH_BYTES;
+    PacketDeduplicator dedup(config);
+
+    std::vector<uint8_t> untagged = make_frame(0, 64, 0);
+    std::vector<uint8_t> tagged = make_frame(1, 63, 0);
+    TestFrame other_spec = tap_copy(1, 64, 9);
+    other_spec.l4_checksum = 0x9934;
+    std::vector<uint8_t> other = build_frame(other_spec);
+
+    CHECK(!dedup.duplicate(10000, untagged));
+    CHECK(dedup.duplicate(10500, tagged));
+    CHECK(!dedup.duplicate(10600, other));
+    // Outside the window of the first copy: a new packet
+    CHECK(!dedup.duplicate(20000, tagged));
+    CHECK(dedup.packets == 4);
+    CHECK(dedup.duplicates == 1);
+
+    // The batch path makes the same decisions
+    PacketDeduplicator batch(config);
+    uint64_t timestamps[] = {10000, 10500, 10600, 20000};
+    std::span<const uint8_t> frames[] = {untagged, tagged, other, tagged};
+    bool out[4] = {};
+    batch.duplicate_batch(timestamps, frames, 4, out);
+    CHECK(!out[0] && out[1] && !out[2] && !out[3]);
+}
+
+int main() {
+    check_fingerprints();
+    check_window();
+    return test_result("packet-dedup-test");
+}
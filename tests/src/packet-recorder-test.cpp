@@ -0,0 +1,206 @@
+#include "test-check.hpp"
+#include "test-frames.hpp"
+#include "packet-recorder.hpp"
+#include "parser.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#define FRAMES 3000
+#define FLOWS 8                     // flow 7 is IPv6, the rest IPv4 TCP / UDP
+#define BURST 64                    // consecutive frames of one flow, so a block holds few flows
+#define SNAPLEN 1024
+#define BASE_NS 1700000000000000000ULL
+#define STEP_NS 1000
+#define TEST_SEED 0x4EC0
+
+/*
+    Packet Recorder Test
+    - Frames of several IPv4 and IPv6 flows, both directions, some longer than the snaplen, go through a
+      PacketRecorder with small blocks and segments; everything read back must match what was recorded: timestamp,
+      original length and the captured bytes, in recording order
+    - A time range must return exactly its frames and a flow filter exactly that flow in both directions, with the
+      indexes letting the reader skip blocks it does not need
+    - Under a small disk budget the oldest segments go, and what is left reads back as an intact tail
+*/
+
+struct Frame {
+    uint64_t timestamp_ns;
+    size_t flow;
+    std::vector<uint8_t> data;
+};
+
+// Frame i: flow (i / BURST) % FLOWS, odd frames go from server to client; the payload is half text, half noise
+static Frame make_frame(size_t i, std::mt19937& rng) {
+    Frame frame;
+    frame.timestamp_ns = BASE_NS + i * STEP_NS;
+    frame.flow = (i / BURST) % FLOWS;
+    bool reply = i & 1;
+    bool ipv6 = frame.flow == FLOWS - 1;
+    uint8_t protocol = frame.flow % 2 ? TEST_PROTOCOL_UDP : TEST_PROTOCOL_TCP;
+    uint16_t client_port = static_cast<uint16_t>(40000 + frame.flow);
+    uint16_t server_port = protocol == TEST_PROTOCOL_TCP ? 443 : 53;
+    size_t payload = i % 97 == 0 ? 1400 : rng() % 400;
+
+    TestFrame spec;
+    spec.ipv6 = ipv6;
+    if (ipv6) {
+        spec.src_ip6 = test_ip6(reply ? 0x01 : 0x10);
+        spec.dest_ip6 = test_ip6(reply ? 0x10 : 0x01);
+    }
+    else {
+        uint32_t client = 0x0A000000u + static_cast<uint32_t>(frame.flow);
+        uint32_t server = 0xC0A80001u;
+        spec.src_ip = reply ? server : client;
+        spec.dest_ip = reply ? client : server;
+    }
+    spec.protocol = protocol;
+    spec.src_port = reply ? server_port : client_port;
+    spec.dest_port = reply ? client_port : server_port;
+    spec.seq = static_cast<uint32_t>(i);
+    spec.tcp_flags = 0x18;              // PSH ACK
+    for (size_t b = 0; b < payload; b++) {
+        spec.payload.push_back(static_cast<uint8_t>(b < payload / 2 ? 'a' + b % 26 : rng()));
+    }
+    frame.data = build_frame(spec);
+    return frame;
+}
+
+static std::string make_directory() {
+    char path[] = "/tmp/packet-recorder-test-XXXXXX";
+    char* made = mkdtemp(path);
+    CHECK(made != nullptr);
+    return made ? made : "";
+}
+
+static RecorderConfig small_config() {
+    RecorderConfig config;
+    config.block_size = 4096;
+    config.segment_size = 64 << 10;
+    config.snaplen = SNAPLEN;
+    return config;
+}
+
+static void record_all(PacketRecorder& recorder, const std::vector<Frame>& frames) {
+    CHECK(recorder.ok);
+    for (const Frame& frame : frames) {
+        recorder.record(frame.timestamp_ns, frame.data);
+    }
+    CHECK(recorder.close());
+}
+
+// Reads everything back from reader and compares it, in order, with the frames wanted() selects
+template <typename Wanted>
+static size_t read_back(RecordingReader& reader, const std::vector<Frame>& frames, Wanted wanted) {
+    CHECK(reader.ok);
+
+    size_t next = 0;
+    size_t mismatches = 0;
+    RecordedPacket packet;
+    while (reader.next(packet)) {
+        while (next < frames.size() && !wanted(frames[next])) {
+            next++;
+        }
+        if (next == frames.size()) {
+            mismatches++;
+            break;
+        }
+        const Frame& frame = frames[next++];
+        size_t captured = frame.data.size() < SNAPLEN ? frame.data.size() : SNAPLEN;
+        mismatches += packet.timestamp_ns != frame.timestamp_ns;
+        mismatches += packet.original_length != frame.data.size();
+        mismatches += packet.data.size() != captured ||
+                      !std::equal(packet.data.begin(), packet.data.end(), frame.data.begin());
+    }
+    while (next < frames.size() && !wanted(frames[next])) {
+        next++;
+    }
+    CHECK(next == frames.size());
+    CHECK(!reader.corrupt);
+    return mismatches;
+}
+
+static FlowKey key_of(const Frame& frame) {
+    ParsedPacket packet = parse_packet(frame.data);
+    FlowKey key;
+    CHECK(make_flow_key(packet.view, key));
+    return key;
+}
+
+static void check_read_back(const std::vector<Frame>& frames) {
+    std::string directory = make_directory();
+    PacketRecorder recorder(directory, small_config());
+    record_all(recorder, frames);
+    CHECK(recorder.recorded == FRAMES);
+    CHECK(recorder.dropped == 0);
+    CHECK(recorder.truncated > 0);
+    CHECK(recorder.segments_closed > 2);
+    CHECK(recorder.write_errors == 0);
+
+    RecordingReader everything(directory, 0, UINT64_MAX);
+    CHECK(read_back(everything, frames, [](const Frame&) { return true; }) == 0);
+    CHECK(everything.records == FRAMES);
+
+    uint64_t from_ns = frames[FRAMES / 3].timestamp_ns;
+    uint64_t to_ns = frames[FRAMES / 2].timestamp_ns;
+    RecordingReader range(directory, from_ns, to_ns);
+    auto in_range = [&](const Frame& frame) { return frame.timestamp_ns >= from_ns && frame.timestamp_ns < to_ns; };
+    CHECK(read_back(range, frames, in_range) == 0);
+    CHECK(range.records == FRAMES / 2 - FRAMES / 3);
+    CHECK(range.segments_read < recorder.segments_closed);
+
+    // Looked up by the reply direction: the filter matches either way
+    for (size_t flow : {size_t(2), size_t(FLOWS - 1)}) {
+        FlowKey key = key_of(frames[flow * BURST + 1]);
+        RecordingReader filtered(directory, 0, UINT64_MAX, &key);
+        CHECK(read_back(filtered, frames, [&](const Frame& frame) { return frame.flow == flow; }) == 0);
+        CHECK(filtered.blocks_skipped > 0);
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+static void check_budget(const std::vector<Frame>& frames) {
+    std::string directory = make_directory();
+    RecorderConfig config = small_config();
+    config.disk_budget = 4 * config.segment_size;
+    PacketRecorder recorder(directory, config);
+    record_all(recorder, frames);
+    CHECK(recorder.segments_deleted > 0);
+    CHECK(recorder.disk_used() <= config.disk_budget);
+
+    // Whatever survived is the newest part of the recording, without holes
+    RecordingReader reader(directory, 0, UINT64_MAX);
+    CHECK(reader.ok);
+    RecordedPacket packet;
+    size_t first = SIZE_MAX;
+    size_t next = 0;
+    size_t mismatches = 0;
+    while (reader.next(packet)) {
+        size_t index = static_cast<size_t>((packet.timestamp_ns - BASE_NS) / STEP_NS);
+        if (first == SIZE_MAX) {
+            first = next = index;
+        }
+        mismatches += index != next++ || index >= FRAMES || packet.original_length != frames[index].data.size();
+    }
+    CHECK(first > 0 && first != SIZE_MAX);
+    CHECK(next == FRAMES);
+    CHECK(mismatches == 0);
+    CHECK(!reader.corrupt);
+
+    std::filesystem::remove_all(directory);
+}
+
+int main() {
+    std::mt19937 rng(TEST_SEED);
+    std::vector<Frame> frames;
+    for (size_t i = 0; i < FRAMES; i++) {
+        frames.push_back(make_frame(i, rng));
+    }
+    check_read_back(frames);
+    check_budget(frames);
+    return test_result("packet-recorder-test");
+}
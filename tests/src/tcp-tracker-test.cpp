@@ -0,0 +1,299 @@
+#include "test-check.hpp"
+#include "test-frames.hpp"
+#include "parser.hpp"
+#include "tcp-tracker.hpp"
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#define SERVER_ADDR 0xC0A80001u
+#define SERVER_PORT 443
+#define BASE_NS 1000000000ULL
+#define CHURN_CAPACITY 64
+#define CHURN_FLOWS 48              // under the 7/8 load limit, so probe runs are long and overlap
+#define CHURN_ROUNDS 200
+#define TEST_SEED 0x7C9
+
+#define TCP_SYN 0x02
+#define TCP_RST 0x04
+#define TCP_ACK 0x10
+
+/*
+    TCP Tracker Test
+    - Handshake RTT: SYN -> SYN-ACK and SYN-ACK -> ACK are measured at the tap and summed into one sample
+    - IPv6 connections are tracked like IPv4 ones, segment lengths come from the payload length, and an IPv4 key with
+      the same folded addresses does not find them
+    - Retransmitted data and repeated SYNs are counted, keepalives are not; a zero window is counted once per closing
+    - Data past the advertised window, ACKs for unsent data and RSTs outside the window count as out-of-window and do
+      not move the connection state, an in-window RST resets it
+    - Idle connections expire by state timeout, through expire() and through the per-packet sweep
+    - Churn in a small table: after every round of inserts, resets and expiry each live connection must still be
+      found and each expired one gone, which fails if backward-shift deletion ever breaks a probe run
+*/
+
+// IPv6 connections use 2000::<client low byte> and 2000::1 for the server
+struct Connection {
+    uint32_t client;
+    uint16_t port;
+    bool ipv6 = false;
+};
+
+static uint64_t at_us(uint64_t us) {
+    return BASE_NS + us * 1000;
+}
+
+static bool send(TcpTracker& tracker, uint64_t timestamp_ns, const Connection& conn, bool from_client, uint32_t seq,
+                 uint32_t ack, uint8_t flags, uint16_t window = 0x2000, size_t payload = 0) {
+    TestFrame spec;
+    spec.ipv6 = conn.ipv6;
+    spec.src_ip6 = test_ip6(from_client ? static_cast<uint8_t>(conn.client) : 1);
+    spec.dest_ip6 = test_ip6(from_client ? 1 : static_cast<uint8_t>(conn.client));
+    spec.src_ip = from_client ? conn.client : SERVER_ADDR;
+    spec.dest_ip = from_client ? SERVER_ADDR : conn.client;
+    spec.src_port = from_client ? conn.port : SERVER_PORT;
+    spec.dest_port = from_client ? SERVER_PORT : conn.port;
+    spec.seq = seq;
+    spec.ack = ack;
+    spec.tcp_flags = flags;
+    spec.window = window;
+    spec.payload.assign(payload, 'x');
+    std::vector<uint8_t> frame = build_frame(spec);
+    ParsedPacket packet = parse_packet(frame);
+    return tracker.update(timestamp_ns, packet.view);
+}
+
+static FlowKey flow_key(const Connection& conn) {
+    FlowKey key{conn.client, SERVER_ADDR, conn.port, SERVER_PORT, TEST_PROTOCOL_TCP};
+    if (conn.ipv6) {
+        std::array<uint8_t, 16> client = test_ip6(static_cast<uint8_t>(conn.client));
+        std::array<uint8_t, 16> server = test_ip6(1);
+        std::memcpy(key.src_addr6, client.data(), 16);
+        std::memcpy(key.dest_addr6, server.data(), 16);
+        key.src_addr = ipv6_fold(key.src_addr6);
+        key.dest_addr = ipv6_fold(key.dest_addr6);
+        key.ipv6 = true;
+    }
+    return key;
+}
+
+static const TcpFlowSlot* find(const TcpTracker& tracker, const Connection& conn) {
+    return tracker.find(flow_key(conn));
+}
+
+// Client ISN 1000, server ISN 5000, no window scaling
+static void handshake(TcpTracker& tracker, uint64_t start_us, const Connection& conn) {
+    send(tracker, at_us(start_us), conn, true, 1000, 0, TCP_SYN);
+    send(tracker, at_us(start_us + 300), conn, false, 5000, 1001, TCP_SYN | TCP_ACK);
+    send(tracker, at_us(start_us + 350), conn, true, 1001, 5001, TCP_ACK);
+}
+
+static void check_rtt() {
+    TcpTracker tracker;
+    Connection conn{0x0A000001, 40000};
+    handshake(tracker, 0, conn);
+
+    const TcpFlowSlot* slot = find(tracker, conn);
+    CHECK(slot != nullptr);
+    if (slot) {
+        CHECK(slot->state == TcpState::ESTABLISHED);
+        CHECK(slot->flags & TCP_FLOW_RTT);
+        CHECK(slot->synack_rtt_us == 300);
+        CHECK(slot->ack_rtt_us == 50);
+    }
+    CHECK(tracker.rtt_samples == 1);
+    CHECK(tracker.rtt_total_us == 350);
+
+    // Picked up mid-stream: no handshake, no RTT sample
+    Connection late{0x0A000002, 40001};
+    send(tracker, at_us(1000), late, true, 7000, 9000, TCP_ACK, 0x2000, 10);
+    slot = find(tracker, late);
+    CHECK(slot != nullptr && slot->state == TcpState::ESTABLISHED && (slot->flags & TCP_FLOW_MIDSTREAM));
+    CHECK(tracker.rtt_samples == 1);
+}
+
+static void check_ipv6() {
+    TcpTracker tracker;
+    Connection conn{0x0A000002, 40000, true};
+    handshake(tracker, 0, conn);
+    CHECK(tracker.ignored == 0);
+    CHECK(tracker.rtt_samples == 1);
+
+    send(tracker, at_us(1000), conn, true, 1001, 5001, TCP_ACK, 0x2000, 100);
+    send(tracker, at_us(1100), conn, true, 1101, 5001, TCP_ACK, 0x2000, 100);
+    CHECK(tracker.retransmissions == 0);
+    send(tracker, at_us(1200), conn, true, 1101, 5001, TCP_ACK, 0x2000, 100);
+    CHECK(tracker.retransmissions == 1);
+
+    const TcpFlowSlot* slot = find(tracker, conn);
+    CHECK(slot != nullptr && slot->state == TcpState::ESTABLISHED && (slot->flags & TCP_FLOW_IPV6));
+
+    // Same folds and ports, other family: another connection
+    FlowKey v4 = flow_key(conn);
+    v4.ipv6 = false;
+    CHECK(tracker.find(v4) == nullptr);
+}
+
+static void check_retransmissions() {
+    TcpTracker tracker;
+    Connection conn{0x0A000001, 40000};
+    handshake(tracker, 0, conn);
+
+    send(tracker, at_us(1000), conn, true, 1001, 5001, TCP_ACK, 0x2000, 100);
+    CHECK(tracker.retransmissions == 0);
+    send(tracker, at_us(1100), conn, true, 1001, 5001, TCP_ACK, 0x2000, 100);
+    CHECK(tracker.retransmissions == 1);
+    // Keepalive: one byte below the next sequence number
+    send(tracker, at_us(1200), conn, true, 1100, 5001, TCP_ACK, 0x2000, 1);
+    send(tracker, at_us(1300), conn, true, 1100, 5001, TCP_ACK);
+    CHECK(tracker.retransmissions == 1);
+    const TcpFlowSlot* slot = find(tracker, conn);
+    CHECK(slot != nullptr && slot->retransmissions == 1);
+
+    Connection repeated{0x0A000002, 40001};
+    send(tracker, at_us(2000), repeated, true, 3000, 0, TCP_SYN);
+    send(tracker, at_us(3000), repeated, true, 3000, 0, TCP_SYN);
+    CHECK(tracker.retransmissions == 2);
+
+    // Zero windows: counted when a side closes its window, not for every segment while it stays closed
+    send(tracker, at_us(4000), conn, false, 5001, 1101, TCP_ACK, 0);
+    send(tracker, at_us(4100), conn, false, 5001, 1101, TCP_ACK, 0);
+    CHECK(tracker.zero_windows == 1);
+    // A one byte probe into the closed window is expected
+    send(tracker, at_us(4200), conn, true, 1101, 5001, TCP_ACK, 0x2000, 1);
+    CHECK(tracker.out_of_window == 0);
+    send(tracker, at_us(4300), conn, false, 5001, 1101, TCP_ACK, 0x2000);
+    send(tracker, at_us(4400), conn, false, 5001, 1101, TCP_ACK, 0);
+    CHECK(tracker.zero_windows == 2);
+    slot = find(tracker, conn);
+    CHECK(slot != nullptr && slot->zero_windows == 2);
+}
+
+static void check_out_of_window() {
+    TcpTracker tracker;
+    Connection conn{0x0A000001, 40000};
+    handshake(tracker, 0, conn);
+
+    // The server acked 1001 with window 0x2000: the right edge is 1001 + 8192
+    send(tracker, at_us(1000), conn, true, 9000, 5001, TCP_ACK, 0x2000, 400);
+    CHECK(tracker.out_of_window == 1);
+    send(tracker, at_us(1100), conn, true, 1001, 5001, TCP_ACK, 0x2000, 400);
+    CHECK(tracker.out_of_window == 1);
+
+    // The server never sent past 5001
+    send(tracker, at_us(1200), conn, true, 1401, 6000, TCP_ACK);
+    CHECK(tracker.out_of_window == 2);
+
+    send(tracker, at_us(1300), conn, false, 100000, 0, TCP_RST);
+    CHECK(tracker.out_of_window == 3);
+    const TcpFlowSlot* slot = find(tracker, conn);
+    CHECK(slot != nullptr && slot->state == TcpState::ESTABLISHED && slot->out_of_window == 3);
+
+    send(tracker, at_us(1400), conn, true, 1401, 0, TCP_RST);
+    CHECK(slot != nullptr && slot->state == TcpState::RESET);
+    CHECK(tracker.flows_reset == 1);
+    CHECK(tracker.retransmissions == 0);
+}
+
+static void check_expiry() {
+    TcpTrackerConfig config;
+    config.capacity = 16;
+    config.handshake_timeout_s = 30;
+    config.established_timeout_s = 600;
+    TcpTracker tracker(config);
+
+    Connection half_open{0x0A000001, 40000};
+    Connection established{0x0A000002, 40001};
+    send(tracker, at_us(0), half_open, true, 1000, 0, TCP_SYN);
+    handshake(tracker, 0, established);
+    CHECK(tracker.active_flows() == 2);
+
+    tracker.expire(at_us(29000000));
+    CHECK(tracker.active_flows() == 2);
+    tracker.expire(at_us(31000000));
+    CHECK(find(tracker, half_open) == nullptr);
+    CHECK(find(tracker, established) != nullptr);
+    CHECK(tracker.flows_expired == 1);
+
+    // The per-packet sweep takes two steps per packet, a removal uses one without moving on: nine packets cover the
+    // whole table
+    Connection active{0x0A000003, 40002};
+    for (uint64_t i = 0; i < 9; i++) {
+        send(tracker, at_us(700000000 + i), active, true, 1000 + static_cast<uint32_t>(i), 0, TCP_ACK);
+    }
+    CHECK(find(tracker, established) == nullptr);
+    CHECK(find(tracker, active) != nullptr);
+    CHECK(tracker.flows_expired == 2);
+    CHECK(tracker.active_flows() == 1);
+}
+
+static void check_churn() {
+    TcpTrackerConfig config;
+    config.capacity = CHURN_CAPACITY;
+    config.closed_timeout_s = 10;
+    TcpTracker tracker(config);
+
+    std::mt19937 rng(TEST_SEED);
+    std::vector<Connection> live;
+    std::vector<Connection> gone;
+    uint32_t next_client = 0x0A000000;
+    uint64_t now_us = 0;
+    size_t lost = 0;
+    size_t stale = 0;
+
+    for (size_t round = 0; round < CHURN_ROUNDS; round++) {
+        while (live.size() < CHURN_FLOWS) {
+            Connection conn{next_client++, static_cast<uint16_t>(1024 + rng() % 60000)};
+            CHECK(send(tracker, at_us(now_us), conn, true, 1000, 2000, TCP_ACK));
+            live.push_back(conn);
+        }
+
+        // Reset a random third, they expire after closed_timeout_s
+        gone.clear();
+        for (size_t i = 0; i < live.size();) {
+            if (rng() % 3 == 0) {
+                send(tracker, at_us(now_us), live[i], true, 1000, 0, TCP_RST);
+                gone.push_back(live[i]);
+                live[i] = live.back();
+                live.pop_back();
+            }
+            else {
+                i++;
+            }
+        }
+
+        now_us += 11000000;
+        if (round % 2) {
+            tracker.expire(at_us(now_us));
+        }
+        // Refreshing the live ones also drives the sweep, on odd rounds it does all the removals
+        for (size_t pass = 0; pass < 2; pass++) {
+            for (const Connection& conn : live) {
+                send(tracker, at_us(now_us), conn, true, 1000, 2000, TCP_ACK);
+            }
+        }
+
+        for (const Connection& conn : live) {
+            const TcpFlowSlot* slot = find(tracker, conn);
+            lost += slot == nullptr || slot->state != TcpState::ESTABLISHED;
+        }
+        for (const Connection& conn : gone) {
+            stale += find(tracker, conn) != nullptr;
+        }
+        CHECK(tracker.active_flows() == live.size());
+    }
+    CHECK(lost == 0);
+    CHECK(stale == 0);
+    CHECK(tracker.table_full == 0);
+    CHECK(tracker.flows_expired == tracker.flows_reset);
+}
+
+int main() {
+    check_rtt();
+    check_ipv6();
+    check_retransmissions();
+    check_out_of_window();
+    check_expiry();
+    check_churn();
+    return test_result("tcp-tracker-test");
+}
@@ -20,8 +20,17 @@ enum class ValidationError {
     TOO_SMALL_FOR_UDP,
     INVALID_UDP_LENGTH,
     UDP_LENGTH_EXCEEDS_PACKET,    
-    UNSUPPORTED_L4_PROTOCOL
+    UNSUPPORTED_L4_PROTOCOL,
+    MISSING_IPV6_HEADER,
+    TOO_SMALL_FOR_IPV6,
+    INVALID_IPV6_VERSION,
+    IPV6_PAYLOAD_LENGTH_EXCEEDS_PACKET,
+    IPV6_EXTENSION_HEADER_TRUNCATED,
+    IPV6_TOO_MANY_EXTENSION_HEADERS,
+    IPV6_MISPLACED_HOP_BY_HOP,
+    ENCAPSULATION_TRUNCATED,
+    ENCAPSULATION_TOO_DEEP
 };
 
-
-
+// Upper-case enumerator name ("TOO_SMALL_FOR_ETHERNET"), for machine-readable output
+const char* validation_error_name(ValidationError error);
@@ -1,6 +1,7 @@
 #pragma once
 #include "packet_view.hpp"
 #include "packet-error.hpp"
+#include <cstdint>
 #include <vector>
 
 class PacketValidator {
@@ -18,10 +19,14 @@ public:
     void print_errors() const;
     void print_raw_packet_bytes() const; 
 
+    // Bit (1 << error) set for every error found, NONE contributes no bit
+    uint32_t error_mask() const;
+
 
 private:
     static bool validate_ethernet(const PacketView& view, ValidationError& error);
     static bool validate_ipv4(const PacketView& view, ValidationError& error);
+    static bool validate_ipv6(const PacketView& view, ValidationError& error);
     static bool validate_tcp(const PacketView& view, ValidationError& error);
     static bool validate_udp(const PacketView& view, ValidationError& error);    
 
@@ -10,6 +10,8 @@
 #define TCP_MIN_HEADER_SIZE 20
 #define UDP_HEADER_SIZE 8
 #define IPv4_ETHERTYPE 0x0800
+#define IPv6_ETHERTYPE 0x86DD
+#define IPV6_HEADER_SIZE 40
 
 /*
     Packet Validator Class Implementation
@@ -29,12 +31,19 @@ void  PacketValidator::validate_packet() {
         return;
     }
 
-    // Layer 3: IPv4 Validation
-    if (!validate_ipv4(view, err)) {
+    // Layer 3: IPv4 or IPv6 Validation
+    bool ipv6 = view.ethertype == IPv6_ETHERTYPE;
+    if (!(ipv6 ? validate_ipv6(view, err) : validate_ipv4(view, err))) {
         errors.push_back(err);
         return;
     }
 
+    // Non-first IPv6 fragments carry no L4 header
+    if (ipv6 && view.ipv6_layer.fragment_offset != 0) {
+        errors.push_back(ValidationError::NONE);
+        return;
+    }
+
     // Layer 4 Protocols based on l4_type
     switch (view.l4_type) {
         case L4Type::TCP:
@@ -81,7 +90,16 @@ void  PacketValidator::validate_packet() {
     TOO_SMALL_FOR_UDP,
     INVALID_UDP_LENGTH,
     UDP_LENGTH_EXCEEDS_PACKET,    
-    UNSUPPORTED_L4_PROTOCOL
+    UNSUPPORTED_L4_PROTOCOL,
+    MISSING_IPV6_HEADER,
+    TOO_SMALL_FOR_IPV6,
+    INVALID_IPV6_VERSION,
+    IPV6_PAYLOAD_LENGTH_EXCEEDS_PACKET,
+    IPV6_EXTENSION_HEADER_TRUNCATED,
+    IPV6_TOO_MANY_EXTENSION_HEADERS,
+    IPV6_MISPLACED_HOP_BY_HOP,
+    ENCAPSULATION_TRUNCATED,
+    ENCAPSULATION_TOO_DEEP
 */
 void PacketValidator::print_errors() const {
     for(ValidationError err: errors) {
@@ -159,6 +177,42 @@ void PacketValidator::print_errors() const {
                 std::cout << "Unsupported L4 Protocol" << std::endl;
                 break;
             
+            case ValidationError::MISSING_IPV6_HEADER:
+                std::cout << "Missing IPv6 header" << std::endl;
+                break;
+
+            case ValidationError::TOO_SMALL_FOR_IPV6:
+                std::cout << "Too small for IPv6" << std::endl;
+                break;
+
+            case ValidationError::INVALID_IPV6_VERSION:
+                std::cout << "Invalid IPv6 version" << std::endl;
+                break;
+
+            case ValidationError::IPV6_PAYLOAD_LENGTH_EXCEEDS_PACKET:
+                std::cout << "IPv6 payload length exceeds packet" << std::endl;
+                break;
+
+            case ValidationError::IPV6_EXTENSION_HEADER_TRUNCATED:
+                std::cout << "IPv6 extension header truncated" << std::endl;
+                break;
+
+            case ValidationError::IPV6_TOO_MANY_EXTENSION_HEADERS:
+                std::cout << "Too many IPv6 extension headers" << std::endl;
+                break;
+
+            case ValidationError::IPV6_MISPLACED_HOP_BY_HOP:
+                std::cout << "IPv6 Hop-by-Hop options not first" << std::endl;
+                break;
+
+            case ValidationError::ENCAPSULATION_TRUNCATED:
+                std::cout << "Encapsulation header truncated" << std::endl;
+                break;
+
+            case ValidationError::ENCAPSULATION_TOO_DEEP:
+                std::cout << "Encapsulation deeper than the parser depth" << std::endl;
+                break;
+
             case ValidationError::NONE:
                 std::cout << "No errors found during Validation" << std::endl;
                 break;
@@ -178,6 +232,16 @@ void PacketValidator::print_errors() const {
 }
 
 
+uint32_t PacketValidator::error_mask() const {
+    uint32_t mask = 0;
+    for (ValidationError err : errors) {
+        if (err != ValidationError::NONE) {
+            mask |= 1u << static_cast<uint32_t>(err);
+        }
+    }
+    return mask;
+}
+
 
 bool PacketValidator::validate_ethernet(const PacketView& view, ValidationError& error) {
     if (view.size() < ETHERNET_HEADER_SIZE) {
@@ -185,9 +249,18 @@ bool PacketValidator::validate_ethernet(const PacketView& view, ValidationError&
         return false;
     }
 
-    // EtherType must be IPv4 for now
-    uint16_t ethertype = ntohs(view.eth_layer.eth->ether_type);
-    if (ethertype != IPv4_ETHERTYPE) {
+    // VLAN / MPLS / tunnel headers the parser could not get past
+    if (view.encap_status == EncapStatus::TRUNCATED) {
+        error = ValidationError::ENCAPSULATION_TRUNCATED;
+        return false;
+    }
+    if (view.encap_status == EncapStatus::TOO_DEEP) {
+        error = ValidationError::ENCAPSULATION_TOO_DEEP;
+        return false;
+    }
+
+    // EtherType of the innermost packet must be IPv4 or IPv6
+    if (view.ethertype != IPv4_ETHERTYPE && view.ethertype != IPv6_ETHERTYPE) {
         error = ValidationError::INVALID_ETHERTYPE;
         return false;
     }
@@ -206,7 +279,7 @@ bool PacketValidator::validate_ipv4(const PacketView& view, ValidationError& err
         return false;
     }
 
-    if(view.size() < ETHERNET_HEADER_SIZE + IPV4_MIN_HEADER_SIZE) {
+    if(view.size() < view.l3_offset + IPV4_MIN_HEADER_SIZE) {
         error = ValidationError::TOO_SMALL_FOR_IPV4;
         return false;
     }
@@ -224,7 +297,7 @@ bool PacketValidator::validate_ipv4(const PacketView& view, ValidationError& err
     }
 
     size_t header_len = ihl * 4;
-    if(view.size() < ETHERNET_HEADER_SIZE + header_len) {
+    if(view.size() < view.l3_offset + header_len) {
         error = ValidationError::INVALID_IPV4_IHL_LENGTH;
         return false;
     }
@@ -236,7 +309,7 @@ bool PacketValidator::validate_ipv4(const PacketView& view, ValidationError& err
     }
 
     // Total length must not exceed actual packet size
-    if(total_len > view.size() -  ETHERNET_HEADER_SIZE) {
+    if(total_len > view.size() - view.l3_offset) {
         error = ValidationError::IPV4_TOTAL_LENGTH_EXCEEDS_PACKET;
         return false;
     }
@@ -245,6 +318,51 @@ bool PacketValidator::validate_ipv4(const PacketView& view, ValidationError& err
 }
 
 
+// Validate IPv6 header and the extension header walk done by the parser
+bool PacketValidator::validate_ipv6(const PacketView& view, ValidationError& error) {
+    const IPv6Layer& ipv6_layer = view.ipv6_layer;
+
+    if(!view.has_ipv6 || !ipv6_layer.ip6h) {
+        error = ValidationError::MISSING_IPV6_HEADER;
+        return false;
+    }
+
+    if(view.size() < view.l3_offset + IPV6_HEADER_SIZE) {
+        error = ValidationError::TOO_SMALL_FOR_IPV6;
+        return false;
+    }
+
+    uint8_t version = ntohl(ipv6_layer.ip6h->version_class_flow) >> 28;
+    if(version != 6) {
+        error = ValidationError::INVALID_IPV6_VERSION;
+        return false;
+    }
+
+    // Payload length must not exceed actual packet size (0 = jumbogram, sized by Hop-by-Hop option)
+    uint16_t payload_len = ntohs(ipv6_layer.ip6h->payload_length);
+    if(payload_len > view.size() - view.l3_offset - IPV6_HEADER_SIZE) {
+        error = ValidationError::IPV6_PAYLOAD_LENGTH_EXCEEDS_PACKET;
+        return false;
+    }
+
+    switch(ipv6_layer.status) {
+        case IPv6ExtensionStatus::TRUNCATED:
+            error = ValidationError::IPV6_EXTENSION_HEADER_TRUNCATED;
+            return false;
+        case IPv6ExtensionStatus::TOO_MANY:
+            error = ValidationError::IPV6_TOO_MANY_EXTENSION_HEADERS;
+            return false;
+        case IPv6ExtensionStatus::MISPLACED_HOP_BY_HOP:
+            error = ValidationError::IPV6_MISPLACED_HOP_BY_HOP;
+            return false;
+        default:
+            break;
+    }
+
+    return true;
+}
+
+
 // Validate TCP 
 bool PacketValidator::validate_tcp(const PacketView& view, ValidationError& error) {
     const TCPHeader* tcp = view.tcp_layer.tcph;
@@ -254,7 +372,7 @@ bool PacketValidator::validate_tcp(const PacketView& view, ValidationError& erro
         return false;
     }
 
-    size_t tcp_offset = ETHERNET_HEADER_SIZE + view.ip_layer.header_size();
+    size_t tcp_offset = view.l4_offset;
     if (view.size() < tcp_offset + TCP_MIN_HEADER_SIZE) {
         error = ValidationError::TOO_SMALL_FOR_TCP;
         return false;
@@ -285,7 +403,7 @@ bool PacketValidator::validate_udp(const PacketView& view, ValidationError& erro
         return false;
     }
 
-    size_t udp_offset = ETHERNET_HEADER_SIZE + view.ip_layer.header_size();
+    size_t udp_offset = view.l4_offset;
     if (view.size() < udp_offset + UDP_HEADER_SIZE) {
         error = ValidationError::TOO_SMALL_FOR_UDP;
         return false;
@@ -306,3 +424,38 @@ bool PacketValidator::validate_udp(const PacketView& view, ValidationError& erro
 }
 
 
+
+
+const char* validation_error_name(ValidationError error) {
+    switch (error) {
+        case ValidationError::NONE: return "NONE";
+        case ValidationError::TOO_SMALL_FOR_ETHERNET: return "TOO_SMALL_FOR_ETHERNET";
+        case ValidationError::INVALID_ETHERTYPE: return "INVALID_ETHERTYPE";
+        case ValidationError::MISSING_IPV4_HEADER: return "MISSING_IPV4_HEADER";
+        case ValidationError::TOO_SMALL_FOR_IPV4: return "TOO_SMALL_FOR_IPV4";
+        case ValidationError::INVALID_IPV4_VERSION: return "INVALID_IPV4_VERSION";
+        case ValidationError::INVALID_IPV4_IHL: return "INVALID_IPV4_IHL";
+        case ValidationError::INVALID_IPV4_IHL_LENGTH: return "INVALID_IPV4_IHL_LENGTH";
+        case ValidationError::INVALID_IPV4_TOTAL_LENGTH: return "INVALID_IPV4_TOTAL_LENGTH";
+        case ValidationError::IPV4_TOTAL_LENGTH_EXCEEDS_PACKET: return "IPV4_TOTAL_LENGTH_EXCEEDS_PACKET";
+        case ValidationError::MISSING_TCP_HEADER: return "MISSING_TCP_HEADER";
+        case ValidationError::TOO_SMALL_FOR_TCP: return "TOO_SMALL_FOR_TCP";
+        case ValidationError::INVALID_TCP_DATA_OFFSET: return "INVALID_TCP_DATA_OFFSET";
+        case ValidationError::TCP_HEADER_EXCEEDS_PACKET: return "TCP_HEADER_EXCEEDS_PACKET";
+        case ValidationError::MISSING_UDP_HEADER: return "MISSING_UDP_HEADER";
+        case ValidationError::TOO_SMALL_FOR_UDP: return "TOO_SMALL_FOR_UDP";
+        case ValidationError::INVALID_UDP_LENGTH: return "INVALID_UDP_LENGTH";
+        case ValidationError::UDP_LENGTH_EXCEEDS_PACKET: return "UDP_LENGTH_EXCEEDS_PACKET";
+        case ValidationError::UNSUPPORTED_L4_PROTOCOL: return "UNSUPPORTED_L4_PROTOCOL";
+        case ValidationError::MISSING_IPV6_HEADER: return "MISSING_IPV6_HEADER";
+        case ValidationError::TOO_SMALL_FOR_IPV6: return "TOO_SMALL_FOR_IPV6";
+        case ValidationError::INVALID_IPV6_VERSION: return "INVALID_IPV6_VERSION";
+        case ValidationError::IPV6_PAYLOAD_LENGTH_EXCEEDS_PACKET: return "IPV6_PAYLOAD_LENGTH_EXCEEDS_PACKET";
+        case ValidationError::IPV6_EXTENSION_HEADER_TRUNCATED: return "IPV6_EXTENSION_HEADER_TRUNCATED";
+        case ValidationError::IPV6_TOO_MANY_EXTENSION_HEADERS: return "IPV6_TOO_MANY_EXTENSION_HEADERS";
+        case ValidationError::IPV6_MISPLACED_HOP_BY_HOP: return "IPV6_MISPLACED_HOP_BY_HOP";
+        case ValidationError::ENCAPSULATION_TRUNCATED: return "ENCAPSULATION_TRUNCATED";
+        case ValidationError::ENCAPSULATION_TOO_DEEP: return "ENCAPSULATION_TOO_DEEP";
+        default: return "UNKNOWN";
+    }
+}